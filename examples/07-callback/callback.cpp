@@ -217,7 +217,7 @@ struct BgfxCallback : public bgfx::CallbackI
 		}
 	}
 
-	virtual void captureFrame(const void* _data, uint32_t /*_size*/) override
+	virtual void captureFrame(const void* _data, uint32_t /*_size*/, uint32_t /*_frame*/) override
 	{
 		if (NULL != m_writer)
 		{
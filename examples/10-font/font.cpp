@@ -291,6 +291,9 @@ public:
 			// Submit the static text.
 			m_textBufferManager->submitTextBuffer(m_staticText, 0);
 
+			// Advance font atlas LRU clock.
+			m_textBufferManager->frame();
+
 			// Advance to next frame. Rendering thread will be kicked to
 			// process submitted rendering primitives.
 			bgfx::frame();
@@ -239,6 +239,9 @@ public:
 			// Draw your text.
 			m_textBufferManager->submitTextBuffer(m_scrollableBuffer, 0);
 
+			// Advance font atlas LRU clock.
+			m_textBufferManager->frame();
+
 			// Advance to next frame. Rendering thread will be kicked to
 			// process submitted rendering primitives.
 			bgfx::frame();
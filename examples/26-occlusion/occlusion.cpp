@@ -6,6 +6,7 @@
 #include "common.h"
 #include "bgfx_utils.h"
 #include "camera.h"
+#include "occlusionbuffer.h"
 #include "imgui/imgui.h"
 
 namespace
@@ -135,6 +136,11 @@ public:
 			}
 		}
 
+		// Small depth buffer is enough for occluders, objects are tested conservatively.
+		m_occlusionBuffer.init(256, 128, 2);
+		m_mode = m_occlusionQuerySupported ? 0 : 1;
+		m_softwareTime = 0.0;
+
 		cameraCreate();
 
 		cameraSetPosition({ 15.5f, 0.0f, -15.5f });
@@ -152,6 +158,8 @@ public:
 		// Cleanup.
 		cameraDestroy();
 
+		m_occlusionBuffer.shutdown();
+
 		if (m_occlusionQuerySupported)
 		{
 			for (uint32_t ii = 0; ii < BX_COUNTOF(m_occlusionQueries); ++ii)
@@ -184,98 +192,199 @@ public:
 				, uint16_t(m_height)
 				);
 
-			showExampleDialog(this
-				, !m_occlusionQuerySupported
-				? "Occlusion query is not supported."
-				: NULL
+			showExampleDialog(this);
+
+			ImGui::SetNextWindowPos(
+				  ImVec2(m_width - m_width / 5.0f - 10.0f, 10.0f)
+				, ImGuiCond_FirstUseEver
+				);
+			ImGui::SetNextWindowSize(
+				  ImVec2(m_width / 5.0f, m_height / 4.0f)
+				, ImGuiCond_FirstUseEver
 				);
+			ImGui::Begin("Settings"
+				, NULL
+				, 0
+				);
+
+			if (m_occlusionQuerySupported)
+			{
+				ImGui::RadioButton("Occlusion query", &m_mode, 0);
+			}
+			else
+			{
+				ImGui::Text("Occlusion query is not supported.");
+				m_mode = 1;
+			}
+
+			ImGui::RadioButton("Software occlusion", &m_mode, 1);
+
+			if (1 == m_mode)
+			{
+				ImGui::Text("Rasterize and test %0.3f [ms]", m_softwareTime);
+			}
+
+			ImGui::End();
 
 			imguiEndFrame();
 
-			if (m_occlusionQuerySupported)
+			int64_t now = bx::getHPCounter();
+			static int64_t last = now;
+			const int64_t frameTime = now - last;
+			last = now;
+			const double freq = double(bx::getHPFrequency() );
+			const float time = (float)( (now-m_timeOffset)/double(bx::getHPFrequency() ) );
+			const float deltaTime = float(frameTime/freq);
+
+			// Update camera.
+			float view[16];
+			cameraUpdate(deltaTime, m_state.m_mouse);
+			cameraGetViewMtx(view);
+
+			// Software occlusion buffer expects depth in [0, 1] range.
+			float viewProj[16];
+
+			// Set view and projection matrix for view 0.
+			{
+				float proj[16];
+				bx::mtxProj(proj, 90.0f, float(m_width)/float(m_height), 0.1f, 10000.0f, false);
+				bx::mtxMul(viewProj, view, proj);
+
+				bx::mtxProj(proj, 90.0f, float(m_width)/float(m_height), 0.1f, 10000.0f, bgfx::getCaps()->homogeneousDepth);
+
+				bgfx::setViewTransform(0, view, proj);
+				bgfx::setViewRect(0, 0, 0, uint16_t(m_width), uint16_t(m_height) );
+
+				bgfx::setViewTransform(1, view, proj);
+				bgfx::setViewRect(1, 0, 0, uint16_t(m_width), uint16_t(m_height) );
+
+				const bx::Vec3 at  = {  0.0f,  0.0f,   0.0f };
+				const bx::Vec3 eye = { 17.5f, 10.0f, -17.5f };
+				bx::mtxLookAt(view, eye, at);
+
+				bgfx::setViewTransform(2, view, proj);
+				bgfx::setViewRect(2, 10, uint16_t(m_height - m_height/4 - 10), uint16_t(m_width/4), uint16_t(m_height/4) );
+			}
+
+			bgfx::touch(0);
+			bgfx::touch(2);
+
+			float mtx[CUBES_DIM*CUBES_DIM][16];
+
+			for (uint32_t yy = 0; yy < CUBES_DIM; ++yy)
 			{
-				int64_t now = bx::getHPCounter();
-				static int64_t last = now;
-				const int64_t frameTime = now - last;
-				last = now;
-				const double freq = double(bx::getHPFrequency() );
-				const float time = (float)( (now-m_timeOffset)/double(bx::getHPFrequency() ) );
-				const float deltaTime = float(frameTime/freq);
-
-				// Update camera.
-				float view[16];
-				cameraUpdate(deltaTime, m_state.m_mouse);
-				cameraGetViewMtx(view);
-
-				// Set view and projection matrix for view 0.
+				for (uint32_t xx = 0; xx < CUBES_DIM; ++xx)
 				{
-					float proj[16];
-					bx::mtxProj(proj, 90.0f, float(m_width)/float(m_height), 0.1f, 10000.0f, bgfx::getCaps()->homogeneousDepth);
+					float* cube = mtx[yy*CUBES_DIM+xx];
+					bx::mtxRotateXY(cube, time + xx*0.21f, time + yy*0.37f);
+					cube[12] = -(CUBES_DIM-1) * 3.0f / 2.0f + float(xx)*3.0f;
+					cube[13] = 0.0f;
+					cube[14] = -(CUBES_DIM-1) * 3.0f / 2.0f + float(yy)*3.0f;
+				}
+			}
+
+			const bool software = 1 == m_mode;
 
-					bgfx::setViewTransform(0, view, proj);
-					bgfx::setViewRect(0, 0, 0, uint16_t(m_width), uint16_t(m_height) );
+			bool visible[CUBES_DIM*CUBES_DIM];
 
-					bgfx::setViewTransform(1, view, proj);
-					bgfx::setViewRect(1, 0, 0, uint16_t(m_width), uint16_t(m_height) );
+			if (software)
+			{
+				const int64_t start = bx::getHPCounter();
 
-					const bx::Vec3 at  = {  0.0f,  0.0f,   0.0f };
-					const bx::Vec3 eye = { 17.5f, 10.0f, -17.5f };
-					bx::mtxLookAt(view, eye, at);
+				// Cubes are occluders and occludees at the same time. Cube's own depth is never
+				// nearer than its bounding box, so cube can't occlude itself.
+				m_occlusionBuffer.begin(viewProj);
 
-					bgfx::setViewTransform(2, view, proj);
-					bgfx::setViewRect(2, 10, uint16_t(m_height - m_height/4 - 10), uint16_t(m_width/4), uint16_t(m_height/4) );
+				for (uint32_t ii = 0; ii < CUBES_DIM*CUBES_DIM; ++ii)
+				{
+					m_occlusionBuffer.addOccluder(mtx[ii]
+						, s_cubeVertices
+						, BX_COUNTOF(s_cubeVertices)
+						, sizeof(PosColorVertex)
+						, s_cubeIndices
+						, BX_COUNTOF(s_cubeIndices)
+						);
 				}
 
-				bgfx::touch(0);
-				bgfx::touch(2);
+				m_occlusionBuffer.end();
 
-				uint8_t img[CUBES_DIM*CUBES_DIM*2];
+				const Aabb aabb =
+				{
+					{ -1.0f, -1.0f, -1.0f },
+					{  1.0f,  1.0f,  1.0f },
+				};
 
-				for (uint32_t yy = 0; yy < CUBES_DIM; ++yy)
+				for (uint32_t ii = 0; ii < CUBES_DIM*CUBES_DIM; ++ii)
 				{
-					for (uint32_t xx = 0; xx < CUBES_DIM; ++xx)
-					{
-						float mtx[16];
-						bx::mtxRotateXY(mtx, time + xx*0.21f, time + yy*0.37f);
-						mtx[12] = -(CUBES_DIM-1) * 3.0f / 2.0f + float(xx)*3.0f;
-						mtx[13] = 0.0f;
-						mtx[14] = -(CUBES_DIM-1) * 3.0f / 2.0f + float(yy)*3.0f;
+					visible[ii] = m_occlusionBuffer.isVisible(aabb, mtx[ii]);
+				}
 
-						bgfx::OcclusionQueryHandle occlusionQuery = m_occlusionQueries[yy*CUBES_DIM+xx];
+				m_softwareTime = double(bx::getHPCounter() - start)*1000.0/freq;
+			}
+
+			uint8_t img[CUBES_DIM*CUBES_DIM*2];
 
-						bgfx::setTransform(mtx);
+			for (uint32_t ii = 0; ii < CUBES_DIM*CUBES_DIM; ++ii)
+			{
+				if (software)
+				{
+					// Result is known before submit, occluded cubes are not submitted at all.
+					if (visible[ii])
+					{
+						bgfx::setTransform(mtx[ii]);
 						bgfx::setVertexBuffer(0, m_vbh);
 						bgfx::setIndexBuffer(m_ibh);
-						bgfx::setCondition(occlusionQuery, true);
 						bgfx::setState(BGFX_STATE_DEFAULT);
 						bgfx::submit(0, m_program);
 
-						bgfx::setTransform(mtx);
+						bgfx::setTransform(mtx[ii]);
 						bgfx::setVertexBuffer(0, m_vbh);
 						bgfx::setIndexBuffer(m_ibh);
-						bgfx::setState(0
-							| BGFX_STATE_DEPTH_TEST_LEQUAL
-							| BGFX_STATE_CULL_CW
-							);
-						bgfx::submit(1, m_program, occlusionQuery);
-
-						bgfx::setTransform(mtx);
-						bgfx::setVertexBuffer(0, m_vbh);
-						bgfx::setIndexBuffer(m_ibh);
-						bgfx::setCondition(occlusionQuery, true);
 						bgfx::setState(BGFX_STATE_DEFAULT);
 						bgfx::submit(2, m_program);
-
-						img[(yy*CUBES_DIM+xx)*2+0] = " \xfex"[bgfx::getResult(occlusionQuery)];
-						img[(yy*CUBES_DIM+xx)*2+1] = 0xf;
 					}
-				}
 
-				for (uint16_t xx = 0; xx < CUBES_DIM; ++xx)
-				{
-					bgfx::dbgTextImage(5 + xx*2, 20, 1, CUBES_DIM, img + xx*2, CUBES_DIM*2);
+					img[ii*2+0] = " \xfe"[visible[ii] ];
+					img[ii*2+1] = 0xf;
+					continue;
 				}
 
+				bgfx::OcclusionQueryHandle occlusionQuery = m_occlusionQueries[ii];
+
+				bgfx::setTransform(mtx[ii]);
+				bgfx::setVertexBuffer(0, m_vbh);
+				bgfx::setIndexBuffer(m_ibh);
+				bgfx::setCondition(occlusionQuery, true);
+				bgfx::setState(BGFX_STATE_DEFAULT);
+				bgfx::submit(0, m_program);
+
+				bgfx::setTransform(mtx[ii]);
+				bgfx::setVertexBuffer(0, m_vbh);
+				bgfx::setIndexBuffer(m_ibh);
+				bgfx::setState(0
+					| BGFX_STATE_DEPTH_TEST_LEQUAL
+					| BGFX_STATE_CULL_CW
+					);
+				bgfx::submit(1, m_program, occlusionQuery);
+
+				bgfx::setTransform(mtx[ii]);
+				bgfx::setVertexBuffer(0, m_vbh);
+				bgfx::setIndexBuffer(m_ibh);
+				bgfx::setCondition(occlusionQuery, true);
+				bgfx::setState(BGFX_STATE_DEFAULT);
+				bgfx::submit(2, m_program);
+
+				img[ii*2+0] = " \xfex"[bgfx::getResult(occlusionQuery)];
+				img[ii*2+1] = 0xf;
+			}
+
+			for (uint16_t xx = 0; xx < CUBES_DIM; ++xx)
+			{
+				bgfx::dbgTextImage(5 + xx*2, 20, 1, CUBES_DIM, img + xx*2, CUBES_DIM*2);
+			}
+
+			if (!software)
+			{
 				int32_t numPixels = 0;
 				bgfx::getResult(m_occlusionQueries[0], &numPixels);
 				bgfx::dbgTextPrintf(5, 20 + CUBES_DIM + 1, 0xf, "Passing pixels count: %d", numPixels);
@@ -301,7 +410,10 @@ public:
 	bgfx::VertexBufferHandle m_vbh;
 	bgfx::IndexBufferHandle m_ibh;
 	bgfx::ProgramHandle m_program;
+	OcclusionBuffer m_occlusionBuffer;
+	double m_softwareTime;
 	int64_t m_timeOffset;
+	int32_t m_mode;
 	bool m_occlusionQuerySupported;
 
 	bgfx::OcclusionQueryHandle m_occlusionQueries[CUBES_DIM*CUBES_DIM];
@@ -311,4 +423,4 @@ public:
 
 } // namespace
 
-ENTRY_IMPLEMENT_MAIN(ExampleOcclusion, "26-occlusion", "Using occlusion query for conditional rendering.");
+ENTRY_IMPLEMENT_MAIN(ExampleOcclusion, "26-occlusion", "Using occlusion query and software occlusion for conditional rendering.");
@@ -0,0 +1,53 @@
+/*
+ * Copyright 2011-2019 Branimir Karadzic. All rights reserved.
+ * License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause
+ */
+
+#include "bgfx_compute.sh"
+
+//meshlet data created by meshletBufferCreate, 4 vec4 per meshlet
+BUFFER_RO(meshletData, vec4, 0);
+//one indexed draw per meshlet, culled meshlets are written with zero instances
+BUFFER_RW(drawcallData, uvec4, 1);
+
+//frustum planes in mesh space (xyz normal, w distance), normals are pointing inside
+uniform vec4 u_frustumPlanes[6];
+//xyz eye position in mesh space, w number of meshlets
+uniform vec4 u_meshletCullingConfig;
+
+NUM_THREADS(64, 1, 1)
+void main()
+{
+	uint meshletId = gl_GlobalInvocationID.x;
+
+	//make sure that we not processing more meshlets than available
+	if (meshletId < uint(u_meshletCullingConfig.w) )
+	{
+		vec4  sphere   = meshletData[4 * meshletId    ];
+		vec4  coneApex = meshletData[4 * meshletId + 1];
+		vec3  coneAxis = meshletData[4 * meshletId + 2].xyz;
+		uvec2 range    = floatBitsToUint(meshletData[4 * meshletId + 3].xy);
+
+		bool visible = true;
+
+		UNROLL
+		for (int ii = 0; ii < 6; ++ii)
+		{
+			visible = visible && dot(u_frustumPlanes[ii].xyz, sphere.xyz) + u_frustumPlanes[ii].w >= -sphere.w;
+		}
+
+		//all triangles in meshlet are facing away from eye
+		vec3 dir = normalize(coneApex.xyz - u_meshletCullingConfig.xyz);
+		visible = visible && dot(dir, coneAxis) < coneApex.w;
+
+		drawIndexedIndirect(
+			drawcallData,
+			meshletId,
+			range.y,				//number of indices
+			visible ? 1u : 0u,		//number of instances
+			range.x,				//offset into the index buffer
+			0u,						//offset into the vertex buffer
+			0u						//offset into the instance buffer
+			);
+	}
+}
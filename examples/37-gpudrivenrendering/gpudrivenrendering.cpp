@@ -341,6 +341,8 @@ public:
 		u_cullingConfig     = bgfx::createUniform("u_cullingConfig",     bgfx::UniformType::Vec4);
 		u_color             = bgfx::createUniform("u_color",             bgfx::UniformType::Vec4, 32);
 		s_texOcclusionDepth = bgfx::createUniform("s_texOcclusionDepth", bgfx::UniformType::Sampler);
+		u_frustumPlanes        = bgfx::createUniform("u_frustumPlanes",        bgfx::UniformType::Vec4, 6);
+		u_meshletCullingConfig = bgfx::createUniform("u_meshletCullingConfig", bgfx::UniformType::Vec4);
 
 		//create props
 		{
@@ -692,6 +694,50 @@ public:
 			BGFX_BUFFER_COMPUTE_READ | BGFX_BUFFER_INDEX32
 		);
 
+		// Mesh culled per meshlet on GPU, each meshlet is drawn by its own indirect draw call.
+		// Mesh is converted with geometryc --meshlets, see examples/assets/meshes.
+		{
+			m_meshletMesh  = meshLoad("meshes/bunny_meshlets.bin");
+			m_meshletGroup = NULL;
+
+			if (NULL != m_meshletMesh)
+			{
+				for (GroupArray::const_iterator it = m_meshletMesh->m_groups.begin(), itEnd = m_meshletMesh->m_groups.end(); it != itEnd; ++it)
+				{
+					if (!it->m_meshlets.empty() )
+					{
+						m_meshletGroup = &*it;
+						break;
+					}
+				}
+			}
+
+			m_meshletBuffer         = BGFX_INVALID_HANDLE;
+			m_meshletIndirectBuffer = BGFX_INVALID_HANDLE;
+			m_programCullMeshlets   = BGFX_INVALID_HANDLE;
+
+			if (NULL != m_meshletGroup)
+			{
+				m_meshletBuffer         = meshletBufferCreate(*m_meshletGroup);
+				m_meshletIndirectBuffer = bgfx::createIndirectBuffer(uint32_t(m_meshletGroup->m_meshlets.size() ) );
+				m_programCullMeshlets   = loadProgram("cs_gdr_cull_meshlets", NULL);
+
+				bx::mtxSRT(m_meshletWorld
+					, 5.0f, 5.0f, 5.0f
+					, 0.0f, 0.0f, 0.0f
+					, 0.0f, 0.0f, 0.0f
+					);
+
+				m_meshletMaterialID = m_noofMaterials;
+				setVector4(m_materials[m_meshletMaterialID].m_color, 0.8f, 0.4f, 0.1f, 1.0f);
+				m_noofMaterials++;
+			}
+			else
+			{
+				bx::printf("Mesh with meshlets not found, meshlet culling is disabled.\n");
+			}
+		}
+
 		m_timeOffset = bx::getHPCounter();
 
 		m_useIndirect = true;
@@ -739,7 +785,21 @@ public:
 		bgfx::destroy(m_allPropsVertexbufferHandle);
 		bgfx::destroy(m_allPropsIndexbufferHandle);
 
+		if (NULL != m_meshletGroup)
+		{
+			bgfx::destroy(m_meshletBuffer);
+			bgfx::destroy(m_meshletIndirectBuffer);
+			bgfx::destroy(m_programCullMeshlets);
+		}
+
+		if (NULL != m_meshletMesh)
+		{
+			meshUnload(m_meshletMesh);
+		}
+
 		bgfx::destroy(s_texOcclusionDepth);
+		bgfx::destroy(u_frustumPlanes);
+		bgfx::destroy(u_meshletCullingConfig);
 		bgfx::destroy(u_inputRTSize);
 		bgfx::destroy(u_cullingConfig);
 		bgfx::destroy(u_color);
@@ -897,6 +957,81 @@ public:
 
 	}
 
+	// cull meshlets against view frustum and their normal cones, and write one indirect draw
+	// per meshlet, culled meshlets are written with zero instances
+	void renderCullMeshletsPass()
+	{
+		// meshlet bounds are in mesh space, bring frustum and eye into mesh space instead
+		float viewProj[16];
+		bx::mtxMul(viewProj, m_mainView, m_mainProj);
+
+		float mvp[16];
+		bx::mtxMul(mvp, m_meshletWorld, viewProj);
+
+		bx::Plane planes[6];
+		buildFrustumPlanes(planes, mvp);
+
+		float frustumPlanes[6][4];
+		for (uint32_t ii = 0; ii < 6; ++ii)
+		{
+			setVector4(frustumPlanes[ii], planes[ii].normal.x, planes[ii].normal.y, planes[ii].normal.z, planes[ii].dist);
+		}
+		bgfx::setUniform(u_frustumPlanes, frustumPlanes, 6);
+
+		float invWorld[16];
+		bx::mtxInverse(invWorld, m_meshletWorld);
+		const bx::Vec3 eye = bx::mul(m_camera.m_pos.curr, invWorld);
+
+		const uint32_t numMeshlets = uint32_t(m_meshletGroup->m_meshlets.size() );
+
+		float meshletCullingConfig[4];
+		setVector4(meshletCullingConfig, eye.x, eye.y, eye.z, float(numMeshlets) );
+		bgfx::setUniform(u_meshletCullingConfig, meshletCullingConfig);
+
+		bgfx::setBuffer(0, m_meshletBuffer,         bgfx::Access::Read);
+		bgfx::setBuffer(1, m_meshletIndirectBuffer, bgfx::Access::Write);
+
+		bgfx::dispatch(RENDER_PASS_OCCLUDE_PROPS_ID, m_programCullMeshlets, (numMeshlets + 63)/64, 1, 1);
+	}
+
+	// render meshlet mesh, with one indirect draw per meshlet when culled on GPU
+	void renderMeshletMesh()
+	{
+		const uint16_t instanceStride = sizeof(float)*16;
+
+		if (1 != bgfx::getAvailInstanceDataBuffer(1, instanceStride) )
+		{
+			return;
+		}
+
+		bgfx::InstanceDataBuffer instanceBuffer;
+		bgfx::allocInstanceDataBuffer(&instanceBuffer, 1, instanceStride);
+
+		float* world = (float*)instanceBuffer.data;
+		bx::memCopy(world, m_meshletWorld, sizeof(m_meshletWorld) );
+		//pack the material ID into the world transform
+		world[3] = float(m_meshletMaterialID);
+
+		bgfx::setVertexBuffer(0, m_meshletGroup->m_vbh);
+		bgfx::setIndexBuffer(m_meshletGroup->m_ibh);
+		bgfx::setInstanceDataBuffer(&instanceBuffer);
+		bgfx::setState(BGFX_STATE_DEFAULT);
+
+		if (m_useIndirect)
+		{
+			bgfx::submit(RENDER_PASS_MAIN_ID
+				, m_programMainPass
+				, m_meshletIndirectBuffer
+				, 0
+				, uint16_t(m_meshletGroup->m_meshlets.size() )
+				);
+		}
+		else
+		{
+			bgfx::submit(RENDER_PASS_MAIN_ID, m_programMainPass);
+		}
+	}
+
 	// render the unoccluded props to the screen
 	void renderMainPass()
 	{
@@ -1060,7 +1195,18 @@ public:
 
 				renderOccludePropsPass();
 
+				if (NULL != m_meshletGroup
+				&&  m_useIndirect)
+				{
+					renderCullMeshletsPass();
+				}
+
 				renderMainPass();
+
+				if (NULL != m_meshletGroup)
+				{
+					renderMeshletMesh();
+				}
 			}
 
 			// Advance to next frame. Rendering thread will be kicked to
@@ -1115,6 +1261,16 @@ public:
 	bgfx::UniformHandle u_inputRTSize;
 	bgfx::UniformHandle u_cullingConfig;
 	bgfx::UniformHandle u_color;
+	bgfx::UniformHandle u_frustumPlanes;
+	bgfx::UniformHandle u_meshletCullingConfig;
+
+	Mesh* m_meshletMesh;
+	const Group* m_meshletGroup;
+	bgfx::VertexBufferHandle m_meshletBuffer;
+	bgfx::IndirectBufferHandle m_meshletIndirectBuffer;
+	bgfx::ProgramHandle m_programCullMeshlets;
+	float m_meshletWorld[16];
+	uint16_t m_meshletMaterialID;
 
 	Prop*	m_props;
 	Material* m_materials;
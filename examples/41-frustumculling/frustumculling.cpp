@@ -0,0 +1,312 @@
+/*
+ * Copyright 2011-2019 Branimir Karadzic. All rights reserved.
+ * License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause
+ */
+
+#include <bx/rng.h>
+#include <bx/timer.h>
+#include "common.h"
+#include "bgfx_utils.h"
+#include "culling.h"
+#include "imgui/imgui.h"
+
+namespace
+{
+
+static const uint32_t kMaxObjects = 1<<20;
+
+// Scalar reference, same test as cullAabbs one object at the time.
+static uint32_t cullAabbsScalar(uint32_t* _outIndices, const bx::Plane* _planes, const Aabb* _aabbs, uint32_t _num, const float* _mtx)
+{
+	uint32_t num = 0;
+
+	for (uint32_t ii = 0; ii < _num; ++ii)
+	{
+		const float* mtx = &_mtx[ii*16];
+		const bx::Vec3 center  = bx::mul(getCenter(_aabbs[ii]), mtx);
+		const bx::Vec3 extents = getExtents(_aabbs[ii]);
+
+		const bx::Vec3 worldExtents =
+		{
+			extents.x*bx::abs(mtx[0]) + extents.y*bx::abs(mtx[4]) + extents.z*bx::abs(mtx[ 8]),
+			extents.x*bx::abs(mtx[1]) + extents.y*bx::abs(mtx[5]) + extents.z*bx::abs(mtx[ 9]),
+			extents.x*bx::abs(mtx[2]) + extents.y*bx::abs(mtx[6]) + extents.z*bx::abs(mtx[10]),
+		};
+
+		bool visible = true;
+		for (uint32_t jj = 0; jj < 6 && visible; ++jj)
+		{
+			const bx::Plane& plane = _planes[jj];
+			const float reach = bx::dot(bx::abs(plane.normal), worldExtents);
+			visible = bx::dot(plane.normal, center) + plane.dist >= -reach;
+		}
+
+		if (visible)
+		{
+			_outIndices[num++] = ii;
+		}
+	}
+
+	return num;
+}
+
+class ExampleFrustumCulling : public entry::AppI
+{
+public:
+	ExampleFrustumCulling(const char* _name, const char* _description)
+		: entry::AppI(_name, _description)
+	{
+	}
+
+	void init(int32_t _argc, const char* const* _argv, uint32_t _width, uint32_t _height) override
+	{
+		Args args(_argc, _argv);
+
+		m_width  = _width;
+		m_height = _height;
+		m_debug  = BGFX_DEBUG_TEXT;
+		m_reset  = BGFX_RESET_VSYNC;
+
+		bgfx::Init init;
+		init.type     = args.m_type;
+		init.vendorId = args.m_pciId;
+		init.resolution.width  = m_width;
+		init.resolution.height = m_height;
+		init.resolution.reset  = m_reset;
+		bgfx::init(init);
+
+		// Enable debug text.
+		bgfx::setDebug(m_debug);
+
+		// Set view 0 clear state.
+		bgfx::setViewClear(0
+			, BGFX_CLEAR_COLOR|BGFX_CLEAR_DEPTH
+			, 0x303030ff
+			, 1.0f
+			, 0
+			);
+
+		bx::AllocatorI* allocator = entry::getAllocator();
+
+		m_aabbs         = (Aabb*    )BX_ALLOC(allocator, kMaxObjects*sizeof(Aabb) );
+		m_mtx           = (float*   )BX_ALIGNED_ALLOC(allocator, kMaxObjects*16*sizeof(float), 16);
+		m_soa           = (float*   )BX_ALIGNED_ALLOC(allocator, kMaxObjects* 6*sizeof(float), 16);
+		m_visibleScalar = (uint32_t*)BX_ALLOC(allocator, kMaxObjects*sizeof(uint32_t) );
+		m_visibleSimd   = (uint32_t*)BX_ALLOC(allocator, kMaxObjects*sizeof(uint32_t) );
+		m_visibleMt     = (uint32_t*)BX_ALLOC(allocator, kMaxObjects*sizeof(uint32_t) );
+
+		m_aabbSoa.minX = &m_soa[kMaxObjects*0];
+		m_aabbSoa.minY = &m_soa[kMaxObjects*1];
+		m_aabbSoa.minZ = &m_soa[kMaxObjects*2];
+		m_aabbSoa.maxX = &m_soa[kMaxObjects*3];
+		m_aabbSoa.maxY = &m_soa[kMaxObjects*4];
+		m_aabbSoa.maxZ = &m_soa[kMaxObjects*5];
+
+		// Random boxes scattered around the camera, each with its own transform.
+		bx::RngMwc rng;
+		for (uint32_t ii = 0; ii < kMaxObjects; ++ii)
+		{
+			const bx::Vec3 extents =
+			{
+				0.5f + bx::frnd(&rng),
+				0.5f + bx::frnd(&rng),
+				0.5f + bx::frnd(&rng),
+			};
+
+			Aabb& aabb = m_aabbs[ii];
+			toAabb(aabb, extents);
+
+			m_soa[kMaxObjects*0 + ii] = aabb.min.x;
+			m_soa[kMaxObjects*1 + ii] = aabb.min.y;
+			m_soa[kMaxObjects*2 + ii] = aabb.min.z;
+			m_soa[kMaxObjects*3 + ii] = aabb.max.x;
+			m_soa[kMaxObjects*4 + ii] = aabb.max.y;
+			m_soa[kMaxObjects*5 + ii] = aabb.max.z;
+
+			bx::mtxSRT(&m_mtx[ii*16]
+				, 1.0f, 1.0f, 1.0f
+				, bx::frndh(&rng)*bx::kPi, bx::frndh(&rng)*bx::kPi, bx::frndh(&rng)*bx::kPi
+				, bx::frndh(&rng)*500.0f, bx::frndh(&rng)*500.0f, bx::frndh(&rng)*500.0f
+				);
+		}
+
+		m_numObjects = 100000;
+		m_numThreads = 3;
+		m_culler.init(m_numThreads);
+
+		m_timeScalar = 0.0;
+		m_timeSimd   = 0.0;
+		m_timeMt     = 0.0;
+		m_numVisible = 0;
+		m_mismatch   = false;
+
+		m_timeOffset = bx::getHPCounter();
+
+		imguiCreate();
+	}
+
+	virtual int shutdown() override
+	{
+		imguiDestroy();
+
+		m_culler.shutdown();
+
+		bx::AllocatorI* allocator = entry::getAllocator();
+		BX_FREE(allocator, m_aabbs);
+		BX_ALIGNED_FREE(allocator, m_mtx, 16);
+		BX_ALIGNED_FREE(allocator, m_soa, 16);
+		BX_FREE(allocator, m_visibleScalar);
+		BX_FREE(allocator, m_visibleSimd);
+		BX_FREE(allocator, m_visibleMt);
+
+		// Shutdown bgfx.
+		bgfx::shutdown();
+
+		return 0;
+	}
+
+	bool update() override
+	{
+		if (!entry::processEvents(m_width, m_height, m_debug, m_reset, &m_mouseState) )
+		{
+			const float time = float(bx::getHPCounter() - m_timeOffset)/float(bx::getHPFrequency() );
+
+			// Camera rotates in place, so visible set changes every frame.
+			const bx::Vec3 at  = { bx::sin(time*0.2f), 0.0f, bx::cos(time*0.2f) };
+			const bx::Vec3 eye = { 0.0f, 0.0f, 0.0f };
+
+			float view[16];
+			bx::mtxLookAt(view, eye, at);
+
+			float proj[16];
+			bx::mtxProj(proj, 60.0f, float(m_width)/float(m_height), 0.1f, 300.0f, bgfx::getCaps()->homogeneousDepth);
+
+			float viewProj[16];
+			bx::mtxMul(viewProj, view, proj);
+
+			bx::Plane planes[6];
+			buildFrustumPlanes(planes, viewProj);
+
+			const uint32_t num = uint32_t(m_numObjects);
+			const double toMs = 1000.0/double(bx::getHPFrequency() );
+
+			int64_t start = bx::getHPCounter();
+			const uint32_t numScalar = cullAabbsScalar(m_visibleScalar, planes, m_aabbs, num, m_mtx);
+
+			int64_t now = bx::getHPCounter();
+			m_timeScalar = double(now - start)*toMs;
+
+			start = now;
+			const uint32_t numSimd = cullAabbs(m_visibleSimd, planes, m_aabbSoa, num, m_mtx);
+
+			now = bx::getHPCounter();
+			m_timeSimd = double(now - start)*toMs;
+
+			start = now;
+			m_numVisible = m_culler.cull(m_visibleMt, planes, m_aabbSoa, num, m_mtx);
+
+			now = bx::getHPCounter();
+			m_timeMt = double(now - start)*toMs;
+
+			// All paths output visible indices in ascending order, compare whole lists.
+			m_mismatch = false
+				|| numScalar != numSimd
+				|| numSimd   != m_numVisible
+				|| 0 != bx::memCmp(m_visibleScalar, m_visibleSimd, numSimd*sizeof(uint32_t) )
+				|| 0 != bx::memCmp(m_visibleSimd,   m_visibleMt,   numSimd*sizeof(uint32_t) )
+				;
+
+			imguiBeginFrame(m_mouseState.m_mx
+				,  m_mouseState.m_my
+				, (m_mouseState.m_buttons[entry::MouseButton::Left  ] ? IMGUI_MBUT_LEFT   : 0)
+				| (m_mouseState.m_buttons[entry::MouseButton::Right ] ? IMGUI_MBUT_RIGHT  : 0)
+				| (m_mouseState.m_buttons[entry::MouseButton::Middle] ? IMGUI_MBUT_MIDDLE : 0)
+				,  m_mouseState.m_mz
+				, uint16_t(m_width)
+				, uint16_t(m_height)
+				);
+
+			showExampleDialog(this);
+
+			ImGui::SetNextWindowPos(
+				  ImVec2(m_width - m_width / 4.0f - 10.0f, 10.0f)
+				, ImGuiCond_FirstUseEver
+				);
+			ImGui::SetNextWindowSize(
+				  ImVec2(m_width / 4.0f, m_height / 3.0f)
+				, ImGuiCond_FirstUseEver
+				);
+			ImGui::Begin("Settings"
+				, NULL
+				, 0
+				);
+
+			ImGui::SliderInt("Num objects", &m_numObjects, 100000, kMaxObjects);
+
+			if (ImGui::SliderInt("Num threads", &m_numThreads, 0, CULLING_MAX_THREADS) )
+			{
+				m_culler.shutdown();
+				m_culler.init(m_numThreads);
+			}
+
+			ImGui::Separator();
+			ImGui::Text("Visible: %d", m_numVisible);
+			ImGui::Text("Scalar  %0.3f [ms]", m_timeScalar);
+			ImGui::Text("SIMD    %0.3f [ms]", m_timeSimd);
+			ImGui::Text("Threads %0.3f [ms]", m_timeMt);
+
+			if (m_mismatch)
+			{
+				ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Results don't match!");
+			}
+
+			ImGui::End();
+
+			imguiEndFrame();
+
+			// Set view 0 default viewport.
+			bgfx::setViewRect(0, 0, 0, uint16_t(m_width), uint16_t(m_height) );
+
+			// This dummy draw call is here to make sure that view 0 is cleared
+			// if no other draw calls are submitted to view 0.
+			bgfx::touch(0);
+
+			// Advance to next frame. Rendering thread will be kicked to
+			// process submitted rendering primitives.
+			bgfx::frame();
+
+			return true;
+		}
+
+		return false;
+	}
+
+	entry::MouseState m_mouseState;
+
+	BatchCuller m_culler;
+	AabbSoa m_aabbSoa;
+	Aabb* m_aabbs;
+	float* m_mtx;
+	float* m_soa;
+	uint32_t* m_visibleScalar;
+	uint32_t* m_visibleSimd;
+	uint32_t* m_visibleMt;
+
+	double m_timeScalar;
+	double m_timeSimd;
+	double m_timeMt;
+	int64_t m_timeOffset;
+
+	uint32_t m_width;
+	uint32_t m_height;
+	uint32_t m_debug;
+	uint32_t m_reset;
+	uint32_t m_numVisible;
+	int32_t m_numObjects;
+	int32_t m_numThreads;
+	bool m_mismatch;
+};
+
+} // namespace
+
+ENTRY_IMPLEMENT_MAIN(ExampleFrustumCulling, "41-frustumculling", "Batch frustum culling of up to million objects.");
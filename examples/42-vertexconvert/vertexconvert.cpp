@@ -0,0 +1,262 @@
+/*
+ * Copyright 2011-2019 Branimir Karadzic. All rights reserved.
+ * License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause
+ */
+
+#include <bx/rng.h>
+#include <bx/timer.h>
+#include "common.h"
+#include "bgfx_utils.h"
+#include "imgui/imgui.h"
+
+namespace
+{
+
+static const uint32_t kNumVertices = 1<<20;
+
+struct Conversion
+{
+	const char* m_name;
+	bgfx::VertexDecl m_decl;
+};
+
+// Generic path, every attribute of every vertex goes through vertexUnpack/vertexPack.
+static void vertexConvertGeneric(const bgfx::VertexDecl& _destDecl, void* _destData, const bgfx::VertexDecl& _srcDecl, const void* _srcData, uint32_t _num)
+{
+	for (uint32_t ii = 0; ii < _num; ++ii)
+	{
+		for (uint32_t attr = 0; attr < bgfx::Attrib::Count; ++attr)
+		{
+			if (_destDecl.has(bgfx::Attrib::Enum(attr) ) )
+			{
+				float unpacked[4];
+				bgfx::vertexUnpack(unpacked, bgfx::Attrib::Enum(attr), _srcDecl, _srcData, ii);
+				bgfx::vertexPack(unpacked, true, bgfx::Attrib::Enum(attr), _destDecl, _destData, ii);
+			}
+		}
+	}
+}
+
+class ExampleVertexConvert : public entry::AppI
+{
+public:
+	ExampleVertexConvert(const char* _name, const char* _description)
+		: entry::AppI(_name, _description)
+	{
+	}
+
+	void init(int32_t _argc, const char* const* _argv, uint32_t _width, uint32_t _height) override
+	{
+		Args args(_argc, _argv);
+
+		m_width  = _width;
+		m_height = _height;
+		m_debug  = BGFX_DEBUG_TEXT;
+		m_reset  = BGFX_RESET_VSYNC;
+
+		bgfx::Init init;
+		init.type     = args.m_type;
+		init.vendorId = args.m_pciId;
+		init.resolution.width  = m_width;
+		init.resolution.height = m_height;
+		init.resolution.reset  = m_reset;
+		bgfx::init(init);
+
+		// Enable debug text.
+		bgfx::setDebug(m_debug);
+
+		// Set view 0 clear state.
+		bgfx::setViewClear(0
+			, BGFX_CLEAR_COLOR|BGFX_CLEAR_DEPTH
+			, 0x303030ff
+			, 1.0f
+			, 0
+			);
+
+		// Typical streamed mesh, float position, normal, tangent and texcoord.
+		m_srcDecl
+			.begin()
+			.add(bgfx::Attrib::Position,  3, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::Normal,    3, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::Tangent,   3, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Float)
+			.end();
+
+		m_conversion[0].m_name = "Int16 normalized";
+		m_conversion[0].m_decl
+			.begin()
+			.add(bgfx::Attrib::Position,  4, bgfx::AttribType::Int16, true, true)
+			.add(bgfx::Attrib::Normal,    4, bgfx::AttribType::Int16, true, true)
+			.add(bgfx::Attrib::Tangent,   4, bgfx::AttribType::Int16, true, true)
+			.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Int16, true, true)
+			.end();
+
+		m_conversion[1].m_name = "Uint8 normalized";
+		m_conversion[1].m_decl
+			.begin()
+			.add(bgfx::Attrib::Position,  3, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::Normal,    4, bgfx::AttribType::Uint8, true, true)
+			.add(bgfx::Attrib::Tangent,   4, bgfx::AttribType::Uint8, true, true)
+			.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Uint8, true, true)
+			.end();
+
+		m_conversion[2].m_name = "Half";
+		m_conversion[2].m_decl
+			.begin()
+			.add(bgfx::Attrib::Position,  4, bgfx::AttribType::Half)
+			.add(bgfx::Attrib::Normal,    4, bgfx::AttribType::Half)
+			.add(bgfx::Attrib::Tangent,   4, bgfx::AttribType::Half)
+			.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Half)
+			.end();
+
+		bx::AllocatorI* allocator = entry::getAllocator();
+
+		m_src     = (float*  )BX_ALLOC(allocator, m_srcDecl.getSize(kNumVertices) );
+		m_dest    = (uint8_t*)BX_ALLOC(allocator, m_srcDecl.getSize(kNumVertices) );
+		m_generic = (uint8_t*)BX_ALLOC(allocator, m_srcDecl.getSize(kNumVertices) );
+
+		// Values in [-1, 1] range, valid input for both normalized and unsigned packing.
+		bx::RngMwc rng;
+		for (uint32_t ii = 0, num = m_srcDecl.getSize(kNumVertices)/sizeof(float); ii < num; ++ii)
+		{
+			m_src[ii] = bx::frndh(&rng);
+		}
+
+		m_current     = 0;
+		m_numVertices = 1<<18;
+		m_timeFast    = 0.0;
+		m_timeGeneric = 0.0;
+		m_match       = true;
+
+		imguiCreate();
+	}
+
+	virtual int shutdown() override
+	{
+		imguiDestroy();
+
+		bx::AllocatorI* allocator = entry::getAllocator();
+		BX_FREE(allocator, m_src);
+		BX_FREE(allocator, m_dest);
+		BX_FREE(allocator, m_generic);
+
+		// Shutdown bgfx.
+		bgfx::shutdown();
+
+		return 0;
+	}
+
+	bool update() override
+	{
+		if (!entry::processEvents(m_width, m_height, m_debug, m_reset, &m_mouseState) )
+		{
+			const bgfx::VertexDecl& destDecl = m_conversion[m_current].m_decl;
+			const uint32_t num = uint32_t(m_numVertices);
+			const double toMs = 1000.0/double(bx::getHPFrequency() );
+
+			// Padding between attributes is not written by conversion.
+			bx::memSet(m_dest,    0, destDecl.getSize(num) );
+			bx::memSet(m_generic, 0, destDecl.getSize(num) );
+
+			int64_t start = bx::getHPCounter();
+			bgfx::vertexConvert(destDecl, m_dest, m_srcDecl, m_src, num);
+
+			int64_t now = bx::getHPCounter();
+			m_timeFast = double(now - start)*toMs;
+
+			start = now;
+			vertexConvertGeneric(destDecl, m_generic, m_srcDecl, m_src, num);
+
+			now = bx::getHPCounter();
+			m_timeGeneric = double(now - start)*toMs;
+
+			m_match = 0 == bx::memCmp(m_dest, m_generic, destDecl.getSize(num) );
+
+			imguiBeginFrame(m_mouseState.m_mx
+				,  m_mouseState.m_my
+				, (m_mouseState.m_buttons[entry::MouseButton::Left  ] ? IMGUI_MBUT_LEFT   : 0)
+				| (m_mouseState.m_buttons[entry::MouseButton::Right ] ? IMGUI_MBUT_RIGHT  : 0)
+				| (m_mouseState.m_buttons[entry::MouseButton::Middle] ? IMGUI_MBUT_MIDDLE : 0)
+				,  m_mouseState.m_mz
+				, uint16_t(m_width)
+				, uint16_t(m_height)
+				);
+
+			showExampleDialog(this);
+
+			ImGui::SetNextWindowPos(
+				  ImVec2(m_width - m_width / 4.0f - 10.0f, 10.0f)
+				, ImGuiCond_FirstUseEver
+				);
+			ImGui::SetNextWindowSize(
+				  ImVec2(m_width / 4.0f, m_height / 3.0f)
+				, ImGuiCond_FirstUseEver
+				);
+			ImGui::Begin("Settings"
+				, NULL
+				, 0
+				);
+
+			for (int32_t ii = 0; ii < int32_t(BX_COUNTOF(m_conversion) ); ++ii)
+			{
+				ImGui::RadioButton(m_conversion[ii].m_name, &m_current, ii);
+			}
+
+			ImGui::SliderInt("Num vertices", &m_numVertices, 1024, kNumVertices);
+
+			const double srcMb = double(m_srcDecl.getSize(num) )/(1024.0*1024.0);
+
+			ImGui::Separator();
+			ImGui::Text("vertexConvert %0.3f [ms], %0.1f [MB/s]", m_timeFast, srcMb/(m_timeFast*0.001) );
+			ImGui::Text("Generic       %0.3f [ms], %0.1f [MB/s]", m_timeGeneric, srcMb/(m_timeGeneric*0.001) );
+
+			if (!m_match)
+			{
+				ImGui::TextColored(ImVec4(1.0f, 0.0f, 0.0f, 1.0f), "Results don't match!");
+			}
+
+			ImGui::End();
+
+			imguiEndFrame();
+
+			// Set view 0 default viewport.
+			bgfx::setViewRect(0, 0, 0, uint16_t(m_width), uint16_t(m_height) );
+
+			// This dummy draw call is here to make sure that view 0 is cleared
+			// if no other draw calls are submitted to view 0.
+			bgfx::touch(0);
+
+			// Advance to next frame. Rendering thread will be kicked to
+			// process submitted rendering primitives.
+			bgfx::frame();
+
+			return true;
+		}
+
+		return false;
+	}
+
+	entry::MouseState m_mouseState;
+
+	bgfx::VertexDecl m_srcDecl;
+	Conversion m_conversion[3];
+
+	float* m_src;
+	uint8_t* m_dest;
+	uint8_t* m_generic;
+
+	double m_timeFast;
+	double m_timeGeneric;
+
+	uint32_t m_width;
+	uint32_t m_height;
+	uint32_t m_debug;
+	uint32_t m_reset;
+	int32_t m_current;
+	int32_t m_numVertices;
+	bool m_match;
+};
+
+} // namespace
+
+ENTRY_IMPLEMENT_MAIN(ExampleVertexConvert, "42-vertexconvert", "Vertex format conversion throughput.");
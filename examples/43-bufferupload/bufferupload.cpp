@@ -0,0 +1,343 @@
+/*
+ * Copyright 2011-2019 Branimir Karadzic. All rights reserved.
+ * License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause
+ */
+
+#include <bx/timer.h>
+#include "common.h"
+#include "bgfx_utils.h"
+#include "imgui/imgui.h"
+
+namespace
+{
+
+struct PosColorVertex
+{
+	float m_x;
+	float m_y;
+	float m_z;
+	uint32_t m_abgr;
+
+	static void init()
+	{
+		ms_decl
+			.begin()
+			.add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float)
+			.add(bgfx::Attrib::Color0,   4, bgfx::AttribType::Uint8, true)
+			.end();
+	};
+
+	static bgfx::VertexDecl ms_decl;
+};
+
+bgfx::VertexDecl PosColorVertex::ms_decl;
+
+static const uint32_t kGridSize      = 256;
+static const uint32_t kMaxTriangles  = kGridSize*kGridSize;
+static const uint32_t kMaxVertices   = kMaxTriangles*3;
+static const uint32_t kMaxUpdates    = 4096;
+
+struct Mode
+{
+	enum Enum
+	{
+		DynamicSingle,
+		DynamicSplit,
+		Transient,
+
+		Count
+	};
+};
+
+static const char* s_modeName[Mode::Count] =
+{
+	"Dynamic, single update",
+	"Dynamic, split updates",
+	"Transient",
+};
+
+class ExampleBufferUpload : public entry::AppI
+{
+public:
+	ExampleBufferUpload(const char* _name, const char* _description)
+		: entry::AppI(_name, _description)
+	{
+	}
+
+	void init(int32_t _argc, const char* const* _argv, uint32_t _width, uint32_t _height) override
+	{
+		Args args(_argc, _argv);
+
+		m_width  = _width;
+		m_height = _height;
+		m_debug  = BGFX_DEBUG_TEXT;
+		m_reset  = BGFX_RESET_NONE;
+
+		bgfx::Init init;
+		init.type     = args.m_type;
+		init.vendorId = args.m_pciId;
+		init.resolution.width  = m_width;
+		init.resolution.height = m_height;
+		init.resolution.reset  = m_reset;
+		bgfx::init(init);
+
+		// Enable debug text.
+		bgfx::setDebug(m_debug);
+
+		// Set view 0 clear state.
+		bgfx::setViewClear(0
+			, BGFX_CLEAR_COLOR|BGFX_CLEAR_DEPTH
+			, 0x303030ff
+			, 1.0f
+			, 0
+			);
+
+		PosColorVertex::init();
+
+		m_vertices = (PosColorVertex*)BX_ALLOC(entry::getAllocator(), kMaxVertices*sizeof(PosColorVertex) );
+
+		m_dvbh = bgfx::createDynamicVertexBuffer(kMaxVertices, PosColorVertex::ms_decl);
+
+		// Create program from shaders.
+		m_program = loadProgram("vs_cubes", "fs_cubes");
+
+		m_mode         = Mode::DynamicSplit;
+		m_numTriangles = kMaxTriangles/4;
+		m_numUpdates   = 256;
+		m_updateTime   = 0.0;
+		m_renderTime   = 0.0;
+		m_frameTime    = 0.0;
+
+		m_timeOffset = bx::getHPCounter();
+		m_lastFrame  = m_timeOffset;
+
+		imguiCreate();
+	}
+
+	virtual int shutdown() override
+	{
+		imguiDestroy();
+
+		bgfx::destroy(m_dvbh);
+		bgfx::destroy(m_program);
+
+		BX_FREE(entry::getAllocator(), m_vertices);
+
+		// Shutdown bgfx.
+		bgfx::shutdown();
+
+		return 0;
+	}
+
+	// Grid of small triangles waving along Z, every vertex changes every frame.
+	void fillVertices(PosColorVertex* _vertices, uint32_t _numTriangles, float _time)
+	{
+		const float spacing = 24.0f/float(kGridSize);
+		const float half    = spacing*0.4f;
+
+		for (uint32_t ii = 0; ii < _numTriangles; ++ii)
+		{
+			const uint32_t xx = ii%kGridSize;
+			const uint32_t yy = ii/kGridSize;
+
+			const float px = (float(xx) - kGridSize*0.5f)*spacing;
+			const float py = (float(yy) - kGridSize*0.5f)*spacing;
+			const float pz = bx::sin(_time*2.0f + px*0.5f) * bx::cos(_time*1.5f + py*0.5f) * 2.0f;
+
+			const uint32_t abgr = 0xff000000
+				| (uint32_t(xx) << 16)
+				| (uint32_t(yy) <<  8)
+				| uint32_t(128.0f + pz*60.0f)
+				;
+
+			PosColorVertex* vertex = &_vertices[ii*3];
+			vertex[0].m_x = px - half; vertex[0].m_y = py - half; vertex[0].m_z = pz; vertex[0].m_abgr = abgr;
+			vertex[1].m_x = px;        vertex[1].m_y = py + half; vertex[1].m_z = pz; vertex[1].m_abgr = abgr;
+			vertex[2].m_x = px + half; vertex[2].m_y = py - half; vertex[2].m_z = pz; vertex[2].m_abgr = abgr;
+		}
+	}
+
+	bool update() override
+	{
+		if (!entry::processEvents(m_width, m_height, m_debug, m_reset, &m_mouseState) )
+		{
+			const int64_t now  = bx::getHPCounter();
+			const double toMs  = 1000.0/double(bx::getHPFrequency() );
+			const float  time  = float( (now - m_timeOffset)/double(bx::getHPFrequency() ) );
+
+			m_frameTime = double(now - m_lastFrame)*toMs;
+			m_lastFrame = now;
+
+			const uint32_t numTriangles = uint32_t(m_numTriangles);
+			const uint32_t numVertices  = numTriangles*3;
+			const uint32_t stride       = PosColorVertex::ms_decl.getStride();
+
+			fillVertices(m_vertices, numTriangles, time);
+
+			int64_t start = bx::getHPCounter();
+
+			bool draw = true;
+
+			switch (m_mode)
+			{
+			case Mode::DynamicSingle:
+				bgfx::update(m_dvbh, 0, bgfx::copy(m_vertices, numVertices*stride) );
+				bgfx::setVertexBuffer(0, m_dvbh, 0, numVertices);
+				break;
+
+			case Mode::DynamicSplit:
+				{
+					// Many small updates, each one is separate upload command.
+					const uint32_t numUpdates = bx::uint32_min(uint32_t(m_numUpdates), numTriangles);
+					const uint32_t perUpdate  = (numTriangles + numUpdates - 1)/numUpdates;
+
+					for (uint32_t ii = 0; ii < numTriangles; ii += perUpdate)
+					{
+						const uint32_t num = bx::uint32_min(perUpdate, numTriangles - ii);
+						bgfx::update(m_dvbh, ii*3, bgfx::copy(&m_vertices[ii*3], num*3*stride) );
+					}
+
+					bgfx::setVertexBuffer(0, m_dvbh, 0, numVertices);
+				}
+				break;
+
+			case Mode::Transient:
+				if (numVertices == bgfx::getAvailTransientVertexBuffer(numVertices, PosColorVertex::ms_decl) )
+				{
+					bgfx::TransientVertexBuffer tvb;
+					bgfx::allocTransientVertexBuffer(&tvb, numVertices, PosColorVertex::ms_decl);
+					bx::memCopy(tvb.data, m_vertices, numVertices*stride);
+					bgfx::setVertexBuffer(0, &tvb);
+				}
+				else
+				{
+					draw = false;
+				}
+				break;
+
+			default:
+				break;
+			}
+
+			m_updateTime = double(bx::getHPCounter() - start)*toMs;
+
+			// Render thread time of previous frame, includes executing all uploads.
+			const bgfx::Stats* stats = bgfx::getStats();
+			m_renderTime = double(stats->cpuTimeEnd - stats->cpuTimeBegin)*1000.0/double(stats->cpuTimerFreq);
+
+			imguiBeginFrame(m_mouseState.m_mx
+				,  m_mouseState.m_my
+				, (m_mouseState.m_buttons[entry::MouseButton::Left  ] ? IMGUI_MBUT_LEFT   : 0)
+				| (m_mouseState.m_buttons[entry::MouseButton::Right ] ? IMGUI_MBUT_RIGHT  : 0)
+				| (m_mouseState.m_buttons[entry::MouseButton::Middle] ? IMGUI_MBUT_MIDDLE : 0)
+				,  m_mouseState.m_mz
+				, uint16_t(m_width)
+				, uint16_t(m_height)
+				);
+
+			showExampleDialog(this);
+
+			ImGui::SetNextWindowPos(
+				  ImVec2(m_width - m_width / 4.0f - 10.0f, 10.0f)
+				, ImGuiCond_FirstUseEver
+				);
+			ImGui::SetNextWindowSize(
+				  ImVec2(m_width / 4.0f, m_height / 2.5f)
+				, ImGuiCond_FirstUseEver
+				);
+			ImGui::Begin("Settings"
+				, NULL
+				, 0
+				);
+
+			for (int32_t ii = 0; ii < Mode::Count; ++ii)
+			{
+				ImGui::RadioButton(s_modeName[ii], &m_mode, ii);
+			}
+
+			ImGui::SliderInt("Num triangles", &m_numTriangles, 1024, kMaxTriangles);
+
+			if (Mode::DynamicSplit == m_mode)
+			{
+				ImGui::SliderInt("Num updates", &m_numUpdates, 1, kMaxUpdates);
+			}
+
+			const double mb = double(numVertices*stride)/(1024.0*1024.0);
+
+			ImGui::Separator();
+			ImGui::Text("Upload size    %0.2f [MB]", mb);
+			ImGui::Text("Frame          %0.3f [ms]", m_frameTime);
+			ImGui::Text("API update     %0.3f [ms]", m_updateTime);
+			ImGui::Text("Render thread  %0.3f [ms]", m_renderTime);
+			ImGui::Text("Throughput     %0.1f [MB/s]", mb/(m_frameTime*0.001) );
+			ImGui::Text("Wait render    %0.3f [ms]", double(stats->waitRender)*1000.0/double(stats->cpuTimerFreq) );
+			ImGui::Text("Wait submit    %0.3f [ms]", double(stats->waitSubmit)*1000.0/double(stats->cpuTimerFreq) );
+
+			ImGui::End();
+
+			imguiEndFrame();
+
+			const bx::Vec3 at  = { 0.0f, 0.0f,   0.0f };
+			const bx::Vec3 eye = { 0.0f, 0.0f, -30.0f };
+
+			float view[16];
+			bx::mtxLookAt(view, eye, at);
+
+			float proj[16];
+			bx::mtxProj(proj, 60.0f, float(m_width)/float(m_height), 0.1f, 100.0f, bgfx::getCaps()->homogeneousDepth);
+			bgfx::setViewTransform(0, view, proj);
+
+			// Set view 0 default viewport.
+			bgfx::setViewRect(0, 0, 0, uint16_t(m_width), uint16_t(m_height) );
+
+			// This dummy draw call is here to make sure that view 0 is cleared
+			// if no other draw calls are submitted to view 0.
+			bgfx::touch(0);
+
+			if (draw)
+			{
+				bgfx::setState(0
+					| BGFX_STATE_WRITE_RGB
+					| BGFX_STATE_WRITE_A
+					| BGFX_STATE_WRITE_Z
+					| BGFX_STATE_DEPTH_TEST_LESS
+					| BGFX_STATE_MSAA
+					);
+
+				bgfx::submit(0, m_program);
+			}
+
+			// Advance to next frame. Rendering thread will be kicked to
+			// process submitted rendering primitives.
+			bgfx::frame();
+
+			return true;
+		}
+
+		return false;
+	}
+
+	entry::MouseState m_mouseState;
+
+	PosColorVertex* m_vertices;
+	bgfx::DynamicVertexBufferHandle m_dvbh;
+	bgfx::ProgramHandle m_program;
+
+	double m_updateTime;
+	double m_renderTime;
+	double m_frameTime;
+	int64_t m_timeOffset;
+	int64_t m_lastFrame;
+
+	uint32_t m_width;
+	uint32_t m_height;
+	uint32_t m_debug;
+	uint32_t m_reset;
+	int32_t m_mode;
+	int32_t m_numTriangles;
+	int32_t m_numUpdates;
+};
+
+} // namespace
+
+ENTRY_IMPLEMENT_MAIN(ExampleBufferUpload, "43-bufferupload", "Vertex buffer upload throughput.");
@@ -8,21 +8,29 @@
 #include <tinystl/allocator.h>
 #include <tinystl/vector.h>
 #include <tinystl/string.h>
+#include <tinystl/unordered_map.h>
 namespace stl = tinystl;
 
 #include <bgfx/bgfx.h>
 #include <bx/commandline.h>
 #include <bx/endian.h>
+#include <bx/file.h>
 #include <bx/math.h>
+#include <bx/mutex.h>
 #include <bx/readerwriter.h>
+#include <bx/semaphore.h>
 #include <bx/string.h>
+#include <bx/thread.h>
 #include "entry/entry.h"
 #include <meshoptimizer/src/meshoptimizer.h>
 
 #include "bgfx_utils.h"
+#include "culling.h"
 
 #include <bimg/decode.h>
 
+#include "../../src/shader.h"
+
 void* load(bx::FileReaderI* _reader, bx::AllocatorI* _allocator, const char* _filePath, uint32_t* _size)
 {
 	if (bx::open(_reader, _filePath) )
@@ -96,10 +104,8 @@ static void* loadMem(bx::FileReaderI* _reader, bx::AllocatorI* _allocator, const
 	return NULL;
 }
 
-static bgfx::ShaderHandle loadShader(bx::FileReaderI* _reader, const char* _name)
+static void getShaderFilePath(char* _filePath, int32_t _max, const char* _name)
 {
-	char filePath[512];
-
 	const char* shaderPath = "???";
 
 	switch (bgfx::getRendererType() )
@@ -120,9 +126,15 @@ static bgfx::ShaderHandle loadShader(bx::FileReaderI* _reader, const char* _name
 		break;
 	}
 
-	bx::strCopy(filePath, BX_COUNTOF(filePath), shaderPath);
-	bx::strCat(filePath, BX_COUNTOF(filePath), _name);
-	bx::strCat(filePath, BX_COUNTOF(filePath), ".bin");
+	bx::strCopy(_filePath, _max, shaderPath);
+	bx::strCat(_filePath, _max, _name);
+	bx::strCat(_filePath, _max, ".bin");
+}
+
+static bgfx::ShaderHandle loadShader(bx::FileReaderI* _reader, const char* _name)
+{
+	char filePath[512];
+	getShaderFilePath(filePath, BX_COUNTOF(filePath), _name);
 
 	bgfx::ShaderHandle handle = bgfx::createShader(loadMem(_reader, filePath) );
 	bgfx::setName(handle, _name);
@@ -152,6 +164,291 @@ bgfx::ProgramHandle loadProgram(const char* _vsName, const char* _fsName)
 	return loadProgram(entry::getFileReader(), _vsName, _fsName);
 }
 
+struct ShaderVariantPack
+{
+	bool load(bx::FileReaderI* _reader, const char* _name)
+	{
+		char filePath[512];
+		getShaderFilePath(filePath, BX_COUNTOF(filePath), _name);
+
+		bx::strCopy(m_name, BX_COUNTOF(m_name), _name);
+		m_data = loadMem(_reader, entry::getAllocator(), filePath, &m_size);
+		if (NULL == m_data)
+		{
+			return false;
+		}
+
+		bx::MemoryReader reader(m_data, m_size);
+
+		uint32_t magic;
+		bx::read(&reader, magic);
+
+		if (BGFX_CHUNK_MAGIC_VPK != magic)
+		{
+			// Regular shader binary is pack with single variant.
+			m_numKeywords = 0;
+			m_numVariants = 1;
+			m_blobIndex.push_back(0);
+			m_blob.push_back( (const uint8_t*)m_data);
+			m_blobSize.push_back(m_size);
+			m_shader.push_back(BGFX_INVALID_HANDLE);
+			return true;
+		}
+
+		uint16_t numKeywords;
+		bx::read(&reader, numKeywords);
+		m_numKeywords = bx::min<uint32_t>(numKeywords, BGFX_SHADER_VARIANTS_MAX_KEYWORDS);
+		BX_WARN(numKeywords == m_numKeywords, "%s: Too many keywords %d.", _name, numKeywords);
+
+		for (uint32_t ii = 0; ii < numKeywords; ++ii)
+		{
+			uint16_t len;
+			bx::read(&reader, len);
+
+			if (ii < m_numKeywords)
+			{
+				const char* keyword = (const char*)m_data + bx::seek(&reader);
+				m_keyword[ii].set(keyword, len);
+			}
+
+			bx::skip(&reader, len);
+		}
+
+		uint32_t numVariants;
+		bx::read(&reader, numVariants);
+
+		uint32_t numBlobs;
+		bx::read(&reader, numBlobs);
+
+		m_numVariants = 1<<m_numKeywords;
+		m_blobIndex.resize(m_numVariants);
+		bx::read(&reader, m_blobIndex.data(), int32_t(m_numVariants*sizeof(uint16_t) ) );
+		bx::skip(&reader, (numVariants-m_numVariants)*sizeof(uint16_t) );
+
+		m_blob.reserve(numBlobs);
+		m_blobSize.reserve(numBlobs);
+		for (uint32_t ii = 0; ii < numBlobs; ++ii)
+		{
+			uint32_t size;
+			bx::read(&reader, size);
+			m_blob.push_back( (const uint8_t*)m_data + bx::seek(&reader) );
+			m_blobSize.push_back(size);
+			bx::skip(&reader, size);
+		}
+
+		m_shader.resize(numBlobs, BGFX_INVALID_HANDLE);
+
+		return true;
+	}
+
+	void unload()
+	{
+		for (uint32_t ii = 0, num = uint32_t(m_shader.size() ); ii < num; ++ii)
+		{
+			if (bgfx::isValid(m_shader[ii]) )
+			{
+				bgfx::destroy(m_shader[ii]);
+			}
+		}
+
+		if (NULL != m_data)
+		{
+			::unload(m_data);
+		}
+	}
+
+	int32_t findKeyword(const bx::StringView& _keyword) const
+	{
+		for (uint32_t ii = 0; ii < m_numKeywords; ++ii)
+		{
+			if (0 == bx::strCmp(m_keyword[ii], _keyword) )
+			{
+				return int32_t(ii);
+			}
+		}
+
+		return -1;
+	}
+
+	uint16_t getBlob(uint32_t _mask) const
+	{
+		return m_blobIndex[_mask & (m_numVariants-1)];
+	}
+
+	bgfx::ShaderHandle getShader(uint16_t _blob)
+	{
+		bgfx::ShaderHandle& handle = m_shader[_blob];
+		if (!bgfx::isValid(handle) )
+		{
+			// Pack memory is released on unload, shader gets its own copy
+			// instead of reference.
+			handle = bgfx::createShader(bgfx::copy(m_blob[_blob], m_blobSize[_blob]) );
+			bgfx::setName(handle, m_name);
+		}
+
+		return handle;
+	}
+
+	char        m_name[128];
+	void*       m_data;
+	uint32_t    m_size;
+
+	bx::StringView m_keyword[BGFX_SHADER_VARIANTS_MAX_KEYWORDS];
+	uint32_t       m_numKeywords;
+	uint32_t       m_numVariants;
+
+	stl::vector<uint16_t>           m_blobIndex;
+	stl::vector<const uint8_t*>     m_blob;
+	stl::vector<uint32_t>           m_blobSize;
+	stl::vector<bgfx::ShaderHandle> m_shader;
+};
+
+struct ProgramVariants
+{
+	uint32_t getStageMask(uint32_t _mask, const uint8_t* _remap) const
+	{
+		uint32_t mask = 0;
+		for (uint32_t ii = 0; ii < m_numKeywords; ++ii)
+		{
+			if (0 != (_mask & (1<<ii) )
+			&&  UINT8_MAX != _remap[ii])
+			{
+				mask |= 1<<_remap[ii];
+			}
+		}
+
+		return mask;
+	}
+
+	ShaderVariantPack m_vs;
+	ShaderVariantPack m_fs;
+	bool m_hasFs;
+
+	// Union of keywords used by both shaders, and mapping to keyword bit
+	// of each shader.
+	bx::StringView m_keyword[BGFX_SHADER_VARIANTS_MAX_KEYWORDS*2];
+	uint8_t        m_vsRemap[BGFX_SHADER_VARIANTS_MAX_KEYWORDS*2];
+	uint8_t        m_fsRemap[BGFX_SHADER_VARIANTS_MAX_KEYWORDS*2];
+	uint32_t       m_numKeywords;
+
+	typedef stl::unordered_map<uint32_t, bgfx::ProgramHandle> ProgramMap;
+	ProgramMap m_programs;
+};
+
+ProgramVariants* loadProgramVariants(bx::FileReaderI* _reader, const char* _vsName, const char* _fsName)
+{
+	ProgramVariants* variants = BX_NEW(entry::getAllocator(), ProgramVariants);
+	variants->m_numKeywords = 0;
+	variants->m_hasFs = NULL != _fsName;
+
+	bool ok = variants->m_vs.load(_reader, _vsName);
+	if (variants->m_hasFs)
+	{
+		ok &= variants->m_fs.load(_reader, _fsName);
+	}
+
+	if (!ok)
+	{
+		unloadProgramVariants(variants);
+		return NULL;
+	}
+
+	const ShaderVariantPack& vs = variants->m_vs;
+	for (uint32_t ii = 0; ii < vs.m_numKeywords; ++ii)
+	{
+		const uint32_t idx = variants->m_numKeywords++;
+		variants->m_keyword[idx] = vs.m_keyword[ii];
+		variants->m_vsRemap[idx] = uint8_t(ii);
+		variants->m_fsRemap[idx] = UINT8_MAX;
+	}
+
+	if (variants->m_hasFs)
+	{
+		const ShaderVariantPack& fs = variants->m_fs;
+		for (uint32_t ii = 0; ii < fs.m_numKeywords; ++ii)
+		{
+			const int32_t idx = vs.findKeyword(fs.m_keyword[ii]);
+			if (0 <= idx)
+			{
+				variants->m_fsRemap[idx] = uint8_t(ii);
+			}
+			else
+			{
+				const uint32_t num = variants->m_numKeywords++;
+				variants->m_keyword[num] = fs.m_keyword[ii];
+				variants->m_vsRemap[num] = UINT8_MAX;
+				variants->m_fsRemap[num] = uint8_t(ii);
+			}
+		}
+	}
+
+	return variants;
+}
+
+ProgramVariants* loadProgramVariants(const char* _vsName, const char* _fsName)
+{
+	return loadProgramVariants(entry::getFileReader(), _vsName, _fsName);
+}
+
+uint32_t getKeywordMask(const ProgramVariants* _variants, const char* _keyword)
+{
+	for (uint32_t ii = 0; ii < _variants->m_numKeywords; ++ii)
+	{
+		if (0 == bx::strCmp(_variants->m_keyword[ii], _keyword) )
+		{
+			return 1<<ii;
+		}
+	}
+
+	return 0;
+}
+
+bgfx::ProgramHandle getProgram(ProgramVariants* _variants, uint32_t _mask)
+{
+	const uint16_t vsBlob = _variants->m_vs.getBlob(_variants->getStageMask(_mask, _variants->m_vsRemap) );
+	const uint16_t fsBlob = _variants->m_hasFs
+		? _variants->m_fs.getBlob(_variants->getStageMask(_mask, _variants->m_fsRemap) )
+		: 0
+		;
+
+	// Different keyword masks often resolve to the same pair of shaders.
+	const uint32_t key = (uint32_t(vsBlob)<<16) | fsBlob;
+
+	ProgramVariants::ProgramMap::iterator it = _variants->m_programs.find(key);
+	if (it != _variants->m_programs.end() )
+	{
+		return it->second;
+	}
+
+	bgfx::ShaderHandle vsh = _variants->m_vs.getShader(vsBlob);
+	bgfx::ShaderHandle fsh = _variants->m_hasFs
+		? _variants->m_fs.getShader(fsBlob)
+		: bgfx::ShaderHandle(BGFX_INVALID_HANDLE)
+		;
+
+	// Shaders are shared between programs and destroyed on unload.
+	bgfx::ProgramHandle handle = bgfx::createProgram(vsh, fsh, false);
+	_variants->m_programs.insert(stl::make_pair(key, handle) );
+
+	return handle;
+}
+
+void unloadProgramVariants(ProgramVariants* _variants)
+{
+	for (ProgramVariants::ProgramMap::iterator it = _variants->m_programs.begin(), itEnd = _variants->m_programs.end(); it != itEnd; ++it)
+	{
+		bgfx::destroy(it->second);
+	}
+
+	_variants->m_vs.unload();
+	if (_variants->m_hasFs)
+	{
+		_variants->m_fs.unload();
+	}
+
+	BX_DELETE(entry::getAllocator(), _variants);
+}
+
 static void imageReleaseCb(void* _ptr, void* _userData)
 {
 	BX_UNUSED(_ptr);
@@ -370,7 +667,10 @@ void Group::reset()
 	m_vertices = NULL;
 	m_numIndices = 0;
 	m_indices = NULL;
+	m_indices32 = NULL;
 	m_prims.clear();
+	m_meshlets.clear();
+	m_lods.clear();
 }
 
 namespace bgfx
@@ -378,6 +678,296 @@ namespace bgfx
 	int32_t read(bx::ReaderI* _reader, bgfx::VertexDecl& _decl, bx::Error* _err = NULL);
 }
 
+static void readNumVertices(bx::ReaderI* _reader, uint32_t& _numVertices, bool _vertex32)
+{
+	if (_vertex32)
+	{
+		bx::read(_reader, _numVertices);
+	}
+	else
+	{
+		uint16_t numVertices;
+		bx::read(_reader, numVertices);
+		_numVertices = numVertices;
+	}
+}
+
+/// Compressed vertex or index chunk. Chunk is decoded straight into memory passed to bgfx,
+/// compressed data follows job in the same allocation.
+struct MeshDecodeJob
+{
+	const bgfx::Memory* m_mem;
+	bgfx::VertexDecl m_decl;
+	bx::Semaphore* m_doneSem;
+	void* m_ramcopy;
+	uint8_t* m_compressed;
+	uint32_t m_compressedSize;
+	uint32_t m_group;
+	uint32_t m_num;
+	uint32_t m_size; //!< Vertex stride, or index size.
+	bool m_vertex;
+};
+
+#define MESH_LOADER_MAX_THREADS 16
+
+class MeshLoader
+{
+public:
+	MeshLoader()
+		: m_numThreads(0)
+		, m_exit(false)
+		, m_async(false)
+	{
+	}
+
+	void init(uint32_t _numThreads)
+	{
+		BX_CHECK(0 == m_numThreads && !m_async, "Mesh loader is already initialized.");
+
+		m_exit = false;
+		m_numThreads = bx::min<uint32_t>(_numThreads, MESH_LOADER_MAX_THREADS);
+
+		for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+		{
+			m_thread[ii].init(decodeProc, this, 0, "meshDecode");
+		}
+
+		m_loader.init(loaderProc, this, 0, "meshLoader");
+		m_async = true;
+	}
+
+	void shutdown()
+	{
+		if (!m_async)
+		{
+			return;
+		}
+
+		m_exit = true;
+		m_jobSem.post(m_numThreads);
+		m_requestSem.post();
+
+		for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+		{
+			m_thread[ii].shutdown();
+		}
+
+		m_loader.shutdown();
+
+		// Drop pending requests and unconsumed semaphore posts, otherwise stale callbacks would
+		// run after loader is initialized again.
+		{
+			bx::MutexScope lock(m_mutex);
+			m_requests.clear();
+		}
+
+		while (m_requestSem.wait(0) )
+		{
+		}
+
+		while (m_jobSem.wait(0) )
+		{
+		}
+
+		m_numThreads = 0;
+		m_async = false;
+	}
+
+	/// Queues job for decoding on worker thread, or decodes it immediately when there are no
+	/// workers. Job's done semaphore is posted once job is decoded.
+	void decode(MeshDecodeJob* _job)
+	{
+		if (0 == m_numThreads)
+		{
+			execute(*_job);
+			return;
+		}
+
+		{
+			bx::MutexScope lock(m_mutex);
+			m_jobs.push_back(_job);
+		}
+
+		m_jobSem.post();
+	}
+
+	/// Waits for _num jobs to be decoded, calling thread decodes queued jobs while waiting.
+	void wait(bx::Semaphore& _doneSem, uint32_t _num)
+	{
+		while (tryExecute() )
+		{
+		}
+
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			_doneSem.wait();
+		}
+	}
+
+	bool load(const char* _filePath, MeshLoadFn _fn, void* _userData, bool _ramcopy)
+	{
+		if (!m_async)
+		{
+			return false;
+		}
+
+		Request request;
+		request.m_filePath = _filePath;
+		request.m_fn       = _fn;
+		request.m_userData = _userData;
+		request.m_ramcopy  = _ramcopy;
+
+		{
+			bx::MutexScope lock(m_mutex);
+			m_requests.push_back(request);
+		}
+
+		m_requestSem.post();
+
+		return true;
+	}
+
+private:
+	struct Request
+	{
+		stl::string m_filePath;
+		MeshLoadFn m_fn;
+		void* m_userData;
+		bool m_ramcopy;
+	};
+
+	static void execute(MeshDecodeJob& _job)
+	{
+		int result = _job.m_vertex
+			? meshopt_decodeVertexBuffer(_job.m_mem->data, _job.m_num, _job.m_size, _job.m_compressed, _job.m_compressedSize)
+			: meshopt_decodeIndexBuffer(_job.m_mem->data, _job.m_num, _job.m_size, _job.m_compressed, _job.m_compressedSize)
+			;
+		BX_WARN(0 == result, "Failed to decode %s chunk (%d).", _job.m_vertex ? "vertex" : "index", result);
+		BX_UNUSED(result);
+
+		if (NULL != _job.m_ramcopy)
+		{
+			bx::memCopy(_job.m_ramcopy, _job.m_mem->data, _job.m_mem->size);
+		}
+
+		_job.m_doneSem->post();
+	}
+
+	bool tryExecute()
+	{
+		MeshDecodeJob* job = NULL;
+
+		{
+			bx::MutexScope lock(m_mutex);
+			if (!m_jobs.empty() )
+			{
+				job = m_jobs.back();
+				m_jobs.pop_back();
+			}
+		}
+
+		if (NULL == job)
+		{
+			return false;
+		}
+
+		execute(*job);
+		return true;
+	}
+
+	static int32_t decodeProc(bx::Thread* /*_self*/, void* _userData)
+	{
+		MeshLoader* loader = (MeshLoader*)_userData;
+
+		for (;;)
+		{
+			loader->m_jobSem.wait();
+
+			if (loader->m_exit)
+			{
+				break;
+			}
+
+			// Queue might be already drained by thread waiting for its jobs.
+			loader->tryExecute();
+		}
+
+		return 0;
+	}
+
+	static int32_t loaderProc(bx::Thread* /*_self*/, void* _userData)
+	{
+		MeshLoader* loader = (MeshLoader*)_userData;
+
+		// Shared entry file reader is not thread safe, loader thread uses its own.
+		bx::FileReader reader;
+
+		for (;;)
+		{
+			loader->m_requestSem.wait();
+
+			if (loader->m_exit)
+			{
+				break;
+			}
+
+			Request request;
+
+			{
+				bx::MutexScope lock(loader->m_mutex);
+				request = loader->m_requests.front();
+				loader->m_requests.erase(loader->m_requests.begin() );
+			}
+
+			Mesh* mesh = NULL;
+			if (bx::open(&reader, request.m_filePath.c_str() ) )
+			{
+				mesh = new Mesh;
+				mesh->load(&reader, request.m_ramcopy);
+				bx::close(&reader);
+			}
+
+			request.m_fn(mesh, request.m_userData);
+		}
+
+		return 0;
+	}
+
+	typedef stl::vector<MeshDecodeJob*> JobArray;
+	typedef stl::vector<Request> RequestArray;
+
+	JobArray m_jobs;
+	RequestArray m_requests;
+
+	bx::Mutex m_mutex;
+	bx::Semaphore m_jobSem;
+	bx::Semaphore m_requestSem;
+	bx::Thread m_thread[MESH_LOADER_MAX_THREADS];
+	bx::Thread m_loader;
+	uint32_t m_numThreads;
+	bool m_exit;
+	bool m_async;
+};
+
+static MeshLoader s_meshLoader;
+
+static MeshDecodeJob* createDecodeJob(bx::ReaderI* _reader, bx::Semaphore* _doneSem, uint32_t _group)
+{
+	uint32_t compressedSize;
+	bx::read(_reader, compressedSize);
+
+	MeshDecodeJob* job = (MeshDecodeJob*)BX_ALLOC(entry::getAllocator(), sizeof(MeshDecodeJob) + compressedSize);
+	job->m_doneSem        = _doneSem;
+	job->m_ramcopy        = NULL;
+	job->m_compressed     = (uint8_t*)&job[1];
+	job->m_compressedSize = compressedSize;
+	job->m_group          = _group;
+
+	bx::read(_reader, job->m_compressed, compressedSize);
+
+	return job;
+}
+
 void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 {
 #define BGFX_CHUNK_MAGIC_VB  BX_MAKEFOURCC('V', 'B', ' ', 0x1)
@@ -385,14 +975,29 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 #define BGFX_CHUNK_MAGIC_IB  BX_MAKEFOURCC('I', 'B', ' ', 0x0)
 #define BGFX_CHUNK_MAGIC_IBC BX_MAKEFOURCC('I', 'B', 'C', 0x1)
 #define BGFX_CHUNK_MAGIC_PRI BX_MAKEFOURCC('P', 'R', 'I', 0x0)
+#define BGFX_CHUNK_MAGIC_MLT BX_MAKEFOURCC('M', 'L', 'T', 0x0)
+#define BGFX_CHUNK_MAGIC_LOD BX_MAKEFOURCC('L', 'O', 'D', 0x0)
+#define BGFX_CHUNK_MAGIC_QNT BX_MAKEFOURCC('Q', 'N', 'T', 0x0)
+
+#define BGFX_CHUNK_MAGIC_VB32  BX_MAKEFOURCC('V', 'B', ' ', 0x2)
+#define BGFX_CHUNK_MAGIC_VBC32 BX_MAKEFOURCC('V', 'B', 'C', 0x1)
+#define BGFX_CHUNK_MAGIC_IB32  BX_MAKEFOURCC('I', 'B', ' ', 0x1)
+#define BGFX_CHUNK_MAGIC_IBC32 BX_MAKEFOURCC('I', 'B', 'C', 0x2)
 
 	using namespace bx;
 	using namespace bgfx;
 	
 	Group group;
+
+	m_dequantOffset = { 0.0f, 0.0f, 0.0f };
+	m_dequantScale  = { 1.0f, 1.0f, 1.0f };
 	
 	bx::AllocatorI* allocator = entry::getAllocator();
 	
+	// Compressed chunks are decoded on mesh loader threads while reading continues.
+	bx::Semaphore doneSem;
+	stl::vector<MeshDecodeJob*> jobs;
+	
 	uint32_t chunk;
 	bx::Error err;
 	while (4 == bx::read(_reader, chunk, &err)
@@ -401,6 +1006,7 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 		switch (chunk)
 		{
 			case BGFX_CHUNK_MAGIC_VB:
+			case BGFX_CHUNK_MAGIC_VB32:
 			{
 				read(_reader, group.m_sphere);
 				read(_reader, group.m_aabb);
@@ -410,7 +1016,7 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 				
 				uint16_t stride = m_decl.getStride();
 				
-				read(_reader, group.m_numVertices);
+				readNumVertices(_reader, group.m_numVertices, BGFX_CHUNK_MAGIC_VB32 == chunk);
 				const bgfx::Memory* mem = bgfx::alloc(group.m_numVertices*stride);
 				read(_reader, mem->data, mem->size);
 				if ( _ramcopy )
@@ -423,6 +1029,7 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 				break;
 				
 			case BGFX_CHUNK_MAGIC_VBC:
+			case BGFX_CHUNK_MAGIC_VBC32:
 			{
 				read(_reader, group.m_sphere);
 				read(_reader, group.m_aabb);
@@ -432,27 +1039,24 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 				
 				uint16_t stride = m_decl.getStride();
 				
-				read(_reader, group.m_numVertices);
-				
-				const bgfx::Memory* mem = bgfx::alloc(group.m_numVertices*stride);
-				
-				uint32_t compressedSize;
-				bx::read(_reader, compressedSize);
+				readNumVertices(_reader, group.m_numVertices, BGFX_CHUNK_MAGIC_VBC32 == chunk);
 				
-				void* compressedVertices = BX_ALLOC(allocator, compressedSize);
-				bx::read(_reader, compressedVertices, compressedSize);
-				
-				meshopt_decodeVertexBuffer(mem->data, group.m_numVertices, stride, (uint8_t*)compressedVertices, compressedSize);
-				
-				BX_FREE(allocator, compressedVertices);
+				MeshDecodeJob* job = createDecodeJob(_reader, &doneSem, uint32_t(m_groups.size() ) );
+				job->m_mem    = bgfx::alloc(group.m_numVertices*stride);
+				job->m_decl   = m_decl;
+				job->m_num    = group.m_numVertices;
+				job->m_size   = stride;
+				job->m_vertex = true;
 
 				if ( _ramcopy )
 				{
 					group.m_vertices = (uint8_t*)BX_ALLOC(allocator, group.m_numVertices*stride);
-					bx::memCopy(group.m_vertices, mem->data, mem->size);
+					job->m_ramcopy = group.m_vertices;
 				}
-				
-				group.m_vbh = bgfx::createVertexBuffer(mem, m_decl);
+
+				// Vertex buffer is created once chunk is decoded.
+				jobs.push_back(job);
+				s_meshLoader.decode(job);
 			}
 				break;
 				
@@ -470,34 +1074,95 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 				group.m_ibh = bgfx::createIndexBuffer(mem);
 			}
 				break;
+
+			case BGFX_CHUNK_MAGIC_IB32:
+			{
+				read(_reader, group.m_numIndices);
+				const bgfx::Memory* mem = bgfx::alloc(group.m_numIndices*4);
+				read(_reader, mem->data, mem->size);
+				if ( _ramcopy )
+				{
+					group.m_indices32 = (uint32_t*)BX_ALLOC(allocator, group.m_numIndices*4);
+					bx::memCopy(group.m_indices32, mem->data, mem->size);
+				}
+
+				group.m_ibh = bgfx::createIndexBuffer(mem, BGFX_BUFFER_INDEX32);
+			}
+				break;
 				
 			case BGFX_CHUNK_MAGIC_IBC:
+			case BGFX_CHUNK_MAGIC_IBC32:
 			{
 				bx::read(_reader, group.m_numIndices);
 				
-				const bgfx::Memory* mem = bgfx::alloc(group.m_numIndices*2);
-				
-				uint32_t compressedSize;
-				bx::read(_reader, compressedSize);
-				
-				void* compressedIndices = BX_ALLOC(allocator, compressedSize);
+				const uint32_t indexSize = BGFX_CHUNK_MAGIC_IBC32 == chunk ? 4 : 2;
 				
-				bx::read(_reader, compressedIndices, compressedSize);
-				
-				meshopt_decodeIndexBuffer(mem->data, group.m_numIndices, 2, (uint8_t*)compressedIndices, compressedSize);
-				
-				BX_FREE(allocator, compressedIndices);
+				MeshDecodeJob* job = createDecodeJob(_reader, &doneSem, uint32_t(m_groups.size() ) );
+				job->m_mem    = bgfx::alloc(group.m_numIndices*indexSize);
+				job->m_num    = group.m_numIndices;
+				job->m_size   = indexSize;
+				job->m_vertex = false;
 				
 				if ( _ramcopy )
 				{
-					group.m_indices = (uint16_t*)BX_ALLOC(allocator, group.m_numIndices*2);
-					bx::memCopy(group.m_indices, mem->data, mem->size);
+					job->m_ramcopy = BX_ALLOC(allocator, group.m_numIndices*indexSize);
+					if (4 == indexSize)
+					{
+						group.m_indices32 = (uint32_t*)job->m_ramcopy;
+					}
+					else
+					{
+						group.m_indices = (uint16_t*)job->m_ramcopy;
+					}
 				}
 				
-				group.m_ibh = bgfx::createIndexBuffer(mem);
+				jobs.push_back(job);
+				s_meshLoader.decode(job);
 			}
 				break;
 				
+			case BGFX_CHUNK_MAGIC_QNT:
+			{
+				read(_reader, m_dequantOffset);
+				read(_reader, m_dequantScale);
+			}
+				break;
+
+			case BGFX_CHUNK_MAGIC_LOD:
+			{
+				uint16_t num;
+				read(_reader, num);
+
+				group.m_lods.resize(num);
+				for (uint32_t ii = 0; ii < num; ++ii)
+				{
+					Lod& lod = group.m_lods[ii];
+					read(_reader, lod.m_startIndex);
+					read(_reader, lod.m_numIndices);
+					read(_reader, lod.m_error);
+				}
+			}
+				break;
+
+			case BGFX_CHUNK_MAGIC_MLT:
+			{
+				uint32_t num;
+				read(_reader, num);
+
+				group.m_meshlets.resize(num);
+				for (uint32_t ii = 0; ii < num; ++ii)
+				{
+					Meshlet& meshlet = group.m_meshlets[ii];
+					read(_reader, meshlet.m_startIndex);
+					read(_reader, meshlet.m_numIndices);
+					read(_reader, meshlet.m_sphere);
+					read(_reader, meshlet.m_coneApex);
+					read(_reader, meshlet.m_coneAxis);
+					read(_reader, meshlet.m_coneCutoff);
+				}
+			}
+				break;
+
 			case BGFX_CHUNK_MAGIC_PRI:
 			{
 				uint16_t len;
@@ -540,6 +1205,25 @@ void Mesh::load(bx::ReaderSeekerI* _reader, bool _ramcopy)
 				break;
 		}
 	}
+
+	s_meshLoader.wait(doneSem, uint32_t(jobs.size() ) );
+
+	for (uint32_t ii = 0, num = uint32_t(jobs.size() ); ii < num; ++ii)
+	{
+		MeshDecodeJob* job = jobs[ii];
+		Group& decoded = m_groups[job->m_group];
+
+		if (job->m_vertex)
+		{
+			decoded.m_vbh = bgfx::createVertexBuffer(job->m_mem, job->m_decl);
+		}
+		else
+		{
+			decoded.m_ibh = bgfx::createIndexBuffer(job->m_mem, 4 == job->m_size ? BGFX_BUFFER_INDEX32 : BGFX_BUFFER_NONE);
+		}
+
+		BX_FREE(allocator, job);
+	}
 }
 
 void Mesh::unload()
@@ -565,10 +1249,59 @@ void Mesh::unload()
 		{
 			BX_FREE(allocator, group.m_indices);
 		}
+
+		if ( NULL != group.m_indices32 )
+		{
+			BX_FREE(allocator, group.m_indices32);
+		}
 	}
 	m_groups.clear();
 }
 
+static void setGroupIndexBuffer(const Group& _group, uint32_t _lod)
+{
+	if (_group.m_lods.empty() )
+	{
+		bgfx::setIndexBuffer(_group.m_ibh);
+	}
+	else
+	{
+		const Lod& lod = _group.m_lods[_lod];
+		bgfx::setIndexBuffer(_group.m_ibh, lod.m_startIndex, lod.m_numIndices);
+	}
+}
+
+uint32_t Mesh::setTransform(const float* _mtx, uint16_t _num) const
+{
+	if (0.0f == m_dequantOffset.x
+	&&  0.0f == m_dequantOffset.y
+	&&  0.0f == m_dequantOffset.z
+	&&  1.0f == m_dequantScale.x
+	&&  1.0f == m_dequantScale.y
+	&&  1.0f == m_dequantScale.z)
+	{
+		return bgfx::setTransform(_mtx, _num);
+	}
+
+	float dequant[16];
+	bx::mtxSRT(dequant
+		, m_dequantScale.x,  m_dequantScale.y,  m_dequantScale.z
+		, 0.0f, 0.0f, 0.0f
+		, m_dequantOffset.x, m_dequantOffset.y, m_dequantOffset.z
+		);
+
+	bgfx::Transform transform;
+	const uint32_t cached = bgfx::allocTransform(&transform, _num);
+
+	for (uint16_t ii = 0; ii < transform.num; ++ii)
+	{
+		bx::mtxMul(&transform.data[ii*16], dequant, &_mtx[ii*16]);
+	}
+
+	bgfx::setTransform(cached, transform.num);
+	return cached;
+}
+
 void Mesh::submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state) const
 {
 	if (BGFX_STATE_MASK == _state)
@@ -583,14 +1316,137 @@ void Mesh::submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _
 		;
 	}
 	
-	bgfx::setTransform(_mtx);
+	setTransform(_mtx);
 	bgfx::setState(_state);
 	
 	for (GroupArray::const_iterator it = m_groups.begin(), itEnd = m_groups.end(); it != itEnd; ++it)
 	{
 		const Group& group = *it;
 		
-		bgfx::setIndexBuffer(group.m_ibh);
+		setGroupIndexBuffer(group, 0);
+		bgfx::setVertexBuffer(0, group.m_vbh);
+		bgfx::submit(_id, _program, 0, it != itEnd-1);
+	}
+}
+
+void Mesh::submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const float* _viewProj) const
+{
+	if (BGFX_STATE_MASK == _state)
+	{
+		_state = 0
+		| BGFX_STATE_WRITE_RGB
+		| BGFX_STATE_WRITE_A
+		| BGFX_STATE_WRITE_Z
+		| BGFX_STATE_DEPTH_TEST_LESS
+		| BGFX_STATE_CULL_CCW
+		| BGFX_STATE_MSAA
+		;
+	}
+
+	// Group bounds are in mesh space, bring frustum into mesh space instead.
+	float mvp[16];
+	bx::mtxMul(mvp, _mtx, _viewProj);
+
+	bx::Plane planes[6];
+	buildFrustumPlanes(planes, mvp);
+
+	const uint32_t cached = setTransform(_mtx);
+
+	const uint32_t kBatchSize = 64;
+	BX_ALIGN_DECL(16, float) x[kBatchSize];
+	BX_ALIGN_DECL(16, float) y[kBatchSize];
+	BX_ALIGN_DECL(16, float) z[kBatchSize];
+	BX_ALIGN_DECL(16, float) radius[kBatchSize];
+	uint32_t visible[kBatchSize];
+
+	SphereSoa spheres;
+	spheres.x      = x;
+	spheres.y      = y;
+	spheres.z      = z;
+	spheres.radius = radius;
+
+	const uint32_t numGroups = uint32_t(m_groups.size() );
+	for (uint32_t base = 0; base < numGroups; base += kBatchSize)
+	{
+		const uint32_t num = bx::min(numGroups - base, kBatchSize);
+		for (uint32_t ii = 0; ii < num; ++ii)
+		{
+			const Sphere& sphere = m_groups[base + ii].m_sphere;
+			x[ii]      = sphere.center.x;
+			y[ii]      = sphere.center.y;
+			z[ii]      = sphere.center.z;
+			radius[ii] = sphere.radius;
+		}
+
+		const uint32_t numVisible = cullSpheres(visible, planes, spheres, num);
+		for (uint32_t ii = 0; ii < numVisible; ++ii)
+		{
+			const Group& group = m_groups[base + visible[ii] ];
+
+			bgfx::setTransform(cached);
+			bgfx::setState(_state);
+			setGroupIndexBuffer(group, 0);
+			bgfx::setVertexBuffer(0, group.m_vbh);
+			bgfx::submit(_id, _program);
+		}
+	}
+}
+
+static uint32_t selectLod(const Group& _group, const float* _mtx, const bx::Vec3& _eye, float _pixelScale, float _maxPixelError)
+{
+	const uint32_t num = uint32_t(_group.m_lods.size() );
+	if (2 > num)
+	{
+		return 0;
+	}
+
+	const bx::Vec3 center = bx::mul(_group.m_sphere.center, _mtx);
+	const float    scale  = bx::length(bx::load<bx::Vec3>(&_mtx[0]) );
+	const float    dist   = bx::length(bx::sub(center, _eye) ) - _group.m_sphere.radius*scale;
+
+	if (0.0f >= dist)
+	{
+		return 0;
+	}
+
+	const float errorScale = scale*_pixelScale/dist;
+
+	uint32_t lod = 0;
+	for (uint32_t ii = 1; ii < num; ++ii)
+	{
+		if (_group.m_lods[ii].m_error*errorScale > _maxPixelError)
+		{
+			break;
+		}
+
+		lod = ii;
+	}
+
+	return lod;
+}
+
+void Mesh::submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const bx::Vec3& _eye, float _pixelScale, float _maxPixelError) const
+{
+	if (BGFX_STATE_MASK == _state)
+	{
+		_state = 0
+		| BGFX_STATE_WRITE_RGB
+		| BGFX_STATE_WRITE_A
+		| BGFX_STATE_WRITE_Z
+		| BGFX_STATE_DEPTH_TEST_LESS
+		| BGFX_STATE_CULL_CCW
+		| BGFX_STATE_MSAA
+		;
+	}
+
+	setTransform(_mtx);
+	bgfx::setState(_state);
+
+	for (GroupArray::const_iterator it = m_groups.begin(), itEnd = m_groups.end(); it != itEnd; ++it)
+	{
+		const Group& group = *it;
+
+		setGroupIndexBuffer(group, selectLod(group, _mtx, _eye, _pixelScale, _maxPixelError) );
 		bgfx::setVertexBuffer(0, group.m_vbh);
 		bgfx::submit(_id, _program, 0, it != itEnd-1);
 	}
@@ -598,7 +1454,7 @@ void Mesh::submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _
 
 void Mesh::submit(const MeshState*const* _state, uint8_t _numPasses, const float* _mtx, uint16_t _numMatrices) const
 {
-	uint32_t cached = bgfx::setTransform(_mtx, _numMatrices);
+	uint32_t cached = setTransform(_mtx, _numMatrices);
 	
 	for (uint32_t pass = 0; pass < _numPasses; ++pass)
 	{
@@ -621,13 +1477,144 @@ void Mesh::submit(const MeshState*const* _state, uint8_t _numPasses, const float
 		{
 			const Group& group = *it;
 			
-			bgfx::setIndexBuffer(group.m_ibh);
+			setGroupIndexBuffer(group, 0);
 			bgfx::setVertexBuffer(0, group.m_vbh);
 			bgfx::submit(state.m_viewId, state.m_program, 0, it != itEnd-1);
 		}
 	}
 }
 
+static bool isVisible(const Meshlet& _meshlet, const bx::Plane* _planes, const bx::Vec3& _eye)
+{
+	const Sphere& sphere = _meshlet.m_sphere;
+
+	for (uint32_t ii = 0; ii < 6; ++ii)
+	{
+		if (bx::dot(_planes[ii].normal, sphere.center) + _planes[ii].dist < -sphere.radius)
+		{
+			return false;
+		}
+	}
+
+	// All triangles in meshlet are facing away from eye.
+	const bx::Vec3 dir = bx::normalize(bx::sub(_meshlet.m_coneApex, _eye) );
+	return bx::dot(dir, _meshlet.m_coneAxis) < _meshlet.m_coneCutoff;
+}
+
+static void submitRange(bgfx::ViewId _id, bgfx::ProgramHandle _program, uint32_t _cached, uint64_t _state, const Group& _group, uint32_t _startIndex, uint32_t _numIndices)
+{
+	if (0 != _numIndices)
+	{
+		bgfx::setTransform(_cached);
+		bgfx::setState(_state);
+		bgfx::setIndexBuffer(_group.m_ibh, _startIndex, _numIndices);
+		bgfx::setVertexBuffer(0, _group.m_vbh);
+		bgfx::submit(_id, _program);
+	}
+}
+
+void Mesh::submitMeshlets(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, const float* _viewProj, const bx::Vec3& _eye, uint64_t _state) const
+{
+	if (BGFX_STATE_MASK == _state)
+	{
+		_state = 0
+		| BGFX_STATE_WRITE_RGB
+		| BGFX_STATE_WRITE_A
+		| BGFX_STATE_WRITE_Z
+		| BGFX_STATE_DEPTH_TEST_LESS
+		| BGFX_STATE_CULL_CCW
+		| BGFX_STATE_MSAA
+		;
+	}
+
+	// Meshlet bounds are in mesh space, bring frustum and eye into mesh space instead of
+	// transforming every meshlet.
+	float mvp[16];
+	bx::mtxMul(mvp, _mtx, _viewProj);
+
+	bx::Plane planes[6];
+	buildFrustumPlanes(planes, mvp);
+
+	float invMtx[16];
+	bx::mtxInverse(invMtx, _mtx);
+	const bx::Vec3 eye = bx::mul(_eye, invMtx);
+
+	uint32_t cached = setTransform(_mtx);
+
+	for (GroupArray::const_iterator it = m_groups.begin(), itEnd = m_groups.end(); it != itEnd; ++it)
+	{
+		const Group& group = *it;
+
+		if (group.m_meshlets.empty() )
+		{
+			const uint32_t startIndex = group.m_lods.empty() ? 0          : group.m_lods[0].m_startIndex;
+			const uint32_t numIndices = group.m_lods.empty() ? UINT32_MAX : group.m_lods[0].m_numIndices;
+			submitRange(_id, _program, cached, _state, group, startIndex, numIndices);
+			continue;
+		}
+
+		uint32_t startIndex = 0;
+		uint32_t numIndices = 0;
+
+		for (MeshletArray::const_iterator jt = group.m_meshlets.begin(), jtEnd = group.m_meshlets.end(); jt != jtEnd; ++jt)
+		{
+			const Meshlet& meshlet = *jt;
+			if (!isVisible(meshlet, planes, eye) )
+			{
+				continue;
+			}
+
+			if (0 != numIndices
+			&&  startIndex + numIndices == meshlet.m_startIndex)
+			{
+				numIndices += meshlet.m_numIndices;
+				continue;
+			}
+
+			submitRange(_id, _program, cached, _state, group, startIndex, numIndices);
+			startIndex = meshlet.m_startIndex;
+			numIndices = meshlet.m_numIndices;
+		}
+
+		submitRange(_id, _program, cached, _state, group, startIndex, numIndices);
+	}
+}
+
+bgfx::VertexBufferHandle meshletBufferCreate(const Group& _group)
+{
+	bgfx::VertexDecl decl;
+	decl.begin()
+		.add(bgfx::Attrib::TexCoord0, 4, bgfx::AttribType::Float)
+		.end();
+
+	const uint32_t num = uint32_t(_group.m_meshlets.size() );
+	const bgfx::Memory* mem = bgfx::alloc(num*4*4*sizeof(float) );
+
+	float* data = (float*)mem->data;
+	for (uint32_t ii = 0; ii < num; ++ii)
+	{
+		const Meshlet& meshlet = _group.m_meshlets[ii];
+
+		bx::store(&data[0], meshlet.m_sphere.center);
+		data[3] = meshlet.m_sphere.radius;
+
+		bx::store(&data[4], meshlet.m_coneApex);
+		data[7] = meshlet.m_coneCutoff;
+
+		bx::store(&data[8], meshlet.m_coneAxis);
+		data[11] = 0.0f;
+
+		data[12] = bx::bitsToFloat(meshlet.m_startIndex);
+		data[13] = bx::bitsToFloat(meshlet.m_numIndices);
+		data[14] = 0.0f;
+		data[15] = 0.0f;
+
+		data += 16;
+	}
+
+	return bgfx::createVertexBuffer(mem, decl, BGFX_BUFFER_COMPUTE_READ);
+}
+
 Mesh* meshLoad(bx::ReaderSeekerI* _reader, bool _ramcopy)
 {
 	Mesh* mesh = new Mesh;
@@ -654,6 +1641,24 @@ void meshUnload(Mesh* _mesh)
 	delete _mesh;
 }
 
+void meshLoaderInit(uint32_t _numThreads)
+{
+	s_meshLoader.init(_numThreads);
+}
+
+void meshLoaderShutdown()
+{
+	s_meshLoader.shutdown();
+}
+
+void meshLoadAsync(const char* _filePath, MeshLoadFn _fn, void* _userData, bool _ramcopy)
+{
+	if (!s_meshLoader.load(_filePath, _fn, _userData, _ramcopy) )
+	{
+		_fn(meshLoad(_filePath, _ramcopy), _userData);
+	}
+}
+
 MeshState* meshStateCreate()
 {
 	MeshState* state = (MeshState*)BX_ALLOC(entry::getAllocator(), sizeof(MeshState) );
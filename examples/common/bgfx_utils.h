@@ -28,6 +28,27 @@ bgfx::ShaderHandle loadShader(const char* _name);
 ///
 bgfx::ProgramHandle loadProgram(const char* _vsName, const char* _fsName);
 
+/// Shader variants loaded from packs built with `shaderc --keywords`.
+struct ProgramVariants;
+
+/// Load vertex and fragment shader variant packs. Programs are created on
+/// first use of each keyword combination.
+///
+/// @param[in] _vsName Vertex shader variant pack name.
+/// @param[in] _fsName Fragment shader variant pack name, can be NULL.
+///
+ProgramVariants* loadProgramVariants(const char* _vsName, const char* _fsName);
+
+/// Returns keyword bit for use with `getProgram`, or 0 if keyword is not used
+/// by either shader.
+uint32_t getKeywordMask(const ProgramVariants* _variants, const char* _keyword);
+
+/// Returns program for combination of enabled keywords.
+bgfx::ProgramHandle getProgram(ProgramVariants* _variants, uint32_t _mask);
+
+///
+void unloadProgramVariants(ProgramVariants* _variants);
+
 ///
 bgfx::TextureHandle loadTexture(const char* _name, uint64_t _flags = BGFX_TEXTURE_NONE|BGFX_SAMPLER_NONE, uint8_t _skip = 0, bgfx::TextureInfo* _info = NULL, bimg::Orientation::Enum* _orientation = NULL);
 
@@ -98,6 +119,30 @@ struct Primitive
 
 typedef stl::vector<Primitive> PrimitiveArray;
 
+/// Cluster of up to 64 vertices and 126 triangles, covering contiguous range of group index buffer.
+struct Meshlet
+{
+	uint32_t m_startIndex;
+	uint32_t m_numIndices;
+
+	Sphere   m_sphere;
+	bx::Vec3 m_coneApex;
+	bx::Vec3 m_coneAxis;
+	float    m_coneCutoff; //!< cos(angle/2) of normal cone.
+};
+
+typedef stl::vector<Meshlet> MeshletArray;
+
+/// Level of detail, range of group index buffer sharing group vertex buffer.
+struct Lod
+{
+	uint32_t m_startIndex;
+	uint32_t m_numIndices;
+	float    m_error; //!< Simplification error in mesh units, 0 for full detail level.
+};
+
+typedef stl::vector<Lod> LodArray;
+
 struct Group
 {
 	Group();
@@ -105,14 +150,17 @@ struct Group
 	
 	bgfx::VertexBufferHandle m_vbh;
 	bgfx::IndexBufferHandle m_ibh;
-	uint16_t m_numVertices;
+	uint32_t m_numVertices;
 	uint8_t* m_vertices;
 	uint32_t m_numIndices;
 	uint16_t* m_indices;
+	uint32_t* m_indices32; //!< Set instead of m_indices when group uses 32-bit indices.
 	Sphere m_sphere;
 	Aabb m_aabb;
 	Obb m_obb;
 	PrimitiveArray m_prims;
+	MeshletArray m_meshlets;
+	LodArray m_lods;
 };
 typedef stl::vector<Group> GroupArray;
 
@@ -121,10 +169,34 @@ struct Mesh
 	void load(bx::ReaderSeekerI* _reader, bool _ramcopy);
 	void unload();
 	void submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state) const;
+
+	/// Submit only groups which bounding sphere is inside view frustum.
+	void submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const float* _viewProj) const;
+
+	/// Submit coarsest LOD of each group which projected error is within _maxPixelError.
+	/// _pixelScale is viewport height / (2*tan(fovy/2) ), projected size in pixels of unit
+	/// length at unit distance.
+	void submit(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, uint64_t _state, const bx::Vec3& _eye, float _pixelScale, float _maxPixelError = 1.0f) const;
 	void submit(const MeshState*const* _state, uint8_t _numPasses, const float* _mtx, uint16_t _numMatrices) const;
 
+	/// Submit only meshlets that pass frustum and normal cone test. Adjacent visible meshlets
+	/// are merged into single draw call. Groups without meshlets are submitted whole.
+	void submitMeshlets(bgfx::ViewId _id, bgfx::ProgramHandle _program, const float* _mtx, const float* _viewProj, const bx::Vec3& _eye, uint64_t _state) const;
+
 	bgfx::VertexDecl m_decl;
 	GroupArray m_groups;
+
+	/// Set model matrices with dequantization folded in, returns matrix cache index. Group
+	/// bounds, meshlets and LOD errors stay in unquantized mesh space, and are tested against
+	/// _mtx alone.
+	uint32_t setTransform(const float* _mtx, uint16_t _num = 1) const;
+
+	/// Quantized mesh position is `normalized int16 * m_dequantScale + m_dequantOffset`.
+	/// Scale is 1 and offset is 0 when positions are not quantized. Quantized normals are
+	/// decoded with decodeNormalOctahedronSnorm, and tangents with decodeNormalOctahedron
+	/// from shaderlib.sh.
+	bx::Vec3 m_dequantOffset;
+	bx::Vec3 m_dequantScale;
 };
 
 ///
@@ -133,6 +205,27 @@ Mesh* meshLoad(const char* _filePath, bool _ramcopy = false);
 ///
 void meshUnload(Mesh* _mesh);
 
+///
+typedef void (*MeshLoadFn)(Mesh* _mesh, void* _userData);
+
+/// Start _numThreads worker threads that decode compressed vertex and index chunks while
+/// mesh is being read, and background thread used by meshLoadAsync. Without loader, chunks
+/// are decoded on the thread calling meshLoad.
+void meshLoaderInit(uint32_t _numThreads);
+
+/// Stop loader threads. Pending asynchronous loads are dropped.
+void meshLoaderShutdown();
+
+/// Load mesh on background thread. _fn is called from loader thread once mesh is loaded,
+/// with NULL mesh if file can't be opened. Mesh is loaded immediately when loader is not
+/// initialized.
+void meshLoadAsync(const char* _filePath, MeshLoadFn _fn, void* _userData, bool _ramcopy = false);
+
+/// Create compute readable buffer with group meshlets, for GPU cluster culling. Each meshlet
+/// is stored as four vec4: bounding sphere, cone apex and cutoff, cone axis, and start index
+/// and number of indices as uint bits. See cs_gdr_cull_meshlets in 37-gpudrivenrendering.
+bgfx::VertexBufferHandle meshletBufferCreate(const Group& _group);
+
 ///
 MeshState* meshStateCreate();
 
@@ -111,6 +111,23 @@ bool RectanglePacker::addRectangle(uint16_t _width, uint16_t _height, uint16_t&
 	best_width = INT_MAX;
 	for (uint16_t ii = 0, num = uint16_t(m_skyline.size() ); ii < num; ++ii)
 	{
+		const Node& candidate = m_skyline[ii];
+
+		// Skyline nodes are sorted by x, once rectangle doesn't fit horizontally
+		// it won't fit at any of the following nodes either.
+		if ( (candidate.x + _width) > (int32_t)(m_width - 1) )
+		{
+			break;
+		}
+
+		// Rectangle can't be placed lower than the node itself, skip nodes that
+		// can't improve on the best placement found so far.
+		if ( (candidate.y + _height) > best_height
+		|| ( (candidate.y + _height) == best_height && candidate.width >= best_width) )
+		{
+			continue;
+		}
+
 		int32_t yy = fit(ii, _width, _height);
 		if (yy >= 0)
 		{
@@ -250,7 +267,9 @@ struct Atlas::PackedLayer
 };
 
 Atlas::Atlas(uint16_t _textureSize, uint16_t _maxRegionsCount)
-	: m_usedLayers(0)
+	: m_frame(0)
+	, m_numFreeRegions(0)
+	, m_usedLayers(0)
 	, m_usedFaces(0)
 	, m_textureSize(_textureSize)
 	, m_regionCount(0)
@@ -268,6 +287,7 @@ Atlas::Atlas(uint16_t _textureSize, uint16_t _maxRegionsCount)
 	}
 
 	m_regions = new AtlasRegion[_maxRegionsCount];
+	m_freeRegions = new uint16_t[_maxRegionsCount];
 	m_textureBuffer = new uint8_t[ _textureSize * _textureSize * 6 * 4 ];
 	bx::memSet(m_textureBuffer, 0, _textureSize * _textureSize * 6 * 4);
 
@@ -279,7 +299,11 @@ Atlas::Atlas(uint16_t _textureSize, uint16_t _maxRegionsCount)
 }
 
 Atlas::Atlas(uint16_t _textureSize, const uint8_t* _textureBuffer, uint16_t _regionCount, const uint8_t* _regionBuffer, uint16_t _maxRegionsCount)
-	: m_usedLayers(24)
+	: m_layers(NULL)
+	, m_frame(0)
+	, m_freeRegions(NULL)
+	, m_numFreeRegions(0)
+	, m_usedLayers(24)
 	, m_usedFaces(6)
 	, m_textureSize(_textureSize)
 	, m_regionCount(_regionCount)
@@ -310,11 +334,17 @@ Atlas::~Atlas()
 
 	delete [] m_layers;
 	delete [] m_regions;
+	delete [] m_freeRegions;
 	delete [] m_textureBuffer;
 }
 
 void Atlas::init()
 {
+	bx::memSet(m_numDirtyRects, 0, sizeof(m_numDirtyRects) );
+	bx::memSet(m_faceLastUsed,  0, sizeof(m_faceLastUsed) );
+	bx::memSet(m_facePinned,    0, sizeof(m_facePinned) );
+	bx::memSet(m_faceRefCount,  0, sizeof(m_faceRefCount) );
+
 	m_texelSize = float(UINT16_MAX) / float(m_textureSize);
 	float texelHalf = m_texelSize/2.0f;
 	switch (bgfx::getRendererType() )
@@ -339,7 +369,8 @@ void Atlas::init()
 
 uint16_t Atlas::addRegion(uint16_t _width, uint16_t _height, const uint8_t* _bitmapBuffer, AtlasRegion::Type _type, uint16_t outline)
 {
-	if (m_regionCount >= m_maxRegionCount)
+	if (m_regionCount >= m_maxRegionCount
+	&&  0 == m_numFreeRegions)
 	{
 		return UINT16_MAX;
 	}
@@ -385,7 +416,12 @@ uint16_t Atlas::addRegion(uint16_t _width, uint16_t _height, const uint8_t* _bit
 		}
 	}
 
-	AtlasRegion& region = m_regions[m_regionCount];
+	const uint16_t regionIdx = 0 != m_numFreeRegions
+		? m_freeRegions[--m_numFreeRegions]
+		: m_regionCount++
+		;
+
+	AtlasRegion& region = m_regions[regionIdx];
 	region.x = xx;
 	region.y = yy;
 	region.width = _width;
@@ -399,7 +435,190 @@ uint16_t Atlas::addRegion(uint16_t _width, uint16_t _height, const uint8_t* _bit
 	region.width -= (outline * 2);
 	region.height -= (outline * 2);
 
-	return m_regionCount++;
+	m_faceLastUsed[region.getFaceIndex()] = m_frame;
+
+	return regionIdx;
+}
+
+void Atlas::retainFaces(uint8_t _faceMask)
+{
+	for (uint32_t ii = 0; ii < 6; ++ii)
+	{
+		if (0 != (_faceMask & (1<<ii) ) )
+		{
+			++m_faceRefCount[ii];
+		}
+	}
+}
+
+void Atlas::releaseFaces(uint8_t _faceMask)
+{
+	for (uint32_t ii = 0; ii < 6; ++ii)
+	{
+		if (0 != (_faceMask & (1<<ii) ) )
+		{
+			BX_CHECK(0 != m_faceRefCount[ii], "Face %d is not referenced.", ii);
+			--m_faceRefCount[ii];
+		}
+	}
+}
+
+bool Atlas::evict(AtlasRegion::Type _type)
+{
+	if (NULL == m_layers)
+	{
+		return false;
+	}
+
+	uint32_t faceIndex = UINT32_MAX;
+	uint32_t lastUsed  = m_frame;
+
+	// Faces used this frame might be referenced by geometry already submitted,
+	// and faces referenced by live text buffers would leave them with stale
+	// glyphs, those are never evicted.
+	for (uint32_t ii = 0; ii < m_usedLayers; ++ii)
+	{
+		const AtlasRegion& faceRegion = m_layers[ii].faceRegion;
+		const uint32_t face = faceRegion.getFaceIndex();
+
+		if (faceRegion.getType() == _type
+		&&  0 == faceRegion.getComponentIndex()
+		&& !m_facePinned[face]
+		&&  0 == m_faceRefCount[face]
+		&&  m_faceLastUsed[face] < lastUsed)
+		{
+			faceIndex = face;
+			lastUsed  = m_faceLastUsed[face];
+		}
+	}
+
+	if (UINT32_MAX == faceIndex)
+	{
+		return false;
+	}
+
+	for (uint32_t ii = 0; ii < m_usedLayers; ++ii)
+	{
+		if (m_layers[ii].faceRegion.getFaceIndex() == faceIndex)
+		{
+			m_layers[ii].packer.clear();
+		}
+	}
+
+	for (uint16_t ii = 0; ii < m_regionCount; ++ii)
+	{
+		AtlasRegion& region = m_regions[ii];
+		if (isRegionValid(ii)
+		&&  region.getFaceIndex() == faceIndex)
+		{
+			bx::memSet(&region, 0, sizeof(AtlasRegion) );
+			m_freeRegions[m_numFreeRegions++] = ii;
+		}
+	}
+
+	return true;
+}
+
+void Atlas::pinRegion(uint16_t _regionHandle)
+{
+	BX_CHECK(isRegionValid(_regionHandle), "Invalid region %d.", _regionHandle);
+	m_facePinned[m_regions[_regionHandle].getFaceIndex()] = true;
+}
+
+static uint32_t dirtyRectArea(uint32_t _x0, uint32_t _y0, uint32_t _x1, uint32_t _y1)
+{
+	return (_x1 - _x0) * (_y1 - _y0);
+}
+
+void Atlas::addDirtyRect(uint32_t _faceIndex, uint16_t _x, uint16_t _y, uint16_t _width, uint16_t _height)
+{
+	DirtyRect* rects = m_dirtyRects[_faceIndex];
+	uint8_t& num = m_numDirtyRects[_faceIndex];
+
+	const uint16_t x1 = uint16_t(_x + _width);
+	const uint16_t y1 = uint16_t(_y + _height);
+
+	// Merge with rectangle that is overlapping or touching, otherwise append
+	// while there is space, and when full merge with rectangle that grows
+	// the least.
+	uint32_t best = 0;
+	uint32_t bestGrowth = UINT32_MAX;
+	bool overlap = false;
+
+	for (uint32_t ii = 0; ii < num; ++ii)
+	{
+		const DirtyRect& rect = rects[ii];
+
+		if (_x <= rect.x1 && rect.x0 <= x1
+		&&  _y <= rect.y1 && rect.y0 <= y1)
+		{
+			best = ii;
+			overlap = true;
+			break;
+		}
+
+		const uint32_t growth = dirtyRectArea(
+			  bx::min(rect.x0, _x)
+			, bx::min(rect.y0, _y)
+			, bx::max(rect.x1, x1)
+			, bx::max(rect.y1, y1)
+			) - dirtyRectArea(rect.x0, rect.y0, rect.x1, rect.y1);
+
+		if (growth < bestGrowth)
+		{
+			best = ii;
+			bestGrowth = growth;
+		}
+	}
+
+	if (!overlap
+	&&  MaxDirtyRects > num)
+	{
+		DirtyRect& rect = rects[num++];
+		rect.x0 = _x;
+		rect.y0 = _y;
+		rect.x1 = x1;
+		rect.y1 = y1;
+		return;
+	}
+
+	DirtyRect& rect = rects[best];
+	rect.x0 = bx::min(rect.x0, _x);
+	rect.y0 = bx::min(rect.y0, _y);
+	rect.x1 = bx::max(rect.x1, x1);
+	rect.y1 = bx::max(rect.y1, y1);
+}
+
+void Atlas::update()
+{
+	const uint32_t facePitch = m_textureSize * 4;
+	const uint32_t faceSize  = m_textureSize * facePitch;
+
+	for (uint32_t face = 0; face < 6; ++face)
+	{
+		for (uint32_t ii = 0, num = m_numDirtyRects[face]; ii < num; ++ii)
+		{
+			const DirtyRect& rect = m_dirtyRects[face][ii];
+			const uint16_t width  = uint16_t(rect.x1 - rect.x0);
+			const uint16_t height = uint16_t(rect.y1 - rect.y0);
+			const uint32_t pitch  = width * 4;
+
+			const bgfx::Memory* mem = bgfx::alloc(pitch * height);
+
+			const uint8_t* src = m_textureBuffer + face * faceSize + rect.y0 * facePitch + rect.x0 * 4;
+			uint8_t* dst = mem->data;
+			for (uint32_t yy = 0; yy < height; ++yy)
+			{
+				bx::memCopy(dst, src, pitch);
+				src += facePitch;
+				dst += pitch;
+			}
+
+			bgfx::updateTextureCube(m_textureHandle, 0, uint8_t(face), 0, rect.x0, rect.y0, width, height, mem);
+		}
+
+		m_numDirtyRects[face] = 0;
+	}
 }
 
 void Atlas::updateRegion(const AtlasRegion& _region, const uint8_t* _bitmapBuffer)
@@ -407,8 +626,6 @@ void Atlas::updateRegion(const AtlasRegion& _region, const uint8_t* _bitmapBuffe
 	uint32_t size = _region.width * _region.height * 4;
 	if (0 < size)
 	{
-		const bgfx::Memory* mem = bgfx::alloc(size);
-		bx::memSet(mem->data, 0, mem->size);
 		if (_region.getType() == AtlasRegion::TYPE_BGRA8)
 		{
 			const uint8_t* inLineBuffer = _bitmapBuffer;
@@ -420,8 +637,6 @@ void Atlas::updateRegion(const AtlasRegion& _region, const uint8_t* _bitmapBuffe
 				inLineBuffer += _region.width * 4;
 				outLineBuffer += m_textureSize * 4;
 			}
-
-			bx::memCopy(mem->data, _bitmapBuffer, mem->size);
 		}
 		else
 		{
@@ -436,13 +651,12 @@ void Atlas::updateRegion(const AtlasRegion& _region, const uint8_t* _bitmapBuffe
 					outLineBuffer[(xx * 4) + layer] = inLineBuffer[xx];
 				}
 
-				bx::memCopy(mem->data + yy * _region.width * 4, outLineBuffer, _region.width * 4);
 				inLineBuffer += _region.width;
 				outLineBuffer += m_textureSize * 4;
 			}
 		}
 
-		bgfx::updateTextureCube(m_textureHandle, 0, (uint8_t)_region.getFaceIndex(), 0, _region.x, _region.y, _region.width, _region.height, mem);
+		addDirtyRect(_region.getFaceIndex(), _region.x, _region.y, _region.width, _region.height);
 	}
 }
 
@@ -468,6 +682,8 @@ static void writeUV(uint8_t* _vertexBuffer, int16_t _x, int16_t _y, int16_t _z,
 
 void Atlas::packUV(const AtlasRegion& _region, uint8_t* _vertexBuffer, uint32_t _offset, uint32_t _stride) const
 {
+	m_faceLastUsed[_region.getFaceIndex()] = m_frame;
+
 	int16_t x0 = (int16_t)( ( (float)_region.x * m_texelSize + m_texelOffset[0]) - float(INT16_MAX) );
 	int16_t y0 = (int16_t)( ( (float)_region.y * m_texelSize + m_texelOffset[1]) - float(INT16_MAX) );
 	int16_t x1 = (int16_t)( ( ( (float)_region.x + _region.width) * m_texelSize + m_texelOffset[0]) - float(INT16_MAX) );
@@ -71,8 +71,54 @@ public:
 	uint16_t addRegion(uint16_t _width, uint16_t _height, const uint8_t* _bitmapBuffer, AtlasRegion::Type _type = AtlasRegion::TYPE_BGRA8, uint16_t outline = 0);
 
 	/// update a preallocated region
+	/// @remark texture is not updated until update() is called
 	void updateRegion(const AtlasRegion& _region, const uint8_t* _bitmapBuffer);
 
+	/// upload all regions modified since last call to the texture, dirty regions are coalesced
+	/// into a few rectangles per cube face. Must be called before atlas texture is used for
+	/// rendering, it can be called multiple times per frame.
+	void update();
+
+	/// advance LRU clock used for face eviction, call once per frame
+	void frame()
+	{
+		++m_frame;
+	}
+
+	/// mark faces as used this frame, bit n of the mask is cube face n
+	void touchFaces(uint8_t _faceMask)
+	{
+		for (uint32_t ii = 0; ii < 6; ++ii)
+		{
+			if (0 != (_faceMask & (1<<ii) ) )
+			{
+				m_faceLastUsed[ii] = m_frame;
+			}
+		}
+	}
+
+	/// add a reference to faces, referenced faces are never evicted, bit n of the mask is cube face n
+	void retainFaces(uint8_t _faceMask);
+
+	/// release references added with retainFaces
+	void releaseFaces(uint8_t _faceMask);
+
+	/// evict least recently used face of the given type, all its regions are released
+	/// @remark faces used this frame, pinned or referenced are never evicted
+	/// @return false if there is no face that can be evicted
+	bool evict(AtlasRegion::Type _type);
+
+	/// prevent face containing the region from being evicted
+	void pinRegion(uint16_t _regionHandle);
+
+	/// return true if region wasn't released by eviction
+	bool isRegionValid(uint16_t _regionHandle) const
+	{
+		return _regionHandle < m_regionCount
+			&& 0 != m_regions[_regionHandle].getType()
+			;
+	}
+
 	/// Pack the UV coordinates of the four corners of a region to a vertex buffer using the supplied vertex format.
 	/// v0 -- v3
 	/// |     |     encoded in that order:  v0,v1,v2,v3
@@ -136,12 +182,31 @@ public:
 
 private:
 	void init();
+	void addDirtyRect(uint32_t _faceIndex, uint16_t _x, uint16_t _y, uint16_t _width, uint16_t _height);
 
 	struct PackedLayer;
 	PackedLayer* m_layers;
 	AtlasRegion* m_regions;
 	uint8_t* m_textureBuffer;
 
+	struct DirtyRect
+	{
+		uint16_t x0, y0, x1, y1;
+	};
+
+	enum { MaxDirtyRects = 4 };
+
+	DirtyRect m_dirtyRects[6][MaxDirtyRects];
+	uint8_t m_numDirtyRects[6];
+
+	mutable uint32_t m_faceLastUsed[6];
+	bool m_facePinned[6];
+	uint16_t m_faceRefCount[6];
+	uint32_t m_frame;
+
+	uint16_t* m_freeRegions;
+	uint16_t m_numFreeRegions;
+
 	uint32_t m_usedLayers;
 	uint32_t m_usedFaces;
 
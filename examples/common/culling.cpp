@@ -0,0 +1,341 @@
+/*
+ * Copyright 2011-2019 Branimir Karadzic. All rights reserved.
+ * License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause
+ */
+
+#include <bx/cpu.h>
+#include <bx/simd_t.h>
+#include "entry/entry.h"
+#include "culling.h"
+
+using namespace bx;
+
+// Number of objects culled by single job, must be multiple of 4 to keep SoA loads aligned.
+#define CULLING_CHUNK_SIZE 4096
+
+struct FrustumSimd
+{
+	simd128_t nx[6];
+	simd128_t ny[6];
+	simd128_t nz[6];
+	simd128_t dist[6];
+	simd128_t ax[6];
+	simd128_t ay[6];
+	simd128_t az[6];
+};
+
+static void loadFrustum(FrustumSimd& _out, const Plane* _planes)
+{
+	for (uint32_t ii = 0; ii < 6; ++ii)
+	{
+		const Plane& plane = _planes[ii];
+		_out.nx[ii]   = simd_splat<simd128_t>(plane.normal.x);
+		_out.ny[ii]   = simd_splat<simd128_t>(plane.normal.y);
+		_out.nz[ii]   = simd_splat<simd128_t>(plane.normal.z);
+		_out.dist[ii] = simd_splat<simd128_t>(plane.dist);
+		_out.ax[ii]   = simd_splat<simd128_t>(abs(plane.normal.x) );
+		_out.ay[ii]   = simd_splat<simd128_t>(abs(plane.normal.y) );
+		_out.az[ii]   = simd_splat<simd128_t>(abs(plane.normal.z) );
+	}
+}
+
+static BX_FORCE_INLINE simd128_t load4(const float* _ptr, uint32_t _idx, uint32_t _end)
+{
+	if (_idx + 4 <= _end)
+	{
+		return simd_ld<simd128_t>(&_ptr[_idx]);
+	}
+
+	// Lanes past the end repeat last object, they are never written to output.
+	const uint32_t last = _end - 1;
+	return simd_ld<simd128_t>(
+		  _ptr[min(_idx    , last)]
+		, _ptr[min(_idx + 1, last)]
+		, _ptr[min(_idx + 2, last)]
+		, _ptr[min(_idx + 3, last)]
+		);
+}
+
+/// Gathers upper 4x3 part of 4 matrices, _out[row*3 + column].
+static BX_FORCE_INLINE void loadMtx4(simd128_t* _out, const float* _mtx, uint32_t _idx, uint32_t _end)
+{
+	const uint32_t last = _end - 1;
+	const float* m0 = &_mtx[min(_idx    , last)*16];
+	const float* m1 = &_mtx[min(_idx + 1, last)*16];
+	const float* m2 = &_mtx[min(_idx + 2, last)*16];
+	const float* m3 = &_mtx[min(_idx + 3, last)*16];
+
+	for (uint32_t ii = 0; ii < 12; ++ii)
+	{
+		const uint32_t el = ii + ii/3;
+		_out[ii] = simd_ld<simd128_t>(m0[el], m1[el], m2[el], m3[el]);
+	}
+}
+
+static BX_FORCE_INLINE void transform4(simd128_t& _x, simd128_t& _y, simd128_t& _z, const simd128_t* _mtx)
+{
+	const simd128_t xx = simd_madd(_x, _mtx[0], simd_madd(_y, _mtx[3], simd_madd(_z, _mtx[6], _mtx[ 9]) ) );
+	const simd128_t yy = simd_madd(_x, _mtx[1], simd_madd(_y, _mtx[4], simd_madd(_z, _mtx[7], _mtx[10]) ) );
+	const simd128_t zz = simd_madd(_x, _mtx[2], simd_madd(_y, _mtx[5], simd_madd(_z, _mtx[8], _mtx[11]) ) );
+	_x = xx;
+	_y = yy;
+	_z = zz;
+}
+
+static BX_FORCE_INLINE simd128_t planeDistance4(const FrustumSimd& _frustum, uint32_t _plane, const simd128_t& _x, const simd128_t& _y, const simd128_t& _z)
+{
+	return simd_madd(_frustum.nx[_plane], _x
+		, simd_madd(_frustum.ny[_plane], _y
+		, simd_madd(_frustum.nz[_plane], _z, _frustum.dist[_plane]) ) );
+}
+
+static BX_FORCE_INLINE uint32_t storeVisible(uint32_t* _outIndices, uint32_t _num, const simd128_t& _visible, uint32_t _idx, uint32_t _end)
+{
+	BX_ALIGN_DECL(16, uint32_t) mask[4];
+	simd_st(mask, _visible);
+
+	// Branchless compaction, index is always written and kept only when visible.
+	const uint32_t numLanes = min<uint32_t>(_end - _idx, 4);
+	for (uint32_t ii = 0; ii < numLanes; ++ii)
+	{
+		_outIndices[_num] = _idx + ii;
+		_num += mask[ii] & 1;
+	}
+
+	return _num;
+}
+
+static uint32_t cullRange(uint32_t* _outIndices, const FrustumSimd& _frustum, const SphereSoa& _spheres, const float* _mtx, uint32_t _begin, uint32_t _end)
+{
+	uint32_t num = 0;
+
+	for (uint32_t ii = _begin; ii < _end; ii += 4)
+	{
+		simd128_t x      = load4(_spheres.x,      ii, _end);
+		simd128_t y      = load4(_spheres.y,      ii, _end);
+		simd128_t z      = load4(_spheres.z,      ii, _end);
+		simd128_t radius = load4(_spheres.radius, ii, _end);
+
+		if (NULL != _mtx)
+		{
+			simd128_t mtx[12];
+			loadMtx4(mtx, _mtx, ii, _end);
+			transform4(x, y, z, mtx);
+
+			// Radius is scaled by largest axis scale.
+			const simd128_t sx = simd_madd(mtx[0], mtx[0], simd_madd(mtx[1], mtx[1], simd_mul(mtx[2], mtx[2]) ) );
+			const simd128_t sy = simd_madd(mtx[3], mtx[3], simd_madd(mtx[4], mtx[4], simd_mul(mtx[5], mtx[5]) ) );
+			const simd128_t sz = simd_madd(mtx[6], mtx[6], simd_madd(mtx[7], mtx[7], simd_mul(mtx[8], mtx[8]) ) );
+			radius = simd_mul(radius, simd_sqrt(simd_max(sx, simd_max(sy, sz) ) ) );
+		}
+
+		const simd128_t negRadius = simd_neg(radius);
+
+		simd128_t visible = simd_cmpge(planeDistance4(_frustum, 0, x, y, z), negRadius);
+		for (uint32_t jj = 1; jj < 6; ++jj)
+		{
+			visible = simd_and(visible, simd_cmpge(planeDistance4(_frustum, jj, x, y, z), negRadius) );
+		}
+
+		num = storeVisible(_outIndices, num, visible, ii, _end);
+	}
+
+	return num;
+}
+
+static uint32_t cullRange(uint32_t* _outIndices, const FrustumSimd& _frustum, const AabbSoa& _aabbs, const float* _mtx, uint32_t _begin, uint32_t _end)
+{
+	const simd128_t half = simd_splat<simd128_t>(0.5f);
+
+	uint32_t num = 0;
+
+	for (uint32_t ii = _begin; ii < _end; ii += 4)
+	{
+		const simd128_t minX = load4(_aabbs.minX, ii, _end);
+		const simd128_t minY = load4(_aabbs.minY, ii, _end);
+		const simd128_t minZ = load4(_aabbs.minZ, ii, _end);
+		const simd128_t maxX = load4(_aabbs.maxX, ii, _end);
+		const simd128_t maxY = load4(_aabbs.maxY, ii, _end);
+		const simd128_t maxZ = load4(_aabbs.maxZ, ii, _end);
+
+		simd128_t x  = simd_mul(simd_add(minX, maxX), half);
+		simd128_t y  = simd_mul(simd_add(minY, maxY), half);
+		simd128_t z  = simd_mul(simd_add(minZ, maxZ), half);
+		simd128_t ex = simd_mul(simd_sub(maxX, minX), half);
+		simd128_t ey = simd_mul(simd_sub(maxY, minY), half);
+		simd128_t ez = simd_mul(simd_sub(maxZ, minZ), half);
+
+		if (NULL != _mtx)
+		{
+			simd128_t mtx[12];
+			loadMtx4(mtx, _mtx, ii, _end);
+			transform4(x, y, z, mtx);
+
+			// Extents of transformed box are projected onto world axes.
+			const simd128_t exx = simd_madd(ex, simd_abs(mtx[0]), simd_madd(ey, simd_abs(mtx[3]), simd_mul(ez, simd_abs(mtx[6]) ) ) );
+			const simd128_t eyy = simd_madd(ex, simd_abs(mtx[1]), simd_madd(ey, simd_abs(mtx[4]), simd_mul(ez, simd_abs(mtx[7]) ) ) );
+			const simd128_t ezz = simd_madd(ex, simd_abs(mtx[2]), simd_madd(ey, simd_abs(mtx[5]), simd_mul(ez, simd_abs(mtx[8]) ) ) );
+			ex = exx;
+			ey = eyy;
+			ez = ezz;
+		}
+
+		simd128_t visible = simd_isplat<simd128_t>(UINT32_MAX);
+		for (uint32_t jj = 0; jj < 6; ++jj)
+		{
+			const simd128_t reach = simd_madd(_frustum.ax[jj], ex
+				, simd_madd(_frustum.ay[jj], ey
+				, simd_mul(_frustum.az[jj], ez) ) );
+			visible = simd_and(visible, simd_cmpge(planeDistance4(_frustum, jj, x, y, z), simd_neg(reach) ) );
+		}
+
+		num = storeVisible(_outIndices, num, visible, ii, _end);
+	}
+
+	return num;
+}
+
+uint32_t cullSpheres(uint32_t* _outIndices, const Plane* _planes, const SphereSoa& _spheres, uint32_t _num, const float* _mtx)
+{
+	BX_CHECK(0 == ( (0
+		| uintptr_t(_spheres.x)
+		| uintptr_t(_spheres.y)
+		| uintptr_t(_spheres.z)
+		| uintptr_t(_spheres.radius)
+		) & 15)
+		, "Sphere arrays must be 16-byte aligned."
+		);
+
+	FrustumSimd frustum;
+	loadFrustum(frustum, _planes);
+
+	return cullRange(_outIndices, frustum, _spheres, _mtx, 0, _num);
+}
+
+uint32_t cullAabbs(uint32_t* _outIndices, const Plane* _planes, const AabbSoa& _aabbs, uint32_t _num, const float* _mtx)
+{
+	BX_CHECK(0 == ( (0
+		| uintptr_t(_aabbs.minX)
+		| uintptr_t(_aabbs.minY)
+		| uintptr_t(_aabbs.minZ)
+		| uintptr_t(_aabbs.maxX)
+		| uintptr_t(_aabbs.maxY)
+		| uintptr_t(_aabbs.maxZ)
+		) & 15)
+		, "AABB arrays must be 16-byte aligned."
+		);
+
+	FrustumSimd frustum;
+	loadFrustum(frustum, _planes);
+
+	return cullRange(_outIndices, frustum, _aabbs, _mtx, 0, _num);
+}
+
+BatchCuller::BatchCuller()
+	: m_outIndices(NULL)
+	, m_numVisible(NULL)
+	, m_planes(NULL)
+	, m_spheres(NULL)
+	, m_aabbs(NULL)
+	, m_mtx(NULL)
+	, m_num(0)
+	, m_numChunks(0)
+	, m_maxChunks(0)
+{
+}
+
+BatchCuller::~BatchCuller()
+{
+	shutdown();
+}
+
+void BatchCuller::init(uint32_t _numThreads)
+{
+	m_jobs.init(_numThreads, "culling");
+}
+
+void BatchCuller::shutdown()
+{
+	m_jobs.shutdown();
+
+	if (NULL != m_numVisible)
+	{
+		BX_FREE(entry::getAllocator(), m_numVisible);
+		m_numVisible = NULL;
+		m_maxChunks  = 0;
+	}
+}
+
+uint32_t BatchCuller::cull(uint32_t* _outIndices, const Plane* _planes, const SphereSoa& _spheres, uint32_t _num, const float* _mtx)
+{
+	if (0 == m_jobs.getNumThreads()
+	||  CULLING_CHUNK_SIZE >= _num)
+	{
+		return cullSpheres(_outIndices, _planes, _spheres, _num, _mtx);
+	}
+
+	m_planes  = _planes;
+	m_spheres = &_spheres;
+	m_aabbs   = NULL;
+	m_mtx     = _mtx;
+
+	return dispatch(_outIndices, _num);
+}
+
+uint32_t BatchCuller::cull(uint32_t* _outIndices, const Plane* _planes, const AabbSoa& _aabbs, uint32_t _num, const float* _mtx)
+{
+	if (0 == m_jobs.getNumThreads()
+	||  CULLING_CHUNK_SIZE >= _num)
+	{
+		return cullAabbs(_outIndices, _planes, _aabbs, _num, _mtx);
+	}
+
+	m_planes  = _planes;
+	m_spheres = NULL;
+	m_aabbs   = &_aabbs;
+	m_mtx     = _mtx;
+
+	return dispatch(_outIndices, _num);
+}
+
+uint32_t BatchCuller::dispatch(uint32_t* _outIndices, uint32_t _num)
+{
+	m_numChunks = (_num + CULLING_CHUNK_SIZE - 1) / CULLING_CHUNK_SIZE;
+
+	if (m_numChunks > m_maxChunks)
+	{
+		m_maxChunks  = m_numChunks;
+		m_numVisible = (uint32_t*)BX_REALLOC(entry::getAllocator(), m_numVisible, m_maxChunks*sizeof(uint32_t) );
+	}
+
+	m_outIndices = _outIndices;
+	m_num        = _num;
+
+	m_jobs.run(cullJob, this, m_numChunks);
+
+	// Each chunk compacted its visible indices at chunk start, close gaps between chunks.
+	uint32_t numVisible = m_numVisible[0];
+	for (uint32_t ii = 1; ii < m_numChunks; ++ii)
+	{
+		memMove(&_outIndices[numVisible], &_outIndices[ii*CULLING_CHUNK_SIZE], m_numVisible[ii]*sizeof(uint32_t) );
+		numVisible += m_numVisible[ii];
+	}
+
+	return numVisible;
+}
+
+void BatchCuller::cullJob(void* _userData, uint32_t _job)
+{
+	BatchCuller& culler = *(BatchCuller*)_userData;
+
+	FrustumSimd frustum;
+	loadFrustum(frustum, culler.m_planes);
+
+	const uint32_t begin = _job*CULLING_CHUNK_SIZE;
+	const uint32_t end   = min<uint32_t>(begin + CULLING_CHUNK_SIZE, culler.m_num);
+
+	culler.m_numVisible[_job] = NULL != culler.m_spheres
+		? cullRange(&culler.m_outIndices[begin], frustum, *culler.m_spheres, culler.m_mtx, begin, end)
+		: cullRange(&culler.m_outIndices[begin], frustum, *culler.m_aabbs,   culler.m_mtx, begin, end)
+		;
+}
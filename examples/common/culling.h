@@ -0,0 +1,85 @@
+/*
+ * Copyright 2011-2019 Branimir Karadzic. All rights reserved.
+ * License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause
+ */
+
+#ifndef CULLING_H_HEADER_GUARD
+#define CULLING_H_HEADER_GUARD
+
+#include "bounds.h"
+#include "jobs.h"
+
+#define CULLING_MAX_THREADS JOBS_MAX_THREADS
+
+/// Bounding spheres as structure of arrays. Arrays must be 16-byte aligned.
+struct SphereSoa
+{
+	const float* x;
+	const float* y;
+	const float* z;
+	const float* radius;
+};
+
+/// Axis aligned bounding boxes as structure of arrays. Arrays must be 16-byte aligned.
+struct AabbSoa
+{
+	const float* minX;
+	const float* minY;
+	const float* minZ;
+	const float* maxX;
+	const float* maxY;
+	const float* maxZ;
+};
+
+/// Test spheres against 6 frustum planes (see buildFrustumPlanes), 4 spheres at the time.
+/// _mtx is array of _num object to world matrices, or NULL when spheres are already in
+/// world space. Indices of visible spheres are written to _outIndices in ascending order,
+/// _outIndices must have space for _num indices. Returns number of visible spheres.
+uint32_t cullSpheres(uint32_t* _outIndices, const bx::Plane* _planes, const SphereSoa& _spheres, uint32_t _num, const float* _mtx = NULL);
+
+/// Test AABBs against 6 frustum planes, same as cullSpheres.
+uint32_t cullAabbs(uint32_t* _outIndices, const bx::Plane* _planes, const AabbSoa& _aabbs, uint32_t _num, const float* _mtx = NULL);
+
+/// Splits culling of large batches across worker threads. Calling thread culls too, without
+/// worker threads it's the same as calling cullSpheres/cullAabbs.
+class BatchCuller
+{
+public:
+	BatchCuller();
+	~BatchCuller();
+
+	///
+	void init(uint32_t _numThreads);
+
+	///
+	void shutdown();
+
+	///
+	uint32_t cull(uint32_t* _outIndices, const bx::Plane* _planes, const SphereSoa& _spheres, uint32_t _num, const float* _mtx = NULL);
+
+	///
+	uint32_t cull(uint32_t* _outIndices, const bx::Plane* _planes, const AabbSoa& _aabbs, uint32_t _num, const float* _mtx = NULL);
+
+	uint32_t getNumThreads() const
+	{
+		return m_jobs.getNumThreads();
+	}
+
+private:
+	static void cullJob(void* _userData, uint32_t _job);
+	uint32_t dispatch(uint32_t* _outIndices, uint32_t _num);
+
+	JobPool m_jobs;
+
+	uint32_t* m_outIndices;
+	uint32_t* m_numVisible;
+	const bx::Plane* m_planes;
+	const SphereSoa* m_spheres;
+	const AabbSoa* m_aabbs;
+	const float* m_mtx;
+	uint32_t m_num;
+	uint32_t m_numChunks;
+	uint32_t m_maxChunks;
+};
+
+#endif // CULLING_H_HEADER_GUARD
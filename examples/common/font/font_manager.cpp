@@ -33,6 +33,7 @@ BX_PRAGMA_DIAGNOSTIC_POP();
 
 #include <tinystl/allocator.h>
 #include <tinystl/unordered_map.h>
+#include <tinystl/vector.h>
 namespace stl = tinystl;
 
 #include "font_manager.h"
@@ -387,6 +388,7 @@ void FontManager::init()
 
 	///make sure the black glyph doesn't bleed by using a one pixel inner outline
 	m_blackGlyph.regionIndex = m_atlas->addRegion(W, W, buffer, AtlasRegion::TYPE_GRAY, 1);
+	m_atlas->pinRegion(m_blackGlyph.regionIndex);
 }
 
 FontManager::~FontManager()
@@ -617,11 +619,42 @@ const GlyphInfo* FontManager::getGlyphInfo(FontHandle _handle, CodePoint _codePo
 
 bool FontManager::addBitmap(GlyphInfo& _glyphInfo, const uint8_t* _data)
 {
-	_glyphInfo.regionIndex = m_atlas->addRegion(
-		  (uint16_t)bx::ceil(_glyphInfo.width)
-		, (uint16_t)bx::ceil(_glyphInfo.height)
-		, _data
-		, AtlasRegion::TYPE_GRAY
-		);
-	return true;
+	const uint16_t width  = (uint16_t)bx::ceil(_glyphInfo.width);
+	const uint16_t height = (uint16_t)bx::ceil(_glyphInfo.height);
+
+	_glyphInfo.regionIndex = m_atlas->addRegion(width, height, _data, AtlasRegion::TYPE_GRAY);
+
+	if (UINT16_MAX == _glyphInfo.regionIndex
+	&&  m_atlas->evict(AtlasRegion::TYPE_GRAY) )
+	{
+		releaseEvictedGlyphs();
+		_glyphInfo.regionIndex = m_atlas->addRegion(width, height, _data, AtlasRegion::TYPE_GRAY);
+	}
+
+	return UINT16_MAX != _glyphInfo.regionIndex;
+}
+
+void FontManager::releaseEvictedGlyphs()
+{
+	stl::vector<CodePoint> evicted;
+
+	const uint16_t* handles = m_fontHandles.getHandles();
+	for (uint16_t ii = 0, num = m_fontHandles.getNumHandles(); ii < num; ++ii)
+	{
+		GlyphHashMap& cachedGlyphs = m_cachedFonts[handles[ii] ].cachedGlyphs;
+
+		evicted.clear();
+		for (GlyphHashMap::const_iterator it = cachedGlyphs.begin(), itEnd = cachedGlyphs.end(); it != itEnd; ++it)
+		{
+			if (!m_atlas->isRegionValid(it->second.regionIndex) )
+			{
+				evicted.push_back(it->first);
+			}
+		}
+
+		for (uint32_t jj = 0, numEvicted = uint32_t(evicted.size() ); jj < numEvicted; ++jj)
+		{
+			cachedGlyphs.erase(cachedGlyphs.find(evicted[jj]) );
+		}
+	}
 }
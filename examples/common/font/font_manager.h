@@ -136,6 +136,11 @@ public:
 		return m_atlas;
 	}
 
+	Atlas* getAtlas()
+	{
+		return m_atlas;
+	}
+
 	/// Load a TrueType font from a given buffer. The buffer is copied and
 	/// thus can be freed or reused after this call.
 	///
@@ -188,6 +193,7 @@ private:
 
 	void init();
 	bool addBitmap(GlyphInfo& _glyphInfo, const uint8_t* _data);
+	void releaseEvictedGlyphs();
 
 	bool m_ownAtlas;
 	Atlas* m_atlas;
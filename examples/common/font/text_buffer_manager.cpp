@@ -101,6 +101,12 @@ public:
 		return (uint8_t*) m_vertexBuffer;
 	}
 
+	/// Atlas faces referenced by glyphs in the buffer, bit n is cube face n.
+	uint8_t getFaceMask() const
+	{
+		return m_faceMask;
+	}
+
 	/// Number of vertex in the vertex buffer.
 	uint32_t getVertexCount() const
 	{
@@ -131,6 +137,31 @@ public:
 		return sizeof(uint16_t);
 	}
 
+	/// True if vertices were written since the last call to resetDirty().
+	bool isDirty() const
+	{
+		return m_dirtyVertexBegin < m_dirtyVertexEnd;
+	}
+
+	/// First vertex modified since the last call to resetDirty().
+	uint32_t getDirtyVertexBegin() const
+	{
+		return m_dirtyVertexBegin;
+	}
+
+	/// One past the last vertex modified since the last call to resetDirty().
+	uint32_t getDirtyVertexEnd() const
+	{
+		return m_dirtyVertexEnd;
+	}
+
+	/// Mark vertex data as uploaded.
+	void resetDirty()
+	{
+		m_dirtyVertexBegin = UINT32_MAX;
+		m_dirtyVertexEnd   = 0;
+	}
+
 	uint32_t getTextColor() const
 	{
 		return toABGR(m_textColor);
@@ -184,6 +215,13 @@ private:
 		m_vertexBuffer[_i].y = _y;
 		m_vertexBuffer[_i].rgba = _rgba;
 		m_styleBuffer[_i] = _style;
+		markDirty(_i, _i + 1);
+	}
+
+	void markDirty(uint32_t _begin, uint32_t _end)
+	{
+		m_dirtyVertexBegin = bx::min(m_dirtyVertexBegin, _begin);
+		m_dirtyVertexEnd   = bx::max(m_dirtyVertexEnd,   _end);
 	}
 
 	struct TextVertex
@@ -200,6 +238,10 @@ private:
 	uint32_t m_indexCount;
 	uint32_t m_lineStartIndex;
 	uint16_t m_vertexCount;
+
+	uint32_t m_dirtyVertexBegin;
+	uint32_t m_dirtyVertexEnd;
+	uint8_t m_faceMask;
 };
 
 TextBuffer::TextBuffer(FontManager* _fontManager)
@@ -223,6 +265,9 @@ TextBuffer::TextBuffer(FontManager* _fontManager)
 	, m_indexCount(0)
 	, m_lineStartIndex(0)
 	, m_vertexCount(0)
+	, m_dirtyVertexBegin(UINT32_MAX)
+	, m_dirtyVertexEnd(0)
+	, m_faceMask(0)
 {
 	m_rectangle.width = 0;
 	m_rectangle.height = 0;
@@ -230,6 +275,8 @@ TextBuffer::TextBuffer(FontManager* _fontManager)
 
 TextBuffer::~TextBuffer()
 {
+	m_fontManager->getAtlas()->releaseFaces(m_faceMask);
+
 	delete [] m_vertexBuffer;
 	delete [] m_indexBuffer;
 	delete [] m_styleBuffer;
@@ -338,6 +385,11 @@ void TextBuffer::clearTextBuffer()
 	m_lineGap = 0;
 	m_rectangle.width = 0;
 	m_rectangle.height = 0;
+
+	m_fontManager->getAtlas()->releaseFaces(m_faceMask);
+	m_faceMask = 0;
+
+	resetDirty();
 }
 
 void TextBuffer::appendGlyph(FontHandle _handle, CodePoint _codePoint)
@@ -526,6 +578,15 @@ void TextBuffer::appendGlyph(FontHandle _handle, CodePoint _codePoint)
 		, sizeof(TextVertex)
 		);
 
+	// Keep the face alive while this buffer references it, otherwise evicting
+	// it would leave stale glyphs in the buffer.
+	const uint8_t faceBit = uint8_t(1 << atlas->getRegion(glyph->regionIndex).getFaceIndex() );
+	if (0 == (m_faceMask & faceBit) )
+	{
+		m_fontManager->getAtlas()->retainFaces(faceBit);
+		m_faceMask |= faceBit;
+	}
+
 	setVertex(m_vertexCount + 0, x0, y0, m_textColor);
 	setVertex(m_vertexCount + 1, x0, y1, m_textColor);
 	setVertex(m_vertexCount + 2, x1, y1, m_textColor);
@@ -554,6 +615,8 @@ void TextBuffer::appendGlyph(FontHandle _handle, CodePoint _codePoint)
 
 void TextBuffer::verticalCenterLastLine(float _dy, float _top, float _bottom)
 {
+	markDirty(m_lineStartIndex, m_vertexCount);
+
 	for (uint32_t ii = m_lineStartIndex; ii < m_vertexCount; ii += 4)
 	{
 		if (m_styleBuffer[ii] == STYLE_BACKGROUND)
@@ -630,6 +693,8 @@ TextBufferHandle TextBufferManager::createTextBuffer(uint32_t _type, BufferType:
 	bc.bufferType = _bufferType;
 	bc.indexBufferHandleIdx = bgfx::kInvalidHandle;
 	bc.vertexBufferHandleIdx = bgfx::kInvalidHandle;
+	bc.vertexCount = 0;
+	bc.indexCount = 0;
 
 	TextBufferHandle ret = {textIdx};
 	return ret;
@@ -678,24 +743,15 @@ void TextBufferManager::destroyTextBuffer(TextBufferHandle _handle)
 	}
 }
 
-void TextBufferManager::submitTextBuffer(TextBufferHandle _handle, bgfx::ViewId _id, int32_t _depth)
+bgfx::ProgramHandle TextBufferManager::setRenderState(uint32_t _fontType, uint32_t _rgba)
 {
-	BX_CHECK(bgfx::isValid(_handle), "Invalid handle used");
-
-	BufferCache& bc = m_textBuffers[_handle.idx];
-
-	uint32_t indexSize  = bc.textBuffer->getIndexCount()  * bc.textBuffer->getIndexSize();
-	uint32_t vertexSize = bc.textBuffer->getVertexCount() * bc.textBuffer->getVertexSize();
-
-	if (0 == indexSize || 0 == vertexSize)
-	{
-		return;
-	}
+	Atlas* atlas = m_fontManager->getAtlas();
+	atlas->update();
 
-	bgfx::setTexture(0, s_texColor, m_fontManager->getAtlas()->getTextureHandle() );
+	bgfx::setTexture(0, s_texColor, atlas->getTextureHandle() );
 
 	bgfx::ProgramHandle program = BGFX_INVALID_HANDLE;
-	switch (bc.fontType)
+	switch (_fontType)
 	{
 	case FONT_TYPE_ALPHA:
 		program = m_basicProgram;
@@ -718,11 +774,36 @@ void TextBufferManager::submitTextBuffer(TextBufferHandle _handle, bgfx::ViewId
 		bgfx::setState(0
 			| BGFX_STATE_WRITE_RGB
 			| BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_FACTOR, BGFX_STATE_BLEND_INV_SRC_COLOR)
-			, bc.textBuffer->getTextColor()
+			, _rgba
 			);
 		break;
 	}
 
+	return program;
+}
+
+void TextBufferManager::submitTextBuffer(TextBufferHandle _handle, bgfx::ViewId _id, int32_t _depth)
+{
+	BX_CHECK(bgfx::isValid(_handle), "Invalid handle used");
+
+	BufferCache& bc = m_textBuffers[_handle.idx];
+	TextBuffer* textBuffer = bc.textBuffer;
+
+	const uint32_t vertexCount = textBuffer->getVertexCount();
+	const uint32_t indexCount  = textBuffer->getIndexCount();
+
+	uint32_t indexSize  = indexCount  * textBuffer->getIndexSize();
+	uint32_t vertexSize = vertexCount * textBuffer->getVertexSize();
+
+	if (0 == indexSize || 0 == vertexSize)
+	{
+		return;
+	}
+
+	m_fontManager->getAtlas()->touchFaces(textBuffer->getFaceMask() );
+
+	bgfx::ProgramHandle program = setRenderState(bc.fontType, textBuffer->getTextColor() );
+
 	switch (bc.bufferType)
 	{
 	case BufferType::Static:
@@ -730,19 +811,35 @@ void TextBufferManager::submitTextBuffer(TextBufferHandle _handle, bgfx::ViewId
 			bgfx::IndexBufferHandle ibh;
 			bgfx::VertexBufferHandle vbh;
 
+			if (bgfx::kInvalidHandle != bc.vertexBufferHandleIdx
+			&& (textBuffer->isDirty() || bc.vertexCount != vertexCount) )
+			{
+				// Content changed since it was baked, rebuild it.
+				ibh.idx = bc.indexBufferHandleIdx;
+				vbh.idx = bc.vertexBufferHandleIdx;
+				bgfx::destroy(ibh);
+				bgfx::destroy(vbh);
+
+				bc.indexBufferHandleIdx  = bgfx::kInvalidHandle;
+				bc.vertexBufferHandleIdx = bgfx::kInvalidHandle;
+			}
+
 			if (bgfx::kInvalidHandle == bc.vertexBufferHandleIdx)
 			{
 				ibh = bgfx::createIndexBuffer(
-								bgfx::copy(bc.textBuffer->getIndexBuffer(), indexSize)
+								bgfx::copy(textBuffer->getIndexBuffer(), indexSize)
 								);
 
 				vbh = bgfx::createVertexBuffer(
-								  bgfx::copy(bc.textBuffer->getVertexBuffer(), vertexSize)
+								  bgfx::copy(textBuffer->getVertexBuffer(), vertexSize)
 								, m_vertexDecl
 								);
 
 				bc.vertexBufferHandleIdx = vbh.idx;
-				bc.indexBufferHandleIdx = ibh.idx;
+				bc.indexBufferHandleIdx  = ibh.idx;
+				bc.vertexCount = vertexCount;
+				bc.indexCount  = indexCount;
+				textBuffer->resetDirty();
 			}
 			else
 			{
@@ -750,8 +847,8 @@ void TextBufferManager::submitTextBuffer(TextBufferHandle _handle, bgfx::ViewId
 				ibh.idx = bc.indexBufferHandleIdx;
 			}
 
-			bgfx::setVertexBuffer(0, vbh, 0, bc.textBuffer->getVertexCount() );
-			bgfx::setIndexBuffer(ibh, 0, bc.textBuffer->getIndexCount() );
+			bgfx::setVertexBuffer(0, vbh, 0, vertexCount);
+			bgfx::setIndexBuffer(ibh, 0, indexCount);
 		}
 		break;
 
@@ -760,40 +857,66 @@ void TextBufferManager::submitTextBuffer(TextBufferHandle _handle, bgfx::ViewId
 			bgfx::DynamicIndexBufferHandle ibh;
 			bgfx::DynamicVertexBufferHandle vbh;
 
-			if (bgfx::kInvalidHandle == bc.vertexBufferHandleIdx )
-			{
-				ibh = bgfx::createDynamicIndexBuffer(
-								bgfx::copy(bc.textBuffer->getIndexBuffer(), indexSize)
-								);
+			uint32_t dirtyBegin = textBuffer->getDirtyVertexBegin();
+			uint32_t dirtyEnd   = bx::min(textBuffer->getDirtyVertexEnd(), vertexCount);
 
-				vbh = bgfx::createDynamicVertexBuffer(
-								  bgfx::copy(bc.textBuffer->getVertexBuffer(), vertexSize)
-								, m_vertexDecl
-								);
+			if (bc.vertexCount < vertexCount)
+			{
+				// Out of capacity, grow and upload everything. Index buffer
+				// content only depends on quad position, so the same pattern
+				// is valid for every text buffer and never needs rewriting.
+				if (bgfx::kInvalidHandle != bc.vertexBufferHandleIdx)
+				{
+					ibh.idx = bc.indexBufferHandleIdx;
+					vbh.idx = bc.vertexBufferHandleIdx;
+					bgfx::destroy(ibh);
+					bgfx::destroy(vbh);
+				}
+
+				const uint32_t maxVertices = MAX_BUFFERED_CHARACTERS * 4;
+				const uint32_t capacity    = bx::min(bx::max(bx::uint32_nextpow2(vertexCount), 64u), maxVertices);
+
+				vbh = bgfx::createDynamicVertexBuffer(capacity, m_vertexDecl);
+				ibh = bgfx::createDynamicIndexBuffer(capacity / 4 * 6);
 
-				bc.indexBufferHandleIdx = ibh.idx;
 				bc.vertexBufferHandleIdx = vbh.idx;
+				bc.indexBufferHandleIdx  = ibh.idx;
+				bc.vertexCount = capacity;
+				bc.indexCount  = 0;
+
+				dirtyBegin = 0;
+				dirtyEnd   = vertexCount;
 			}
 			else
 			{
 				ibh.idx = bc.indexBufferHandleIdx;
 				vbh.idx = bc.vertexBufferHandleIdx;
+			}
 
+			if (dirtyBegin < dirtyEnd)
+			{
+				const uint32_t vertexStride = textBuffer->getVertexSize();
 				bgfx::update(
-					  ibh
-					, 0
-					, bgfx::copy(bc.textBuffer->getIndexBuffer(), indexSize)
+					  vbh
+					, dirtyBegin
+					, bgfx::copy(textBuffer->getVertexBuffer() + dirtyBegin * vertexStride, (dirtyEnd - dirtyBegin) * vertexStride)
 					);
+			}
 
+			if (bc.indexCount < indexCount)
+			{
 				bgfx::update(
-					  vbh
-					, 0
-					, bgfx::copy(bc.textBuffer->getVertexBuffer(), vertexSize)
+					  ibh
+					, bc.indexCount
+					, bgfx::copy(textBuffer->getIndexBuffer() + bc.indexCount, (indexCount - bc.indexCount) * textBuffer->getIndexSize() )
 					);
+				bc.indexCount = indexCount;
 			}
 
-			bgfx::setVertexBuffer(0, vbh, 0, bc.textBuffer->getVertexCount() );
-			bgfx::setIndexBuffer(ibh, 0, bc.textBuffer->getIndexCount() );
+			textBuffer->resetDirty();
+
+			bgfx::setVertexBuffer(0, vbh, 0, vertexCount);
+			bgfx::setIndexBuffer(ibh, 0, indexCount);
 		}
 		break;
 
@@ -801,12 +924,12 @@ void TextBufferManager::submitTextBuffer(TextBufferHandle _handle, bgfx::ViewId
 		{
 			bgfx::TransientIndexBuffer tib;
 			bgfx::TransientVertexBuffer tvb;
-			bgfx::allocTransientIndexBuffer(&tib, bc.textBuffer->getIndexCount() );
-			bgfx::allocTransientVertexBuffer(&tvb, bc.textBuffer->getVertexCount(), m_vertexDecl);
-			bx::memCopy(tib.data, bc.textBuffer->getIndexBuffer(), indexSize);
-			bx::memCopy(tvb.data, bc.textBuffer->getVertexBuffer(), vertexSize);
-			bgfx::setVertexBuffer(0, &tvb, 0, bc.textBuffer->getVertexCount() );
-			bgfx::setIndexBuffer(&tib, 0, bc.textBuffer->getIndexCount() );
+			bgfx::allocTransientIndexBuffer(&tib, indexCount);
+			bgfx::allocTransientVertexBuffer(&tvb, vertexCount, m_vertexDecl);
+			bx::memCopy(tib.data, textBuffer->getIndexBuffer(), indexSize);
+			bx::memCopy(tvb.data, textBuffer->getVertexBuffer(), vertexSize);
+			bgfx::setVertexBuffer(0, &tvb, 0, vertexCount);
+			bgfx::setIndexBuffer(&tib, 0, indexCount);
 		}
 		break;
 	}
@@ -814,6 +937,106 @@ void TextBufferManager::submitTextBuffer(TextBufferHandle _handle, bgfx::ViewId
 	bgfx::submit(_id, program, _depth);
 }
 
+void TextBufferManager::submitTextBuffers(const TextBufferHandle* _handles, uint32_t _num, bgfx::ViewId _id, int32_t _depth)
+{
+	uint32_t ii = 0;
+	while (ii < _num)
+	{
+		BX_CHECK(bgfx::isValid(_handles[ii]), "Invalid handle used");
+		const BufferCache& first = m_textBuffers[_handles[ii].idx];
+		const uint32_t fontType = first.fontType;
+		const uint32_t rgba     = first.textBuffer->getTextColor();
+
+		// Gather a run of consecutive buffers that can be drawn with the
+		// same program and state, without overflowing 16-bit indices.
+		uint32_t numVertices = 0;
+		uint32_t numIndices  = 0;
+		uint8_t  faceMask    = 0;
+		uint32_t end = ii;
+		for (; end < _num; ++end)
+		{
+			BX_CHECK(bgfx::isValid(_handles[end]), "Invalid handle used");
+			const BufferCache& bc = m_textBuffers[_handles[end].idx];
+			const uint32_t vertexCount = bc.textBuffer->getVertexCount();
+
+			if (bc.fontType != fontType
+			|| (FONT_TYPE_DISTANCE_SUBPIXEL == fontType && bc.textBuffer->getTextColor() != rgba)
+			||  numVertices + vertexCount > UINT16_MAX)
+			{
+				break;
+			}
+
+			numVertices += vertexCount;
+			numIndices  += bc.textBuffer->getIndexCount();
+			faceMask    |= bc.textBuffer->getFaceMask();
+		}
+
+		if (end == ii)
+		{
+			// Single buffer too large to be merged with anything.
+			submitTextBuffer(_handles[ii], _id, _depth);
+			++ii;
+			continue;
+		}
+
+		m_fontManager->getAtlas()->touchFaces(faceMask);
+
+		if (0 != numIndices
+		&&  bgfx::getAvailTransientVertexBuffer(numVertices, m_vertexDecl) == numVertices
+		&&  bgfx::getAvailTransientIndexBuffer(numIndices) == numIndices)
+		{
+			bgfx::TransientIndexBuffer tib;
+			bgfx::TransientVertexBuffer tvb;
+			bgfx::allocTransientIndexBuffer(&tib, numIndices);
+			bgfx::allocTransientVertexBuffer(&tvb, numVertices, m_vertexDecl);
+
+			uint8_t*  vertices = tvb.data;
+			uint16_t* indices  = (uint16_t*)tib.data;
+			uint16_t  base     = 0;
+
+			for (uint32_t jj = ii; jj < end; ++jj)
+			{
+				TextBuffer* textBuffer = m_textBuffers[_handles[jj].idx].textBuffer;
+				const uint32_t vertexCount = textBuffer->getVertexCount();
+				const uint32_t indexCount  = textBuffer->getIndexCount();
+
+				const uint32_t vertexSize = vertexCount * textBuffer->getVertexSize();
+				bx::memCopy(vertices, textBuffer->getVertexBuffer(), vertexSize);
+				vertices += vertexSize;
+
+				const uint16_t* src = textBuffer->getIndexBuffer();
+				for (uint32_t kk = 0; kk < indexCount; ++kk)
+				{
+					indices[kk] = src[kk] + base;
+				}
+				indices += indexCount;
+				base    += uint16_t(vertexCount);
+			}
+
+			bgfx::ProgramHandle program = setRenderState(fontType, rgba);
+			bgfx::setVertexBuffer(0, &tvb);
+			bgfx::setIndexBuffer(&tib);
+			bgfx::submit(_id, program, _depth);
+		}
+		else
+		{
+			// Not enough transient space to merge the run, fall back to
+			// submitting each buffer on its own.
+			for (uint32_t jj = ii; jj < end; ++jj)
+			{
+				submitTextBuffer(_handles[jj], _id, _depth);
+			}
+		}
+
+		ii = end;
+	}
+}
+
+void TextBufferManager::frame()
+{
+	m_fontManager->getAtlas()->frame();
+}
+
 void TextBufferManager::setStyle(TextBufferHandle _handle, uint32_t _flags)
 {
 	BX_CHECK(bgfx::isValid(_handle), "Invalid handle used");
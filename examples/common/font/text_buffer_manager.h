@@ -49,6 +49,14 @@ public:
 	void destroyTextBuffer(TextBufferHandle _handle);
 	void submitTextBuffer(TextBufferHandle _handle, bgfx::ViewId _id, int32_t _depth = 0);
 
+	/// Submit multiple text buffers, merging consecutive buffers that share font type into
+	/// a single draw call. Vertices are gathered into transient buffers every call.
+	void submitTextBuffers(const TextBufferHandle* _handles, uint32_t _num, bgfx::ViewId _id, int32_t _depth = 0);
+
+	/// Advance atlas LRU clock, call once per frame. Atlas faces used by text buffers
+	/// submitted in the current frame are never evicted.
+	void frame();
+
 	void setStyle(TextBufferHandle _handle, uint32_t _flags = STYLE_NORMAL);
 	void setTextColor(TextBufferHandle _handle, uint32_t _rgba = 0x000000FF);
 	void setBackgroundColor(TextBufferHandle _handle, uint32_t _rgba = 0x000000FF);
@@ -75,6 +83,8 @@ public:
 	TextRectangle getRectangle(TextBufferHandle _handle) const;
 
 private:
+	bgfx::ProgramHandle setRenderState(uint32_t _fontType, uint32_t _rgba);
+
 	struct BufferCache
 	{
 		uint16_t indexBufferHandleIdx;
@@ -82,6 +92,8 @@ private:
 		TextBuffer* textBuffer;
 		BufferType::Enum bufferType;
 		uint32_t fontType;
+		uint32_t vertexCount; //!< Static: baked vertex count, Dynamic: vertex capacity.
+		uint32_t indexCount;  //!< Number of indices uploaded.
 	};
 
 	BufferCache* m_textBuffers;
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2011-2019 Branimir Karadzic. All rights reserved.
+ * License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause
+ */
+
+#include <bx/cpu.h>
+#include "jobs.h"
+
+using namespace bx;
+
+JobPool::JobPool()
+	: m_fn(NULL)
+	, m_userData(NULL)
+	, m_numJobs(0)
+	, m_next(0)
+	, m_numThreads(0)
+	, m_exit(false)
+{
+}
+
+JobPool::~JobPool()
+{
+	shutdown();
+}
+
+void JobPool::init(uint32_t _numThreads, const char* _name)
+{
+	m_exit       = false;
+	m_numThreads = min<uint32_t>(_numThreads, JOBS_MAX_THREADS);
+
+	for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+	{
+		m_thread[ii].init(workerProc, this, 0, _name);
+	}
+}
+
+void JobPool::shutdown()
+{
+	if (0 < m_numThreads)
+	{
+		m_exit = true;
+		m_workSem.post(m_numThreads);
+
+		for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+		{
+			m_thread[ii].shutdown();
+		}
+
+		m_numThreads = 0;
+	}
+}
+
+void JobPool::run(JobFn _fn, void* _userData, uint32_t _numJobs)
+{
+	if (0 == _numJobs)
+	{
+		return;
+	}
+
+	m_fn       = _fn;
+	m_userData = _userData;
+	m_numJobs  = _numJobs;
+	m_next     = 0;
+
+	// Calling thread runs jobs too, wake up only as many workers as there are jobs left for
+	// them.
+	const uint32_t numThreads = min<uint32_t>(m_numThreads, _numJobs - 1);
+	m_workSem.post(numThreads);
+
+	execute();
+
+	for (uint32_t ii = 0; ii < numThreads; ++ii)
+	{
+		m_doneSem.wait();
+	}
+}
+
+int32_t JobPool::workerProc(Thread* /*_self*/, void* _userData)
+{
+	return ( (JobPool*)_userData)->worker();
+}
+
+int32_t JobPool::worker()
+{
+	for (;;)
+	{
+		m_workSem.wait();
+
+		if (m_exit)
+		{
+			break;
+		}
+
+		execute();
+		m_doneSem.post();
+	}
+
+	return 0;
+}
+
+void JobPool::execute()
+{
+	for (;;)
+	{
+		const uint32_t idx = atomicFetchAndAdd<uint32_t>(&m_next, 1);
+
+		if (idx >= m_numJobs)
+		{
+			break;
+		}
+
+		m_fn(m_userData, idx);
+	}
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2011-2019 Branimir Karadzic. All rights reserved.
+ * License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause
+ */
+
+#ifndef JOBS_H_HEADER_GUARD
+#define JOBS_H_HEADER_GUARD
+
+#include <bx/semaphore.h>
+#include <bx/thread.h>
+
+#define JOBS_MAX_THREADS 16
+
+/// Fixed pool of worker threads running batches of independent jobs. Jobs are picked in
+/// order by whichever thread is free, calling thread runs jobs too. Without worker threads
+/// all jobs run on calling thread.
+class JobPool
+{
+public:
+	///
+	typedef void (*JobFn)(void* _userData, uint32_t _job);
+
+	JobPool();
+	~JobPool();
+
+	///
+	void init(uint32_t _numThreads, const char* _name);
+
+	///
+	void shutdown();
+
+	/// Run jobs [0, _numJobs), returns once all of them are done.
+	void run(JobFn _fn, void* _userData, uint32_t _numJobs);
+
+	///
+	uint32_t getNumThreads() const
+	{
+		return m_numThreads;
+	}
+
+private:
+	static int32_t workerProc(bx::Thread* _self, void* _userData);
+	int32_t worker();
+	void execute();
+
+	bx::Thread m_thread[JOBS_MAX_THREADS];
+	bx::Semaphore m_workSem;
+	bx::Semaphore m_doneSem;
+
+	JobFn m_fn;
+	void* m_userData;
+	uint32_t m_numJobs;
+	uint32_t m_next;
+	uint32_t m_numThreads;
+	bool m_exit;
+};
+
+#endif // JOBS_H_HEADER_GUARD
@@ -151,6 +151,7 @@ namespace
 		bgfx::TextureHandle texMissing;
 
 		bgfx::TransientVertexBuffer tvb;
+		bgfx::TransientIndexBuffer tib;
 		bgfx::ViewId viewId;
 
 		struct GLNVGtexture* textures;
@@ -486,6 +487,18 @@ namespace
 			}
 			gl->th = tex->id;
 		}
+		else if (0 == bx::memCmp(&paint->innerColor, &paint->outerColor, sizeof(NVGcolor) ) )
+		{
+			// Solid color, gradient evaluates to inner color everywhere. Paint transform
+			// and shape are canonicalized so that calls with the same color can be merged
+			// regardless of current transform.
+			frag->type = NSVG_SHADER_FILLGRAD;
+			frag->extent[0] = 0.0f;
+			frag->extent[1] = 0.0f;
+			frag->radius  = 0.0f;
+			frag->feather = 1.0f;
+			nvgTransformIdentity(invxform);
+		}
 		else
 		{
 			frag->type = NSVG_SHADER_FILLGRAD;
@@ -713,6 +726,168 @@ namespace
 		}
 	}
 
+	static uint32_t glnvg__stripToList(uint16_t* _out, uint32_t _start, uint32_t _count)
+	{
+		if (3 > _count)
+		{
+			return 0;
+		}
+
+		const uint32_t numTris = _count-2;
+		if (NULL != _out)
+		{
+			for (uint32_t ii = 0; ii < numTris; ++ii)
+			{
+				_out[ii*3+0] = uint16_t(_start + ii + 0);
+				_out[ii*3+1] = uint16_t(_start + ii + 1 + (ii&1) );
+				_out[ii*3+2] = uint16_t(_start + ii + 2 - (ii&1) );
+			}
+		}
+
+		return numTris*3;
+	}
+
+	static uint32_t glnvg__fanToList(uint16_t* _out, uint32_t _start, uint32_t _count)
+	{
+		if (3 > _count)
+		{
+			return 0;
+		}
+
+		const uint32_t numTris = _count-2;
+		if (NULL != _out)
+		{
+			for (uint32_t ii = 0; ii < numTris; ++ii)
+			{
+				_out[ii*3+0] = uint16_t(_start);
+				_out[ii*3+1] = uint16_t(_start + ii + 1);
+				_out[ii*3+2] = uint16_t(_start + ii + 2);
+			}
+		}
+
+		return numTris*3;
+	}
+
+	// Writes call geometry as indexed triangle list relative to _base vertex. When
+	// _out is NULL only number of indices is returned. Stencil fills can't be merged.
+	static uint32_t glnvg__batchIndices(struct GLNVGcontext* gl, const struct GLNVGcall* call, uint16_t* _out, uint32_t _base)
+	{
+		const struct GLNVGpath* paths = &gl->paths[call->pathOffset];
+		uint32_t num = 0;
+
+		switch (call->type)
+		{
+		case GLNVG_CONVEXFILL:
+			for (int i = 0; i < call->pathCount; i++)
+			{
+				num += glnvg__fanToList(NULL == _out ? NULL : &_out[num], paths[i].fillOffset - _base, paths[i].fillCount);
+			}
+
+			if (gl->edgeAntiAlias)
+			{
+				for (int i = 0; i < call->pathCount; i++)
+				{
+					num += glnvg__stripToList(NULL == _out ? NULL : &_out[num], paths[i].strokeOffset - _base, paths[i].strokeCount);
+				}
+			}
+			break;
+
+		case GLNVG_STROKE:
+			for (int i = 0; i < call->pathCount; i++)
+			{
+				num += glnvg__stripToList(NULL == _out ? NULL : &_out[num], paths[i].strokeOffset - _base, paths[i].strokeCount);
+			}
+			break;
+
+		case GLNVG_TRIANGLES:
+			if (3 <= call->vertexCount)
+			{
+				const uint32_t count = call->vertexCount - call->vertexCount%3;
+				if (NULL != _out)
+				{
+					for (uint32_t ii = 0; ii < count; ++ii)
+					{
+						_out[ii] = uint16_t(call->vertexOffset - _base + ii);
+					}
+				}
+				num = count;
+			}
+			break;
+
+		default:
+			break;
+		}
+
+		return num;
+	}
+
+	// Returns false if call has no geometry.
+	static bool glnvg__batchRange(struct GLNVGcontext* gl, const struct GLNVGcall* call, uint32_t& _first, uint32_t& _last)
+	{
+		_first = UINT32_MAX;
+		_last  = 0;
+
+		if (GLNVG_TRIANGLES == call->type)
+		{
+			if (3 <= call->vertexCount)
+			{
+				_first = call->vertexOffset;
+				_last  = call->vertexOffset + call->vertexCount;
+			}
+		}
+		else
+		{
+			const struct GLNVGpath* paths = &gl->paths[call->pathOffset];
+			for (int i = 0; i < call->pathCount; i++)
+			{
+				if (0 < paths[i].fillCount && GLNVG_CONVEXFILL == call->type)
+				{
+					_first = bx::min<uint32_t>(_first, paths[i].fillOffset);
+					_last  = bx::max<uint32_t>(_last,  paths[i].fillOffset + paths[i].fillCount);
+				}
+
+				if (0 < paths[i].strokeCount)
+				{
+					_first = bx::min<uint32_t>(_first, paths[i].strokeOffset);
+					_last  = bx::max<uint32_t>(_last,  paths[i].strokeOffset + paths[i].strokeCount);
+				}
+			}
+		}
+
+		return _first < _last;
+	}
+
+	static bool glnvg__canBatch(struct GLNVGcontext* gl, const struct GLNVGcall* _a, const struct GLNVGcall* _b)
+	{
+		return GLNVG_FILL != _b->type
+			&& _a->image == _b->image
+			&& 0 == bx::memCmp(&_a->blendFunc, &_b->blendFunc, sizeof(GLNVGblend) )
+			&& 0 == bx::memCmp(nvg__fragUniformPtr(gl, _a->uniformOffset), nvg__fragUniformPtr(gl, _b->uniformOffset), sizeof(GLNVGfragUniforms) )
+			;
+	}
+
+	static void glnvg__drawCall(struct GLNVGcontext* gl, struct GLNVGcall* call)
+	{
+		switch (call->type)
+		{
+		case GLNVG_FILL:
+			glnvg__fill(gl, call);
+			break;
+
+		case GLNVG_CONVEXFILL:
+			glnvg__convexFill(gl, call);
+			break;
+
+		case GLNVG_STROKE:
+			glnvg__stroke(gl, call);
+			break;
+
+		case GLNVG_TRIANGLES:
+			glnvg__triangles(gl, call);
+			break;
+		}
+	}
+
 	static const uint64_t s_blend[] =
 	{
 		BGFX_STATE_BLEND_ZERO,
@@ -772,6 +947,28 @@ namespace
 
 			bgfx::setUniform(gl->u_viewSize, gl->view);
 
+			// Consecutive convex fills, strokes and triangles with identical paint, image
+			// and blend state are converted to indexed triangle lists and merged into a
+			// single draw call.
+			uint32_t numIndices = 0;
+			for (uint32_t ii = 0, num = gl->ncalls; ii < num; ++ii)
+			{
+				numIndices += glnvg__batchIndices(gl, &gl->calls[ii], NULL, 0);
+			}
+
+			const bool batch = 0 < numIndices
+				&& numIndices == bgfx::getAvailTransientIndexBuffer(numIndices)
+				;
+
+			uint16_t* indices = NULL;
+			if (batch)
+			{
+				bgfx::allocTransientIndexBuffer(&gl->tib, numIndices);
+				indices = (uint16_t*)gl->tib.data;
+			}
+
+			uint32_t numBatchIndices = 0;
+
 			for (uint32_t ii = 0, num = gl->ncalls; ii < num; ++ii)
 			{
 				struct GLNVGcall* call = &gl->calls[ii];
@@ -780,23 +977,56 @@ namespace
 					| BGFX_STATE_WRITE_RGB
 					| BGFX_STATE_WRITE_A
 					;
-				switch (call->type)
+
+				uint32_t first, last;
+				if (!batch
+				||  GLNVG_FILL == call->type
+				|| !glnvg__batchRange(gl, call, first, last)
+				||  last > uint32_t(gl->nverts)
+				||  last - first > UINT16_MAX+1)
 				{
-				case GLNVG_FILL:
-					glnvg__fill(gl, call);
-					break;
+					glnvg__drawCall(gl, call);
+					continue;
+				}
+
+				const uint32_t startIndex = numBatchIndices;
+				numBatchIndices += glnvg__batchIndices(gl, call, &indices[numBatchIndices], first);
 
-				case GLNVG_CONVEXFILL:
-					glnvg__convexFill(gl, call);
-					break;
+				for (uint32_t jj = ii+1; jj < num; ++jj)
+				{
+					struct GLNVGcall* next = &gl->calls[jj];
+
+					uint32_t nextFirst, nextLast;
+					if (!glnvg__canBatch(gl, call, next) )
+					{
+						break;
+					}
+
+					if (glnvg__batchRange(gl, next, nextFirst, nextLast) )
+					{
+						if (nextFirst < first
+						||  nextLast  > uint32_t(gl->nverts)
+						||  nextLast - first > UINT16_MAX+1)
+						{
+							break;
+						}
+
+						numBatchIndices += glnvg__batchIndices(gl, next, &indices[numBatchIndices], first);
+						last = bx::max(last, nextLast);
+					}
+
+					ii = jj;
+				}
 
-				case GLNVG_STROKE:
-					glnvg__stroke(gl, call);
-					break;
+				if (startIndex != numBatchIndices)
+				{
+					nvgRenderSetUniforms(gl, call->uniformOffset, call->image);
 
-				case GLNVG_TRIANGLES:
-					glnvg__triangles(gl, call);
-					break;
+					bgfx::setState(gl->state);
+					bgfx::setVertexBuffer(0, &gl->tvb, first, last - first);
+					bgfx::setIndexBuffer(&gl->tib, startIndex, numBatchIndices - startIndex);
+					bgfx::setTexture(0, gl->s_tex, gl->th);
+					bgfx::submit(gl->viewId, gl->prog);
 				}
 			}
 		}
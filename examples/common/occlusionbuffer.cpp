@@ -0,0 +1,493 @@
+/*
+ * Copyright 2011-2019 Branimir Karadzic. All rights reserved.
+ * License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause
+ */
+
+#include <bx/cpu.h>
+#include <bx/simd_t.h>
+#include "entry/entry.h"
+#include "occlusionbuffer.h"
+
+using namespace bx;
+
+// Triangles with any vertex closer than this (clip space w) are not rasterized, and objects
+// with any corner closer than this are always visible.
+static const float kNearW = 1.0e-4f;
+
+OcclusionBuffer::OcclusionBuffer()
+	: m_clip(NULL)
+	, m_maxClipVertices(0)
+	, m_numMips(0)
+	, m_width(0)
+	, m_height(0)
+	, m_tilesX(0)
+	, m_tilesY(0)
+{
+	memSet(m_mip, 0, sizeof(m_mip) );
+	mtxIdentity(m_viewProj);
+}
+
+OcclusionBuffer::~OcclusionBuffer()
+{
+	shutdown();
+}
+
+void OcclusionBuffer::init(uint16_t _width, uint16_t _height, uint32_t _numThreads)
+{
+	m_tilesX = uint16_t( (_width  + OCCLUSION_TILE_WIDTH  - 1) / OCCLUSION_TILE_WIDTH );
+	m_tilesY = uint16_t( (_height + OCCLUSION_TILE_HEIGHT - 1) / OCCLUSION_TILE_HEIGHT);
+	m_width  = uint16_t(m_tilesX * OCCLUSION_TILE_WIDTH );
+	m_height = uint16_t(m_tilesY * OCCLUSION_TILE_HEIGHT);
+
+	m_bins.resize(m_tilesX*m_tilesY);
+
+	bx::AllocatorI* allocator = entry::getAllocator();
+
+	uint16_t width  = m_width;
+	uint16_t height = m_height;
+
+	for (m_numMips = 0; m_numMips < OCCLUSION_MAX_MIPS;)
+	{
+		m_mipWidth[m_numMips]  = width;
+		m_mipHeight[m_numMips] = height;
+		m_mip[m_numMips] = (float*)BX_ALIGNED_ALLOC(allocator, width*height*sizeof(float), 16);
+		++m_numMips;
+
+		if (1 == width
+		&&  1 == height)
+		{
+			break;
+		}
+
+		width  = max<uint16_t>(1, (width +1)/2);
+		height = max<uint16_t>(1, (height+1)/2);
+	}
+
+	m_jobs.init(_numThreads, "occlusion");
+}
+
+void OcclusionBuffer::shutdown()
+{
+	m_jobs.shutdown();
+
+	bx::AllocatorI* allocator = entry::getAllocator();
+
+	for (uint32_t ii = 0; ii < m_numMips; ++ii)
+	{
+		BX_ALIGNED_FREE(allocator, m_mip[ii], 16);
+		m_mip[ii] = NULL;
+	}
+
+	m_numMips = 0;
+
+	if (NULL != m_clip)
+	{
+		BX_ALIGNED_FREE(allocator, m_clip, 16);
+		m_clip = NULL;
+		m_maxClipVertices = 0;
+	}
+
+	m_triangles.clear();
+	m_bins.clear();
+}
+
+void OcclusionBuffer::begin(const float* _viewProj)
+{
+	memCopy(m_viewProj, _viewProj, sizeof(m_viewProj) );
+
+	m_triangles.clear();
+
+	for (uint32_t ii = 0, num = uint32_t(m_bins.size() ); ii < num; ++ii)
+	{
+		m_bins[ii].clear();
+	}
+}
+
+void OcclusionBuffer::addOccluder(const float* _mtx, const void* _vertices, uint32_t _numVertices, uint32_t _stride, const uint16_t* _indices, uint32_t _numIndices)
+{
+	BX_ALIGN_DECL(16, float) mvp[16];
+
+	if (NULL != _mtx)
+	{
+		mtxMul(mvp, _mtx, m_viewProj);
+	}
+	else
+	{
+		memCopy(mvp, m_viewProj, sizeof(mvp) );
+	}
+
+	if (_numVertices > m_maxClipVertices)
+	{
+		m_maxClipVertices = _numVertices;
+		m_clip = (float*)BX_ALIGNED_REALLOC(entry::getAllocator(), m_clip, m_maxClipVertices*4*sizeof(float), 16);
+	}
+
+	const simd128_t row0 = simd_ld<simd128_t>(&mvp[ 0]);
+	const simd128_t row1 = simd_ld<simd128_t>(&mvp[ 4]);
+	const simd128_t row2 = simd_ld<simd128_t>(&mvp[ 8]);
+	const simd128_t row3 = simd_ld<simd128_t>(&mvp[12]);
+
+	const uint8_t* vertices = (const uint8_t*)_vertices;
+
+	for (uint32_t ii = 0; ii < _numVertices; ++ii)
+	{
+		const float* pos = (const float*)&vertices[ii*_stride];
+
+		const simd128_t clip = simd_madd(simd_splat<simd128_t>(pos[0]), row0
+			, simd_madd(simd_splat<simd128_t>(pos[1]), row1
+			, simd_madd(simd_splat<simd128_t>(pos[2]), row2, row3) ) );
+
+		simd_st(&m_clip[ii*4], clip);
+	}
+
+	setupTriangles(m_clip, _indices, _numIndices);
+}
+
+void OcclusionBuffer::setupTriangles(const float* _clip, const uint16_t* _indices, uint32_t _numIndices)
+{
+	const simd128_t zero    = simd_zero<simd128_t>();
+	const simd128_t half    = simd_splat<simd128_t>(0.5f);
+	const simd128_t one     = simd_splat<simd128_t>(1.0f);
+	const simd128_t nearW   = simd_splat<simd128_t>(kNearW);
+	const simd128_t minArea = simd_splat<simd128_t>(1.0e-8f);
+	const simd128_t width   = simd_splat<simd128_t>(float(m_width) );
+	const simd128_t height  = simd_splat<simd128_t>(float(m_height) );
+
+	const uint32_t numTriangles = _numIndices/3;
+
+	for (uint32_t ii = 0; ii < numTriangles; ii += 4)
+	{
+		const uint32_t numLanes = min<uint32_t>(numTriangles - ii, 4);
+
+		simd128_t x[3];
+		simd128_t y[3];
+		simd128_t z[3];
+		simd128_t valid = simd_isplat<simd128_t>(UINT32_MAX);
+
+		for (uint32_t vv = 0; vv < 3; ++vv)
+		{
+			// Lanes past the end repeat last triangle, they are never stored.
+			const simd128_t v0 = simd_ld<simd128_t>(&_clip[_indices[(ii + 0                   )*3 + vv]*4]);
+			const simd128_t v1 = simd_ld<simd128_t>(&_clip[_indices[(ii + min(1u, numLanes-1) )*3 + vv]*4]);
+			const simd128_t v2 = simd_ld<simd128_t>(&_clip[_indices[(ii + min(2u, numLanes-1) )*3 + vv]*4]);
+			const simd128_t v3 = simd_ld<simd128_t>(&_clip[_indices[(ii + min(3u, numLanes-1) )*3 + vv]*4]);
+
+			const simd128_t t0 = simd_shuf_xAyB(v0, v2);
+			const simd128_t t1 = simd_shuf_xAyB(v1, v3);
+			const simd128_t t2 = simd_shuf_zCwD(v0, v2);
+			const simd128_t t3 = simd_shuf_zCwD(v1, v3);
+
+			const simd128_t cx = simd_shuf_xAyB(t0, t1);
+			const simd128_t cy = simd_shuf_zCwD(t0, t1);
+			const simd128_t cz = simd_shuf_xAyB(t2, t3);
+			const simd128_t cw = simd_shuf_zCwD(t2, t3);
+
+			valid = simd_and(valid, simd_cmpge(cw, nearW) );
+
+			const simd128_t invW = simd_div(one, simd_max(cw, nearW) );
+			x[vv] = simd_mul(simd_madd(simd_mul(cx, invW), half, half), width);
+			y[vv] = simd_mul(simd_sub(half, simd_mul(simd_mul(cy, invW), half) ), height);
+			z[vv] = simd_mul(cz, invW);
+		}
+
+		const simd128_t x10 = simd_sub(x[1], x[0]);
+		const simd128_t y10 = simd_sub(y[1], y[0]);
+		const simd128_t x20 = simd_sub(x[2], x[0]);
+		const simd128_t y20 = simd_sub(y[2], y[0]);
+		const simd128_t z10 = simd_sub(z[1], z[0]);
+		const simd128_t z20 = simd_sub(z[2], z[0]);
+
+		const simd128_t area = simd_sub(simd_mul(x10, y20), simd_mul(x20, y10) );
+		valid = simd_and(valid, simd_cmpgt(simd_abs(area), minArea) );
+
+		// Both windings are rasterized, edge functions are flipped to be positive inside.
+		const simd128_t sign = simd_selb(simd_cmplt(area, zero), simd_neg(one), one);
+
+		BX_ALIGN_DECL(16, float) edge[3][3][4];
+		for (uint32_t ee = 0; ee < 3; ++ee)
+		{
+			const uint32_t aa = ee;
+			const uint32_t bb = (ee + 1) % 3;
+			simd_st(edge[ee][0], simd_mul(simd_sub(y[aa], y[bb]), sign) );
+			simd_st(edge[ee][1], simd_mul(simd_sub(x[bb], x[aa]), sign) );
+			simd_st(edge[ee][2], simd_mul(simd_sub(simd_mul(x[aa], y[bb]), simd_mul(x[bb], y[aa]) ), sign) );
+		}
+
+		const simd128_t invArea = simd_div(one, area);
+		const simd128_t dzdx = simd_mul(simd_sub(simd_mul(z10, y20), simd_mul(z20, y10) ), invArea);
+		const simd128_t dzdy = simd_mul(simd_sub(simd_mul(z20, x10), simd_mul(z10, x20) ), invArea);
+		const simd128_t dz   = simd_sub(z[0], simd_madd(dzdx, x[0], simd_mul(dzdy, y[0]) ) );
+
+		BX_ALIGN_DECL(16, float) depth[3][4];
+		simd_st(depth[0], dzdx);
+		simd_st(depth[1], dzdy);
+		simd_st(depth[2], dz);
+
+		BX_ALIGN_DECL(16, float) minX[4];
+		BX_ALIGN_DECL(16, float) minY[4];
+		BX_ALIGN_DECL(16, float) maxX[4];
+		BX_ALIGN_DECL(16, float) maxY[4];
+		simd_st(minX, simd_min(x[0], simd_min(x[1], x[2]) ) );
+		simd_st(minY, simd_min(y[0], simd_min(y[1], y[2]) ) );
+		simd_st(maxX, simd_max(x[0], simd_max(x[1], x[2]) ) );
+		simd_st(maxY, simd_max(y[0], simd_max(y[1], y[2]) ) );
+
+		BX_ALIGN_DECL(16, uint32_t) mask[4];
+		simd_st(mask, valid);
+
+		for (uint32_t ll = 0; ll < numLanes; ++ll)
+		{
+			if (0 == mask[ll]
+			||  0.0f > maxX[ll]
+			||  0.0f > maxY[ll]
+			||  float(m_width ) <= minX[ll]
+			||  float(m_height) <= minY[ll])
+			{
+				continue;
+			}
+
+			RasterTriangle tri;
+			for (uint32_t ee = 0; ee < 3; ++ee)
+			{
+				tri.m_edge[ee][0] = edge[ee][0][ll];
+				tri.m_edge[ee][1] = edge[ee][1][ll];
+				tri.m_edge[ee][2] = edge[ee][2][ll];
+				tri.m_depth[ee]   = depth[ee][ll];
+			}
+
+			tri.m_minX = uint16_t(max(minX[ll], 0.0f) );
+			tri.m_minY = uint16_t(max(minY[ll], 0.0f) );
+			tri.m_maxX = uint16_t(min(maxX[ll], float(m_width -1) ) );
+			tri.m_maxY = uint16_t(min(maxY[ll], float(m_height-1) ) );
+
+			const uint32_t idx = uint32_t(m_triangles.size() );
+			m_triangles.push_back(tri);
+
+			for (uint32_t ty = tri.m_minY/OCCLUSION_TILE_HEIGHT, tyEnd = tri.m_maxY/OCCLUSION_TILE_HEIGHT; ty <= tyEnd; ++ty)
+			{
+				for (uint32_t tx = tri.m_minX/OCCLUSION_TILE_WIDTH, txEnd = tri.m_maxX/OCCLUSION_TILE_WIDTH; tx <= txEnd; ++tx)
+				{
+					m_bins[ty*m_tilesX + tx].push_back(idx);
+				}
+			}
+		}
+	}
+}
+
+void OcclusionBuffer::end()
+{
+	m_jobs.run(rasterizeJob, this, m_tilesX*m_tilesY);
+
+	buildMips();
+}
+
+void OcclusionBuffer::rasterizeTile(uint32_t _tile)
+{
+	const uint32_t x0 = (_tile % m_tilesX) * OCCLUSION_TILE_WIDTH;
+	const uint32_t y0 = (_tile / m_tilesX) * OCCLUSION_TILE_HEIGHT;
+	const uint32_t x1 = x0 + OCCLUSION_TILE_WIDTH;
+	const uint32_t y1 = y0 + OCCLUSION_TILE_HEIGHT;
+
+	float* depth = m_mip[0];
+
+	const simd128_t zero = simd_zero<simd128_t>();
+	const simd128_t one  = simd_splat<simd128_t>(1.0f);
+
+	for (uint32_t yy = y0; yy < y1; ++yy)
+	{
+		for (uint32_t xx = x0; xx < x1; xx += 4)
+		{
+			simd_st(&depth[yy*m_width + xx], one);
+		}
+	}
+
+	const simd128_t offset = simd_ld<simd128_t>(0.5f, 1.5f, 2.5f, 3.5f);
+
+	const BinArray& bin = m_bins[_tile];
+
+	for (BinArray::const_iterator it = bin.begin(), itEnd = bin.end(); it != itEnd; ++it)
+	{
+		const RasterTriangle& tri = m_triangles[*it];
+
+		// Tile width is multiple of 4, 4 pixel wide spans never cross tile edge.
+		const uint32_t minX = max<uint32_t>(tri.m_minX, x0) & ~3u;
+		const uint32_t maxX = min<uint32_t>(tri.m_maxX + 1, x1);
+		const uint32_t minY = max<uint32_t>(tri.m_minY, y0);
+		const uint32_t maxY = min<uint32_t>(tri.m_maxY + 1, y1);
+
+		const simd128_t a0 = simd_splat<simd128_t>(tri.m_edge[0][0]);
+		const simd128_t b0 = simd_splat<simd128_t>(tri.m_edge[0][1]);
+		const simd128_t c0 = simd_splat<simd128_t>(tri.m_edge[0][2]);
+		const simd128_t a1 = simd_splat<simd128_t>(tri.m_edge[1][0]);
+		const simd128_t b1 = simd_splat<simd128_t>(tri.m_edge[1][1]);
+		const simd128_t c1 = simd_splat<simd128_t>(tri.m_edge[1][2]);
+		const simd128_t a2 = simd_splat<simd128_t>(tri.m_edge[2][0]);
+		const simd128_t b2 = simd_splat<simd128_t>(tri.m_edge[2][1]);
+		const simd128_t c2 = simd_splat<simd128_t>(tri.m_edge[2][2]);
+		const simd128_t za = simd_splat<simd128_t>(tri.m_depth[0]);
+		const simd128_t zb = simd_splat<simd128_t>(tri.m_depth[1]);
+		const simd128_t zc = simd_splat<simd128_t>(tri.m_depth[2]);
+
+		for (uint32_t yy = minY; yy < maxY; ++yy)
+		{
+			const simd128_t py = simd_splat<simd128_t>(float(yy) + 0.5f);
+
+			// Row constant part of edge and depth functions.
+			const simd128_t r0 = simd_madd(b0, py, c0);
+			const simd128_t r1 = simd_madd(b1, py, c1);
+			const simd128_t r2 = simd_madd(b2, py, c2);
+			const simd128_t rz = simd_madd(zb, py, zc);
+
+			float* row = &depth[yy*m_width];
+
+			for (uint32_t xx = minX; xx < maxX; xx += 4)
+			{
+				const simd128_t px = simd_add(simd_splat<simd128_t>(float(xx) ), offset);
+
+				const simd128_t inside = simd_and(
+					  simd_cmpge(simd_madd(a0, px, r0), zero)
+					, simd_and(
+						  simd_cmpge(simd_madd(a1, px, r1), zero)
+						, simd_cmpge(simd_madd(a2, px, r2), zero)
+						)
+					);
+
+				const simd128_t zz  = simd_madd(za, px, rz);
+				const simd128_t dst = simd_ld<simd128_t>(&row[xx]);
+				simd_st(&row[xx], simd_selb(inside, simd_min(dst, zz), dst) );
+			}
+		}
+	}
+}
+
+void OcclusionBuffer::buildMips()
+{
+	// Each texel keeps farthest depth of texels it covers, object nearer than that is not
+	// hidden.
+	for (uint32_t mip = 1; mip < m_numMips; ++mip)
+	{
+		const float*   src       = m_mip[mip-1];
+		const uint32_t srcWidth  = m_mipWidth[mip-1];
+		const uint32_t srcHeight = m_mipHeight[mip-1];
+
+		float*         dst       = m_mip[mip];
+		const uint32_t dstWidth  = m_mipWidth[mip];
+		const uint32_t dstHeight = m_mipHeight[mip];
+
+		for (uint32_t yy = 0; yy < dstHeight; ++yy)
+		{
+			const uint32_t sy0 = yy*2;
+			const uint32_t sy1 = min<uint32_t>(sy0 + 1, srcHeight - 1);
+
+			for (uint32_t xx = 0; xx < dstWidth; ++xx)
+			{
+				const uint32_t sx0 = xx*2;
+				const uint32_t sx1 = min<uint32_t>(sx0 + 1, srcWidth - 1);
+
+				dst[yy*dstWidth + xx] = max(
+					  max(src[sy0*srcWidth + sx0], src[sy0*srcWidth + sx1])
+					, max(src[sy1*srcWidth + sx0], src[sy1*srcWidth + sx1])
+					);
+			}
+		}
+	}
+}
+
+bool OcclusionBuffer::isVisible(const Aabb& _aabb, const float* _mtx) const
+{
+	float mvp[16];
+
+	if (NULL != _mtx)
+	{
+		mtxMul(mvp, _mtx, m_viewProj);
+	}
+	else
+	{
+		memCopy(mvp, m_viewProj, sizeof(mvp) );
+	}
+
+	float minX = kFloatMax;
+	float minY = kFloatMax;
+	float minZ = kFloatMax;
+	float maxX = -kFloatMax;
+	float maxY = -kFloatMax;
+
+	for (uint32_t ii = 0; ii < 8; ++ii)
+	{
+		const Vec3 pos =
+		{
+			ii&1 ? _aabb.max.x : _aabb.min.x,
+			ii&2 ? _aabb.max.y : _aabb.min.y,
+			ii&4 ? _aabb.max.z : _aabb.min.z,
+		};
+
+		const float ww = pos.x*mvp[3] + pos.y*mvp[7] + pos.z*mvp[11] + mvp[15];
+
+		// Box crosses near plane.
+		if (kNearW > ww)
+		{
+			return true;
+		}
+
+		const float invW = 1.0f/ww;
+		const float xx = (pos.x*mvp[0] + pos.y*mvp[4] + pos.z*mvp[ 8] + mvp[12])*invW;
+		const float yy = (pos.x*mvp[1] + pos.y*mvp[5] + pos.z*mvp[ 9] + mvp[13])*invW;
+		const float zz = (pos.x*mvp[2] + pos.y*mvp[6] + pos.z*mvp[10] + mvp[14])*invW;
+
+		const float sx = (0.5f + 0.5f*xx)*m_width;
+		const float sy = (0.5f - 0.5f*yy)*m_height;
+
+		minX = min(minX, sx);
+		minY = min(minY, sy);
+		maxX = max(maxX, sx);
+		maxY = max(maxY, sy);
+		minZ = min(minZ, zz);
+	}
+
+	// Outside of depth buffer, there is nothing to occlude it.
+	if (0.0f > maxX
+	||  0.0f > maxY
+	||  float(m_width ) <= minX
+	||  float(m_height) <= minY)
+	{
+		return true;
+	}
+
+	uint32_t x0 = uint32_t(max(minX, 0.0f) );
+	uint32_t y0 = uint32_t(max(minY, 0.0f) );
+	uint32_t x1 = uint32_t(min(maxX, float(m_width -1) ) );
+	uint32_t y1 = uint32_t(min(maxY, float(m_height-1) ) );
+
+	// Go down the mip chain until rectangle covers at most 4x4 texels.
+	uint32_t mip = 0;
+	while (mip + 1 < m_numMips
+	&&    (x1 - x0 > 3 || y1 - y0 > 3) )
+	{
+		x0 >>= 1;
+		y0 >>= 1;
+		x1 >>= 1;
+		y1 >>= 1;
+		++mip;
+	}
+
+	const float*   depth = m_mip[mip];
+	const uint32_t width = m_mipWidth[mip];
+
+	for (uint32_t yy = y0; yy <= y1; ++yy)
+	{
+		for (uint32_t xx = x0; xx <= x1; ++xx)
+		{
+			if (depth[yy*width + xx] >= minZ)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void OcclusionBuffer::rasterizeJob(void* _userData, uint32_t _job)
+{
+	( (OcclusionBuffer*)_userData)->rasterizeTile(_job);
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2011-2019 Branimir Karadzic. All rights reserved.
+ * License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause
+ */
+
+#ifndef OCCLUSIONBUFFER_H_HEADER_GUARD
+#define OCCLUSIONBUFFER_H_HEADER_GUARD
+
+#include "bounds.h"
+#include "jobs.h"
+
+#include <tinystl/allocator.h>
+#include <tinystl/vector.h>
+namespace stl = tinystl;
+
+#define OCCLUSION_TILE_WIDTH  32
+#define OCCLUSION_TILE_HEIGHT 16
+#define OCCLUSION_MAX_THREADS JOBS_MAX_THREADS
+#define OCCLUSION_MAX_MIPS    12
+
+/// CPU depth buffer for occlusion culling on submission side. Occluder triangles are set up
+/// 4 at the time, binned into tiles and rasterized on worker threads. Objects are tested
+/// against hierarchical depth built from rasterized occluders, results are available before
+/// submit, unlike occlusion queries which are one or more frames late.
+///
+/// Depth is z/w of view projection matrix passed to begin, it must map depth to [0, 1]
+/// range (homogeneousDepth false).
+class OcclusionBuffer
+{
+public:
+	OcclusionBuffer();
+	~OcclusionBuffer();
+
+	/// Width and height are rounded up to tile size.
+	void init(uint16_t _width, uint16_t _height, uint32_t _numThreads);
+
+	///
+	void shutdown();
+
+	/// Clear depth, and start adding occluders for view projection matrix.
+	void begin(const float* _viewProj);
+
+	/// Add occluder mesh. _mtx is model matrix, or NULL when vertices are in world space.
+	/// Triangles crossing near plane are skipped, occluder never hides more than it covers.
+	void addOccluder(const float* _mtx, const void* _vertices, uint32_t _numVertices, uint32_t _stride, const uint16_t* _indices, uint32_t _numIndices);
+
+	/// Rasterize occluders and build hierarchical depth.
+	void end();
+
+	/// Returns false when AABB is completely hidden behind occluders. _mtx is model matrix,
+	/// or NULL when AABB is in world space.
+	bool isVisible(const Aabb& _aabb, const float* _mtx = NULL) const;
+
+	///
+	const float* getDepth(uint32_t _mip = 0) const
+	{
+		return m_mip[_mip];
+	}
+
+	///
+	uint16_t getWidth(uint32_t _mip = 0) const
+	{
+		return m_mipWidth[_mip];
+	}
+
+	///
+	uint16_t getHeight(uint32_t _mip = 0) const
+	{
+		return m_mipHeight[_mip];
+	}
+
+	///
+	uint32_t getNumMips() const
+	{
+		return m_numMips;
+	}
+
+private:
+	struct RasterTriangle
+	{
+		float m_edge[3][3]; //!< Edge functions, pixel is inside when a*x + b*y + c >= 0.
+		float m_depth[3];   //!< Depth plane, z = a*x + b*y + c.
+		uint16_t m_minX;
+		uint16_t m_minY;
+		uint16_t m_maxX;
+		uint16_t m_maxY;
+	};
+
+	typedef stl::vector<RasterTriangle> RasterTriangleArray;
+	typedef stl::vector<uint32_t> BinArray;
+
+	void setupTriangles(const float* _clip, const uint16_t* _indices, uint32_t _numIndices);
+	void rasterizeTile(uint32_t _tile);
+	void buildMips();
+
+	static void rasterizeJob(void* _userData, uint32_t _job);
+
+	RasterTriangleArray m_triangles;
+	stl::vector<BinArray> m_bins;
+
+	float m_viewProj[16];
+	float* m_clip;
+	uint32_t m_maxClipVertices;
+
+	float* m_mip[OCCLUSION_MAX_MIPS];
+	uint16_t m_mipWidth[OCCLUSION_MAX_MIPS];
+	uint16_t m_mipHeight[OCCLUSION_MAX_MIPS];
+	uint32_t m_numMips;
+
+	uint16_t m_width;
+	uint16_t m_height;
+	uint16_t m_tilesX;
+	uint16_t m_tilesY;
+
+	JobPool m_jobs;
+};
+
+#endif // OCCLUSIONBUFFER_H_HEADER_GUARD
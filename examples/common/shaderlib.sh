@@ -87,6 +87,14 @@ vec3 decodeNormalOctahedron(vec2 _encodedNormal)
 	return normalize(normal);
 }
 
+vec3 decodeNormalOctahedronSnorm(vec2 _encodedNormal)
+{
+	// Octahedron normal stored in signed normalized [-1, 1] range, as written by
+	// geometryc --quantize for normals. Quantized tangents are unsigned normalized,
+	// and are decoded with decodeNormalOctahedron.
+	return decodeNormalOctahedron(_encodedNormal * 0.5 + 0.5);
+}
+
 vec3 convertRGB2XYZ(vec3 _rgb)
 {
 	// Reference:
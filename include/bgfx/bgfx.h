@@ -591,10 +591,13 @@ namespace bgfx
 		///
 		/// @param[in] _data Image data.
 		/// @param[in] _size Image size.
+		/// @param[in] _frame Frame number, as returned by `bgfx::frame` call
+		///   that submitted this frame. Frames might be delivered with a few
+		///   frames of latency when renderer reads back asynchronously.
 		///
 		/// @attention C99 equivalent is `bgfx_callback_vtbl.capture_frame`.
 		///
-		virtual void captureFrame(const void* _data, uint32_t _size) = 0;
+		virtual void captureFrame(const void* _data, uint32_t _size, uint32_t _frame) = 0;
 	};
 
 	inline CallbackI::~CallbackI()
@@ -1823,6 +1826,33 @@ namespace bgfx
 		, float _epsilon = 0.001f
 		);
 
+	/// Weld vertices.
+	///
+	/// @param[in] _output Welded vertices remapping table. The size of buffer
+	///   must be the same as number of vertices.
+	/// @param[in] _decl Vertex stream declaration.
+	/// @param[in] _data Vertex stream.
+	/// @param[in] _num Number of vertices in vertex stream.
+	/// @param[in] _epsilon Error tolerance for vertex position comparison.
+	/// @param[in] _allocator Allocator for temporary memory. If NULL default
+	///   allocator is used.
+	/// @returns Number of unique vertices after vertex welding.
+	///
+	/// @remarks
+	///   Vertices are bucketed into uniform grid, so all vertices within
+	///   epsilon are found regardless of where cell boundaries are. Large
+	///   vertex streams are welded on multiple threads, result doesn't depend
+	///   on number of threads.
+	///
+	uint32_t weldVertices(
+		  uint32_t* _output
+		, const VertexDecl& _decl
+		, const void* _data
+		, uint32_t _num
+		, float _epsilon = 0.001f
+		, bx::AllocatorI* _allocator = NULL
+		);
+
 	/// Convert index buffer for use with different primitive topologies.
 	///
 	/// @param[in] _conversion Conversion type, see `TopologyConvert::Enum`.
@@ -2862,6 +2892,9 @@ namespace bgfx
 	/// @param[in] _mip Mip level.
 	///
 	/// @returns Frame number when the result will be available. See: `bgfx::frame`.
+	///   Destination buffer must stay valid until then. Renderers that read back
+	///   asynchronously fill it as soon as GPU is done, and wait only if it's
+	///   still in flight by that frame.
 	///
 	/// @attention Texture must be created with `BGFX_TEXTURE_READ_BACK` flag.
 	/// @attention Availability depends on: `BGFX_CAPS_TEXTURE_READ_BACK`.
@@ -488,6 +488,9 @@ or _OPTIONS["with-combined-examples"] then
 		, "38-bloom"
 		, "39-assao"
 		, "40-svt"
+		, "41-frustumculling"
+		, "42-vertexconvert"
+		, "43-bufferupload"
 		)
 
 	-- C99 source doesn't compile under WinRT settings
@@ -143,7 +143,7 @@ namespace bgfx
 		{
 		}
 
-		virtual void captureFrame(const void* /*_data*/, uint32_t /*_size*/) override
+		virtual void captureFrame(const void* /*_data*/, uint32_t /*_size*/, uint32_t /*_frame*/) override
 		{
 		}
 	};
@@ -2181,6 +2181,7 @@ namespace bgfx
 		m_submit->m_resolution = m_init.resolution;
 		m_init.resolution.reset &= ~BGFX_RESET_INTERNAL_FORCE;
 		m_submit->m_debug = m_debug;
+		m_submit->m_frameNum = m_frames + 1;
 		m_submit->m_perfStats.numViews = 0;
 
 		bx::memCopy(m_submit->m_viewRemap, m_viewRemap, sizeof(m_viewRemap) );
@@ -5296,9 +5297,9 @@ namespace bgfx
 			m_interface->vtbl->capture_end(m_interface);
 		}
 
-		virtual void captureFrame(const void* _data, uint32_t _size) override
+		virtual void captureFrame(const void* _data, uint32_t _size, uint32_t _frame) override
 		{
-			m_interface->vtbl->capture_frame(m_interface, _data, _size);
+			m_interface->vtbl->capture_frame(m_interface, _data, _size, _frame);
 		}
 
 		bgfx_callback_interface_t* m_interface;
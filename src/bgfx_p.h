@@ -1882,6 +1882,7 @@ constexpr uint64_t kSortKeyComputeProgramMask  = uint64_t(BGFX_CONFIG_MAX_PROGRA
 		Frame()
 			: m_waitSubmit(0)
 			, m_waitRender(0)
+			, m_frameNum(0)
 			, m_capture(false)
 		{
 			SortKey term;
@@ -2161,6 +2162,7 @@ constexpr uint64_t kSortKeyComputeProgramMask  = uint64_t(BGFX_CONFIG_MAX_PROGRA
 		int64_t m_waitSubmit;
 		int64_t m_waitRender;
 
+		uint32_t m_frameNum;
 		bool m_capture;
 	};
 
@@ -4219,7 +4221,14 @@ constexpr uint64_t kSortKeyComputeProgramMask  = uint64_t(BGFX_CONFIG_MAX_PROGRA
 			cmdbuf.write(_handle);
 			cmdbuf.write(_data);
 			cmdbuf.write(_mip);
-			return m_frames + 2;
+
+			// Only GL reads back through pixel pack buffers that stay in flight,
+			// other renderers copy data when command buffer is executed.
+			const bool asyncReadBack = false
+				|| RendererType::OpenGL   == g_caps.rendererType
+				|| RendererType::OpenGLES == g_caps.rendererType
+				;
+			return m_frames + 2 + (asyncReadBack ? BGFX_CONFIG_READ_TEXTURE_LATENCY : 0);
 		}
 
 		void resizeTexture(TextureHandle _handle, uint16_t _width, uint16_t _height, uint8_t _numMips, uint16_t _numLayers)
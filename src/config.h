@@ -199,6 +199,10 @@
 #	define BGFX_CONFIG_MAX_RECT_CACHE (4<<10)
 #endif //  BGFX_CONFIG_MAX_RECT_CACHE
 
+#ifndef BGFX_CONFIG_MAX_VAO_CACHE
+#	define BGFX_CONFIG_MAX_VAO_CACHE (1<<10)
+#endif // BGFX_CONFIG_MAX_VAO_CACHE
+
 #ifndef BGFX_CONFIG_SORT_KEY_NUM_BITS_DEPTH
 #	define BGFX_CONFIG_SORT_KEY_NUM_BITS_DEPTH 32
 #endif // BGFX_CONFIG_SORT_KEY_NUM_BITS_DEPTH
@@ -286,6 +290,20 @@ BX_STATIC_ASSERT(bx::isPowerOf2(BGFX_CONFIG_MAX_VIEWS), "BGFX_CONFIG_MAX_VIEWS m
 #	define BGFX_CONFIG_MAX_OCCLUSION_QUERIES 256
 #endif // BGFX_CONFIG_MAX_OCCLUSION_QUERIES
 
+/// Maximum number of in-flight asynchronous back buffer read backs (video
+/// capture frames and screen shots).
+#ifndef BGFX_CONFIG_MAX_READBACKS
+#	define BGFX_CONFIG_MAX_READBACKS 4
+#endif // BGFX_CONFIG_MAX_READBACKS
+
+/// Number of frames texture read back can stay in flight before renderer
+/// waits for it. Frame number returned by `bgfx::readTexture` includes it.
+/// WebGL can't wait on a single fence and has to finish, so it gets one more
+/// frame.
+#ifndef BGFX_CONFIG_READ_TEXTURE_LATENCY
+#	define BGFX_CONFIG_READ_TEXTURE_LATENCY ( (0 == BX_PLATFORM_EMSCRIPTEN) ? 1 : 2)
+#endif // BGFX_CONFIG_READ_TEXTURE_LATENCY
+
 #ifndef BGFX_CONFIG_MAX_COMMAND_BUFFER_SIZE
 #	define BGFX_CONFIG_MAX_COMMAND_BUFFER_SIZE (64<<10)
 #endif // BGFX_CONFIG_MAX_COMMAND_BUFFER_SIZE
@@ -298,6 +316,59 @@ BX_STATIC_ASSERT(bx::isPowerOf2(BGFX_CONFIG_MAX_VIEWS), "BGFX_CONFIG_MAX_VIEWS m
 #	define BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE (2<<20)
 #endif // BGFX_CONFIG_TRANSIENT_INDEX_BUFFER_SIZE
 
+/// Maximum number of frames renderer keeps in flight on GPU.
+#ifndef BGFX_CONFIG_MAX_FRAME_LATENCY
+#	define BGFX_CONFIG_MAX_FRAME_LATENCY 3
+#endif // BGFX_CONFIG_MAX_FRAME_LATENCY
+
+/// Number of worker threads compiling pipeline state objects in background.
+/// When 0 (default), pipelines are compiled synchronously on first use. When
+/// enabled, draw calls are skipped until their pipeline is compiled. Skipped
+/// draw is dropped for that frame, it's not deferred and there is no fallback
+/// pipeline, so new state combinations can be missing for a few frames.
+#ifndef BGFX_CONFIG_MAX_PIPELINE_COMPILE_THREADS
+#	define BGFX_CONFIG_MAX_PIPELINE_COMPILE_THREADS 0
+#endif // BGFX_CONFIG_MAX_PIPELINE_COMPILE_THREADS
+
+/// Number of worker threads recording draw calls into secondary command
+/// buffers. Render thread records too, when 0 it's the only one recording.
+/// Only vkCmd* recording is parallel, translating render items into draw
+/// commands (state, uniforms, pipeline lookup) is still serial on render thread.
+#ifndef BGFX_CONFIG_MAX_RECORD_THREADS
+#	define BGFX_CONFIG_MAX_RECORD_THREADS 3
+#endif // BGFX_CONFIG_MAX_RECORD_THREADS
+
+/// Number of worker threads welding large vertex streams in weldVertices.
+/// Calling thread welds too, when 0 welding is single threaded.
+#ifndef BGFX_CONFIG_MAX_WELD_THREADS
+#	define BGFX_CONFIG_MAX_WELD_THREADS ( (0 != BGFX_CONFIG_MULTITHREADED) ? 3 : 0)
+#endif // BGFX_CONFIG_MAX_WELD_THREADS
+
+/// Minimum number of vertices per weldVertices worker thread. Smaller vertex
+/// streams are welded on calling thread only.
+#ifndef BGFX_CONFIG_WELD_MIN_VERTICES_PER_THREAD
+#	define BGFX_CONFIG_WELD_MIN_VERTICES_PER_THREAD (64<<10)
+#endif // BGFX_CONFIG_WELD_MIN_VERTICES_PER_THREAD
+
+/// Maximum number of draw calls recorded into single secondary command
+/// buffer. Views with more draw calls are split across worker threads.
+#ifndef BGFX_CONFIG_RECORD_RANGE_SIZE
+#	define BGFX_CONFIG_RECORD_RANGE_SIZE 1024
+#endif // BGFX_CONFIG_RECORD_RANGE_SIZE
+
+/// Size of single frame partition of upload staging buffer. It should fit
+/// transient buffers, larger uploads are split across partitions.
+#ifndef BGFX_CONFIG_STAGING_BUFFER_SIZE
+#	define BGFX_CONFIG_STAGING_BUFFER_SIZE (16<<20)
+#endif // BGFX_CONFIG_STAGING_BUFFER_SIZE
+
+/// GL index and vertex buffer updates go through persistently mapped upload
+/// ring when buffer storage is supported. When 0, glBufferSubData path is
+/// used, 43-bufferupload compares both.
+#ifndef BGFX_CONFIG_RENDERER_OPENGL_STREAM_UPLOADS
+#	define BGFX_CONFIG_RENDERER_OPENGL_STREAM_UPLOADS 1
+#endif // BGFX_CONFIG_RENDERER_OPENGL_STREAM_UPLOADS
+
 #ifndef BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT
 #	define BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT 5
 #endif // BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT
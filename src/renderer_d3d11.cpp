@@ -3186,7 +3186,7 @@ namespace bgfx { namespace d3d11
 			DX_RELEASE(m_captureTexture, 0);
 		}
 
-		void capture()
+		void capture(uint32_t _frame)
 		{
 			if (NULL != m_captureTexture)
 			{
@@ -3215,7 +3215,7 @@ namespace bgfx { namespace d3d11
 					, mapped.RowPitch
 					);
 
-				g_callback->captureFrame(mapped.pData, m_scd.height*mapped.RowPitch);
+				g_callback->captureFrame(mapped.pData, m_scd.height*mapped.RowPitch, _frame);
 
 				m_deviceCtx->Unmap(m_captureTexture, 0);
 
@@ -6129,7 +6129,7 @@ namespace bgfx { namespace d3d11
 				}
 
 				captureElapsed = -bx::getHPCounter();
-				capture();
+				capture(_render->m_frameNum);
 				captureElapsed += bx::getHPCounter();
 
 				profiler.end();
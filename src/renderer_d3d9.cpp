@@ -1828,7 +1828,7 @@ namespace bgfx { namespace d3d9
 			}
 		}
 
-		void capture()
+		void capture(uint32_t _frame)
 		{
 			if (NULL != m_captureSurface)
 			{
@@ -1854,7 +1854,7 @@ namespace bgfx { namespace d3d9
 						, D3DLOCK_NO_DIRTY_UPDATE|D3DLOCK_NOSYSLOCK|D3DLOCK_READONLY
 						) );
 
-					g_callback->captureFrame(rect.pBits, m_params.BackBufferHeight*rect.Pitch);
+					g_callback->captureFrame(rect.pBits, m_params.BackBufferHeight*rect.Pitch, _frame);
 
 					DX_CHECK(m_captureSurface->UnlockRect() );
 				}
@@ -4383,7 +4383,7 @@ namespace bgfx { namespace d3d9
 				}
 
 				captureElapsed = -bx::getHPCounter();
-				capture();
+				capture(_render->m_frameNum);
 				captureElapsed += bx::getHPCounter();
 
 				profiler.end();
@@ -74,6 +74,23 @@ namespace bgfx { namespace gl
 	};
 	BX_STATIC_ASSERT(BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT == BX_COUNTOF(s_instanceDataName) );
 
+	struct UniformBlockName
+	{
+		const char* m_name;
+		const char* m_instance;
+	};
+
+	// Uniform block per stage, block index is also binding point.
+	static const UniformBlockName s_uniformBlockName[] =
+	{
+		{ "bgfx_UniformsVS", "bgfx_vs" },
+		{ "bgfx_UniformsFS", "bgfx_fs" },
+	};
+
+	// Uniform location bit marking byte offset into program uniform block
+	// data instead of GL uniform location.
+	static const uint32_t kUniformBlockBit = UINT32_C(0x80000000);
+
 	static const GLenum s_access[] =
 	{
 		GL_READ_ONLY,
@@ -481,9 +498,11 @@ namespace bgfx { namespace gl
 			APPLE_texture_format_BGRA8888,
 			APPLE_texture_max_level,
 
+			ARB_buffer_storage,
 			ARB_clip_control,
 			ARB_compute_shader,
 			ARB_conservative_depth,
+			ARB_copy_buffer,
 			ARB_copy_image,
 			ARB_debug_label,
 			ARB_debug_output,
@@ -514,6 +533,7 @@ namespace bgfx { namespace gl
 			ARB_shader_image_load_store,
 			ARB_shader_storage_buffer_object,
 			ARB_shader_texture_lod,
+			ARB_sync,
 			ARB_texture_compression_bptc,
 			ARB_texture_compression_rgtc,
 			ARB_texture_cube_map_array,
@@ -542,6 +562,7 @@ namespace bgfx { namespace gl
 			EXT_blend_color,
 			EXT_blend_minmax,
 			EXT_blend_subtract,
+			EXT_buffer_storage,
 			EXT_color_buffer_half_float,
 			EXT_color_buffer_float,
 			EXT_copy_image,
@@ -691,9 +712,11 @@ namespace bgfx { namespace gl
 		{ "APPLE_texture_format_BGRA8888",            false,                             true  },
 		{ "APPLE_texture_max_level",                  false,                             true  },
 
+		{ "ARB_buffer_storage",                       BGFX_CONFIG_RENDERER_OPENGL >= 44, true  },
 		{ "ARB_clip_control",                         BGFX_CONFIG_RENDERER_OPENGL >= 43, true  },
 		{ "ARB_compute_shader",                       BGFX_CONFIG_RENDERER_OPENGL >= 43, true  },
 		{ "ARB_conservative_depth",                   BGFX_CONFIG_RENDERER_OPENGL >= 42, true  },
+		{ "ARB_copy_buffer",                          BGFX_CONFIG_RENDERER_OPENGL >= 31, true  },
 		{ "ARB_copy_image",                           BGFX_CONFIG_RENDERER_OPENGL >= 42, true  },
 		{ "ARB_debug_label",                          false,                             true  },
 		{ "ARB_debug_output",                         BGFX_CONFIG_RENDERER_OPENGL >= 43, true  },
@@ -724,6 +747,7 @@ namespace bgfx { namespace gl
 		{ "ARB_shader_image_load_store",              BGFX_CONFIG_RENDERER_OPENGL >= 42, true  },
 		{ "ARB_shader_storage_buffer_object",         BGFX_CONFIG_RENDERER_OPENGL >= 43, true  },
 		{ "ARB_shader_texture_lod",                   BGFX_CONFIG_RENDERER_OPENGL >= 30, true  },
+		{ "ARB_sync",                                 BGFX_CONFIG_RENDERER_OPENGL >= 32, true  },
 		{ "ARB_texture_compression_bptc",             BGFX_CONFIG_RENDERER_OPENGL >= 44, true  },
 		{ "ARB_texture_compression_rgtc",             BGFX_CONFIG_RENDERER_OPENGL >= 30, true  },
 		{ "ARB_texture_cube_map_array",               BGFX_CONFIG_RENDERER_OPENGL >= 40, true  },
@@ -752,6 +776,7 @@ namespace bgfx { namespace gl
 		{ "EXT_blend_color",                          BGFX_CONFIG_RENDERER_OPENGL >= 31, true  },
 		{ "EXT_blend_minmax",                         BGFX_CONFIG_RENDERER_OPENGL >= 14, true  },
 		{ "EXT_blend_subtract",                       BGFX_CONFIG_RENDERER_OPENGL >= 14, true  },
+		{ "EXT_buffer_storage",                       false,                             true  }, // GLES3.1 extension.
 		{ "EXT_color_buffer_half_float",              false,                             true  }, // GLES2 extension.
 		{ "EXT_color_buffer_float",                   false,                             true  }, // GLES2 extension.
 		{ "EXT_copy_image",                           false,                             true  }, // GLES2 extension.
@@ -1732,6 +1757,7 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 			, m_fbDiscard(BGFX_CLEAR_NONE)
 			, m_capture(NULL)
 			, m_captureSize(0)
+			, m_frameNum(0)
 			, m_maxAnisotropy(0.0f)
 			, m_maxAnisotropyDefault(0.0f)
 			, m_maxMsaa(0)
@@ -1748,6 +1774,9 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 			, m_depthTextureSupport(false)
 			, m_timerQuerySupport(false)
 			, m_occlusionQuerySupport(false)
+			, m_asyncReadBackSupport(false)
+			, m_bufferStorageSupport(false)
+			, m_uniformBufferSupport(false)
 			, m_atocSupport(false)
 			, m_conservativeRasterSupport(false)
 			, m_flip(false)
@@ -1756,6 +1785,8 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 			, m_msaaBackBufferFbo(0)
 			, m_clearQuadColor(BGFX_INVALID_HANDLE)
 			, m_clearQuadDepth(BGFX_INVALID_HANDLE)
+			, m_uniformProgram(NULL)
+			, m_uniformBufferAlign(16)
 		{
 			bx::memSet(m_msaaBackBufferRbos, 0, sizeof(m_msaaBackBufferRbos) );
 		}
@@ -2431,6 +2462,57 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 					&& NULL != glEndQuery
 					;
 
+				m_asyncReadBackSupport = true
+					&& (BX_ENABLED(BGFX_CONFIG_RENDERER_OPENGLES >= 30) || s_extension[Extension::ARB_sync            ].m_supported)
+					&& (BX_ENABLED(BGFX_CONFIG_RENDERER_OPENGLES >= 30) || s_extension[Extension::ARB_map_buffer_range].m_supported)
+					;
+
+				m_asyncReadBackSupport &= true
+					&& NULL != glFenceSync
+					&& NULL != glClientWaitSync
+					&& NULL != glDeleteSync
+					&& NULL != glMapBufferRange
+					&& NULL != glUnmapBuffer
+					;
+
+				m_bufferStorageSupport = true
+					&& (false
+						|| s_extension[Extension::ARB_buffer_storage].m_supported
+						|| s_extension[Extension::EXT_buffer_storage].m_supported
+						)
+					&& (BX_ENABLED(BGFX_CONFIG_RENDERER_OPENGLES >= 30) || s_extension[Extension::ARB_copy_buffer].m_supported)
+					&& (BX_ENABLED(BGFX_CONFIG_RENDERER_OPENGLES >= 30) || s_extension[Extension::ARB_sync       ].m_supported)
+					;
+
+				m_bufferStorageSupport &= true
+					&& NULL != glBufferStorage
+					&& NULL != glCopyBufferSubData
+					&& NULL != glFenceSync
+					&& NULL != glClientWaitSync
+					&& NULL != glDeleteSync
+					&& NULL != glMapBufferRange
+					&& NULL != glUnmapBuffer
+					;
+
+				// Uniform blocks are streamed through persistently mapped
+				// buffer, shader patching is done only for GLSL 1.40 and
+				// ESSL 3.00.
+				m_uniformBufferSupport = true
+					&& (BX_ENABLED(BGFX_CONFIG_RENDERER_OPENGL >= 31) || BX_ENABLED(BGFX_CONFIG_RENDERER_OPENGLES >= 30) )
+					&& (BX_ENABLED(BGFX_CONFIG_RENDERER_OPENGLES >= 30) || s_extension[Extension::ARB_uniform_buffer_object].m_supported)
+					&& m_bufferStorageSupport
+					&& NULL != glBindBufferRange
+					&& NULL != glGetActiveUniformBlockiv
+					&& NULL != glGetActiveUniformsiv
+					&& NULL != glGetUniformBlockIndex
+					&& NULL != glUniformBlockBinding
+					;
+
+				if (m_uniformBufferSupport)
+				{
+					m_uniformBufferAlign = bx::max<uint32_t>(16, glGet(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT) );
+				}
+
 				m_atocSupport = s_extension[Extension::ARB_multisample].m_supported;
 				m_conservativeRasterSupport = s_extension[Extension::NV_conservative_raster].m_supported;
 
@@ -2569,6 +2651,16 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 					m_occlusionQuery.create();
 				}
 
+				if (m_asyncReadBackSupport)
+				{
+					m_readBack.create();
+				}
+
+				if (m_bufferStorageSupport)
+				{
+					m_streamBuffer.create(BGFX_CONFIG_STAGING_BUFFER_SIZE);
+				}
+
 				// Init reserved part of view name.
 				for (uint32_t ii = 0; ii < BGFX_CONFIG_MAX_VIEWS; ++ii)
 				{
@@ -2604,6 +2696,16 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 			captureFinish();
 
+			if (m_asyncReadBackSupport)
+			{
+				m_readBack.destroy();
+			}
+
+			if (m_bufferStorageSupport)
+			{
+				m_streamBuffer.destroy();
+			}
+
 			invalidateCache();
 
 			if (m_timerQuerySupport)
@@ -2778,13 +2880,26 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 				const TextureGL& texture = m_textures[_handle.idx];
 				const bool compressed    = bimg::isCompressed(bimg::TextureFormat::Enum(texture.m_textureFormat) );
 
+				const uint32_t size = bimg::imageGetSize(
+					  NULL
+					, uint16_t(bx::max<uint32_t>(1, texture.m_width >>_mip) )
+					, uint16_t(bx::max<uint32_t>(1, texture.m_height>>_mip) )
+					, uint16_t(bx::max<uint32_t>(1, texture.m_depth >>_mip) )
+					, false
+					, false
+					, 1
+					, bimg::TextureFormat::Enum(texture.m_textureFormat)
+					);
+
 				GL_CHECK(glBindTexture(texture.m_target, texture.m_id) );
 
+				void* data = readTextureBegin(_data, size);
+
 				if (compressed)
 				{
 					GL_CHECK(glGetCompressedTexImage(texture.m_target
 						, _mip
-						, _data
+						, data
 						) );
 				}
 				else
@@ -2793,10 +2908,12 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 						, _mip
 						, texture.m_fmt
 						, texture.m_type
-						, _data
+						, data
 						) );
 				}
 
+				readTextureEnd();
+
 				GL_CHECK(glBindTexture(texture.m_target, 0) );
 			}
 			else
@@ -2828,6 +2945,8 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 					if (GL_FRAMEBUFFER_COMPLETE == glCheckFramebufferStatus(GL_FRAMEBUFFER) )
 					{
+						void* data = readTextureBegin(_data, texture.m_width*texture.m_height*4);
+
 						GL_CHECK(glReadPixels(
 							  0
 							, 0
@@ -2835,8 +2954,10 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 							, texture.m_height
 							, m_readPixelsFmt
 							, GL_UNSIGNED_BYTE
-							, _data
+							, data
 							) );
+
+						readTextureEnd();
 					}
 
 					frameBuffer.destroy();
@@ -2844,6 +2965,35 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 			}
 		}
 
+		void* readTextureBegin(void* _data, uint32_t _size)
+		{
+			if (!m_asyncReadBackSupport)
+			{
+				return _data;
+			}
+
+			// Read goes into pixel pack buffer, and it's copied into _data once
+			// GPU is done, at the latest by frame returned from bgfx::readTexture.
+			ReadBackGL::Pixels& pixels = m_readBack.begin(ReadBackGL::Kind::Texture, _size);
+			pixels.m_dst      = _data;
+			pixels.m_deadline = m_frameNum + BGFX_CONFIG_READ_TEXTURE_LATENCY;
+
+			return NULL;
+		}
+
+		void readTextureEnd()
+		{
+			if (m_asyncReadBackSupport)
+			{
+				m_readBack.end();
+
+				if (0 == BGFX_CONFIG_READ_TEXTURE_LATENCY)
+				{
+					m_readBack.resolve(true);
+				}
+			}
+		}
+
 		void resizeTexture(TextureHandle _handle, uint16_t _width, uint16_t _height, uint8_t _numMips, uint16_t _numLayers) override
 		{
 			TextureGL& texture = m_textures[_handle.idx];
@@ -2955,6 +3105,15 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 			m_glctx.makeCurrent(swapChain);
 
+			if (m_asyncReadBackSupport
+			&&  NULL == swapChain)
+			{
+				// Screen shot is delivered from resolve, once GPU is done
+				// with the frame, instead of stalling here.
+				m_readBack.read(ReadBackGL::Kind::ScreenShot, width, height, m_readPixelsFmt, 0, _filePath);
+				return;
+			}
+
 			uint32_t length = width*height*4;
 			uint8_t* data = (uint8_t*)BX_ALLOC(g_allocator, length);
 
@@ -3076,11 +3235,9 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 			float proj[16];
 			bx::mtxOrtho(proj, 0.0f, (float)width, (float)height, 0.0f, 0.0f, 1000.0f, 0.0f, true);
 
-			GL_CHECK(glUniformMatrix4fv(program.m_predefined[0].m_loc
-				, 1
-				, GL_FALSE
-				, proj
-				) );
+			m_uniformProgram = &program;
+			setShaderUniform4x4f(0, program.m_predefined[0].m_loc, proj, 1);
+			commitUniformBlocks(program, true);
 
 			GL_CHECK(glActiveTexture(GL_TEXTURE0) );
 			GL_CHECK(glBindTexture(GL_TEXTURE_2D, m_textures[_blitter.m_texture.idx].m_id) );
@@ -3181,6 +3338,12 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 		void setShaderUniform4f(uint8_t /*_flags*/, uint32_t _regIndex, const void* _val, uint32_t _numRegs)
 		{
+			if (0 != (_regIndex & kUniformBlockBit) )
+			{
+				setUniformBlock(_regIndex, UniformType::Vec4, _val, _numRegs);
+				return;
+			}
+
 			GL_CHECK(glUniform4fv(_regIndex
 				, _numRegs
 				, (const GLfloat*)_val
@@ -3189,6 +3352,12 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 		void setShaderUniform4x4f(uint8_t /*_flags*/, uint32_t _regIndex, const void* _val, uint32_t _numRegs)
 		{
+			if (0 != (_regIndex & kUniformBlockBit) )
+			{
+				setUniformBlock(_regIndex, UniformType::Mat4, _val, _numRegs);
+				return;
+			}
+
 			GL_CHECK(glUniformMatrix4fv(_regIndex
 				, _numRegs
 				, GL_FALSE
@@ -3196,6 +3365,76 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 				) );
 		}
 
+		void updateUniformBlock(ProgramGL& _program, uint8_t* _dst, const void* _val, uint32_t _size)
+		{
+			BX_CHECK(_dst + _size <= _program.m_uniformData + _program.m_uniformSize
+				, "Uniform block write out of bounds."
+				);
+
+			if (0 != bx::memCmp(_dst, _val, _size) )
+			{
+				bx::memCopy(_dst, _val, _size);
+				_program.m_uniformDirty = true;
+			}
+		}
+
+		void setUniformBlock(uint32_t _loc, UniformType::Enum _type, const void* _val, uint32_t _num)
+		{
+			BX_CHECK(NULL != m_uniformProgram, "Uniform block program is not set.");
+
+			ProgramGL& program = *m_uniformProgram;
+			uint8_t* dst = &program.m_uniformData[_loc & ~kUniformBlockBit];
+
+			if (UniformType::Mat3 == _type)
+			{
+				// std140 pads mat3 columns to vec4.
+				const float* src = (const float*)_val;
+				for (uint32_t ii = 0, num = _num*3; ii < num; ++ii)
+				{
+					updateUniformBlock(program, dst, src, 3*sizeof(float) );
+					src += 3;
+					dst += 16;
+				}
+			}
+			else
+			{
+				updateUniformBlock(program, dst, _val, g_uniformTypeSize[_type]*_num);
+			}
+		}
+
+		void commitUniformBlocks(ProgramGL& _program, bool _rebind)
+		{
+			if (0 == _program.m_uniformSize)
+			{
+				return;
+			}
+
+			if (_program.m_uniformDirty
+			||  _program.m_uniformEpoch != m_streamBuffer.m_epoch)
+			{
+				_program.m_uniformOffset = m_streamBuffer.write(_program.m_uniformData, _program.m_uniformSize, m_uniformBufferAlign);
+				_program.m_uniformEpoch  = m_streamBuffer.m_epoch;
+				_program.m_uniformDirty  = false;
+				_rebind = true;
+			}
+
+			if (_rebind)
+			{
+				for (uint32_t ii = 0; ii < BX_COUNTOF(_program.m_uniformBlockSize); ++ii)
+				{
+					if (0 != _program.m_uniformBlockSize[ii])
+					{
+						GL_CHECK(glBindBufferRange(GL_UNIFORM_BUFFER
+							, ii
+							, m_streamBuffer.m_id
+							, _program.m_uniformOffset + _program.m_uniformBlockOffset[ii]
+							, _program.m_uniformBlockSize[ii]
+							) );
+					}
+				}
+			}
+		}
+
 		uint32_t setFrameBuffer(FrameBufferHandle _fbh, uint32_t _height, uint16_t _discard = BGFX_CLEAR_NONE, bool _msaa = true)
 		{
 			if (isValid(m_fbh)
@@ -3385,6 +3624,11 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 			{
 				m_samplerStateCache.invalidate();
 			}
+
+			if (m_vaoSupport)
+			{
+				m_vaoStateCache.invalidate();
+			}
 		}
 
 		void setSamplerState(uint32_t _stage, uint32_t _numMips, uint32_t _flags, const float _rgba[4])
@@ -3504,6 +3748,11 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 		void updateCapture()
 		{
+			if (m_asyncReadBackSupport)
+			{
+				m_readBack.resolve(true);
+			}
+
 			if (m_resolution.reset&BGFX_RESET_CAPTURE)
 			{
 				m_captureSize = m_resolution.width*m_resolution.height*4;
@@ -3516,9 +3765,23 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 			}
 		}
 
-		void capture()
+		void capture(uint32_t _frame)
 		{
-			if (NULL != m_capture)
+			if (NULL == m_capture)
+			{
+				return;
+			}
+
+			if (m_asyncReadBackSupport)
+			{
+				m_readBack.read(ReadBackGL::Kind::Capture
+					, m_resolution.width
+					, m_resolution.height
+					, m_readPixelsFmt
+					, _frame
+					);
+			}
+			else
 			{
 				GL_CHECK(glReadPixels(0
 					, 0
@@ -3541,7 +3804,7 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 						);
 				}
 
-				g_callback->captureFrame(m_capture, m_captureSize);
+				g_callback->captureFrame(m_capture, m_captureSize, _frame);
 			}
 		}
 
@@ -3549,6 +3812,11 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 		{
 			if (NULL != m_capture)
 			{
+				if (m_asyncReadBackSupport)
+				{
+					m_readBack.resolve(true);
+				}
+
 				g_callback->captureEnd();
 				BX_FREE(g_allocator, m_capture);
 				m_capture = NULL;
@@ -3648,6 +3916,12 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 				uint32_t loc = _uniformBuffer.read();
 
+				if (0 != (loc & kUniformBlockBit) )
+				{
+					setUniformBlock(loc, type, data, num);
+					continue;
+				}
+
 #define CASE_IMPLEMENT_UNIFORM(_uniform, _glsuffix, _dxsuffix, _type) \
 		case UniformType::_uniform: \
 				{ \
@@ -3837,7 +4111,9 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 				updateUniform(m_clearQuadColor.idx, mrtClearColor[0], numMrt * sizeof(float) * 4);
 
+				m_uniformProgram = &program;
 				commit(*program.m_constantBuffer);
+				commitUniformBlocks(program, true);
 
 				GL_CHECK(glDrawArrays(GL_TRIANGLE_STRIP
 					, 0
@@ -3863,8 +4139,11 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 		TimerQueryGL m_gpuTimer;
 		OcclusionQueryGL m_occlusionQuery;
+		ReadBackGL m_readBack;
+		StreamBufferGL m_streamBuffer;
 
 		SamplerStateCache m_samplerStateCache;
+		VaoStateCache m_vaoStateCache;
 
 		TextVideoMem m_textVideoMem;
 		bool m_rtMsaa;
@@ -3875,6 +4154,7 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 		Resolution m_resolution;
 		void* m_capture;
 		uint32_t m_captureSize;
+		uint32_t m_frameNum;
 		float m_maxAnisotropy;
 		float m_maxAnisotropyDefault;
 		int32_t m_maxMsaa;
@@ -3892,6 +4172,9 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 		bool m_depthTextureSupport;
 		bool m_timerQuerySupport;
 		bool m_occlusionQuerySupport;
+		bool m_asyncReadBackSupport;
+		bool m_bufferStorageSupport;
+		bool m_uniformBufferSupport;
 		bool m_atocSupport;
 		bool m_conservativeRasterSupport;
 		bool m_imageLoadStoreSupport;
@@ -3909,6 +4192,9 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 		UniformHandle m_clearQuadColor;
 		UniformHandle m_clearQuadDepth;
 
+		ProgramGL* m_uniformProgram;
+		uint32_t m_uniformBufferAlign;
+
 		const char* m_vendor;
 		const char* m_renderer;
 		const char* m_version;
@@ -4178,6 +4464,8 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 	void ProgramGL::destroy()
 	{
+		m_vcref.invalidate(s_renderGL->m_vaoStateCache);
+
 		if (NULL != m_constantBuffer)
 		{
 			UniformBuffer::destroy(m_constantBuffer);
@@ -4185,6 +4473,13 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 		}
 		m_numPredefined = 0;
 
+		if (NULL != m_uniformData)
+		{
+			BX_FREE(g_allocator, m_uniformData);
+			m_uniformData = NULL;
+		}
+		m_uniformSize = 0;
+
 		if (0 != m_id)
 		{
 			GL_CHECK(glUseProgram(0) );
@@ -4266,6 +4561,41 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 		m_numPredefined = 0;
 		m_numSamplers = 0;
 
+		GLuint blockIndex[BX_COUNTOF(s_uniformBlockName)];
+		bx::memSet(blockIndex, 0xff, sizeof(blockIndex) );
+
+		m_uniformSize = 0;
+		bx::memSet(m_uniformBlockOffset, 0, sizeof(m_uniformBlockOffset) );
+		bx::memSet(m_uniformBlockSize,   0, sizeof(m_uniformBlockSize)   );
+
+		if (s_renderGL->m_uniformBufferSupport)
+		{
+			for (uint32_t ii = 0; ii < BX_COUNTOF(s_uniformBlockName); ++ii)
+			{
+				blockIndex[ii] = glGetUniformBlockIndex(m_id, s_uniformBlockName[ii].m_name);
+
+				if (GL_INVALID_INDEX != blockIndex[ii])
+				{
+					GLint size = 0;
+					GL_CHECK(glGetActiveUniformBlockiv(m_id, blockIndex[ii], GL_UNIFORM_BLOCK_DATA_SIZE, &size) );
+					GL_CHECK(glUniformBlockBinding(m_id, blockIndex[ii], ii) );
+
+					m_uniformBlockOffset[ii] = m_uniformSize;
+					m_uniformBlockSize[ii]   = uint32_t(size);
+					m_uniformSize = bx::strideAlign(m_uniformSize + uint32_t(size), s_renderGL->m_uniformBufferAlign);
+
+					BX_TRACE("Uniform block %s, size %d, binding %d.", s_uniformBlockName[ii].m_name, size, ii);
+				}
+			}
+
+			if (0 != m_uniformSize)
+			{
+				m_uniformData = (uint8_t*)BX_ALLOC(g_allocator, m_uniformSize);
+				bx::memSet(m_uniformData, 0, m_uniformSize);
+				m_uniformDirty = true;
+			}
+		}
+
 		BX_TRACE("Uniforms (%d):", activeUniforms);
 		for (int32_t ii = 0; ii < activeUniforms; ++ii)
 		{
@@ -4324,6 +4654,34 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 				bx::fromString(&offset, bx::StringView(array.getPtr()+1, end.getPtr() ) );
 			}
 
+			if (-1 == loc
+			&&  0 != m_uniformSize)
+			{
+				const GLuint index = GLuint(ii);
+				GLint block = -1;
+				GL_CHECK(glGetActiveUniformsiv(m_id, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block) );
+
+				for (uint32_t stage = 0; stage < BX_COUNTOF(blockIndex); ++stage)
+				{
+					if (GLuint(block) == blockIndex[stage])
+					{
+						GLint blockOffset = 0;
+						GL_CHECK(glGetActiveUniformsiv(m_id, 1, &index, GL_UNIFORM_OFFSET, &blockOffset) );
+
+						// Block members are reported as "<block>.<member>".
+						const bx::StringView member = bx::strFind(name, '.');
+						if (!member.isEmpty() )
+						{
+							bx::memMove(name, member.getPtr()+1, bx::strLen(member.getPtr()+1)+1);
+						}
+
+						loc = GLint(kUniformBlockBit | (m_uniformBlockOffset[stage] + uint32_t(blockOffset) ) );
+						BX_TRACE("--- %s in block %d at offset %d", name, stage, blockOffset);
+						break;
+					}
+				}
+			}
+
 			switch (gltype)
 			{
 			case GL_SAMPLER_2D:
@@ -4580,16 +4938,202 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 		}
 	}
 
+	void StreamBufferGL::create(uint32_t _size)
+	{
+		const uint32_t size = _size * BGFX_CONFIG_MAX_FRAME_LATENCY;
+		const GLbitfield flags = 0
+			| GL_MAP_WRITE_BIT
+			| GL_MAP_PERSISTENT_BIT
+			| GL_MAP_COHERENT_BIT
+			;
+
+		GL_CHECK(glGenBuffers(1, &m_id) );
+		GL_CHECK(glBindBuffer(GL_COPY_READ_BUFFER, m_id) );
+		GL_CHECK(glBufferStorage(GL_COPY_READ_BUFFER, size, NULL, flags) );
+		m_data = (uint8_t*)glMapBufferRange(GL_COPY_READ_BUFFER, 0, size, flags);
+		GL_CHECK(glBindBuffer(GL_COPY_READ_BUFFER, 0) );
+
+		BX_CHECK(NULL != m_data, "Failed to map stream buffer.");
+
+		m_size    = _size;
+		m_pos     = 0;
+		m_current = 0;
+	}
+
+	void StreamBufferGL::destroy()
+	{
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_sync); ++ii)
+		{
+			if (NULL != m_sync[ii])
+			{
+				glDeleteSync(m_sync[ii]);
+				m_sync[ii] = NULL;
+			}
+		}
+
+		if (0 != m_id)
+		{
+			GL_CHECK(glBindBuffer(GL_COPY_READ_BUFFER, m_id) );
+			GL_CHECK(glUnmapBuffer(GL_COPY_READ_BUFFER) );
+			GL_CHECK(glBindBuffer(GL_COPY_READ_BUFFER, 0) );
+			GL_CHECK(glDeleteBuffers(1, &m_id) );
+			m_id   = 0;
+			m_data = NULL;
+		}
+	}
+
+	void StreamBufferGL::copy(GLuint _dst, uint32_t _dstOffset, const void* _data, uint32_t _size)
+	{
+		const uint8_t* data = (const uint8_t*)_data;
+
+		GL_CHECK(glBindBuffer(GL_COPY_READ_BUFFER, m_id) );
+		GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, _dst) );
+
+		while (0 < _size)
+		{
+			if (m_pos == m_size)
+			{
+				fence();
+			}
+
+			const uint32_t size   = bx::min(_size, m_size - m_pos);
+			const uint32_t offset = m_current*m_size + m_pos;
+			bx::memCopy(&m_data[offset], data, size);
+
+			GL_CHECK(glCopyBufferSubData(GL_COPY_READ_BUFFER
+				, GL_COPY_WRITE_BUFFER
+				, offset
+				, _dstOffset
+				, size
+				) );
+
+			// Keep offsets aligned, some drivers take slow path for unaligned
+			// copies.
+			m_pos       = bx::min(BX_ALIGN_16(m_pos + size), m_size);
+			data       += size;
+			_dstOffset += size;
+			_size      -= size;
+		}
+
+		GL_CHECK(glBindBuffer(GL_COPY_WRITE_BUFFER, 0) );
+		GL_CHECK(glBindBuffer(GL_COPY_READ_BUFFER, 0) );
+	}
+
+	uint32_t StreamBufferGL::write(const void* _data, uint32_t _size, uint32_t _align)
+	{
+		BX_CHECK(_size <= m_size, "Stream buffer write is too large (size %d, max %d).", _size, m_size);
+
+		uint32_t pos = bx::strideAlign(m_pos, _align);
+		if (pos + _size > m_size)
+		{
+			fence();
+			pos = 0;
+		}
+
+		const uint32_t offset = m_current*m_size + pos;
+		bx::memCopy(&m_data[offset], _data, _size);
+
+		m_pos = pos + _size;
+
+		return offset;
+	}
+
+	void StreamBufferGL::fence()
+	{
+		if (0 == m_pos)
+		{
+			return;
+		}
+
+		m_sync[m_current] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		m_current = (m_current + 1) % BGFX_CONFIG_MAX_FRAME_LATENCY;
+		m_pos     = 0;
+		m_epoch++;
+
+		GLsync sync = m_sync[m_current];
+		if (NULL != sync)
+		{
+			GLenum result = glClientWaitSync(sync, GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX);
+			BX_WARN(GL_WAIT_FAILED != result, "glClientWaitSync failed.");
+			BX_UNUSED(result);
+
+			glDeleteSync(sync);
+			m_sync[m_current] = NULL;
+		}
+	}
+
+	void IndexBufferGL::update(uint32_t _offset, uint32_t _size, void* _data, bool _discard)
+	{
+		BX_CHECK(0 != m_id, "Updating invalid index buffer.");
+
+		if (_discard)
+		{
+			// orphan buffer, so that update doesn't wait for draws still
+			// reading previous contents...
+			destroy();
+			create(m_size, NULL, m_flags);
+		}
+
+		if (BX_ENABLED(BGFX_CONFIG_RENDERER_OPENGL_STREAM_UPLOADS)
+		&&  s_renderGL->m_bufferStorageSupport)
+		{
+			// Copy is ordered after previously submitted draws on GPU, CPU
+			// never waits on destination buffer.
+			s_renderGL->m_streamBuffer.copy(m_id, _offset, _data, _size);
+			return;
+		}
+
+		GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id) );
+		GL_CHECK(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER
+			, _offset
+			, _size
+			, _data
+			) );
+		GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
+	}
+
 	void IndexBufferGL::destroy()
 	{
 		GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
 		GL_CHECK(glDeleteBuffers(1, &m_id) );
+
+		m_vcref.invalidate(s_renderGL->m_vaoStateCache);
+	}
+
+	void VertexBufferGL::update(uint32_t _offset, uint32_t _size, void* _data, bool _discard)
+	{
+		BX_CHECK(0 != m_id, "Updating invalid vertex buffer.");
+
+		if (_discard)
+		{
+			// orphan buffer...
+			destroy();
+			create(m_size, NULL, m_decl, 0);
+		}
+
+		if (BX_ENABLED(BGFX_CONFIG_RENDERER_OPENGL_STREAM_UPLOADS)
+		&&  s_renderGL->m_bufferStorageSupport)
+		{
+			s_renderGL->m_streamBuffer.copy(m_id, _offset, _data, _size);
+			return;
+		}
+
+		GL_CHECK(glBindBuffer(m_target, m_id) );
+		GL_CHECK(glBufferSubData(m_target
+			, _offset
+			, _size
+			, _data
+			) );
+		GL_CHECK(glBindBuffer(m_target, 0) );
 	}
 
 	void VertexBufferGL::destroy()
 	{
 		GL_CHECK(glBindBuffer(m_target, 0) );
 		GL_CHECK(glDeleteBuffers(1, &m_id) );
+
+		m_vcref.invalidate(s_renderGL->m_vaoStateCache);
 	}
 
 	bool TextureGL::init(GLenum _target, uint32_t _width, uint32_t _height, uint32_t _depth, uint8_t _numMips, uint64_t _flags)
@@ -5259,6 +5803,115 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 		bx::memCopy(_str, _insert, len);
 	}
 
+	bx::StringView nextLine(bx::StringView& _parse)
+	{
+		const bx::StringView eol = bx::strFind(_parse, '\n');
+		const bx::StringView line(_parse.getPtr(), eol.isEmpty() ? _parse.getTerm() : eol.getTerm() );
+		_parse.set(line.getTerm(), _parse.getTerm() );
+		return line;
+	}
+
+	bool parseUniformBlockMember(const bx::StringView& _line, bx::StringView& _member, bx::StringView& _name)
+	{
+		const bx::StringView parse = bx::strLTrimSpace(_line);
+		if (0 != bx::strCmp(parse, "uniform ", 8) )
+		{
+			return false;
+		}
+
+		_member = bx::strLTrimSpace(bx::StringView(parse.getPtr()+8, parse.getTerm() ) );
+
+		bx::StringView typen = bx::strWord(_member);
+		if (0 == bx::strCmp(typen, "lowp")
+		||  0 == bx::strCmp(typen, "mediump")
+		||  0 == bx::strCmp(typen, "highp") )
+		{
+			typen = bx::strWord(bx::strLTrimSpace(bx::StringView(typen.getTerm(), parse.getTerm() ) ) );
+		}
+
+		// Same types shaderc puts into uniform block layout.
+		if (0 != bx::strCmp(typen, "vec4")
+		&&  0 != bx::strCmp(typen, "mat3")
+		&&  0 != bx::strCmp(typen, "mat4") )
+		{
+			return false;
+		}
+
+		_name = bx::strWord(bx::strLTrimSpace(bx::StringView(typen.getTerm(), parse.getTerm() ) ) );
+		const bx::StringView eol = bx::strFind(bx::StringView(_name.getTerm(), parse.getTerm() ), ';');
+
+		if (_name.isEmpty()
+		||  eol.isEmpty() )
+		{
+			return false;
+		}
+
+		_member.set(_member.getPtr(), eol.getTerm() );
+
+		return true;
+	}
+
+	void writeUniformBlock(bx::WriterI* _writer, const bx::StringView& _code, uint32_t _stage)
+	{
+		const UniformBlockName& block = s_uniformBlockName[_stage];
+		bool declared = false;
+
+		for (bx::StringView parse = _code; !parse.isEmpty();)
+		{
+			const bx::StringView line = nextLine(parse);
+
+			bx::StringView member;
+			bx::StringView name;
+			if (!parseUniformBlockMember(line, member, name) )
+			{
+				bx::write(_writer, line);
+				continue;
+			}
+
+			if (declared)
+			{
+				continue;
+			}
+
+			// Declare block in place of first member, so that it ends up
+			// after #extension directives. Members keep declaration order,
+			// which is the std140 layout shaderc stored in uniform table.
+			declared = true;
+
+			bx::write(_writer, "layout(std140) uniform ");
+			bx::write(_writer, block.m_name);
+			bx::write(_writer, "\n{\n");
+
+			for (bx::StringView it(line.getPtr(), parse.getTerm() ); !it.isEmpty();)
+			{
+				if (parseUniformBlockMember(nextLine(it), member, name) )
+				{
+					bx::write(_writer, "\t");
+					bx::write(_writer, member);
+					bx::write(_writer, "\n");
+				}
+			}
+
+			bx::write(_writer, "} ");
+			bx::write(_writer, block.m_instance);
+			bx::write(_writer, ";\n");
+
+			for (bx::StringView it(line.getPtr(), parse.getTerm() ); !it.isEmpty();)
+			{
+				if (parseUniformBlockMember(nextLine(it), member, name) )
+				{
+					bx::write(_writer, "#define ");
+					bx::write(_writer, name);
+					bx::write(_writer, " ");
+					bx::write(_writer, block.m_instance);
+					bx::write(_writer, ".");
+					bx::write(_writer, name);
+					bx::write(_writer, "\n");
+				}
+			}
+		}
+	}
+
 	void ShaderGL::create(const Memory* _mem)
 	{
 		bx::MemoryReader reader(_mem->data, _mem->size);
@@ -5302,6 +5955,13 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 			, count
 			);
 
+		bool uniformBlock = true
+			&& s_renderGL->m_uniformBufferSupport
+			&& GL_COMPUTE_SHADER != m_type
+			;
+		uint32_t numRegs = 0;
+		int32_t uniformBlockLen = 0;
+
 		for (uint32_t ii = 0; ii < count; ++ii)
 		{
 			uint8_t nameSize = 0;
@@ -5322,8 +5982,22 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 			uint16_t regCount;
 			bx::read(&reader, regCount);
+
+			const UniformType::Enum utype = UniformType::Enum(type & ~BGFX_UNIFORM_MASK);
+			if (UniformType::Sampler != utype)
+			{
+				// shaderc stores std140 layout in vec4 registers. Shaders
+				// compiled without it keep using default uniform block.
+				const uint16_t regs = UniformType::Mat4 == utype ? 4 : UniformType::Mat3 == utype ? 3 : 1;
+				uniformBlock &= regIndex == numRegs && regCount == num*regs;
+				numRegs += regCount;
+				uniformBlockLen += 3*nameSize + 64;
+			}
 		}
 
+		// Minimum GL_MAX_UNIFORM_BLOCK_SIZE is 16KB.
+		uniformBlock &= 0 != numRegs && numRegs*16 <= (16<<10);
+
 		uint32_t shaderSize;
 		bx::read(&reader, shaderSize);
 
@@ -5337,7 +6011,7 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 			if (GL_COMPUTE_SHADER != m_type
 			&&  0 != bx::strCmp(code, "#version 430", 12) )
 			{
-				int32_t tempLen = code.getLength() + (4<<10);
+				int32_t tempLen = code.getLength() + (4<<10) + uniformBlockLen;
 				char* temp = (char*)alloca(tempLen);
 				bx::StaticMemoryBlockWriter writer(temp, tempLen);
 
@@ -5795,7 +6469,15 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 							);
 					}
 
-					bx::write(&writer, code.getPtr(), code.getLength() );
+					if (uniformBlock)
+					{
+						writeUniformBlock(&writer, code, GL_FRAGMENT_SHADER == m_type ? 1 : 0);
+					}
+					else
+					{
+						bx::write(&writer, code.getPtr(), code.getLength() );
+					}
+
 					bx::write(&writer, '\0');
 				}
 
@@ -6307,6 +6989,238 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 		}
 	}
 
+	void ReadBackGL::create()
+	{
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_pixels); ++ii)
+		{
+			Pixels& pixels = m_pixels[ii];
+			pixels.m_pbo      = 0;
+			pixels.m_sync     = NULL;
+			pixels.m_capacity = 0;
+			pixels.m_filePath = NULL;
+		}
+	}
+
+	void ReadBackGL::destroy()
+	{
+		resolve(true);
+
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_pixels); ++ii)
+		{
+			Pixels& pixels = m_pixels[ii];
+			if (0 != pixels.m_pbo)
+			{
+				GL_CHECK(glDeleteBuffers(1, &pixels.m_pbo) );
+				pixels.m_pbo      = 0;
+				pixels.m_capacity = 0;
+			}
+		}
+
+		BX_FREE(g_allocator, m_data);
+		m_data     = NULL;
+		m_dataSize = 0;
+	}
+
+	ReadBackGL::Pixels& ReadBackGL::begin(Kind::Enum _kind, uint32_t _size)
+	{
+		while (0 == m_control.reserve(1) )
+		{
+			resolve(true);
+		}
+
+		Pixels& pixels = m_pixels[m_control.m_current];
+
+		if (0 == pixels.m_pbo)
+		{
+			GL_CHECK(glGenBuffers(1, &pixels.m_pbo) );
+		}
+
+		GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, pixels.m_pbo) );
+
+		if (pixels.m_capacity < _size)
+		{
+			GL_CHECK(glBufferData(GL_PIXEL_PACK_BUFFER, _size, NULL, GL_STREAM_READ) );
+			pixels.m_capacity = _size;
+		}
+
+		pixels.m_size     = _size;
+		pixels.m_width    = 0;
+		pixels.m_height   = 0;
+		pixels.m_frame    = 0;
+		pixels.m_deadline = UINT32_MAX;
+		pixels.m_format   = GL_NONE;
+		pixels.m_kind     = _kind;
+		pixels.m_dst      = NULL;
+
+		return pixels;
+	}
+
+	void ReadBackGL::end()
+	{
+		GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0) );
+
+		Pixels& pixels = m_pixels[m_control.m_current];
+		pixels.m_sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+		m_control.commit(1);
+	}
+
+	void ReadBackGL::read(Kind::Enum _kind, uint32_t _width, uint32_t _height, GLenum _format, uint32_t _frame, const char* _filePath)
+	{
+		Pixels& pixels = begin(_kind, _width*_height*4);
+		pixels.m_width  = _width;
+		pixels.m_height = _height;
+		pixels.m_frame  = _frame;
+		pixels.m_format = _format;
+
+		if (NULL != _filePath)
+		{
+			const uint32_t len = bx::strLen(_filePath)+1;
+			pixels.m_filePath = (char*)BX_ALLOC(g_allocator, len);
+			bx::memCopy(pixels.m_filePath, _filePath, len);
+		}
+
+		GL_CHECK(glReadPixels(0
+			, 0
+			, _width
+			, _height
+			, _format
+			, GL_UNSIGNED_BYTE
+			, NULL
+			) );
+
+		end();
+	}
+
+	void ReadBackGL::resolve(bool _wait, uint32_t _frame)
+	{
+		const uint32_t num = m_control.available();
+		const uint32_t max = BX_COUNTOF(m_pixels);
+
+#if BX_PLATFORM_EMSCRIPTEN
+		// WebGL doesn't allow client side waits with timeout, any slot past its
+		// deadline forces finish instead, and already signaled fences are polled
+		// below.
+		bool finish = _wait;
+		for (uint32_t ii = 0; ii < num && !finish; ++ii)
+		{
+			const Pixels& pixels = m_pixels[(m_control.m_read + ii) % max];
+			finish = NULL != pixels.m_sync
+				&& pixels.m_deadline <= _frame
+				;
+		}
+
+		if (finish)
+		{
+			GL_CHECK(glFinish() );
+		}
+#endif // BX_PLATFORM_EMSCRIPTEN
+
+		// Each slot is delivered as soon as its own fence is signaled. Slot is
+		// released once all slots before it are delivered too.
+		for (uint32_t ii = 0; ii < num; ++ii)
+		{
+			Pixels& pixels = m_pixels[(m_control.m_read + ii) % max];
+
+			if (NULL == pixels.m_sync)
+			{
+				continue;
+			}
+
+			// Block only on fence of the slot that must be delivered now, other
+			// slots are just polled.
+			const bool wait = true
+				&& !BX_ENABLED(BX_PLATFORM_EMSCRIPTEN)
+				&& (_wait || pixels.m_deadline <= _frame)
+				;
+
+			GLenum result = wait
+				? glClientWaitSync(pixels.m_sync, GL_SYNC_FLUSH_COMMANDS_BIT, UINT64_MAX)
+				: glClientWaitSync(pixels.m_sync, 0, 0)
+				;
+
+			if (GL_TIMEOUT_EXPIRED == result)
+			{
+				continue;
+			}
+
+			BX_WARN(GL_WAIT_FAILED != result, "glClientWaitSync failed.");
+
+			glDeleteSync(pixels.m_sync);
+			pixels.m_sync = NULL;
+
+			deliver(pixels);
+		}
+
+		while (0 != m_control.available()
+		&&     NULL == m_pixels[m_control.m_read].m_sync)
+		{
+			m_control.consume(1);
+		}
+	}
+
+	void ReadBackGL::deliver(Pixels& _pixels)
+	{
+		const uint32_t pitch = _pixels.m_width*4;
+		const uint32_t size  = _pixels.m_size;
+
+		GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, _pixels.m_pbo) );
+		void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+
+		if (NULL != mapped)
+		{
+			const void* data = mapped;
+
+			if (Kind::Texture != _pixels.m_kind
+			&&  GL_RGBA == _pixels.m_format)
+			{
+				if (m_dataSize < size)
+				{
+					m_data     = BX_REALLOC(g_allocator, m_data, size);
+					m_dataSize = size;
+				}
+
+				bimg::imageSwizzleBgra8(m_data, pitch, _pixels.m_width, _pixels.m_height, mapped, pitch);
+				data = m_data;
+			}
+
+			switch (_pixels.m_kind)
+			{
+			case Kind::Capture:
+				g_callback->captureFrame(data, size, _pixels.m_frame);
+				break;
+
+			case Kind::ScreenShot:
+				g_callback->screenShot(_pixels.m_filePath
+					, _pixels.m_width
+					, _pixels.m_height
+					, pitch
+					, data
+					, size
+					, true
+					);
+				break;
+
+			case Kind::Texture:
+				bx::memCopy(_pixels.m_dst, data, size);
+				break;
+
+			default:
+				break;
+			}
+
+			GL_CHECK(glUnmapBuffer(GL_PIXEL_PACK_BUFFER) );
+		}
+
+		GL_CHECK(glBindBuffer(GL_PIXEL_PACK_BUFFER, 0) );
+
+		if (NULL != _pixels.m_filePath)
+		{
+			BX_FREE(g_allocator, _pixels.m_filePath);
+			_pixels.m_filePath = NULL;
+		}
+	}
+
 	void RendererContextGL::submitBlit(BlitState& _bs, uint16_t _view)
 	{
 		if (m_blitSupported)
@@ -6360,6 +7274,8 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 		if (1 < m_numWindows
 		&&  m_vaoSupport)
 		{
+			// VAOs are not shared between contexts.
+			m_vaoStateCache.invalidate();
 			m_vaoSupport = false;
 			GL_CHECK(glBindVertexArray(0) );
 			GL_CHECK(glDeleteVertexArrays(1, &m_vao) );
@@ -6368,6 +7284,13 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 		m_glctx.makeCurrent(NULL);
 
+		m_frameNum = _render->m_frameNum;
+
+		if (m_asyncReadBackSupport)
+		{
+			m_readBack.resolve();
+		}
+
 		const GLuint defaultVao = m_vao;
 		if (0 != defaultVao)
 		{
@@ -6419,6 +7342,8 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 
 		ProgramHandle currentProgram = BGFX_INVALID_HANDLE;
 		ProgramHandle boundProgram   = BGFX_INVALID_HANDLE;
+		GLuint   currentVao     = defaultVao;
+		uint32_t currentVaoHash = 0;
 		SortKey key;
 		uint16_t view = UINT16_MAX;
 		FrameBufferHandle fbh = { BGFX_CONFIG_MAX_FRAME_BUFFERS };
@@ -6500,6 +7425,14 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 					view = key.m_view;
 					currentProgram = BGFX_INVALID_HANDLE;
 
+					if (defaultVao != currentVao)
+					{
+						// Clear quad sets up attributes in default VAO.
+						GL_CHECK(glBindVertexArray(defaultVao) );
+						currentVao = defaultVao;
+						currentState.m_indexBuffer.idx = kInvalidHandle;
+					}
+
 					if (_render->m_view[view].m_fbh.idx != fbh.idx)
 					{
 						fbh = _render->m_view[view].m_fbh;
@@ -6618,6 +7551,7 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 						{
 							bool constantsChanged = compute.m_uniformBegin < compute.m_uniformEnd;
 							rendererUpdateUniforms(this, _render->m_uniformBuffer[compute.m_uniformIdx], compute.m_uniformBegin, compute.m_uniformEnd);
+							m_uniformProgram = &program;
 
 							if (constantsChanged
 							&&  NULL != program.m_constantBuffer)
@@ -7060,6 +7994,7 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 				if (isValid(currentProgram) )
 				{
 					ProgramGL& program = m_program[currentProgram.idx];
+					m_uniformProgram = &program;
 
 					if (constantsChanged
 					&&  NULL != program.m_constantBuffer)
@@ -7068,6 +8003,7 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 					}
 
 					viewState.setPredefined<1>(this, view, program, _render, draw);
+					commitUniformBlocks(program, programChanged);
 
 					{
 						for (uint32_t stage = 0; stage < BGFX_CONFIG_MAX_TEXTURE_SAMPLERS; ++stage)
@@ -7156,6 +8092,104 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 							bindAttribs = true;
 						}
 
+						if (m_vaoSupport)
+						{
+							// Vertex streams without transient offset and instance
+							// data are cached in VAO, together with index buffer.
+							bool cacheVao = true
+								&& 0 != draw.m_streamMask
+								&& UINT8_MAX != draw.m_streamMask
+								&& !isValid(draw.m_instanceDataBuffer)
+								;
+
+							bx::HashMurmur2A murmur;
+							murmur.begin();
+							murmur.add(currentProgram.idx);
+							murmur.add(draw.m_indexBuffer.idx);
+
+							for (uint32_t idx = 0, streamMask = draw.m_streamMask
+								; 0 != streamMask && cacheVao
+								; streamMask >>= 1, idx += 1
+								)
+							{
+								const uint32_t ntz = bx::uint32_cnttz(streamMask);
+								streamMask >>= ntz;
+								idx         += ntz;
+
+								const VertexBufferGL& vb = m_vertexBuffers[draw.m_stream[idx].m_handle.idx];
+								const uint16_t decl = isValid(draw.m_stream[idx].m_decl)
+									? draw.m_stream[idx].m_decl.idx
+									: vb.m_decl.idx;
+
+								cacheVao &= 0 == draw.m_stream[idx].m_startVertex;
+
+								murmur.add(idx);
+								murmur.add(draw.m_stream[idx].m_handle.idx);
+								murmur.add(m_vertexDecls[decl].m_hash);
+							}
+
+							const uint32_t hash = murmur.end();
+
+							if (cacheVao)
+							{
+								if (defaultVao     == currentVao
+								||  currentVaoHash != hash)
+								{
+									GLuint vao = m_vaoStateCache.find(hash);
+									if (UINT32_MAX != vao)
+									{
+										GL_CHECK(glBindVertexArray(vao) );
+									}
+									else
+									{
+										vao = m_vaoStateCache.add(hash);
+										program.m_vcref.add(hash);
+
+										if (isValid(draw.m_indexBuffer) )
+										{
+											IndexBufferGL& ib = m_indexBuffers[draw.m_indexBuffer.idx];
+											GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ib.m_id) );
+											ib.m_vcref.add(hash);
+										}
+
+										program.bindAttributesBegin();
+
+										for (uint32_t idx = 0, streamMask = draw.m_streamMask
+											; 0 != streamMask
+											; streamMask >>= 1, idx += 1
+											)
+										{
+											const uint32_t ntz = bx::uint32_cnttz(streamMask);
+											streamMask >>= ntz;
+											idx         += ntz;
+
+											VertexBufferGL& vb = m_vertexBuffers[draw.m_stream[idx].m_handle.idx];
+											const uint16_t decl = isValid(draw.m_stream[idx].m_decl)
+												? draw.m_stream[idx].m_decl.idx
+												: vb.m_decl.idx;
+											GL_CHECK(glBindBuffer(GL_ARRAY_BUFFER, vb.m_id) );
+											program.bindAttributes(m_vertexDecls[decl], 0);
+											vb.m_vcref.add(hash);
+										}
+
+										program.bindAttributesEnd();
+									}
+
+									currentVao     = vao;
+									currentVaoHash = hash;
+								}
+
+								currentState.m_indexBuffer = draw.m_indexBuffer;
+							}
+							else if (defaultVao != currentVao)
+							{
+								GL_CHECK(glBindVertexArray(defaultVao) );
+								currentVao = defaultVao;
+								currentState.m_indexBuffer.idx = kInvalidHandle;
+								bindAttribs = true;
+							}
+						}
+
 						if (currentState.m_indexBuffer.idx != draw.m_indexBuffer.idx)
 						{
 							currentState.m_indexBuffer = draw.m_indexBuffer;
@@ -7172,7 +8206,8 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 							}
 						}
 
-						if (0 != currentState.m_streamMask)
+						if (0 != currentState.m_streamMask
+						&&  defaultVao == currentVao)
 						{
 							bool diffStartVertex = false;
 							for (uint32_t idx = 0, streamMask = draw.m_streamMask
@@ -7393,6 +8428,12 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 				}
 			}
 
+			if (defaultVao != currentVao)
+			{
+				GL_CHECK(glBindVertexArray(defaultVao) );
+				currentVao = defaultVao;
+			}
+
 			if (isValid(boundProgram) )
 			{
 				m_program[boundProgram.idx].unbindAttributes();
@@ -7423,13 +8464,26 @@ BX_TRACE("%d, %d, %d, %s", _array, _srgb, _mipAutogen, getName(_format) );
 				}
 
 				captureElapsed = -bx::getHPCounter();
-				capture();
+				capture(_render->m_frameNum);
 				captureElapsed += bx::getHPCounter();
 
 				profiler.end();
 			}
 		}
 
+		if (m_asyncReadBackSupport)
+		{
+			// Texture read backs must be done by the frame bgfx::readTexture
+			// promised, block only on fences of those that are due. Others are
+			// delivered if already signaled, without stalling the pipeline.
+			m_readBack.resolve(false, m_frameNum);
+		}
+
+		if (m_bufferStorageSupport)
+		{
+			m_streamBuffer.fence();
+		}
+
 		BGFX_GL_PROFILER_END();
 
 		m_glctx.makeCurrent(NULL);
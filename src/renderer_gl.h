@@ -96,6 +96,7 @@ typedef double GLdouble;
 #		endif // BX_PLATFORM_
 typedef int64_t  GLint64;
 typedef uint64_t GLuint64;
+typedef struct __GLsync* GLsync;
 #		define GL_PROGRAM_BINARY_LENGTH GL_PROGRAM_BINARY_LENGTH_OES
 #		define GL_HALF_FLOAT GL_HALF_FLOAT_OES
 #		define GL_RGBA8 GL_RGBA8_OES
@@ -641,6 +642,78 @@ typedef uint64_t GLuint64;
 #	define GL_TIMESTAMP 0x8E28
 #endif // GL_TIMESTAMP
 
+#ifndef GL_PIXEL_PACK_BUFFER
+#	define GL_PIXEL_PACK_BUFFER 0x88EB
+#endif // GL_PIXEL_PACK_BUFFER
+
+#ifndef GL_STREAM_READ
+#	define GL_STREAM_READ 0x88E1
+#endif // GL_STREAM_READ
+
+#ifndef GL_MAP_READ_BIT
+#	define GL_MAP_READ_BIT 0x0001
+#endif // GL_MAP_READ_BIT
+
+#ifndef GL_MAP_WRITE_BIT
+#	define GL_MAP_WRITE_BIT 0x0002
+#endif // GL_MAP_WRITE_BIT
+
+#ifndef GL_MAP_PERSISTENT_BIT
+#	define GL_MAP_PERSISTENT_BIT 0x0040
+#endif // GL_MAP_PERSISTENT_BIT
+
+#ifndef GL_MAP_COHERENT_BIT
+#	define GL_MAP_COHERENT_BIT 0x0080
+#endif // GL_MAP_COHERENT_BIT
+
+#ifndef GL_COPY_READ_BUFFER
+#	define GL_COPY_READ_BUFFER 0x8F36
+#endif // GL_COPY_READ_BUFFER
+
+#ifndef GL_COPY_WRITE_BUFFER
+#	define GL_COPY_WRITE_BUFFER 0x8F37
+#endif // GL_COPY_WRITE_BUFFER
+
+#ifndef GL_UNIFORM_BUFFER
+#	define GL_UNIFORM_BUFFER 0x8A11
+#endif // GL_UNIFORM_BUFFER
+
+#ifndef GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+#	define GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT 0x8A34
+#endif // GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+
+#ifndef GL_UNIFORM_BLOCK_INDEX
+#	define GL_UNIFORM_BLOCK_INDEX 0x8A3A
+#endif // GL_UNIFORM_BLOCK_INDEX
+
+#ifndef GL_UNIFORM_OFFSET
+#	define GL_UNIFORM_OFFSET 0x8A3B
+#endif // GL_UNIFORM_OFFSET
+
+#ifndef GL_UNIFORM_BLOCK_DATA_SIZE
+#	define GL_UNIFORM_BLOCK_DATA_SIZE 0x8A40
+#endif // GL_UNIFORM_BLOCK_DATA_SIZE
+
+#ifndef GL_INVALID_INDEX
+#	define GL_INVALID_INDEX 0xFFFFFFFFu
+#endif // GL_INVALID_INDEX
+
+#ifndef GL_SYNC_FLUSH_COMMANDS_BIT
+#	define GL_SYNC_FLUSH_COMMANDS_BIT 0x00000001
+#endif // GL_SYNC_FLUSH_COMMANDS_BIT
+
+#ifndef GL_SYNC_GPU_COMMANDS_COMPLETE
+#	define GL_SYNC_GPU_COMMANDS_COMPLETE 0x9117
+#endif // GL_SYNC_GPU_COMMANDS_COMPLETE
+
+#ifndef GL_TIMEOUT_EXPIRED
+#	define GL_TIMEOUT_EXPIRED 0x911B
+#endif // GL_TIMEOUT_EXPIRED
+
+#ifndef GL_WAIT_FAILED
+#	define GL_WAIT_FAILED 0x911D
+#endif // GL_WAIT_FAILED
+
 #ifndef GL_VBO_FREE_MEMORY_ATI
 #	define GL_VBO_FREE_MEMORY_ATI 0x87FB
 #endif // GL_VBO_FREE_MEMORY_ATI
@@ -1156,6 +1229,163 @@ namespace bgfx { namespace gl
 		HashMap m_hashMap;
 	};
 
+	/// Vertex array objects keyed by hash of program, vertex streams and
+	/// index buffer. Least recently used VAO is deleted when cache is full.
+	class VaoStateCache
+	{
+	public:
+		/// Creates new VAO and leaves it bound.
+		GLuint add(uint32_t _hash)
+		{
+			invalidate(_hash);
+
+			uint16_t handle = m_alloc.alloc();
+			if (UINT16_MAX == handle)
+			{
+				release(m_alloc.getBack() );
+				handle = m_alloc.alloc();
+			}
+
+			BX_CHECK(UINT16_MAX != handle, "Failed to find handle.");
+
+			GLuint arrayId;
+			GL_CHECK(glGenVertexArrays(1, &arrayId) );
+			GL_CHECK(glBindVertexArray(arrayId) );
+
+			Data& data = m_data[handle];
+			data.m_hash = _hash;
+			data.m_id   = arrayId;
+			m_hashMap.insert(stl::make_pair(_hash, handle) );
+
+			return arrayId;
+		}
+
+		GLuint find(uint32_t _hash)
+		{
+			HashMap::iterator it = m_hashMap.find(_hash);
+			if (it != m_hashMap.end() )
+			{
+				m_alloc.touch(it->second);
+				return m_data[it->second].m_id;
+			}
+
+			return UINT32_MAX;
+		}
+
+		void invalidate(uint32_t _hash)
+		{
+			HashMap::iterator it = m_hashMap.find(_hash);
+			if (it != m_hashMap.end() )
+			{
+				release(it->second);
+			}
+		}
+
+		void invalidate()
+		{
+			for (uint16_t ii = 0, num = m_alloc.getNumHandles(); ii < num; ++ii)
+			{
+				Data& data = m_data[m_alloc.getHandleAt(ii)];
+				GL_CHECK(glDeleteVertexArrays(1, &data.m_id) );
+			}
+
+			m_hashMap.clear();
+			m_alloc.reset();
+		}
+
+		uint32_t getCount() const
+		{
+			return uint32_t(m_hashMap.size() );
+		}
+
+	private:
+		void release(uint16_t _handle)
+		{
+			Data& data = m_data[_handle];
+			GL_CHECK(glDeleteVertexArrays(1, &data.m_id) );
+			m_hashMap.erase(m_hashMap.find(data.m_hash) );
+			m_alloc.free(_handle);
+		}
+
+		typedef stl::unordered_map<uint32_t, uint16_t> HashMap;
+		HashMap m_hashMap;
+		bx::HandleAllocLruT<BGFX_CONFIG_MAX_VAO_CACHE> m_alloc;
+
+		struct Data
+		{
+			uint32_t m_hash;
+			GLuint m_id;
+		};
+
+		Data m_data[BGFX_CONFIG_MAX_VAO_CACHE];
+	};
+
+	/// Hashes of cached VAOs referencing resource, VAOs are invalidated
+	/// when resource is destroyed.
+	class VaoCacheRef
+	{
+	public:
+		void add(uint32_t _hash)
+		{
+			m_vaoSet.insert(_hash);
+		}
+
+		void invalidate(VaoStateCache& _vaoCache)
+		{
+			for (VaoSet::iterator it = m_vaoSet.begin(), itEnd = m_vaoSet.end(); it != itEnd; ++it)
+			{
+				_vaoCache.invalidate(*it);
+			}
+
+			m_vaoSet.clear();
+		}
+
+		typedef stl::unordered_set<uint32_t> VaoSet;
+		VaoSet m_vaoSet;
+	};
+
+	/// Persistently mapped upload ring, split into one partition per frame
+	/// in flight. Data is written by CPU into current partition, and copied
+	/// on GPU into destination buffer, avoiding implicit synchronization of
+	/// glBufferSubData.
+	struct StreamBufferGL
+	{
+		StreamBufferGL()
+			: m_id(0)
+			, m_data(NULL)
+			, m_size(0)
+			, m_pos(0)
+			, m_current(0)
+			, m_epoch(0)
+		{
+			bx::memSet(m_sync, 0, sizeof(m_sync) );
+		}
+
+		void create(uint32_t _size);
+		void destroy();
+
+		/// Copies _data into ring and issues GPU copy into buffer _dst at
+		/// _dstOffset. Uploads larger than remaining space in partition
+		/// continue in next partition.
+		void copy(GLuint _dst, uint32_t _dstOffset, const void* _data, uint32_t _size);
+
+		/// Copies _data into ring and returns its offset in stream buffer,
+		/// for binding ring directly (uniform blocks).
+		uint32_t write(const void* _data, uint32_t _size, uint32_t _align);
+
+		/// Fences current partition and moves to next one, waiting for GPU to
+		/// be done with it.
+		void fence();
+
+		GLsync   m_sync[BGFX_CONFIG_MAX_FRAME_LATENCY];
+		GLuint   m_id;
+		uint8_t* m_data;
+		uint32_t m_size;
+		uint32_t m_pos;
+		uint32_t m_current;
+		uint32_t m_epoch; // Incremented on partition switch.
+	};
+
 	struct IndexBufferGL
 	{
 		void create(uint32_t _size, void* _data, uint16_t _flags)
@@ -1174,31 +1404,13 @@ namespace bgfx { namespace gl
 			GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
 		}
 
-		void update(uint32_t _offset, uint32_t _size, void* _data, bool _discard = false)
-		{
-			BX_CHECK(0 != m_id, "Updating invalid index buffer.");
-
-			if (_discard)
-			{
-				// orphan buffer...
-				destroy();
-				create(m_size, NULL, m_flags);
-			}
-
-			GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_id) );
-			GL_CHECK(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER
-				, _offset
-				, _size
-				, _data
-				) );
-			GL_CHECK(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0) );
-		}
-
+		void update(uint32_t _offset, uint32_t _size, void* _data, bool _discard = false);
 		void destroy();
 
 		GLuint m_id;
 		uint32_t m_size;
 		uint16_t m_flags;
+		VaoCacheRef m_vcref;
 	};
 
 	struct VertexBufferGL
@@ -1222,32 +1434,14 @@ namespace bgfx { namespace gl
 			GL_CHECK(glBindBuffer(m_target, 0) );
 		}
 
-		void update(uint32_t _offset, uint32_t _size, void* _data, bool _discard = false)
-		{
-			BX_CHECK(0 != m_id, "Updating invalid vertex buffer.");
-
-			if (_discard)
-			{
-				// orphan buffer...
-				destroy();
-				create(m_size, NULL, m_decl, 0);
-			}
-
-			GL_CHECK(glBindBuffer(m_target, m_id) );
-			GL_CHECK(glBufferSubData(m_target
-				, _offset
-				, _size
-				, _data
-				) );
-			GL_CHECK(glBindBuffer(m_target, 0) );
-		}
-
+		void update(uint32_t _offset, uint32_t _size, void* _data, bool _discard = false);
 		void destroy();
 
 		GLuint m_id;
 		GLenum m_target;
 		uint32_t m_size;
 		VertexDeclHandle m_decl;
+		VaoCacheRef m_vcref;
 	};
 
 	struct TextureGL
@@ -1350,7 +1544,14 @@ namespace bgfx { namespace gl
 			: m_id(0)
 			, m_constantBuffer(NULL)
 			, m_numPredefined(0)
+			, m_uniformData(NULL)
+			, m_uniformSize(0)
+			, m_uniformOffset(0)
+			, m_uniformEpoch(0)
+			, m_uniformDirty(false)
 		{
+			bx::memSet(m_uniformBlockOffset, 0, sizeof(m_uniformBlockOffset) );
+			bx::memSet(m_uniformBlockSize,   0, sizeof(m_uniformBlockSize)   );
 		}
 
 		void create(const ShaderGL& _vsh, const ShaderGL& _fsh);
@@ -1393,8 +1594,18 @@ namespace bgfx { namespace gl
 		uint8_t m_numSamplers;
 
 		UniformBuffer* m_constantBuffer;
-		PredefinedUniform m_predefined[PredefinedUniform::Count];
+		PredefinedUniform m_predefined[PredefinedUniform::Count*2];
 		uint8_t m_numPredefined;
+
+		uint8_t* m_uniformData; // CPU copy of std140 uniform blocks, VS block first.
+		uint32_t m_uniformSize;
+		uint32_t m_uniformBlockOffset[2];
+		uint32_t m_uniformBlockSize[2];
+		uint32_t m_uniformOffset; // Offset in stream buffer of last upload.
+		uint32_t m_uniformEpoch;
+		bool m_uniformDirty;
+
+		VaoCacheRef m_vcref;
 	};
 
 	struct TimerQueryGL
@@ -1562,6 +1773,67 @@ namespace bgfx { namespace gl
 		bx::RingBufferControl m_control;
 	};
 
+	struct ReadBackGL
+	{
+		struct Kind
+		{
+			enum Enum
+			{
+				Capture,
+				ScreenShot,
+				Texture,
+
+				Count
+			};
+		};
+
+		struct Pixels
+		{
+			GLuint   m_pbo;
+			GLsync   m_sync;
+			uint32_t m_capacity;
+			uint32_t m_size;
+			uint32_t m_width;
+			uint32_t m_height;
+			uint32_t m_frame;
+			uint32_t m_deadline;
+			GLenum   m_format;
+			Kind::Enum m_kind;
+			char*    m_filePath;
+			void*    m_dst;
+		};
+
+		ReadBackGL()
+			: m_control(BX_COUNTOF(m_pixels) )
+			, m_data(NULL)
+			, m_dataSize(0)
+		{
+		}
+
+		void create();
+		void destroy();
+
+		/// Reserves read back slot, and binds its pixel pack buffer. Read is
+		/// issued by caller with NULL offset, and finished with `end`.
+		Pixels& begin(Kind::Enum _kind, uint32_t _size);
+		void end();
+
+		void read(Kind::Enum _kind, uint32_t _width, uint32_t _height, GLenum _format, uint32_t _frame, const char* _filePath = NULL);
+
+		/// Delivers completed read backs, each slot independently as soon as
+		/// its fence is signaled. Waits on fences of all slots when `_wait` is
+		/// set, otherwise only on fences of slots with deadline <= `_frame`.
+		void resolve(bool _wait = false, uint32_t _frame = 0);
+
+		/// Maps pixel pack buffer and hands data to callback or destination.
+		void deliver(Pixels& _pixels);
+
+		Pixels m_pixels[BGFX_CONFIG_MAX_READBACKS];
+		bx::RingBufferControl m_control;
+		void* m_data;
+		uint32_t m_dataSize;
+	};
+
 	class LineReader : public bx::ReaderI
 	{
 	public:
@@ -1286,7 +1286,7 @@ namespace bgfx { namespace mtl
 			}
 		}
 
-		void capture()
+		void capture(uint32_t _frame)
 		{
 			if (NULL != m_capture)
 			{
@@ -1318,7 +1318,7 @@ namespace bgfx { namespace mtl
 						);
 				}
 
-				g_callback->captureFrame(m_capture, m_captureSize);
+				g_callback->captureFrame(m_capture, m_captureSize, _frame);
 
 				RenderPassDescriptor renderPassDescriptor = newRenderPassDescriptor();
 				setFrameBuffer(renderPassDescriptor, m_renderCommandEncoderFrameBufferHandle);
@@ -4521,7 +4521,7 @@ namespace bgfx { namespace mtl
 			if (0 < _render->m_numRenderItems)
 			{
 				captureElapsed = -bx::getHPCounter();
-				capture();
+				capture(_render->m_frameNum);
 				rce = m_renderCommandEncoder;
 				captureElapsed += bx::getHPCounter();
 
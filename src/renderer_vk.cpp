@@ -755,7 +755,7 @@ VK_IMPORT_DEVICE
 			break;
 
 		case VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL:
-			dstAccessMask |= VK_ACCESS_SHADER_READ_BIT;
+			dstAccessMask |= VK_ACCESS_TRANSFER_READ_BIT;
 			break;
 
 		case VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL:
@@ -810,6 +810,9 @@ VK_IMPORT_DEVICE
 			, m_maxAnisotropy(1)
 			, m_depthClamp(false)
 			, m_wireframe(false)
+			, m_readBackSupport(false)
+			, m_capture(false)
+			, m_presentFrame(UINT32_MAX)
 		{
 		}
 
@@ -842,6 +845,8 @@ VK_IMPORT_DEVICE
 			m_fbh.idx = kInvalidHandle;
 			bx::memSet(m_uniforms, 0, sizeof(m_uniforms) );
 			bx::memSet(&m_resolution, 0, sizeof(m_resolution) );
+			bx::memSet(m_imageAcquired, 0, sizeof(m_imageAcquired) );
+			bx::memSet(m_renderDone, 0, sizeof(m_renderDone) );
 
 			bool imported = true;
 			VkResult result;
@@ -1507,6 +1512,23 @@ VK_IMPORT_DEVICE
 				m_sci.imageExtent.height = _init.resolution.height;
 				m_sci.imageArrayLayers = 1;
 				m_sci.imageUsage       = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+
+				// Back buffer read back (screen shots and video capture) copies
+				// swap chain image into staging buffer, and swizzles RGBA to BGRA.
+				m_readBackSupport = true
+					&& 0 != (surfaceCapabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_SRC_BIT)
+					&& (false
+						|| VK_FORMAT_B8G8R8A8_UNORM == m_sci.imageFormat
+						|| VK_FORMAT_B8G8R8A8_SRGB  == m_sci.imageFormat
+						|| VK_FORMAT_R8G8B8A8_UNORM == m_sci.imageFormat
+						|| VK_FORMAT_R8G8B8A8_SRGB  == m_sci.imageFormat
+						)
+					;
+
+				if (m_readBackSupport)
+				{
+					m_sci.imageUsage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+				}
 				m_sci.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE;
 				m_sci.queueFamilyIndexCount = 0;
 				m_sci.pQueueFamilyIndices   = NULL;
@@ -1659,11 +1681,6 @@ VK_IMPORT_DEVICE
 				fci.height = m_sci.imageExtent.height;
 				fci.layers = 1;
 
-				VkSemaphoreCreateInfo sci;
-				sci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
-				sci.pNext = NULL;
-				sci.flags = 0;
-
 				for (uint32_t ii = 0; ii < numSwapchainImages; ++ii)
 				{
 					ivci.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
@@ -1698,72 +1715,47 @@ VK_IMPORT_DEVICE
 						BX_TRACE("Init error: vkCreateFramebuffer failed %d: %s.", result, getName(result) );
 						goto error;
 					}
-
-					result = vkCreateSemaphore(m_device, &sci, m_allocatorCb, &m_presentDone[ii]);
-
-					if (VK_SUCCESS != result)
-					{
-						BX_TRACE("Init error: vkCreateSemaphore failed %d: %s.", result, getName(result) );
-						goto error;
-					}
-
-					sci.flags = 0;
 				}
 			}
 
 			errorState = ErrorState::SwapchainCreated;
 
 			{
-				VkFenceCreateInfo fci;
-				fci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-				fci.pNext = NULL;
-				fci.flags = 0;
-				result = vkCreateFence(m_device, &fci, m_allocatorCb, &m_fence);
-
-				if (VK_SUCCESS != result)
-				{
-					BX_TRACE("Init error: vkCreateFence failed %d: %s.", result, getName(result) );
-					goto error;
-				}
+				const uint32_t numFramesInFlight = 0 == _init.resolution.maxFrameLatency
+					? BGFX_CONFIG_MAX_FRAME_LATENCY
+					: bx::min<uint32_t>(_init.resolution.maxFrameLatency, BGFX_CONFIG_MAX_FRAME_LATENCY)
+					;
 
-				VkCommandPoolCreateInfo cpci;
-				cpci.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
-				cpci.pNext = NULL;
-				cpci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
-				cpci.queueFamilyIndex = m_qfiGraphics;
-				result = vkCreateCommandPool(m_device, &cpci, m_allocatorCb, &m_commandPool);
+				VkSemaphoreCreateInfo sci;
+				sci.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+				sci.pNext = NULL;
+				sci.flags = 0;
 
-				if (VK_SUCCESS != result)
+				for (uint32_t ii = 0; ii < numFramesInFlight; ++ii)
 				{
-					vkDestroy(m_fence);
-					BX_TRACE("Init error: vkCreateCommandPool failed %d: %s.", result, getName(result) );
-					goto error;
-				}
-
-				VkCommandBufferAllocateInfo cbai;
-				cbai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-				cbai.pNext = NULL;
-				cbai.commandPool = m_commandPool;
-				cbai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-				cbai.commandBufferCount = BX_COUNTOF(m_commandBuffers);
+					result = vkCreateSemaphore(m_device, &sci, m_allocatorCb, &m_imageAcquired[ii]);
 
-				result = vkAllocateCommandBuffers(m_device, &cbai, m_commandBuffers);
+					if (VK_SUCCESS == result)
+					{
+						result = vkCreateSemaphore(m_device, &sci, m_allocatorCb, &m_renderDone[ii]);
+					}
 
-				if (VK_SUCCESS != result)
-				{
-					vkDestroy(m_commandPool);
-					vkDestroy(m_fence);
-					BX_TRACE("Init error: vkAllocateCommandBuffers failed %d: %s.", result, getName(result) );
-					goto error;
+					if (VK_SUCCESS != result)
+					{
+						BX_TRACE("Init error: vkCreateSemaphore failed %d: %s.", result, getName(result) );
+						goto error;
+					}
 				}
 
+				m_cmd.init(numFramesInFlight);
+
 				VkCommandBufferBeginInfo cbbi;
 				cbbi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 				cbbi.pNext = NULL;
 				cbbi.flags = 0;
 				cbbi.pInheritanceInfo = NULL;
 
-				VkCommandBuffer commandBuffer = m_commandBuffers[0];
+				VkCommandBuffer commandBuffer = m_cmd.alloc();
 				VK_CHECK(vkBeginCommandBuffer(commandBuffer, &cbbi) );
 
 				VkRenderPassBeginInfo rpbi;
@@ -1804,10 +1796,8 @@ VK_IMPORT_DEVICE
 				VK_CHECK(vkEndCommandBuffer(commandBuffer) );
 				m_backBufferColorIdx = 0;
 
-				kick();
-				finishAll();
-
-				VK_CHECK(vkResetCommandPool(m_device, m_commandPool, 0) );
+				m_cmd.kick(VK_NULL_HANDLE, VK_NULL_HANDLE);
+				m_cmd.finish();
 			}
 
 			errorState = ErrorState::CommandBuffersCreated;
@@ -1816,15 +1806,15 @@ VK_IMPORT_DEVICE
 				VkDescriptorPoolSize dps[] =
 				{
 //					{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, BGFX_CONFIG_MAX_TEXTURE_SAMPLERS },
-					{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         10<<10                           },
+					{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 10<<10                           },
 //					{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         BGFX_CONFIG_MAX_TEXTURE_SAMPLERS },
 				};
 
 				VkDescriptorSetLayoutBinding dslb[] =
 				{
 //					{ DslBinding::CombinedImageSampler,  VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, BGFX_CONFIG_MAX_TEXTURE_SAMPLERS, VK_SHADER_STAGE_ALL,          NULL },
-					{ DslBinding::VertexUniformBuffer,   VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         1,                                VK_SHADER_STAGE_ALL,          NULL },
-					{ DslBinding::FragmentUniformBuffer, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,         1,                                VK_SHADER_STAGE_FRAGMENT_BIT, NULL },
+					{ DslBinding::VertexUniformBuffer,   VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1,                                VK_SHADER_STAGE_ALL,          NULL },
+					{ DslBinding::FragmentUniformBuffer, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1,                                VK_SHADER_STAGE_FRAGMENT_BIT, NULL },
 //					{ DslBinding::StorageBuffer,         VK_DESCRIPTOR_TYPE_STORAGE_BUFFER,         BGFX_CONFIG_MAX_TEXTURE_SAMPLERS, VK_SHADER_STAGE_ALL,          NULL },
 				};
 
@@ -1874,26 +1864,73 @@ VK_IMPORT_DEVICE
 					goto error;
 				}
 
+				bx::HashMurmur2A murmur;
+				murmur.begin();
+				murmur.add(m_deviceProperties.vendorID);
+				murmur.add(m_deviceProperties.deviceID);
+				murmur.add(m_deviceProperties.driverVersion);
+				murmur.add(m_deviceProperties.pipelineCacheUUID, VK_UUID_SIZE);
+				m_pipelineCacheId = uint64_t(murmur.end() ) << 32;
+
+				void* cachedData = NULL;
+
 				VkPipelineCacheCreateInfo pcci;
 				pcci.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
 				pcci.pNext = NULL;
 				pcci.flags = 0;
 				pcci.initialDataSize = 0;
 				pcci.pInitialData    = NULL;
+
+				uint32_t length = g_callback->cacheReadSize(m_pipelineCacheId);
+				if (0 < length)
+				{
+					cachedData = BX_ALLOC(g_allocator, length);
+					if (g_callback->cacheRead(m_pipelineCacheId, cachedData, length) )
+					{
+						BX_TRACE("Loading cached pipeline cache (size %d).", length);
+						pcci.initialDataSize = length;
+						pcci.pInitialData    = cachedData;
+					}
+				}
+
 				result = vkCreatePipelineCache(m_device, &pcci, m_allocatorCb, &m_pipelineCache);
 
+				if (VK_SUCCESS != result
+				&&  NULL != pcci.pInitialData)
+				{
+					BX_TRACE("Cached pipeline cache is invalid, ignoring it.");
+					pcci.initialDataSize = 0;
+					pcci.pInitialData    = NULL;
+					result = vkCreatePipelineCache(m_device, &pcci, m_allocatorCb, &m_pipelineCache);
+				}
+
+				if (NULL != cachedData)
+				{
+					BX_FREE(g_allocator, cachedData);
+				}
+
 				if (VK_SUCCESS != result)
 				{
 					BX_TRACE("Init error: vkCreatePipelineCache failed %d: %s.", result, getName(result) );
 					goto error;
 				}
+
+				loadPipelineKeys();
 			}
 
-			for (uint32_t ii = 0; ii < BX_COUNTOF(m_scratchBuffer); ++ii)
+			m_pipelineCompiler.init(BGFX_CONFIG_MAX_PIPELINE_COMPILE_THREADS);
+			m_commandRecorder.init(BGFX_CONFIG_MAX_RECORD_THREADS);
+
+			for (uint32_t ii = 0; ii < m_cmd.m_numFramesInFlight; ++ii)
 			{
-				m_scratchBuffer[ii].create(BGFX_CONFIG_MAX_DRAW_CALLS*1024
-					, 1024 //BGFX_CONFIG_MAX_TEXTURES + BGFX_CONFIG_MAX_SHADERS + BGFX_CONFIG_MAX_DRAW_CALLS
-					);
+				m_scratchBuffer[ii].create(BGFX_CONFIG_MAX_DRAW_CALLS*1024);
+			}
+
+			m_stagingBuffer.create(BGFX_CONFIG_STAGING_BUFFER_SIZE);
+
+			if (m_readBackSupport)
+			{
+				m_readBack.create();
 			}
 
 			errorState = ErrorState::DescriptorCreated;
@@ -1935,12 +1972,16 @@ VK_IMPORT_DEVICE
 				BX_FALLTHROUGH;
 
 			case ErrorState::CommandBuffersCreated:
-				vkFreeCommandBuffers(m_device, m_commandPool, BX_COUNTOF(m_commandBuffers), m_commandBuffers);
-				vkDestroy(m_commandPool);
-				vkDestroy(m_fence);
+				m_cmd.shutdown();
 				BX_FALLTHROUGH;
 
 			case ErrorState::SwapchainCreated:
+				for (uint32_t ii = 0; ii < BX_COUNTOF(m_imageAcquired); ++ii)
+				{
+					vkDestroy(m_imageAcquired[ii]);
+					vkDestroy(m_renderDone[ii]);
+				}
+
 				for (uint32_t ii = 0; ii < BX_COUNTOF(m_backBufferColorImageView); ++ii)
 				{
 					if (VK_NULL_HANDLE != m_backBufferColorImageView[ii])
@@ -1952,11 +1993,6 @@ VK_IMPORT_DEVICE
 					{
 						vkDestroy(m_backBufferColor[ii]);
 					}
-
-					if (VK_NULL_HANDLE != m_presentDone[ii])
-					{
-						vkDestroy(m_presentDone[ii]);
-					}
 				}
 				vkDestroy(m_swapchain);
 				BX_FALLTHROUGH;
@@ -2002,9 +2038,23 @@ VK_IMPORT_DEVICE
 			VK_CHECK(vkQueueWaitIdle(m_queueGraphics) );
 			VK_CHECK(vkDeviceWaitIdle(m_device) );
 
+			captureFinish();
+
+			if (m_readBackSupport)
+			{
+				m_readBack.destroy();
+			}
+
+			m_stagingBuffer.destroy();
+
+			m_commandRecorder.shutdown();
+			m_pipelineCompiler.shutdown();
+			savePipelineCache();
+
 			m_pipelineStateCache.invalidate();
+			m_descriptorSetCache.invalidate();
 
-			for (uint32_t ii = 0; ii < BX_COUNTOF(m_scratchBuffer); ++ii)
+			for (uint32_t ii = 0; ii < m_cmd.m_numFramesInFlight; ++ii)
 			{
 				m_scratchBuffer[ii].destroy();
 			}
@@ -2034,14 +2084,18 @@ VK_IMPORT_DEVICE
 				m_textures[ii].destroy();
 			}
 
+			m_cmd.shutdown();
+
 			vkDestroy(m_pipelineCache);
 			vkDestroy(m_pipelineLayout);
 			vkDestroy(m_descriptorSetLayout);
 			vkDestroy(m_descriptorPool);
 
-			vkFreeCommandBuffers(m_device, m_commandPool, BX_COUNTOF(m_commandBuffers), m_commandBuffers);
-			vkDestroy(m_commandPool);
-			vkDestroy(m_fence);
+			for (uint32_t ii = 0; ii < BX_COUNTOF(m_imageAcquired); ++ii)
+			{
+				vkDestroy(m_imageAcquired[ii]);
+				vkDestroy(m_renderDone[ii]);
+			}
 
 			for (uint32_t ii = 0; ii < BX_COUNTOF(m_backBufferColorImageView); ++ii)
 			{
@@ -2054,11 +2108,6 @@ VK_IMPORT_DEVICE
 				{
 					vkDestroy(m_backBufferColor[ii]);
 				}
-
-				if (VK_NULL_HANDLE != m_presentDone[ii])
-				{
-					vkDestroy(m_presentDone[ii]);
-				}
 			}
 			vkDestroy(m_swapchain);
 
@@ -2102,18 +2151,21 @@ VK_IMPORT_DEVICE
 
 		void flip() override
 		{
-			if (VK_NULL_HANDLE != m_swapchain)
+			if (VK_NULL_HANDLE != m_swapchain
+			&&  UINT32_MAX != m_presentFrame)
 			{
 				VkPresentInfoKHR pi;
 				pi.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
 				pi.pNext = NULL;
-				pi.waitSemaphoreCount = 0;
-				pi.pWaitSemaphores    = NULL; //&m_presentDone[0];
+				pi.waitSemaphoreCount = 1;
+				pi.pWaitSemaphores    = &m_renderDone[m_presentFrame];
 				pi.swapchainCount = 1;
 				pi.pSwapchains    = &m_swapchain;
 				pi.pImageIndices  = &m_backBufferColorIdx;
 				pi.pResults       = NULL;
 				VK_CHECK(vkQueuePresentKHR(m_queueGraphics, &pi) );
+
+				m_presentFrame = UINT32_MAX;
 			}
 		}
 
@@ -2155,8 +2207,7 @@ VK_IMPORT_DEVICE
 
 		void updateDynamicIndexBuffer(IndexBufferHandle _handle, uint32_t _offset, uint32_t _size, const Memory* _mem) override
 		{
-			BX_UNUSED(_handle, _offset, _size, _mem);
-//			m_indexBuffers[_handle.idx].update(m_commandBuffer, _offset, bx::min<uint32_t>(_size, _mem->size), _mem->data);
+			m_indexBuffers[_handle.idx].update(_offset, bx::min<uint32_t>(_size, _mem->size), _mem->data);
 		}
 
 		void destroyDynamicIndexBuffer(IndexBufferHandle _handle) override
@@ -2172,8 +2223,7 @@ VK_IMPORT_DEVICE
 
 		void updateDynamicVertexBuffer(VertexBufferHandle _handle, uint32_t _offset, uint32_t _size, const Memory* _mem) override
 		{
-			BX_UNUSED(_handle, _offset, _size, _mem);
-//			m_vertexBuffers[_handle.idx].update(m_commandBuffer, _offset, bx::min<uint32_t>(_size, _mem->size), _mem->data);
+			m_vertexBuffers[_handle.idx].update(_offset, bx::min<uint32_t>(_size, _mem->size), _mem->data);
 		}
 
 		void destroyDynamicVertexBuffer(VertexBufferHandle _handle) override
@@ -2188,16 +2238,19 @@ VK_IMPORT_DEVICE
 
 		void destroyShader(ShaderHandle _handle) override
 		{
+			m_pipelineCompiler.update(true);
 			m_shaders[_handle.idx].destroy();
 		}
 
 		void createProgram(ProgramHandle _handle, ShaderHandle _vsh, ShaderHandle _fsh) override
 		{
 			m_program[_handle.idx].create(&m_shaders[_vsh.idx], isValid(_fsh) ? &m_shaders[_fsh.idx] : NULL);
+			warmUpPipelines(m_program[_handle.idx]);
 		}
 
 		void destroyProgram(ProgramHandle _handle) override
 		{
+			m_pipelineCompiler.update(true);
 			m_program[_handle.idx].destroy();
 		}
 
@@ -2271,8 +2324,23 @@ VK_IMPORT_DEVICE
 			m_uniforms[_handle.idx] = NULL;
 		}
 
-		void requestScreenShot(FrameBufferHandle /*_handle*/, const char* /*_filePath*/) override
+		void requestScreenShot(FrameBufferHandle _handle, const char* _filePath) override
 		{
+			if (isValid(_handle)
+			||  !m_readBackSupport)
+			{
+				BX_TRACE("Screen shot is not supported.");
+				return;
+			}
+
+			m_readBack.read(m_backBufferColorImage[m_backBufferColorIdx]
+				, ReadBackVK::Kind::ScreenShot
+				, m_sci.imageExtent.width
+				, m_sci.imageExtent.height
+				, m_sci.imageFormat
+				, 0
+				, _filePath
+				);
 		}
 
 		void updateViewName(ViewId _id, const char* _name) override
@@ -2364,6 +2432,7 @@ VK_IMPORT_DEVICE
 
 			if (m_depthClamp != depthClamp)
 			{
+				m_pipelineCompiler.update(true);
 				m_depthClamp = depthClamp;
 				m_pipelineStateCache.invalidate();
 			}
@@ -2384,6 +2453,8 @@ VK_IMPORT_DEVICE
 				m_textVideoMem.resize(false, _resolution.width, _resolution.height);
 				m_textVideoMem.clear();
 
+				updateCapture();
+
 #if 1
 				BX_UNUSED(resize);
 #else
@@ -2428,6 +2499,57 @@ VK_IMPORT_DEVICE
 			}
 		}
 
+		void updateCapture()
+		{
+			if (m_readBackSupport)
+			{
+				m_readBack.resolve(true);
+			}
+
+			if (0 != (m_resolution.reset&BGFX_RESET_CAPTURE)
+			&&  m_readBackSupport)
+			{
+				if (!m_capture)
+				{
+					m_capture = true;
+					g_callback->captureBegin(m_sci.imageExtent.width
+						, m_sci.imageExtent.height
+						, m_sci.imageExtent.width*4
+						, TextureFormat::BGRA8
+						, false
+						);
+				}
+			}
+			else
+			{
+				captureFinish();
+			}
+		}
+
+		void capture(uint32_t _frame)
+		{
+			if (m_capture)
+			{
+				m_readBack.read(m_backBufferColorImage[m_backBufferColorIdx]
+					, ReadBackVK::Kind::Capture
+					, m_sci.imageExtent.width
+					, m_sci.imageExtent.height
+					, m_sci.imageFormat
+					, _frame
+					);
+			}
+		}
+
+		void captureFinish()
+		{
+			if (m_capture)
+			{
+				m_readBack.resolve(true);
+				g_callback->captureEnd();
+				m_capture = false;
+			}
+		}
+
 		void setShaderUniform(uint8_t _flags, uint32_t _regIndex, const void* _val, uint32_t _numRegs)
 		{
 			BX_UNUSED(_flags, _regIndex, _val, _numRegs);
@@ -2453,7 +2575,7 @@ VK_IMPORT_DEVICE
 			setShaderUniform(_flags, _regIndex, _val, _numRegs);
 		}
 
-		void commitShaderUniforms(VkCommandBuffer _commandBuffer, ProgramHandle _program)
+		void commitShaderUniforms(ProgramHandle _program, VkDescriptorSet& _descriptorSet, uint32_t _offset[2])
 		{
 			const ProgramVK& program = m_program[_program.idx];
 
@@ -2464,9 +2586,10 @@ VK_IMPORT_DEVICE
 
 			if (0 < total)
 			{
-				ScratchBufferVK& sb = m_scratchBuffer[m_backBufferColorIdx];
+				ScratchBufferVK& sb = m_scratchBuffer[m_cmd.m_currentFrame];
 
-				uint8_t* data = (uint8_t*)sb.allocUbv(vsize, fsize);
+				uint8_t* data;
+				_descriptorSet = sb.allocUbv(vsize, fsize, _offset, (void**)&data);
 
 				bx::memCopy(data, m_vsScratch, program.m_vsh->m_size);
 				data += vsize;
@@ -2475,16 +2598,6 @@ VK_IMPORT_DEVICE
 				{
 					bx::memCopy(data, m_fsScratch, program.m_fsh->m_size);
 				}
-
-				vkCmdBindDescriptorSets(_commandBuffer
-					, VK_PIPELINE_BIND_POINT_GRAPHICS
-					, m_pipelineLayout
-					, 0
-					, 1
-					, &sb.m_descriptorSet[sb.m_currentDs - 1]
-					, 0
-					, NULL
-					);
 			}
 
 			m_vsChanges = 0;
@@ -2773,11 +2886,55 @@ VK_IMPORT_DEVICE
 			return VK_NULL_HANDLE;
 		}
 
+		uint32_t getPipelineHash(const PipelineKeyVK& _key, const ShaderVK* _vsh, const ShaderVK* _fsh) const
+		{
+			VertexDecl decl;
+			bx::memCopy(&decl, &_key.m_decl, sizeof(VertexDecl) );
+			const uint16_t* attrMask = _vsh->m_attrMask;
+
+			for (uint32_t ii = 0; ii < Attrib::Count; ++ii)
+			{
+				uint16_t mask = attrMask[ii];
+				uint16_t attr = (decl.m_attributes[ii] & mask);
+				decl.m_attributes[ii] = attr == 0 ? UINT16_MAX : attr == UINT16_MAX ? 0 : attr;
+			}
+
+			bx::HashMurmur2A murmur;
+			murmur.begin();
+			murmur.add(_key.m_state);
+			murmur.add(_key.m_stencil);
+			murmur.add(_vsh->m_hash);
+			murmur.add(_vsh->m_attrMask, sizeof(_vsh->m_attrMask) );
+			murmur.add(_fsh->m_hash);
+			murmur.add(_key.m_decl.m_hash);
+			murmur.add(decl.m_attributes, sizeof(decl.m_attributes) );
+			murmur.add(_key.m_colorFormat);
+			murmur.add(_key.m_depthFormat);
+			murmur.add(_key.m_numInstanceData);
+			return murmur.end();
+		}
+
+		static uint32_t getPipelineKeyHash(const PipelineKeyVK& _key)
+		{
+			bx::HashMurmur2A murmur;
+			murmur.begin();
+			murmur.add(_key.m_state);
+			murmur.add(_key.m_stencil);
+			murmur.add(_key.m_vshHash);
+			murmur.add(_key.m_fshHash);
+			murmur.add(_key.m_decl.m_hash);
+			murmur.add(_key.m_colorFormat);
+			murmur.add(_key.m_depthFormat);
+			murmur.add(_key.m_numInstanceData);
+			return murmur.end();
+		}
+
 		VkPipeline getPipeline(uint64_t _state, uint64_t _stencil, uint16_t _declIdx, ProgramHandle _program, uint8_t _numInstanceData)
 		{
-			ProgramVK& program = m_program[_program.idx];
+			const ProgramVK& program = m_program[_program.idx];
 
-			_state &= 0
+			PipelineCompilerVK::Job job;
+			job.m_key.m_state = _state & (0
 				| BGFX_STATE_WRITE_RGB
 				| BGFX_STATE_WRITE_A
 				| BGFX_STATE_WRITE_Z
@@ -2791,58 +2948,182 @@ VK_IMPORT_DEVICE
 				| BGFX_STATE_LINEAA
 				| BGFX_STATE_CONSERVATIVE_RASTER
 				| BGFX_STATE_PT_MASK
-				;
+				);
+			job.m_key.m_stencil = _stencil & packStencil(~BGFX_STENCIL_FUNC_REF_MASK, ~BGFX_STENCIL_FUNC_REF_MASK);
+			job.m_key.m_vshHash = program.m_vsh->m_hash;
+			job.m_key.m_fshHash = program.m_fsh->m_hash;
+			bx::memCopy(&job.m_key.m_decl, &m_vertexDecls[_declIdx], sizeof(VertexDecl) );
+			job.m_key.m_colorFormat = m_sci.imageFormat;
+			job.m_key.m_depthFormat = m_backBufferDepthStencilFormat;
+			job.m_key.m_numInstanceData = _numInstanceData;
+			job.m_vsh  = program.m_vsh;
+			job.m_fsh  = program.m_fsh;
+			job.m_hash = getPipelineHash(job.m_key, job.m_vsh, job.m_fsh);
+
+			VkPipeline pipeline = m_pipelineStateCache.find(job.m_hash);
 
-			_stencil &= packStencil(~BGFX_STENCIL_FUNC_REF_MASK, ~BGFX_STENCIL_FUNC_REF_MASK);
+			if (VK_NULL_HANDLE != pipeline)
+			{
+				return pipeline;
+			}
 
-			VertexDecl decl;
-			bx::memCopy(&decl, &m_vertexDecls[_declIdx], sizeof(VertexDecl) );
-			const uint16_t* attrMask = program.m_vsh->m_attrMask;
+			m_pipelineKeys.insert(stl::make_pair(getPipelineKeyHash(job.m_key), job.m_key) );
 
-			for (uint32_t ii = 0; ii < Attrib::Count; ++ii)
+			if (0 < m_pipelineCompiler.getNumThreads() )
 			{
-				uint16_t mask = attrMask[ii];
-				uint16_t attr = (decl.m_attributes[ii] & mask);
-				decl.m_attributes[ii] = attr == 0 ? UINT16_MAX : attr == UINT16_MAX ? 0 : attr;
+				// Draws using this pipeline are skipped until it's compiled.
+				if (!m_pipelineCompiler.isPending(job.m_hash) )
+				{
+					m_pipelineCompiler.compile(job);
+				}
+
+				return VK_NULL_HANDLE;
 			}
 
-			bx::HashMurmur2A murmur;
-			murmur.begin();
-			murmur.add(_state);
-			murmur.add(_stencil);
-			murmur.add(program.m_vsh->m_hash);
-			murmur.add(program.m_vsh->m_attrMask, sizeof(program.m_vsh->m_attrMask) );
-			murmur.add(program.m_fsh->m_hash);
-			murmur.add(m_vertexDecls[_declIdx].m_hash);
-			murmur.add(decl.m_attributes, sizeof(decl.m_attributes) );
-			murmur.add(m_fbh.idx);
-			murmur.add(_numInstanceData);
-			const uint32_t hash = murmur.end();
+			pipeline = createPipeline(job);
+			m_pipelineStateCache.add(job.m_hash, pipeline);
 
-			VkPipeline pipeline = m_pipelineStateCache.find(hash);
+			return pipeline;
+		}
 
-			if (VK_NULL_HANDLE != pipeline)
+		void warmUpPipelines(const ProgramVK& _program)
+		{
+			if (NULL == _program.m_fsh)
 			{
-				return pipeline;
+				return;
+			}
+
+			for (PipelineKeyMap::const_iterator it = m_pipelineKeys.begin(), itEnd = m_pipelineKeys.end(); it != itEnd; ++it)
+			{
+				const PipelineKeyVK& key = it->second;
+
+				if (key.m_vshHash == _program.m_vsh->m_hash
+				&&  key.m_fshHash == _program.m_fsh->m_hash)
+				{
+					PipelineCompilerVK::Job job;
+					job.m_key  = key;
+					job.m_vsh  = _program.m_vsh;
+					job.m_fsh  = _program.m_fsh;
+					job.m_hash = getPipelineHash(key, job.m_vsh, job.m_fsh);
+
+					if (VK_NULL_HANDLE == m_pipelineStateCache.find(job.m_hash)
+					&&  !m_pipelineCompiler.isPending(job.m_hash) )
+					{
+						if (0 < m_pipelineCompiler.getNumThreads() )
+						{
+							m_pipelineCompiler.compile(job);
+						}
+						else
+						{
+							m_pipelineStateCache.add(job.m_hash, createPipeline(job) );
+						}
+					}
+				}
+			}
+		}
+
+		struct PipelineKeysHeader
+		{
+			uint32_t m_magic;
+			uint32_t m_keySize;
+			uint32_t m_num;
+		};
+
+		void loadPipelineKeys()
+		{
+			const uint64_t id = m_pipelineCacheId | 1;
+
+			uint32_t length = g_callback->cacheReadSize(id);
+			if (sizeof(PipelineKeysHeader) > length)
+			{
+				return;
+			}
+
+			uint8_t* data = (uint8_t*)BX_ALLOC(g_allocator, length);
+			if (g_callback->cacheRead(id, data, length) )
+			{
+				PipelineKeysHeader header;
+				bx::memCopy(&header, data, sizeof(header) );
+
+				if (BX_MAKEFOURCC('V', 'K', 'P', 'K') == header.m_magic
+				&&  sizeof(PipelineKeyVK) == header.m_keySize
+				&&  sizeof(PipelineKeysHeader) + header.m_num*sizeof(PipelineKeyVK) <= length)
+				{
+					BX_TRACE("Loaded %d pipeline keys for warm up.", header.m_num);
+
+					const uint8_t* keys = &data[sizeof(header)];
+					for (uint32_t ii = 0; ii < header.m_num; ++ii)
+					{
+						PipelineKeyVK key;
+						bx::memCopy(&key, &keys[ii*sizeof(PipelineKeyVK)], sizeof(PipelineKeyVK) );
+						m_pipelineKeys.insert(stl::make_pair(getPipelineKeyHash(key), key) );
+					}
+				}
+			}
+
+			BX_FREE(g_allocator, data);
+		}
+
+		void savePipelineCache()
+		{
+			size_t dataSize;
+			VK_CHECK(vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, NULL) );
+
+			if (0 < dataSize)
+			{
+				void* data = BX_ALLOC(g_allocator, dataSize);
+				VK_CHECK(vkGetPipelineCacheData(m_device, m_pipelineCache, &dataSize, data) );
+				g_callback->cacheWrite(m_pipelineCacheId, data, uint32_t(dataSize) );
+				BX_FREE(g_allocator, data);
+			}
+
+			const uint32_t num  = uint32_t(m_pipelineKeys.size() );
+			const uint32_t size = uint32_t(sizeof(PipelineKeysHeader) + num*sizeof(PipelineKeyVK) );
+			uint8_t* data = (uint8_t*)BX_ALLOC(g_allocator, size);
+
+			PipelineKeysHeader header;
+			header.m_magic   = BX_MAKEFOURCC('V', 'K', 'P', 'K');
+			header.m_keySize = sizeof(PipelineKeyVK);
+			header.m_num     = num;
+			bx::memCopy(data, &header, sizeof(header) );
+
+			uint8_t* keys = &data[sizeof(header)];
+			for (PipelineKeyMap::const_iterator it = m_pipelineKeys.begin(), itEnd = m_pipelineKeys.end(); it != itEnd; ++it)
+			{
+				bx::memCopy(keys, &it->second, sizeof(PipelineKeyVK) );
+				keys += sizeof(PipelineKeyVK);
 			}
 
+			g_callback->cacheWrite(m_pipelineCacheId | 1, data, size);
+			BX_FREE(g_allocator, data);
+		}
+
+		VkPipeline createPipeline(const PipelineCompilerVK::Job& _job)
+		{
+			const uint64_t state   = _job.m_key.m_state;
+			const uint64_t stencil = _job.m_key.m_stencil;
+
+			ProgramVK program;
+			program.m_vsh = _job.m_vsh;
+			program.m_fsh = _job.m_fsh;
+
 			VkPipelineColorBlendAttachmentState blendAttachmentState[BGFX_CONFIG_MAX_FRAME_BUFFER_ATTACHMENTS];
 			VkPipelineColorBlendStateCreateInfo colorBlendState;
 			colorBlendState.pAttachments = blendAttachmentState;
-			setBlendState(colorBlendState, _state);
+			setBlendState(colorBlendState, state);
 
 			VkPipelineInputAssemblyStateCreateInfo inputAssemblyState;
 			inputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
 			inputAssemblyState.pNext = NULL;
 			inputAssemblyState.flags = 0;
-			inputAssemblyState.topology = s_primInfo[(_state&BGFX_STATE_PT_MASK) >> BGFX_STATE_PT_SHIFT].m_topology;
+			inputAssemblyState.topology = s_primInfo[(state&BGFX_STATE_PT_MASK) >> BGFX_STATE_PT_SHIFT].m_topology;
 			inputAssemblyState.primitiveRestartEnable = VK_FALSE;
 
 			VkPipelineRasterizationStateCreateInfo rasterizationState;
-			setRasterizerState(rasterizationState, _state);
+			setRasterizerState(rasterizationState, state);
 
 			VkPipelineDepthStencilStateCreateInfo depthStencilState;
-			setDepthStencilState(depthStencilState, _state, _stencil);
+			setDepthStencilState(depthStencilState, state, stencil);
 
 			VkVertexInputBindingDescription  inputBinding[Attrib::Count + 1 + BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT];
 			VkVertexInputAttributeDescription inputAttrib[Attrib::Count + 1 + BGFX_CONFIG_MAX_INSTANCE_DATA_COUNT];
@@ -2850,7 +3131,7 @@ VK_IMPORT_DEVICE
 			VkPipelineVertexInputStateCreateInfo vertexInputState;
 			vertexInputState.pVertexBindingDescriptions   = inputBinding;
 			vertexInputState.pVertexAttributeDescriptions = inputAttrib;
-			setInputLayout(vertexInputState, m_vertexDecls[_declIdx], program, _numInstanceData);
+			setInputLayout(vertexInputState, _job.m_key.m_decl, program, _job.m_key.m_numInstanceData);
 
 			const VkDynamicState dynamicStates[] =
 			{
@@ -2897,9 +3178,9 @@ VK_IMPORT_DEVICE
 			multisampleState.flags = 0;
 			multisampleState.rasterizationSamples  = VK_SAMPLE_COUNT_1_BIT;
 			multisampleState.sampleShadingEnable   = VK_FALSE;
-			multisampleState.minSampleShading      = !!(BGFX_STATE_CONSERVATIVE_RASTER & _state) ? 1.0f : 0.0f;
+			multisampleState.minSampleShading      = !!(BGFX_STATE_CONSERVATIVE_RASTER & state) ? 1.0f : 0.0f;
 			multisampleState.pSampleMask           = NULL;
-			multisampleState.alphaToCoverageEnable = !!(BGFX_STATE_BLEND_ALPHA_TO_COVERAGE & _state);
+			multisampleState.alphaToCoverageEnable = !!(BGFX_STATE_BLEND_ALPHA_TO_COVERAGE & state);
 			multisampleState.alphaToOneEnable      = VK_FALSE;
 
 			VkGraphicsPipelineCreateInfo graphicsPipeline;
@@ -2923,63 +3204,14 @@ VK_IMPORT_DEVICE
 			graphicsPipeline.basePipelineHandle = VK_NULL_HANDLE;
 			graphicsPipeline.basePipelineIndex  = 0;
 
-			uint32_t length = g_callback->cacheReadSize(hash);
-			bool cached = length > 0;
-
-			void* cachedData = NULL;
-
-			VkPipelineCacheCreateInfo pcci;
-			pcci.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
-			pcci.pNext = NULL;
-			pcci.flags = 0;
-			pcci.initialDataSize = 0;
-			pcci.pInitialData    = NULL;
-
-			if (cached)
-			{
-				cachedData = BX_ALLOC(g_allocator, length);
-				if (g_callback->cacheRead(hash, cachedData, length) )
-				{
-					BX_TRACE("Loading cached pipeline state (size %d).", length);
-					bx::MemoryReader reader(cachedData, length);
-
-					pcci.initialDataSize = (size_t)reader.remaining();
-					pcci.pInitialData    = reader.getDataPtr();
-				}
-			}
-
-			VkPipelineCache cache;
-			VK_CHECK(vkCreatePipelineCache(m_device, &pcci, m_allocatorCb, &cache) );
-
+			VkPipeline pipeline;
 			VK_CHECK(vkCreateGraphicsPipelines(m_device
-				, cache
+				, m_pipelineCache
 				, 1
 				, &graphicsPipeline
 				, m_allocatorCb
 				, &pipeline
 				) );
-			m_pipelineStateCache.add(hash, pipeline);
-
-			size_t dataSize;
-			VK_CHECK(vkGetPipelineCacheData(m_device, cache, &dataSize, NULL) );
-
-			if (0 < dataSize)
-			{
-				if (length < dataSize)
-				{
-					cachedData = BX_REALLOC(g_allocator, cachedData, dataSize);
-				}
-				VK_CHECK(vkGetPipelineCacheData(m_device, cache, &dataSize, cachedData) );
-				g_callback->cacheWrite(hash, cachedData, (uint32_t)dataSize);
-			}
-
-			VK_CHECK(vkMergePipelineCaches(m_device, m_pipelineCache, 1, &cache) );
-			vkDestroy(cache);
-
-			if (NULL != cachedData)
-			{
-				BX_FREE(g_allocator, cachedData);
-			}
 
 			return pipeline;
 		}
@@ -3064,15 +3296,15 @@ VK_IMPORT_DEVICE
 			}
 		}
 
-		void clearQuad(const Rect& _rect, const Clear& _clear, const float _palette[][4])
+		void clearQuad(RecordRangeVK& _range, const Rect& _rect, const Clear& _clear, const float _palette[][4])
 		{
-			VkClearRect rect[1];
-			rect[0].rect.offset.x      = _rect.m_x;
-			rect[0].rect.offset.y      = _rect.m_y;
-			rect[0].rect.extent.width  = _rect.m_width;
-			rect[0].rect.extent.height = _rect.m_height;
-			rect[0].baseArrayLayer = 0;
-			rect[0].layerCount     = 1;
+			VkClearRect& rect = _range.m_clearRect;
+			rect.rect.offset.x      = _rect.m_x;
+			rect.rect.offset.y      = _rect.m_y;
+			rect.rect.extent.width  = _rect.m_width;
+			rect.rect.extent.height = _rect.m_height;
+			rect.baseArrayLayer = 0;
+			rect.layerCount     = 1;
 
 			uint32_t numMrt = 1;
 //			FrameBufferHandle fbh = m_fbh;
@@ -3082,7 +3314,7 @@ VK_IMPORT_DEVICE
 //				numMrt = bx::max(1, fb.m_num);
 //			}
 
-			VkClearAttachment attachments[BGFX_CONFIG_MAX_FRAME_BUFFERS];
+			VkClearAttachment* attachments = _range.m_clearAttachment;
 			uint32_t mrt = 0;
 
 			if (true //NULL != m_currentColor
@@ -3132,45 +3364,197 @@ VK_IMPORT_DEVICE
 				++mrt;
 			}
 
- 			vkCmdClearAttachments(m_commandBuffer
-				, mrt
-				, attachments
-				, BX_COUNTOF(rect)
-				, rect
-				);
+			_range.m_numClearAttachments = uint8_t(mrt);
 		}
 
-		uint64_t kick(VkSemaphore _wait = VK_NULL_HANDLE, VkSemaphore _signal = VK_NULL_HANDLE)
+		uint32_t addRecordRange(uint16_t _view, const Rect& _rect, const Rect& _scissor)
 		{
-			VkPipelineStageFlags stageFlags = 0
-				| VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT
-				;
-
-			VkSubmitInfo si;
-			si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-			si.pNext = NULL;
-			si.waitSemaphoreCount = VK_NULL_HANDLE != _wait;
-			si.pWaitSemaphores    = &_wait;
-			si.pWaitDstStageMask  = &stageFlags;
-			si.commandBufferCount = 1;
-			si.pCommandBuffers    = &m_commandBuffers[m_backBufferColorIdx];
-			si.signalSemaphoreCount = VK_NULL_HANDLE != _signal;
-			si.pSignalSemaphores    = &_signal;
-
-//			VK_CHECK(vkResetFences(m_device, 1, &m_fence) );
-			VK_CHECK(vkQueueSubmit(m_queueGraphics, 1, &si, VK_NULL_HANDLE) );
-			return 0;
+			RecordRangeVK range;
+			range.m_commandBuffer = VK_NULL_HANDLE;
+			range.m_rect    = _rect;
+			range.m_scissor = _scissor;
+			range.m_first   = uint32_t(m_drawCommands.size() );
+			range.m_num     = 0;
+			range.m_view    = _view;
+			range.m_numClearAttachments = 0;
+			m_recordRanges.push_back(range);
+
+			return uint32_t(m_recordRanges.size() - 1);
 		}
 
-		void finish()
+		void recordRange(const RecordRangeVK& _range)
 		{
-			finishAll();
-		}
+			VkCommandBufferInheritanceInfo cbii;
+			cbii.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+			cbii.pNext = NULL;
+			cbii.renderPass  = m_renderPass;
+			cbii.subpass     = 0;
+			cbii.framebuffer = m_backBufferColor[m_backBufferColorIdx];
+			cbii.occlusionQueryEnable = VK_FALSE;
+			cbii.queryFlags           = 0;
+			cbii.pipelineStatistics   = 0;
+
+			VkCommandBufferBeginInfo cbbi;
+			cbbi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+			cbbi.pNext = NULL;
+			cbbi.flags = 0
+				| VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+				| VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT
+				;
+			cbbi.pInheritanceInfo = &cbii;
+
+			VkCommandBuffer commandBuffer = _range.m_commandBuffer;
+			VK_CHECK(vkBeginCommandBuffer(commandBuffer, &cbbi) );
+
+			VkViewport vp;
+			vp.x        = _range.m_rect.m_x;
+			vp.y        = _range.m_rect.m_y;
+			vp.width    = _range.m_rect.m_width;
+			vp.height   = _range.m_rect.m_height;
+			vp.minDepth = 0.0f;
+			vp.maxDepth = 1.0f;
+			vkCmdSetViewport(commandBuffer, 0, 1, &vp);
+
+			VkRect2D scissor;
+			scissor.offset.x      = _range.m_scissor.m_x;
+			scissor.offset.y      = _range.m_scissor.m_y;
+			scissor.extent.width  = _range.m_scissor.m_width;
+			scissor.extent.height = _range.m_scissor.m_height;
+			vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+
+			if (0 != _range.m_numClearAttachments)
+			{
+				vkCmdClearAttachments(commandBuffer
+					, _range.m_numClearAttachments
+					, _range.m_clearAttachment
+					, 1
+					, &_range.m_clearRect
+					);
+			}
 
-		void finishAll()
-		{
-			VK_CHECK(vkQueueWaitIdle(m_queueGraphics) );
-//			VK_CHECK(vkWaitForFences(m_device, 1, &m_fence, true, INT64_MAX) );
+			// State isn't inherited from primary command buffer, each range
+			// starts with nothing bound.
+			VkPipeline      currentPipeline      = VK_NULL_HANDLE;
+			VkDescriptorSet currentDescriptorSet = VK_NULL_HANDLE;
+			VkBuffer        currentVertexBuffer  = VK_NULL_HANDLE;
+			VkBuffer        currentIndexBuffer   = VK_NULL_HANDLE;
+			VkIndexType     currentIndexType     = VK_INDEX_TYPE_UINT16;
+			uint32_t currentUniformOffset[2] = { 0, 0 };
+			uint64_t currentStencilRef = UINT64_MAX;
+			uint64_t currentRgba       = UINT64_MAX;
+
+			for (uint32_t ii = _range.m_first, end = _range.m_first + _range.m_num; ii < end; ++ii)
+			{
+				const DrawCommandVK& cmd = m_drawCommands[ii];
+
+				if (currentPipeline != cmd.m_pipeline)
+				{
+					currentPipeline = cmd.m_pipeline;
+					vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, currentPipeline);
+				}
+
+				if (currentStencilRef != cmd.m_stencilRef)
+				{
+					currentStencilRef = cmd.m_stencilRef;
+					vkCmdSetStencilReference(commandBuffer, VK_STENCIL_FRONT_AND_BACK, cmd.m_stencilRef);
+				}
+
+				if (currentRgba != cmd.m_rgba)
+				{
+					currentRgba = cmd.m_rgba;
+
+					float bf[4];
+					bf[0] = ( (cmd.m_rgba>>24)     )/255.0f;
+					bf[1] = ( (cmd.m_rgba>>16)&0xff)/255.0f;
+					bf[2] = ( (cmd.m_rgba>> 8)&0xff)/255.0f;
+					bf[3] = ( (cmd.m_rgba    )&0xff)/255.0f;
+					vkCmdSetBlendConstants(commandBuffer, bf);
+				}
+
+				if (0 != bx::memCmp(&scissor, &cmd.m_scissor, sizeof(VkRect2D) ) )
+				{
+					scissor = cmd.m_scissor;
+					vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+				}
+
+				if (VK_NULL_HANDLE != cmd.m_descriptorSet
+				&& (currentDescriptorSet    != cmd.m_descriptorSet
+				||  currentUniformOffset[0] != cmd.m_uniformOffset[0]
+				||  currentUniformOffset[1] != cmd.m_uniformOffset[1]) )
+				{
+					currentDescriptorSet    = cmd.m_descriptorSet;
+					currentUniformOffset[0] = cmd.m_uniformOffset[0];
+					currentUniformOffset[1] = cmd.m_uniformOffset[1];
+
+					vkCmdBindDescriptorSets(commandBuffer
+						, VK_PIPELINE_BIND_POINT_GRAPHICS
+						, m_pipelineLayout
+						, 0
+						, 1
+						, &currentDescriptorSet
+						, BX_COUNTOF(currentUniformOffset)
+						, currentUniformOffset
+						);
+				}
+
+				if (currentVertexBuffer != cmd.m_vertexBuffer)
+				{
+					currentVertexBuffer = cmd.m_vertexBuffer;
+
+					VkDeviceSize offset = 0;
+					vkCmdBindVertexBuffers(commandBuffer
+						, 0
+						, 1
+						, &currentVertexBuffer
+						, &offset
+						);
+				}
+
+				if (VK_NULL_HANDLE == cmd.m_indexBuffer)
+				{
+					vkCmdDraw(commandBuffer
+						, cmd.m_numVertices
+						, cmd.m_numInstances
+						, cmd.m_startVertex
+						, 0
+						);
+				}
+				else
+				{
+					if (currentIndexBuffer != cmd.m_indexBuffer
+					||  currentIndexType   != cmd.m_indexType)
+					{
+						currentIndexBuffer = cmd.m_indexBuffer;
+						currentIndexType   = cmd.m_indexType;
+						vkCmdBindIndexBuffer(commandBuffer
+							, currentIndexBuffer
+							, 0
+							, currentIndexType
+							);
+					}
+
+					vkCmdDrawIndexed(commandBuffer
+						, cmd.m_numIndices
+						, cmd.m_numInstances
+						, cmd.m_startIndex
+						, cmd.m_startVertex
+						, 0
+						);
+				}
+			}
+
+			VK_CHECK(vkEndCommandBuffer(commandBuffer) );
+		}
+
+		void finish()
+		{
+			finishAll();
+		}
+
+		void finishAll()
+		{
+			VK_CHECK(vkQueueWaitIdle(m_queueGraphics) );
+			m_cmd.finish();
 		}
 
 		uint32_t selectMemoryType(uint32_t _memoryTypeBits, uint32_t _propertyFlags) const
@@ -3203,7 +3587,6 @@ VK_IMPORT_DEVICE
 		VkImage          m_backBufferColorImage[4];
 		VkImageView      m_backBufferColorImageView[4];
 		VkFramebuffer    m_backBufferColor[4];
-		VkCommandBuffer  m_commandBuffers[4];
 		VkCommandBuffer  m_commandBuffer;
 
 		VkFormat         m_backBufferDepthStencilFormat;
@@ -3211,8 +3594,11 @@ VK_IMPORT_DEVICE
 		VkImage          m_backBufferDepthStencilImage;
 		VkImageView      m_backBufferDepthStencilImageView;
 
-		ScratchBufferVK  m_scratchBuffer[4];
-		VkSemaphore      m_presentDone[4];
+		CommandQueueVK   m_cmd;
+		ScratchBufferVK  m_scratchBuffer[BGFX_CONFIG_MAX_FRAME_LATENCY];
+		StagingBufferVK  m_stagingBuffer;
+		VkSemaphore      m_imageAcquired[BGFX_CONFIG_MAX_FRAME_LATENCY];
+		VkSemaphore      m_renderDone[BGFX_CONFIG_MAX_FRAME_LATENCY];
 
 		uint32_t m_qfiGraphics;
 		uint32_t m_qfiCompute;
@@ -3220,13 +3606,11 @@ VK_IMPORT_DEVICE
 		VkDevice m_device;
 		VkQueue  m_queueGraphics;
 		VkQueue  m_queueCompute;
-		VkFence  m_fence;
 		VkRenderPass m_renderPass;
 		VkDescriptorPool m_descriptorPool;
 		VkDescriptorSetLayout m_descriptorSetLayout;
 		VkPipelineLayout m_pipelineLayout;
 		VkPipelineCache m_pipelineCache;
-		VkCommandPool m_commandPool;
 
 		void* m_renderDocDll;
 		void* m_vulkan1Dll;
@@ -3243,11 +3627,27 @@ VK_IMPORT_DEVICE
 		UniformRegistry m_uniformReg;
 
 		StateCacheT<VkPipeline> m_pipelineStateCache;
+		StateCacheT<VkDescriptorSet> m_descriptorSetCache;
+		PipelineCompilerVK m_pipelineCompiler;
+		CommandRecorderVK m_commandRecorder;
+
+		typedef stl::vector<DrawCommandVK> DrawCommandArray;
+		typedef stl::vector<RecordRangeVK> RecordRangeArray;
+		DrawCommandArray m_drawCommands;
+		RecordRangeArray m_recordRanges;
+
+		typedef stl::unordered_map<uint32_t, PipelineKeyVK> PipelineKeyMap;
+		PipelineKeyMap m_pipelineKeys;
+		uint64_t m_pipelineCacheId;
 
 		Resolution m_resolution;
 		uint32_t m_maxAnisotropy;
 		bool m_depthClamp;
 		bool m_wireframe;
+		bool m_readBackSupport;
+		bool m_capture;
+
+		ReadBackVK m_readBack;
 
 		TextVideoMem m_textVideoMem;
 
@@ -3257,6 +3657,7 @@ VK_IMPORT_DEVICE
 		uint32_t m_vsChanges;
 
 		uint32_t m_backBufferColorIdx;
+		uint32_t m_presentFrame;
 		FrameBufferHandle m_fbh;
 	};
 
@@ -3292,25 +3693,202 @@ VK_IMPORT_DEVICE
 VK_DESTROY
 #undef VK_DESTROY_FUNC
 
-	void ScratchBufferVK::create(uint32_t _size, uint32_t _maxDescriptors)
+	void vkDestroy(VkDescriptorSet& _obj)
 	{
-		m_maxDescriptors = _maxDescriptors;
-		m_descriptorSet  = (VkDescriptorSet*)BX_ALLOC(g_allocator, _maxDescriptors * sizeof(VkDescriptorSet) );
+		if (VK_NULL_HANDLE != _obj)
+		{
+			vkFreeDescriptorSets(s_renderVK->m_device, s_renderVK->m_descriptorPool, 1, &_obj);
+			_obj = VK_NULL_HANDLE;
+		}
+	}
+
+#define VK_DESTROY_FUNC(_name) \
+			static void release##_name(uint64_t _handle) \
+			{ \
+				Vk##_name obj( (::Vk##_name)_handle); \
+				vkDestroy(obj); \
+			} \
+			void vkRelease(Vk##_name& _obj) \
+			{ \
+				if (VK_NULL_HANDLE != _obj) \
+				{ \
+					s_renderVK->m_cmd.release(uint64_t(_obj.vk), release##_name); \
+					_obj = VK_NULL_HANDLE; \
+				} \
+			}
+VK_DESTROY
+#undef VK_DESTROY_FUNC
+
+	static void releaseDescriptorSet(uint64_t _handle)
+	{
+		::VkDescriptorSet obj = (::VkDescriptorSet)_handle;
+		vkDestroy(obj);
+	}
 
+	void vkRelease(VkDescriptorSet& _obj)
+	{
+		if (VK_NULL_HANDLE != _obj)
+		{
+			s_renderVK->m_cmd.release(uint64_t(_obj), releaseDescriptorSet);
+			_obj = VK_NULL_HANDLE;
+		}
+	}
+
+	static void releaseDeviceMemory(uint64_t _handle)
+	{
+		vkFreeMemory(s_renderVK->m_device, (::VkDeviceMemory)_handle, s_renderVK->m_allocatorCb);
+	}
+
+	void vkReleaseMemory(VkDeviceMemory& _obj)
+	{
+		if (VK_NULL_HANDLE != _obj)
+		{
+			s_renderVK->m_cmd.release(uint64_t(_obj), releaseDeviceMemory);
+			_obj = VK_NULL_HANDLE;
+		}
+	}
+
+	void CommandQueueVK::init(uint32_t _numFramesInFlight)
+	{
 		VkAllocationCallbacks* allocatorCb = s_renderVK->m_allocatorCb;
 		VkDevice device = s_renderVK->m_device;
 
-		VkDescriptorSetAllocateInfo dsai;
-		dsai.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
-		dsai.pNext = NULL;
-		dsai.descriptorPool = s_renderVK->m_descriptorPool;
-		dsai.descriptorSetCount = 1;
-		dsai.pSetLayouts        = &s_renderVK->m_descriptorSetLayout;
-		for (uint32_t ii = 0, num = m_maxDescriptors; ii < num; ++ii)
+		m_numFramesInFlight = bx::max<uint32_t>(1, bx::min<uint32_t>(_numFramesInFlight, BGFX_CONFIG_MAX_FRAME_LATENCY) );
+		m_currentFrame      = 0;
+
+		VkCommandPoolCreateInfo cpci;
+		cpci.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cpci.pNext = NULL;
+		cpci.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		cpci.queueFamilyIndex = s_renderVK->m_qfiGraphics;
+
+		VkCommandBufferAllocateInfo cbai;
+		cbai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		cbai.pNext = NULL;
+		cbai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		cbai.commandBufferCount = 1;
+
+		VkFenceCreateInfo fci;
+		fci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fci.pNext = NULL;
+		fci.flags = 0;
+
+		for (uint32_t ii = 0; ii < m_numFramesInFlight; ++ii)
+		{
+			Frame& frame = m_frame[ii];
+
+			VK_CHECK(vkCreateCommandPool(device, &cpci, allocatorCb, &frame.m_commandPool) );
+
+			cbai.commandPool = frame.m_commandPool;
+			VK_CHECK(vkAllocateCommandBuffers(device, &cbai, &frame.m_commandBuffer) );
+
+			VK_CHECK(vkCreateFence(device, &fci, allocatorCb, &frame.m_fence) );
+			frame.m_submitted = false;
+		}
+	}
+
+	void CommandQueueVK::shutdown()
+	{
+		finish();
+		consume(m_release);
+
+		VkDevice device = s_renderVK->m_device;
+
+		for (uint32_t ii = 0; ii < m_numFramesInFlight; ++ii)
+		{
+			Frame& frame = m_frame[ii];
+			vkFreeCommandBuffers(device, frame.m_commandPool, 1, &frame.m_commandBuffer);
+			vkDestroy(frame.m_commandPool);
+			vkDestroy(frame.m_fence);
+		}
+
+		m_numFramesInFlight = 0;
+	}
+
+	VkCommandBuffer CommandQueueVK::alloc()
+	{
+		Frame& frame = m_frame[m_currentFrame];
+		consume(frame);
+
+		VK_CHECK(vkResetCommandPool(s_renderVK->m_device, frame.m_commandPool, 0) );
+
+		return frame.m_commandBuffer;
+	}
+
+	void CommandQueueVK::kick(VkSemaphore _wait, VkSemaphore _signal)
+	{
+		Frame& frame = m_frame[m_currentFrame];
+
+		VkPipelineStageFlags stageFlags = 0
+			| VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT
+			;
+
+		VkSubmitInfo si;
+		si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		si.pNext = NULL;
+		si.waitSemaphoreCount = VK_NULL_HANDLE != _wait;
+		si.pWaitSemaphores    = &_wait;
+		si.pWaitDstStageMask  = &stageFlags;
+		si.commandBufferCount = 1;
+		si.pCommandBuffers    = &frame.m_commandBuffer;
+		si.signalSemaphoreCount = VK_NULL_HANDLE != _signal;
+		si.pSignalSemaphores    = &_signal;
+
+		VK_CHECK(vkQueueSubmit(s_renderVK->m_queueGraphics, 1, &si, frame.m_fence) );
+		frame.m_submitted = true;
+
+		// Everything released so far might be referenced by this or earlier
+		// frames, it's destroyed once this frame's fence is signaled.
+		BX_CHECK(frame.m_release.empty(), "Frame release list must be consumed before kick.");
+		frame.m_release.swap(m_release);
+
+		m_currentFrame = (m_currentFrame + 1) % m_numFramesInFlight;
+	}
+
+	void CommandQueueVK::finish()
+	{
+		for (uint32_t ii = 0; ii < m_numFramesInFlight; ++ii)
+		{
+			consume(m_frame[ii]);
+		}
+	}
+
+	void CommandQueueVK::release(uint64_t _handle, ReleaseFn _fn)
+	{
+		Resource resource;
+		resource.m_handle = _handle;
+		resource.m_fn     = _fn;
+		m_release.push_back(resource);
+	}
+
+	void CommandQueueVK::consume(Frame& _frame)
+	{
+		if (_frame.m_submitted)
+		{
+			VkDevice device = s_renderVK->m_device;
+			VK_CHECK(vkWaitForFences(device, 1, &_frame.m_fence, VK_TRUE, UINT64_MAX) );
+			VK_CHECK(vkResetFences(device, 1, &_frame.m_fence) );
+			_frame.m_submitted = false;
+		}
+
+		consume(_frame.m_release);
+	}
+
+	void CommandQueueVK::consume(ResourceArray& _release)
+	{
+		for (ResourceArray::const_iterator it = _release.begin(), itEnd = _release.end(); it != itEnd; ++it)
 		{
-			VK_CHECK(vkAllocateDescriptorSets(device, &dsai, &m_descriptorSet[ii]) );
+			it->m_fn(it->m_handle);
 		}
 
+		_release.clear();
+	}
+
+	void ScratchBufferVK::create(uint32_t _size)
+	{
+		VkAllocationCallbacks* allocatorCb = s_renderVK->m_allocatorCb;
+		VkDevice device = s_renderVK->m_device;
+
 		VkBufferCreateInfo bci;
 		bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
 		bci.pNext = NULL;
@@ -3362,9 +3940,6 @@ VK_DESTROY
 		VkAllocationCallbacks* allocatorCb = s_renderVK->m_allocatorCb;
 		VkDevice device = s_renderVK->m_device;
 
-		vkFreeDescriptorSets(device, s_renderVK->m_descriptorPool, m_maxDescriptors, m_descriptorSet);
-		BX_FREE(g_allocator, m_descriptorSet);
-
 		vkUnmapMemory(device, m_deviceMem);
 
 		vkDestroy(m_buffer);
@@ -3378,60 +3953,710 @@ VK_DESTROY
 	void ScratchBufferVK::reset(VkDescriptorBufferInfo& /*_descriptorBufferInfo*/)
 	{
 		m_pos = 0;
-		m_currentDs = 0;
 	}
 
-	void* ScratchBufferVK::allocUbv(uint32_t _vsize, uint32_t _fsize)
+	VkDescriptorSet ScratchBufferVK::allocUbv(uint32_t _vsize, uint32_t _fsize, uint32_t _offset[2], void** _data)
 	{
-		VkDescriptorBufferInfo dbi[2];
+		// Uniform buffers are bound as dynamic, descriptor set depends only on
+		// buffer and ranges, and it's shared by all draws using same sizes.
+		// When there is no fragment uniform data, fragment binding aliases
+		// vertex uniform data.
+		const uint32_t frange = 0 != _fsize ? _fsize : _vsize;
 
-		dbi[0].buffer = m_buffer;
-		dbi[0].offset = m_pos;
-		dbi[0].range  = _vsize;
+		bx::HashMurmur2A murmur;
+		murmur.begin();
+		murmur.add(&m_buffer, sizeof(::VkBuffer) );
+		murmur.add(_vsize);
+		murmur.add(frange);
+		const uint32_t hash = murmur.end();
 
-		VkWriteDescriptorSet wds[2];
+		VkDescriptorSet descriptorSet = s_renderVK->m_descriptorSetCache.find(hash);
 
-		wds[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-		wds[0].pNext = NULL;
-		wds[0].dstSet     = m_descriptorSet[m_currentDs];
-		wds[0].dstBinding = DslBinding::VertexUniformBuffer;
-		wds[0].dstArrayElement  = 0;
-		wds[0].descriptorCount  = 1;
-		wds[0].descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-		wds[0].pImageInfo       = NULL;
-		wds[0].pBufferInfo      = &dbi[0];
-		wds[0].pTexelBufferView = NULL;
+		if (VK_NULL_HANDLE == descriptorSet)
+		{
+			VkDevice device = s_renderVK->m_device;
 
-		uint32_t numWds = 1;
+			VkDescriptorSetAllocateInfo dsai;
+			dsai.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+			dsai.pNext = NULL;
+			dsai.descriptorPool = s_renderVK->m_descriptorPool;
+			dsai.descriptorSetCount = 1;
+			dsai.pSetLayouts        = &s_renderVK->m_descriptorSetLayout;
+			VK_CHECK(vkAllocateDescriptorSets(device, &dsai, &descriptorSet) );
+
+			VkDescriptorBufferInfo dbi[2];
+			dbi[0].buffer = m_buffer;
+			dbi[0].offset = 0;
+			dbi[0].range  = _vsize;
 
-		if (0 != _fsize)
-		{
 			dbi[1].buffer = m_buffer;
-			dbi[1].offset = m_pos + _vsize;
-			dbi[1].range  = _fsize;
+			dbi[1].offset = 0;
+			dbi[1].range  = frange;
 
-			wds[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-			wds[1].pNext = NULL;
-			wds[1].dstSet     = m_descriptorSet[m_currentDs];
-			wds[1].dstBinding = DslBinding::FragmentUniformBuffer;
-			wds[1].dstArrayElement  = 0;
-			wds[1].descriptorCount  = 1;
-			wds[1].descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
-			wds[1].pImageInfo       = NULL;
-			wds[1].pBufferInfo      = &dbi[1];
-			wds[1].pTexelBufferView = NULL;
+			VkWriteDescriptorSet wds[2];
+			for (uint32_t ii = 0; ii < BX_COUNTOF(wds); ++ii)
+			{
+				wds[ii].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				wds[ii].pNext = NULL;
+				wds[ii].dstSet     = descriptorSet;
+				wds[ii].dstBinding = 0 == ii
+					? DslBinding::VertexUniformBuffer
+					: DslBinding::FragmentUniformBuffer
+					;
+				wds[ii].dstArrayElement  = 0;
+				wds[ii].descriptorCount  = 1;
+				wds[ii].descriptorType   = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+				wds[ii].pImageInfo       = NULL;
+				wds[ii].pBufferInfo      = &dbi[ii];
+				wds[ii].pTexelBufferView = NULL;
+			}
 
-			++numWds;
-		}
+			vkUpdateDescriptorSets(device, BX_COUNTOF(wds), wds, 0, NULL);
 
-		vkUpdateDescriptorSets(s_renderVK->m_device, numWds, wds, 0, NULL);
+			s_renderVK->m_descriptorSetCache.add(hash, descriptorSet);
+		}
 
-		void* data = &m_data[m_pos];
+		_offset[0] = m_pos;
+		_offset[1] = 0 != _fsize ? m_pos + _vsize : m_pos;
+		*_data = &m_data[m_pos];
 
 		m_pos += _vsize + _fsize;
-		++m_currentDs;
 
-		return data;
+		return descriptorSet;
+	}
+
+	void PipelineCompilerVK::init(uint32_t _numThreads)
+	{
+		m_exit       = false;
+		m_numThreads = bx::min<uint32_t>(_numThreads, BGFX_CONFIG_MAX_PIPELINE_COMPILE_THREADS);
+
+		for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+		{
+			m_thread[ii].init(workerProc, this, 0, "bgfx - vk pipeline compiler");
+		}
+	}
+
+	void PipelineCompilerVK::shutdown()
+	{
+		update(true);
+
+		{
+			bx::MutexScope scope(m_mutex);
+			m_exit = true;
+		}
+
+		m_jobSem.post(m_numThreads);
+
+		for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+		{
+			m_thread[ii].shutdown();
+		}
+
+		m_numThreads = 0;
+	}
+
+	void PipelineCompilerVK::compile(const Job& _job)
+	{
+		m_pending.insert(_job.m_hash);
+
+		{
+			bx::MutexScope scope(m_mutex);
+			m_jobs.push_back(_job);
+		}
+
+		m_jobSem.post();
+	}
+
+	bool PipelineCompilerVK::isPending(uint32_t _hash)
+	{
+		return m_pending.end() != m_pending.find(_hash);
+	}
+
+	void PipelineCompilerVK::update(bool _wait)
+	{
+		while (!m_pending.empty() )
+		{
+			if (_wait)
+			{
+				m_resultSem.wait();
+			}
+
+			{
+				bx::MutexScope scope(m_mutex);
+
+				for (ResultArray::const_iterator it = m_results.begin(), itEnd = m_results.end(); it != itEnd; ++it)
+				{
+					s_renderVK->m_pipelineStateCache.add(it->m_hash, it->m_pipeline);
+					m_pending.erase(it->m_hash);
+				}
+
+				m_results.clear();
+			}
+
+			if (!_wait)
+			{
+				break;
+			}
+		}
+	}
+
+	int32_t PipelineCompilerVK::workerProc(bx::Thread* /*_self*/, void* _userData)
+	{
+		return ( (PipelineCompilerVK*)_userData)->worker();
+	}
+
+	int32_t PipelineCompilerVK::worker()
+	{
+		for (;;)
+		{
+			m_jobSem.wait();
+
+			Job job;
+
+			{
+				bx::MutexScope scope(m_mutex);
+
+				if (m_exit)
+				{
+					break;
+				}
+
+				job = m_jobs.front();
+				m_jobs.erase(m_jobs.begin() );
+			}
+
+			Result result;
+			result.m_hash     = job.m_hash;
+			result.m_pipeline = s_renderVK->createPipeline(job);
+
+			{
+				bx::MutexScope scope(m_mutex);
+				m_results.push_back(result);
+			}
+
+			m_resultSem.post();
+		}
+
+		return 0;
+	}
+
+	void CommandRecorderVK::init(uint32_t _numThreads)
+	{
+		VkAllocationCallbacks* allocatorCb = s_renderVK->m_allocatorCb;
+		VkDevice device = s_renderVK->m_device;
+
+		m_exit       = false;
+		m_numStarted = 0;
+		m_numThreads = bx::min<uint32_t>(_numThreads, BGFX_CONFIG_MAX_RECORD_THREADS);
+
+		VkCommandPoolCreateInfo cpci;
+		cpci.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cpci.pNext = NULL;
+		cpci.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		cpci.queueFamilyIndex = s_renderVK->m_qfiGraphics;
+
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_worker); ++ii)
+		{
+			Worker& worker = m_worker[ii];
+			worker.m_num = 0;
+
+			for (uint32_t frame = 0; frame < BX_COUNTOF(worker.m_commandPool); ++frame)
+			{
+				VK_CHECK(vkCreateCommandPool(device, &cpci, allocatorCb, &worker.m_commandPool[frame]) );
+			}
+		}
+
+		for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+		{
+			m_thread[ii].init(workerProc, this, 0, "bgfx - vk command recorder");
+		}
+	}
+
+	void CommandRecorderVK::shutdown()
+	{
+		m_exit = true;
+		m_workSem.post(m_numThreads);
+
+		for (uint32_t ii = 0; ii < m_numThreads; ++ii)
+		{
+			m_thread[ii].shutdown();
+		}
+
+		m_numThreads = 0;
+
+		VkDevice device = s_renderVK->m_device;
+
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_worker); ++ii)
+		{
+			Worker& worker = m_worker[ii];
+
+			for (uint32_t frame = 0; frame < BX_COUNTOF(worker.m_commandPool); ++frame)
+			{
+				stl::vector<VkCommandBuffer>& commandBuffers = worker.m_commandBuffers[frame];
+
+				if (!commandBuffers.empty() )
+				{
+					vkFreeCommandBuffers(device
+						, worker.m_commandPool[frame]
+						, uint32_t(commandBuffers.size() )
+						, &commandBuffers[0]
+						);
+					commandBuffers.clear();
+				}
+
+				vkDestroy(worker.m_commandPool[frame]);
+			}
+		}
+	}
+
+	void CommandRecorderVK::reset(uint32_t _frame)
+	{
+		VkDevice device = s_renderVK->m_device;
+
+		m_frame = _frame;
+
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_worker); ++ii)
+		{
+			Worker& worker = m_worker[ii];
+
+			if (!worker.m_commandBuffers[_frame].empty() )
+			{
+				VK_CHECK(vkResetCommandPool(device, worker.m_commandPool[_frame], 0) );
+			}
+
+			worker.m_num = 0;
+		}
+	}
+
+	void CommandRecorderVK::record(RecordRangeVK* _ranges, uint32_t _num)
+	{
+		m_ranges    = _ranges;
+		m_numRanges = _num;
+		m_next      = 0;
+
+		// Calling thread records too, wake up only as many workers as there
+		// are ranges left for them.
+		const uint32_t numThreads = bx::min<uint32_t>(m_numThreads, _num - 1);
+		m_workSem.post(numThreads);
+
+		run(m_worker[BX_COUNTOF(m_worker) - 1]);
+
+		for (uint32_t ii = 0; ii < numThreads; ++ii)
+		{
+			m_doneSem.wait();
+		}
+	}
+
+	int32_t CommandRecorderVK::workerProc(bx::Thread* /*_self*/, void* _userData)
+	{
+		return ( (CommandRecorderVK*)_userData)->worker();
+	}
+
+	int32_t CommandRecorderVK::worker()
+	{
+		Worker& worker = m_worker[bx::atomicFetchAndAdd<uint32_t>(&m_numStarted, 1)];
+
+		for (;;)
+		{
+			m_workSem.wait();
+
+			if (m_exit)
+			{
+				break;
+			}
+
+			run(worker);
+			m_doneSem.post();
+		}
+
+		return 0;
+	}
+
+	void CommandRecorderVK::run(Worker& _worker)
+	{
+		for (;;)
+		{
+			const uint32_t idx = bx::atomicFetchAndAdd<uint32_t>(&m_next, 1);
+
+			if (idx >= m_numRanges)
+			{
+				break;
+			}
+
+			stl::vector<VkCommandBuffer>& commandBuffers = _worker.m_commandBuffers[m_frame];
+
+			if (_worker.m_num == commandBuffers.size() )
+			{
+				VkCommandBufferAllocateInfo cbai;
+				cbai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+				cbai.pNext = NULL;
+				cbai.commandPool = _worker.m_commandPool[m_frame];
+				cbai.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+				cbai.commandBufferCount = 1;
+
+				VkCommandBuffer commandBuffer;
+				VK_CHECK(vkAllocateCommandBuffers(s_renderVK->m_device, &cbai, &commandBuffer) );
+				commandBuffers.push_back(commandBuffer);
+			}
+
+			RecordRangeVK& range = m_ranges[idx];
+			range.m_commandBuffer = commandBuffers[_worker.m_num++];
+			s_renderVK->recordRange(range);
+		}
+	}
+
+	void StagingBufferVK::create(uint32_t _size)
+	{
+		VkAllocationCallbacks* allocatorCb = s_renderVK->m_allocatorCb;
+		VkDevice device = s_renderVK->m_device;
+
+		VkBufferCreateInfo bci;
+		bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		bci.pNext = NULL;
+		bci.flags = 0;
+		bci.size  = _size * BGFX_CONFIG_MAX_FRAME_LATENCY;
+		bci.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		bci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		bci.queueFamilyIndexCount = 0;
+		bci.pQueueFamilyIndices   = NULL;
+
+		VK_CHECK(vkCreateBuffer(device
+			, &bci
+			, allocatorCb
+			, &m_buffer
+			) );
+
+		VkMemoryRequirements mr;
+		vkGetBufferMemoryRequirements(device
+			, m_buffer
+			, &mr
+			);
+
+		VkMemoryAllocateInfo ma;
+		ma.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		ma.pNext = NULL;
+		ma.allocationSize  = mr.size;
+		ma.memoryTypeIndex = s_renderVK->selectMemoryType(mr.memoryTypeBits
+			, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+			);
+		VK_CHECK(vkAllocateMemory(device
+			, &ma
+			, allocatorCb
+			, &m_deviceMem
+			) );
+
+		VK_CHECK(vkBindBufferMemory(device, m_buffer, m_deviceMem, 0) );
+		VK_CHECK(vkMapMemory(device, m_deviceMem, 0, ma.allocationSize, 0, (void**)&m_data) );
+
+		m_size    = _size;
+		m_pos     = 0;
+		m_current = 0;
+
+		VkCommandPoolCreateInfo cpci;
+		cpci.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cpci.pNext = NULL;
+		cpci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		cpci.queueFamilyIndex = s_renderVK->m_qfiGraphics;
+		VK_CHECK(vkCreateCommandPool(device, &cpci, allocatorCb, &m_commandPool) );
+
+		VkCommandBufferAllocateInfo cbai;
+		cbai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		cbai.pNext = NULL;
+		cbai.commandPool = m_commandPool;
+		cbai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		cbai.commandBufferCount = 1;
+
+		VkFenceCreateInfo fci;
+		fci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fci.pNext = NULL;
+		fci.flags = 0;
+
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_partition); ++ii)
+		{
+			Partition& partition = m_partition[ii];
+			partition.m_submitted = false;
+
+			VK_CHECK(vkAllocateCommandBuffers(device, &cbai, &partition.m_commandBuffer) );
+			VK_CHECK(vkCreateFence(device, &fci, allocatorCb, &partition.m_fence) );
+		}
+
+		m_batch.reserve(64);
+		m_region.reserve(256);
+		m_written.reserve(256);
+	}
+
+	void StagingBufferVK::destroy()
+	{
+		VkAllocationCallbacks* allocatorCb = s_renderVK->m_allocatorCb;
+		VkDevice device = s_renderVK->m_device;
+
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_partition); ++ii)
+		{
+			Partition& partition = m_partition[ii];
+
+			if (partition.m_submitted)
+			{
+				VK_CHECK(vkWaitForFences(device, 1, &partition.m_fence, VK_TRUE, UINT64_MAX) );
+			}
+
+			vkDestroy(partition.m_fence);
+			vkFreeCommandBuffers(device, m_commandPool, 1, &partition.m_commandBuffer);
+		}
+
+		vkDestroy(m_commandPool);
+
+		vkUnmapMemory(device, m_deviceMem);
+		vkDestroy(m_buffer);
+		vkFreeMemory(device
+			, m_deviceMem
+			, allocatorCb
+			);
+
+		m_batch.clear();
+		m_region.clear();
+		m_written.clear();
+		m_data = NULL;
+	}
+
+	void StagingBufferVK::copy(VkBuffer _dst, uint32_t _dstOffset, const void* _data, uint32_t _size)
+	{
+		const uint8_t* src = (const uint8_t*)_data;
+
+		while (0 < _size)
+		{
+			if (m_pos == m_size)
+			{
+				flush();
+			}
+
+			const uint32_t size   = bx::min(_size, m_size - m_pos);
+			const uint32_t offset = m_current*m_size + m_pos;
+			bx::memCopy(&m_data[offset], src, size);
+
+			// Copies into same buffer are issued with single vkCmdCopyBuffer, as
+			// long as they don't overlap with any copy since last barrier. Overlapping
+			// copy starts new batch, separated from previous ones by barrier. Ranges
+			// written since last barrier are kept sorted, so overlap test is binary
+			// search instead of scan over all pending copies.
+			const uint32_t dstEnd = _dstOffset + size;
+
+			uint32_t idx = findWritten(_dst, _dstOffset);
+			const bool overlap = idx < m_written.size()
+				&& m_written[idx].m_dst   == _dst
+				&& m_written[idx].m_begin <  dstEnd
+				;
+
+			if (overlap)
+			{
+				m_written.clear();
+				idx = 0;
+			}
+
+			const bool mergePrev = 0 < idx
+				&& m_written[idx-1].m_dst == _dst
+				&& m_written[idx-1].m_end == _dstOffset
+				;
+			const bool mergeNext = idx < m_written.size()
+				&& m_written[idx].m_dst   == _dst
+				&& m_written[idx].m_begin == dstEnd
+				;
+
+			if (mergePrev && mergeNext)
+			{
+				m_written[idx-1].m_end = m_written[idx].m_end;
+				m_written.erase(m_written.begin() + idx);
+			}
+			else if (mergePrev)
+			{
+				m_written[idx-1].m_end = dstEnd;
+			}
+			else if (mergeNext)
+			{
+				m_written[idx].m_begin = _dstOffset;
+			}
+			else
+			{
+				Written written;
+				written.m_dst   = _dst;
+				written.m_begin = _dstOffset;
+				written.m_end   = dstEnd;
+				m_written.insert(m_written.begin() + idx, written);
+			}
+
+			if (m_batch.empty()
+			||  overlap
+			||  m_batch.back().m_dst != _dst)
+			{
+				Batch batch;
+				batch.m_dst     = _dst;
+				batch.m_first   = uint32_t(m_region.size() );
+				batch.m_num     = 0;
+				batch.m_barrier = overlap;
+				m_batch.push_back(batch);
+			}
+
+			VkBufferCopy* last = 0 < m_batch.back().m_num
+				? &m_region.back()
+				: NULL
+				;
+
+			if (NULL != last
+			&&  last->srcOffset + last->size == offset
+			&&  last->dstOffset + last->size == _dstOffset)
+			{
+				// Contiguous in both staging and destination buffer, extend previous region.
+				last->size += size;
+			}
+			else
+			{
+				VkBufferCopy region;
+				region.srcOffset = offset;
+				region.dstOffset = _dstOffset;
+				region.size      = size;
+				m_region.push_back(region);
+				++m_batch.back().m_num;
+			}
+
+			m_pos      += size;
+			src        += size;
+			_dstOffset += size;
+			_size      -= size;
+		}
+	}
+
+	uint32_t StagingBufferVK::findWritten(VkBuffer _dst, uint32_t _begin) const
+	{
+		uint32_t first = 0;
+		uint32_t count = uint32_t(m_written.size() );
+
+		while (0 < count)
+		{
+			const uint32_t step = count/2;
+			const Written& written = m_written[first + step];
+
+			if (written.m_dst < _dst
+			|| (written.m_dst == _dst && written.m_end <= _begin) )
+			{
+				first += step + 1;
+				count -= step + 1;
+			}
+			else
+			{
+				count = step;
+			}
+		}
+
+		return first;
+	}
+
+	void StagingBufferVK::flush()
+	{
+		if (m_batch.empty() )
+		{
+			return;
+		}
+
+		VkDevice device = s_renderVK->m_device;
+		Partition& partition = m_partition[m_current];
+		VkCommandBuffer commandBuffer = partition.m_commandBuffer;
+
+		VkCommandBufferBeginInfo cbbi;
+		cbbi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		cbbi.pNext = NULL;
+		cbbi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		cbbi.pInheritanceInfo = NULL;
+		VK_CHECK(vkBeginCommandBuffer(commandBuffer, &cbbi) );
+
+		VkMemoryBarrier mb;
+		mb.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		mb.pNext = NULL;
+
+		// Previously submitted draws must be done reading before buffers are
+		// overwritten.
+		vkCmdPipelineBarrier(commandBuffer
+			, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
+			, VK_PIPELINE_STAGE_TRANSFER_BIT
+			, 0
+			, 0
+			, NULL
+			, 0
+			, NULL
+			, 0
+			, NULL
+			);
+
+		for (BatchArray::const_iterator it = m_batch.begin(), itEnd = m_batch.end(); it != itEnd; ++it)
+		{
+			const Batch& batch = *it;
+
+			if (batch.m_barrier)
+			{
+				mb.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				mb.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+				vkCmdPipelineBarrier(commandBuffer
+					, VK_PIPELINE_STAGE_TRANSFER_BIT
+					, VK_PIPELINE_STAGE_TRANSFER_BIT
+					, 0
+					, 1
+					, &mb
+					, 0
+					, NULL
+					, 0
+					, NULL
+					);
+			}
+
+			vkCmdCopyBuffer(commandBuffer
+				, m_buffer
+				, batch.m_dst
+				, batch.m_num
+				, &m_region[batch.m_first]
+				);
+		}
+
+		mb.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		mb.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT|VK_ACCESS_INDEX_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer
+			, VK_PIPELINE_STAGE_TRANSFER_BIT
+			, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT
+			, 0
+			, 1
+			, &mb
+			, 0
+			, NULL
+			, 0
+			, NULL
+			);
+
+		VK_CHECK(vkEndCommandBuffer(commandBuffer) );
+
+		VkSubmitInfo si;
+		si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		si.pNext = NULL;
+		si.waitSemaphoreCount   = 0;
+		si.pWaitSemaphores      = NULL;
+		si.pWaitDstStageMask    = NULL;
+		si.commandBufferCount   = 1;
+		si.pCommandBuffers      = &commandBuffer;
+		si.signalSemaphoreCount = 0;
+		si.pSignalSemaphores    = NULL;
+		VK_CHECK(vkQueueSubmit(s_renderVK->m_queueGraphics, 1, &si, partition.m_fence) );
+		partition.m_submitted = true;
+
+		m_batch.clear();
+		m_region.clear();
+		m_written.clear();
+
+		m_current = (m_current + 1) % BGFX_CONFIG_MAX_FRAME_LATENCY;
+		m_pos     = 0;
+
+		Partition& next = m_partition[m_current];
+		if (next.m_submitted)
+		{
+			VK_CHECK(vkWaitForFences(device, 1, &next.m_fence, VK_TRUE, UINT64_MAX) );
+			VK_CHECK(vkResetFences(device, 1, &next.m_fence) );
+			next.m_submitted = false;
+		}
 	}
 
 	VkResult ImageVK::create(VkFormat _format, const VkExtent3D& _extent)
@@ -3556,8 +4781,8 @@ VK_DESTROY
 		bci.flags = 0;
 		bci.size  = _size;
 		bci.usage = 0
-			| (m_dynamic ? VK_BUFFER_USAGE_TRANSFER_DST_BIT  : 0)
-			| (_vertex   ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT : VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
+			| VK_BUFFER_USAGE_TRANSFER_DST_BIT
+			| (_vertex ? VK_BUFFER_USAGE_VERTEX_BUFFER_BIT : VK_BUFFER_USAGE_INDEX_BUFFER_BIT)
 			;
 		bci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 		bci.queueFamilyIndexCount = 0;
@@ -3582,7 +4807,7 @@ VK_DESTROY
 		ma.pNext = NULL;
 		ma.allocationSize  = mr.size;
 		ma.memoryTypeIndex = s_renderVK->selectMemoryType(mr.memoryTypeBits
-			, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+			, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT
 			);
 		VK_CHECK(vkAllocateMemory(device
 			, &ma
@@ -3590,34 +4815,27 @@ VK_DESTROY
 			, &m_deviceMem
 			) );
 
+		VK_CHECK(vkBindBufferMemory(device, m_buffer, m_deviceMem, 0) );
+
 		if (!m_dynamic)
 		{
-			void* dst;
-			VK_CHECK(vkMapMemory(device, m_deviceMem, 0, ma.allocationSize, 0, &dst) );
-			bx::memCopy(dst, _data, _size);
-			vkUnmapMemory(device, m_deviceMem);
+			update(0, _size, _data);
 		}
-
-		VK_CHECK(vkBindBufferMemory(device, m_buffer, m_deviceMem, 0) );
 	}
 
-	void BufferVK::update(VkCommandBuffer _commandBuffer, uint32_t _offset, uint32_t _size, void* _data, bool _discard)
+	void BufferVK::update(uint32_t _offset, uint32_t _size, void* _data, bool _discard)
 	{
-		BX_UNUSED(_commandBuffer, _offset, _size, _data, _discard);
+		BX_UNUSED(_discard);
+		s_renderVK->m_stagingBuffer.copy(m_buffer, _offset, _data, _size);
 	}
 
 	void BufferVK::destroy()
 	{
 		if (VK_NULL_HANDLE != m_buffer)
 		{
-			VkAllocationCallbacks* allocatorCb = s_renderVK->m_allocatorCb;
-			VkDevice device = s_renderVK->m_device;
-
-			vkDestroy(m_buffer);
-			vkFreeMemory(device
-				, m_deviceMem
-				, allocatorCb
-				);
+			// Buffer might still be referenced by frames in flight.
+			vkRelease(m_buffer);
+			vkReleaseMemory(m_deviceMem);
 			m_dynamic = false;
 		}
 	}
@@ -3843,6 +5061,282 @@ VK_DESTROY
 	{
 	}
 
+	void ReadBackVK::create()
+	{
+		VkAllocationCallbacks* allocatorCb = s_renderVK->m_allocatorCb;
+		VkDevice device = s_renderVK->m_device;
+
+		VkCommandPoolCreateInfo cpci;
+		cpci.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		cpci.pNext = NULL;
+		cpci.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+		cpci.queueFamilyIndex = s_renderVK->m_qfiGraphics;
+		VK_CHECK(vkCreateCommandPool(device, &cpci, allocatorCb, &m_commandPool) );
+
+		VkCommandBufferAllocateInfo cbai;
+		cbai.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		cbai.pNext = NULL;
+		cbai.commandPool = m_commandPool;
+		cbai.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		cbai.commandBufferCount = 1;
+
+		VkFenceCreateInfo fci;
+		fci.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fci.pNext = NULL;
+		fci.flags = 0;
+
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_pixels); ++ii)
+		{
+			Pixels& pixels = m_pixels[ii];
+			pixels.m_buffer    = VK_NULL_HANDLE;
+			pixels.m_deviceMem = VK_NULL_HANDLE;
+			pixels.m_mapped    = NULL;
+			pixels.m_size      = 0;
+			pixels.m_filePath  = NULL;
+
+			VK_CHECK(vkAllocateCommandBuffers(device, &cbai, &pixels.m_commandBuffer) );
+			VK_CHECK(vkCreateFence(device, &fci, allocatorCb, &pixels.m_fence) );
+		}
+	}
+
+	void ReadBackVK::destroy()
+	{
+		resolve(true);
+
+		VkAllocationCallbacks* allocatorCb = s_renderVK->m_allocatorCb;
+		VkDevice device = s_renderVK->m_device;
+
+		for (uint32_t ii = 0; ii < BX_COUNTOF(m_pixels); ++ii)
+		{
+			Pixels& pixels = m_pixels[ii];
+
+			if (VK_NULL_HANDLE != pixels.m_buffer)
+			{
+				vkUnmapMemory(device, pixels.m_deviceMem);
+				vkDestroy(pixels.m_buffer);
+				vkFreeMemory(device, pixels.m_deviceMem, allocatorCb);
+			}
+
+			vkDestroy(pixels.m_fence);
+			vkFreeCommandBuffers(device, m_commandPool, 1, &pixels.m_commandBuffer);
+		}
+
+		vkDestroy(m_commandPool);
+
+		BX_FREE(g_allocator, m_data);
+		m_data     = NULL;
+		m_dataSize = 0;
+	}
+
+	void ReadBackVK::read(VkImage _image, Kind::Enum _kind, uint32_t _width, uint32_t _height, VkFormat _format, uint32_t _frame, const char* _filePath)
+	{
+		while (0 == m_control.reserve(1) )
+		{
+			resolve(true);
+		}
+
+		VkAllocationCallbacks* allocatorCb = s_renderVK->m_allocatorCb;
+		VkDevice device = s_renderVK->m_device;
+
+		Pixels& pixels = m_pixels[m_control.m_current];
+
+		const uint32_t size = _width*_height*4;
+
+		if (pixels.m_size < size)
+		{
+			if (VK_NULL_HANDLE != pixels.m_buffer)
+			{
+				vkUnmapMemory(device, pixels.m_deviceMem);
+				vkDestroy(pixels.m_buffer);
+				vkFreeMemory(device, pixels.m_deviceMem, allocatorCb);
+			}
+
+			VkBufferCreateInfo bci;
+			bci.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+			bci.pNext = NULL;
+			bci.flags = 0;
+			bci.size  = size;
+			bci.usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+			bci.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+			bci.queueFamilyIndexCount = 0;
+			bci.pQueueFamilyIndices   = NULL;
+			VK_CHECK(vkCreateBuffer(device, &bci, allocatorCb, &pixels.m_buffer) );
+
+			VkMemoryRequirements mr;
+			vkGetBufferMemoryRequirements(device, pixels.m_buffer, &mr);
+
+			VkMemoryAllocateInfo ma;
+			ma.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+			ma.pNext = NULL;
+			ma.allocationSize  = mr.size;
+			ma.memoryTypeIndex = s_renderVK->selectMemoryType(mr.memoryTypeBits
+				, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT
+				| VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+				);
+			VK_CHECK(vkAllocateMemory(device, &ma, allocatorCb, &pixels.m_deviceMem) );
+			VK_CHECK(vkBindBufferMemory(device, pixels.m_buffer, pixels.m_deviceMem, 0) );
+			VK_CHECK(vkMapMemory(device, pixels.m_deviceMem, 0, ma.allocationSize, 0, &pixels.m_mapped) );
+
+			pixels.m_size = size;
+		}
+
+		VkCommandBuffer commandBuffer = pixels.m_commandBuffer;
+
+		VkCommandBufferBeginInfo cbbi;
+		cbbi.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		cbbi.pNext = NULL;
+		cbbi.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		cbbi.pInheritanceInfo = NULL;
+		VK_CHECK(vkBeginCommandBuffer(commandBuffer, &cbbi) );
+
+		setImageMemoryBarrier(commandBuffer
+			, _image
+			, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+			, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+			);
+
+		VkBufferImageCopy bic;
+		bic.bufferOffset      = 0;
+		bic.bufferRowLength   = 0;
+		bic.bufferImageHeight = 0;
+		bic.imageSubresource.aspectMask     = VK_IMAGE_ASPECT_COLOR_BIT;
+		bic.imageSubresource.mipLevel       = 0;
+		bic.imageSubresource.baseArrayLayer = 0;
+		bic.imageSubresource.layerCount     = 1;
+		bic.imageOffset.x = 0;
+		bic.imageOffset.y = 0;
+		bic.imageOffset.z = 0;
+		bic.imageExtent.width  = _width;
+		bic.imageExtent.height = _height;
+		bic.imageExtent.depth  = 1;
+		vkCmdCopyImageToBuffer(commandBuffer
+			, _image
+			, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+			, pixels.m_buffer
+			, 1
+			, &bic
+			);
+
+		VkMemoryBarrier mb;
+		mb.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		mb.pNext = NULL;
+		mb.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		mb.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+		vkCmdPipelineBarrier(commandBuffer
+			, VK_PIPELINE_STAGE_TRANSFER_BIT
+			, VK_PIPELINE_STAGE_HOST_BIT
+			, 0
+			, 1
+			, &mb
+			, 0
+			, NULL
+			, 0
+			, NULL
+			);
+
+		setImageMemoryBarrier(commandBuffer
+			, _image
+			, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+			, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR
+			);
+
+		VK_CHECK(vkEndCommandBuffer(commandBuffer) );
+
+		VkSubmitInfo si;
+		si.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		si.pNext = NULL;
+		si.waitSemaphoreCount = 0;
+		si.pWaitSemaphores    = NULL;
+		si.pWaitDstStageMask  = NULL;
+		si.commandBufferCount = 1;
+		si.pCommandBuffers    = &commandBuffer;
+		si.signalSemaphoreCount = 0;
+		si.pSignalSemaphores    = NULL;
+		VK_CHECK(vkQueueSubmit(s_renderVK->m_queueGraphics, 1, &si, pixels.m_fence) );
+
+		pixels.m_width  = _width;
+		pixels.m_height = _height;
+		pixels.m_frame  = _frame;
+		pixels.m_format = _format;
+		pixels.m_kind   = _kind;
+
+		if (NULL != _filePath)
+		{
+			const uint32_t len = bx::strLen(_filePath)+1;
+			pixels.m_filePath = (char*)BX_ALLOC(g_allocator, len);
+			bx::memCopy(pixels.m_filePath, _filePath, len);
+		}
+
+		m_control.commit(1);
+	}
+
+	void ReadBackVK::resolve(bool _wait)
+	{
+		VkDevice device = s_renderVK->m_device;
+
+		while (0 != m_control.available() )
+		{
+			Pixels& pixels = m_pixels[m_control.m_read];
+
+			if (_wait)
+			{
+				VK_CHECK(vkWaitForFences(device, 1, &pixels.m_fence, VK_TRUE, UINT64_MAX) );
+			}
+			else if (VK_SUCCESS != vkGetFenceStatus(device, pixels.m_fence) )
+			{
+				break;
+			}
+
+			VK_CHECK(vkResetFences(device, 1, &pixels.m_fence) );
+
+			const uint32_t pitch = pixels.m_width*4;
+			const uint32_t size  = pitch*pixels.m_height;
+			const void* data = pixels.m_mapped;
+
+			if (VK_FORMAT_R8G8B8A8_UNORM == pixels.m_format
+			||  VK_FORMAT_R8G8B8A8_SRGB  == pixels.m_format)
+			{
+				if (m_dataSize < size)
+				{
+					m_data     = BX_REALLOC(g_allocator, m_data, size);
+					m_dataSize = size;
+				}
+
+				bimg::imageSwizzleBgra8(m_data, pitch, pixels.m_width, pixels.m_height, pixels.m_mapped, pitch);
+				data = m_data;
+			}
+
+			switch (pixels.m_kind)
+			{
+			case Kind::Capture:
+				g_callback->captureFrame(data, size, pixels.m_frame);
+				break;
+
+			case Kind::ScreenShot:
+				g_callback->screenShot(pixels.m_filePath
+					, pixels.m_width
+					, pixels.m_height
+					, pitch
+					, data
+					, size
+					, false
+					);
+				break;
+
+			default:
+				break;
+			}
+
+			if (NULL != pixels.m_filePath)
+			{
+				BX_FREE(g_allocator, pixels.m_filePath);
+				pixels.m_filePath = NULL;
+			}
+
+			m_control.consume(1);
+		}
+	}
+
 	void RendererContextVK::submitBlit(BlitState& _bs, uint16_t _view)
 	{
 		while (_bs.hasItem(_view) )
@@ -3858,6 +5352,13 @@ VK_DESTROY
 
 		updateResolution(_render->m_resolution);
 
+		if (m_readBackSupport)
+		{
+			m_readBack.resolve();
+		}
+
+		m_pipelineCompiler.update();
+
 		int64_t timeBegin = bx::getHPCounter();
 		int64_t captureElapsed = 0;
 
@@ -3866,17 +5367,19 @@ VK_DESTROY
 		if (0 < _render->m_iboffset)
 		{
 			BGFX_PROFILER_SCOPE("bgfx/Update transient index buffer", kColorResource);
-//			TransientIndexBuffer* ib = _render->m_transientIb;
-//			m_indexBuffers[ib->handle.idx].update(m_commandList, 0, _render->m_iboffset, ib->data);
+			TransientIndexBuffer* ib = _render->m_transientIb;
+			m_indexBuffers[ib->handle.idx].update(0, _render->m_iboffset, ib->data, true);
 		}
 
 		if (0 < _render->m_vboffset)
 		{
 			BGFX_PROFILER_SCOPE("bgfx/Update transient vertex buffer", kColorResource);
-//			TransientVertexBuffer* vb = _render->m_transientVb;
-//			m_vertexBuffers[vb->handle.idx].update(m_commandList, 0, _render->m_vboffset, vb->data);
+			TransientVertexBuffer* vb = _render->m_transientVb;
+			m_vertexBuffers[vb->handle.idx].update(0, _render->m_vboffset, vb->data, true);
 		}
 
+		m_stagingBuffer.flush();
+
 		_render->sort();
 
 		RenderDraw currentState;
@@ -3895,22 +5398,18 @@ VK_DESTROY
 		uint32_t currentBindHash        = 0;
 		bool     hasPredefined          = false;
 		bool     commandListChanged     = false;
-		VkPipeline currentPipeline = VK_NULL_HANDLE;
 		SortKey key;
 		uint16_t view = UINT16_MAX;
 		FrameBufferHandle fbh = { BGFX_CONFIG_MAX_FRAME_BUFFERS };
 
 		BlitState bs(_render);
 
-		uint32_t blendFactor = 0;
-
 		const uint64_t primType = _render->m_debug&BGFX_DEBUG_WIREFRAME ? BGFX_STATE_PT_LINES : 0;
 		uint8_t primIndex = uint8_t(primType >> BGFX_STATE_PT_SHIFT);
 		PrimInfo prim = s_primInfo[primIndex];
 
 		bool wasCompute = false;
 		bool viewHasScissor = false;
-		bool restoreScissor = false;
 		Rect viewScissorRect;
 		viewScissorRect.clear();
 
@@ -3923,20 +5422,19 @@ VK_DESTROY
 		uint32_t statsNumIndices = 0;
 		uint32_t statsKeyType[2] = {};
 
-		VkSemaphore renderWait = m_presentDone[m_backBufferColorIdx];
+		m_commandBuffer = m_cmd.alloc();
+
+		const uint32_t frame = m_cmd.m_currentFrame;
+
 		VK_CHECK(vkAcquireNextImageKHR(m_device
 				, m_swapchain
 				, UINT64_MAX
-				, renderWait
+				, m_imageAcquired[frame]
 				, VK_NULL_HANDLE
 				, &m_backBufferColorIdx
 				) );
 
-		const uint64_t f0 = BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_FACTOR, BGFX_STATE_BLEND_FACTOR);
-		const uint64_t f1 = BGFX_STATE_BLEND_FUNC(BGFX_STATE_BLEND_INV_FACTOR, BGFX_STATE_BLEND_INV_FACTOR);
-
-
-		ScratchBufferVK& scratchBuffer = m_scratchBuffer[m_backBufferColorIdx];
+		ScratchBufferVK& scratchBuffer = m_scratchBuffer[frame];
 		VkDescriptorBufferInfo descriptorBufferInfo;
 		scratchBuffer.reset(descriptorBufferInfo);
 
@@ -3949,7 +5447,6 @@ VK_DESTROY
 			;
 		cbbi.pInheritanceInfo = NULL;
 
-		m_commandBuffer = m_commandBuffers[m_backBufferColorIdx];
 		VK_CHECK(vkBeginCommandBuffer(m_commandBuffer, &cbbi) );
 
 		setImageMemoryBarrier(m_commandBuffer
@@ -3969,7 +5466,12 @@ VK_DESTROY
 		rpbi.clearValueCount = 0;
 		rpbi.pClearValues    = NULL;
 
-		bool beginRenderPass = false;
+		m_drawCommands.clear();
+		m_recordRanges.clear();
+
+		VkDescriptorSet currentDescriptorSet = VK_NULL_HANDLE;
+		uint32_t currentUniformOffset[2] = { 0, 0 };
+		uint32_t rangeIdx = 0;
 
 		if (0 == (_render->m_debug&BGFX_DEBUG_IFH) )
 		{
@@ -3996,26 +5498,7 @@ VK_DESTROY
 
 				if (viewChanged)
 				{
-					if (beginRenderPass)
-					{
-						vkCmdEndRenderPass(m_commandBuffer);
-						beginRenderPass = false;
-
-						if (BX_ENABLED(BGFX_CONFIG_DEBUG_ANNOTATION) )
-						{
-							vkCmdEndDebugUtilsLabelEXT(m_commandBuffer);
-						}
-					}
-
-					VK_CHECK(vkEndCommandBuffer(m_commandBuffer) );
-
-//					m_batch.flush(m_commandList, true);
-					kick(renderWait);
-					renderWait = VK_NULL_HANDLE;
-finishAll();
-
 					view = key.m_view;
-					currentPipeline = VK_NULL_HANDLE;
 					currentSamplerStateIdx = kInvalidHandle;
 BX_UNUSED(currentSamplerStateIdx);
 					currentProgram         = BGFX_INVALID_HANDLE;
@@ -4030,57 +5513,17 @@ BX_UNUSED(currentSamplerStateIdx);
 					viewHasScissor  = !scissorRect.isZero();
 					viewScissorRect = viewHasScissor ? scissorRect : rect;
 
-					rpbi.renderArea.offset.x = rect.m_x;
-					rpbi.renderArea.offset.y = rect.m_y;
-					rpbi.renderArea.extent.width  = rect.m_width;
-					rpbi.renderArea.extent.height = rect.m_height;
-					VK_CHECK(vkBeginCommandBuffer(m_commandBuffer, &cbbi) );
-
-					if (BX_ENABLED(BGFX_CONFIG_DEBUG_ANNOTATION) )
-					{
-						VkDebugUtilsLabelEXT dul;
-						dul.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
-						dul.pNext = NULL;
-						dul.pLabelName = s_viewName[view];
-						dul.color[0] = 1.0f;
-						dul.color[1] = 1.0f;
-						dul.color[2] = 1.0f;
-						dul.color[3] = 1.0f;
-						vkCmdBeginDebugUtilsLabelEXT(m_commandBuffer, &dul);
-					}
-
-					vkCmdBeginRenderPass(m_commandBuffer, &rpbi, VK_SUBPASS_CONTENTS_INLINE);
-					beginRenderPass = true;
-
-					VkViewport vp;
-					vp.x        = rect.m_x;
-					vp.y        = rect.m_y;
-					vp.width    = rect.m_width;
-					vp.height   = rect.m_height;
-					vp.minDepth = 0.0f;
-					vp.maxDepth = 1.0f;
-					vkCmdSetViewport(m_commandBuffer, 0, 1, &vp);
-
-					VkRect2D rc;
-					rc.offset.x      = viewScissorRect.m_x;
-					rc.offset.y      = viewScissorRect.m_y;
-					rc.extent.width  = viewScissorRect.m_x + viewScissorRect.m_width;
-					rc.extent.height = viewScissorRect.m_y + viewScissorRect.m_height;
-					vkCmdSetScissor(m_commandBuffer, 0, 1, &rc);
-
-					restoreScissor = false;
+					rangeIdx = addRecordRange(view, rect, viewScissorRect);
 
 					Clear& clr = _render->m_view[view].m_clear;
 					if (BGFX_CLEAR_NONE != clr.m_flags)
 					{
 						Rect clearRect = rect;
 						clearRect.setIntersect(rect, viewScissorRect);
-						clearQuad(clearRect, clr, _render->m_colorPalette);
+						clearQuad(m_recordRanges[rangeIdx], clearRect, clr, _render->m_colorPalette);
 					}
 
 					prim = s_primInfo[Topology::Count]; // Force primitive type update.
-
-					submitBlit(bs, view);
 				}
 
 				if (isCompute)
@@ -4099,13 +5542,11 @@ BX_UNUSED(currentSamplerStateIdx);
 
 					const RenderCompute& compute = renderItem.compute;
 
+					// Compute dispatches must be recorded outside of render pass,
+					// they are not translated into draw commands yet.
 					VkPipeline pipeline = getPipeline(key.m_program);
-					if (pipeline != currentPipeline)
-					{
-						currentPipeline = pipeline;
-						vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, pipeline);
-						currentBindHash = 0;
-					}
+					BX_UNUSED(pipeline);
+					currentBindHash = 0;
 
 //					uint32_t bindHash = bx::hash<bx::HashMurmur2A>(renderBind.m_bind, sizeof(renderBind.m_bind) );
 //					if (currentBindHash != bindHash)
@@ -4276,7 +5717,6 @@ BX_UNUSED(currentSamplerStateIdx);
 				currentState.m_stateFlags = newFlags;
 
 				const uint64_t newStencil = draw.m_stencil;
-				uint64_t changedStencil = (currentState.m_stencil ^ draw.m_stencil) & BGFX_STENCIL_FUNC_REF_MASK;
 				currentState.m_stencil = newStencil;
 
 				if (viewChanged
@@ -4310,14 +5750,12 @@ BX_UNUSED(currentSamplerStateIdx);
 //					};
 //					m_commandList->SetDescriptorHeaps(BX_COUNTOF(heaps), heaps);
 
-					currentPipeline        = VK_NULL_HANDLE;
 					currentBindHash        = 0;
 					currentSamplerStateIdx = kInvalidHandle;
 					currentProgram         = BGFX_INVALID_HANDLE;
 					currentState.clear();
 					currentState.m_scissor = !draw.m_scissor;
 					changedFlags = BGFX_STATE_MASK;
-					changedStencil = packStencil(BGFX_STENCIL_MASK, BGFX_STENCIL_MASK);
 					currentState.m_stateFlags = newFlags;
 					currentState.m_stencil    = newStencil;
 
@@ -4330,10 +5768,6 @@ BX_UNUSED(currentSamplerStateIdx);
 				if (isValid(draw.m_stream[0].m_handle) )
 				{
 					const uint64_t state = draw.m_stateFlags;
-					bool hasFactor = 0
-						|| f0 == (state & f0)
-						|| f1 == (state & f1)
-						;
 
 					const VertexBufferVK& vb = m_vertexBuffers[draw.m_stream[0].m_handle.idx];
 					uint16_t declIdx = !isValid(vb.m_decl) ? draw.m_stream[0].m_decl.idx : vb.m_decl.idx;
@@ -4346,20 +5780,18 @@ BX_UNUSED(currentSamplerStateIdx);
 							, uint8_t(draw.m_instanceDataStride/16)
 							);
 
-					uint16_t scissor = draw.m_scissor;
-					uint32_t bindHash = bx::hash<bx::HashMurmur2A>(renderBind.m_bind, sizeof(renderBind.m_bind) );
-					if (currentBindHash != bindHash
-					||  0 != changedStencil
-					|| (hasFactor && blendFactor != draw.m_rgba)
-					|| (0 != (BGFX_STATE_PT_MASK & changedFlags)
-					||  prim.m_topology != s_primInfo[primIndex].m_topology)
-					||  currentState.m_scissor != scissor
-					||  pipeline != currentPipeline
-					||  hasOcclusionQuery)
+					if (VK_NULL_HANDLE == pipeline)
 					{
-//						m_batch.flush(m_commandList);
+						// Pipeline is still being compiled, draw is dropped for
+						// this frame and not deferred. Force program and uniforms
+						// to be rebound by the next draw.
+						currentProgram = BGFX_INVALID_HANDLE;
+						continue;
 					}
 
+					uint32_t bindHash = bx::hash<bx::HashMurmur2A>(renderBind.m_bind, sizeof(renderBind.m_bind) );
+					BX_UNUSED(bindHash);
+
 //					if (currentBindHash != bindHash)
 //					{
 //						currentBindHash  = bindHash;
@@ -4422,73 +5854,12 @@ BX_UNUSED(currentSamplerStateIdx);
 //						}
 //					}
 
-					if (pipeline != currentPipeline
-					||  0 != changedStencil)
-					{
-						const uint32_t fstencil = unpackStencil(0, draw.m_stencil);
-						const uint32_t ref = (fstencil&BGFX_STENCIL_FUNC_REF_MASK)>>BGFX_STENCIL_FUNC_REF_SHIFT;
-						vkCmdSetStencilReference(m_commandBuffer, VK_STENCIL_FRONT_AND_BACK, ref);
-					}
-
-					if (pipeline != currentPipeline
-					|| (hasFactor && blendFactor != draw.m_rgba) )
-					{
-						blendFactor = draw.m_rgba;
-
-						float bf[4];
-						bf[0] = ( (draw.m_rgba>>24)     )/255.0f;
-						bf[1] = ( (draw.m_rgba>>16)&0xff)/255.0f;
-						bf[2] = ( (draw.m_rgba>> 8)&0xff)/255.0f;
-						bf[3] = ( (draw.m_rgba    )&0xff)/255.0f;
-						vkCmdSetBlendConstants(m_commandBuffer, bf);
-					}
-
 					if (0 != (BGFX_STATE_PT_MASK & changedFlags)
 					||  prim.m_topology != s_primInfo[primIndex].m_topology)
 					{
 						const uint64_t pt = newFlags&BGFX_STATE_PT_MASK;
 						primIndex = uint8_t(pt>>BGFX_STATE_PT_SHIFT);
 						prim = s_primInfo[primIndex];
-//						m_commandList->IASetPrimitiveTopology(prim.m_topology);
-					}
-
-					if (currentState.m_scissor != scissor)
-					{
-						currentState.m_scissor = scissor;
-
-						if (UINT16_MAX == scissor)
-						{
-							if (restoreScissor
-							||  viewHasScissor)
-							{
-								restoreScissor = false;
-								VkRect2D rc;
-								rc.offset.x      = viewScissorRect.m_x;
-								rc.offset.y      = viewScissorRect.m_y;
-								rc.extent.width  = viewScissorRect.m_x + viewScissorRect.m_width;
-								rc.extent.height = viewScissorRect.m_y + viewScissorRect.m_height;
-								vkCmdSetScissor(m_commandBuffer, 0, 1, &rc);
-							}
-						}
-						else
-						{
-							restoreScissor = true;
-							Rect scissorRect;
-							scissorRect.setIntersect(viewScissorRect, _render->m_frameCache.m_rectCache.m_cache[scissor]);
-
-							VkRect2D rc;
-							rc.offset.x      = scissorRect.m_x;
-							rc.offset.y      = scissorRect.m_y;
-							rc.extent.width  = scissorRect.m_x + scissorRect.m_width;
-							rc.extent.height = scissorRect.m_y + scissorRect.m_height;
-							vkCmdSetScissor(m_commandBuffer, 0, 1, &rc);
-						}
-					}
-
-					if (pipeline != currentPipeline)
-					{
-						currentPipeline = pipeline;
-						vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
 					}
 
 					bool constantsChanged = false;
@@ -4522,40 +5893,47 @@ BX_UNUSED(currentSamplerStateIdx);
 						uint32_t ref = (newFlags&BGFX_STATE_ALPHA_REF_MASK)>>BGFX_STATE_ALPHA_REF_SHIFT;
 						viewState.m_alphaRef = ref/255.0f;
 						viewState.setPredefined<4>(this, view, program, _render, draw);
-						commitShaderUniforms(m_commandBuffer, key.m_program); //, gpuAddress);
+						commitShaderUniforms(key.m_program, currentDescriptorSet, currentUniformOffset);
 					}
 
-
-//					vb.setState(_commandList, D3D12_RESOURCE_STATE_GENERIC_READ);
-
 					const VertexDecl& vertexDecl = m_vertexDecls[declIdx];
 					uint32_t numIndices = 0;
 
-					VkDeviceSize offset = 0;
-					vkCmdBindVertexBuffers(m_commandBuffer
-						, 0
-						, 1
-						, &vb.m_buffer
-						, &offset
-						);
+					const uint32_t fstencil = unpackStencil(0, draw.m_stencil);
+
+					DrawCommandVK cmd;
+					cmd.m_pipeline         = pipeline;
+					cmd.m_descriptorSet    = currentDescriptorSet;
+					cmd.m_uniformOffset[0] = currentUniformOffset[0];
+					cmd.m_uniformOffset[1] = currentUniformOffset[1];
+					cmd.m_vertexBuffer     = vb.m_buffer;
+					cmd.m_indexBuffer      = VK_NULL_HANDLE;
+					cmd.m_indexType        = VK_INDEX_TYPE_UINT16;
+					cmd.m_rgba             = draw.m_rgba;
+					cmd.m_stencilRef       = (fstencil&BGFX_STENCIL_FUNC_REF_MASK)>>BGFX_STENCIL_FUNC_REF_SHIFT;
+					cmd.m_numInstances     = draw.m_numInstances;
+					cmd.m_startVertex      = draw.m_stream[0].m_startVertex;
+					cmd.m_startIndex       = draw.m_startIndex;
+					cmd.m_numIndices       = 0;
+					cmd.m_numVertices      = UINT32_MAX == draw.m_numVertices
+						? vb.m_size / vertexDecl.m_stride
+						: draw.m_numVertices
+						;
 
-					if (!isValid(draw.m_indexBuffer) )
+					Rect scissorRect = viewScissorRect;
+					if (UINT16_MAX != draw.m_scissor)
 					{
-						const uint32_t numVertices = UINT32_MAX == draw.m_numVertices
-							? vb.m_size / vertexDecl.m_stride
-							: draw.m_numVertices
-							;
-						vkCmdDraw(m_commandBuffer
-							, numVertices
-							, draw.m_numInstances
-							, draw.m_stream[0].m_startVertex
-							, 0
-							);
+						scissorRect.setIntersect(viewScissorRect, _render->m_frameCache.m_rectCache.m_cache[draw.m_scissor]);
 					}
-					else
+
+					cmd.m_scissor.offset.x      = scissorRect.m_x;
+					cmd.m_scissor.offset.y      = scissorRect.m_y;
+					cmd.m_scissor.extent.width  = scissorRect.m_width;
+					cmd.m_scissor.extent.height = scissorRect.m_height;
+
+					if (isValid(draw.m_indexBuffer) )
 					{
-						BufferVK& ib = m_indexBuffers[draw.m_indexBuffer.idx];
-//						ib.setState(_commandList, D3D12_RESOURCE_STATE_GENERIC_READ);
+						const BufferVK& ib = m_indexBuffers[draw.m_indexBuffer.idx];
 
 						const bool hasIndex16 = 0 == (ib.m_flags & BGFX_BUFFER_INDEX32);
 						const uint32_t indexSize = hasIndex16 ? 2 : 4;
@@ -4565,22 +5943,22 @@ BX_UNUSED(currentSamplerStateIdx);
 							: draw.m_numIndices
 							;
 
-						vkCmdBindIndexBuffer(m_commandBuffer
-							, ib.m_buffer
-							, 0
-							, hasIndex16
-								? VK_INDEX_TYPE_UINT16
-								: VK_INDEX_TYPE_UINT32
-							);
-						vkCmdDrawIndexed(m_commandBuffer
-							, numIndices
-							, draw.m_numInstances
-							, draw.m_startIndex
-							, draw.m_stream[0].m_startVertex
-							, 0
-							);
+						cmd.m_indexBuffer = ib.m_buffer;
+						cmd.m_indexType   = hasIndex16
+							? VK_INDEX_TYPE_UINT16
+							: VK_INDEX_TYPE_UINT32
+							;
+						cmd.m_numIndices  = numIndices;
 					}
 
+					if (BGFX_CONFIG_RECORD_RANGE_SIZE == m_recordRanges[rangeIdx].m_num)
+					{
+						rangeIdx = addRecordRange(view, _render->m_view[view].m_rect, viewScissorRect);
+					}
+
+					m_drawCommands.push_back(cmd);
+					++m_recordRanges[rangeIdx].m_num;
+
 					uint32_t numPrimsSubmitted = numIndices / prim.m_div - prim.m_sub;
 					uint32_t numPrimsRendered  = numPrimsSubmitted*draw.m_numInstances;
 
@@ -4598,6 +5976,74 @@ BX_UNUSED(currentSamplerStateIdx);
 				}
 			}
 
+			// Translation above is serial, uniform commits and descriptor sets
+			// depend on previous draw. Only recording of translated ranges is
+			// split across threads.
+			const uint32_t numRanges = uint32_t(m_recordRanges.size() );
+			if (0 < numRanges)
+			{
+				m_commandRecorder.reset(frame);
+				m_commandRecorder.record(&m_recordRanges[0], numRanges);
+			}
+
+			bool beginRenderPass = false;
+			view = UINT16_MAX;
+
+			for (RecordRangeArray::const_iterator it = m_recordRanges.begin(), itEnd = m_recordRanges.end(); it != itEnd; ++it)
+			{
+				const RecordRangeVK& range = *it;
+
+				if (range.m_view != view)
+				{
+					view = range.m_view;
+
+					if (beginRenderPass)
+					{
+						vkCmdEndRenderPass(m_commandBuffer);
+						beginRenderPass = false;
+
+						if (BX_ENABLED(BGFX_CONFIG_DEBUG_ANNOTATION) )
+						{
+							vkCmdEndDebugUtilsLabelEXT(m_commandBuffer);
+						}
+					}
+
+					submitBlit(bs, view);
+
+					if (BX_ENABLED(BGFX_CONFIG_DEBUG_ANNOTATION) )
+					{
+						VkDebugUtilsLabelEXT dul;
+						dul.sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT;
+						dul.pNext = NULL;
+						dul.pLabelName = s_viewName[view];
+						dul.color[0] = 1.0f;
+						dul.color[1] = 1.0f;
+						dul.color[2] = 1.0f;
+						dul.color[3] = 1.0f;
+						vkCmdBeginDebugUtilsLabelEXT(m_commandBuffer, &dul);
+					}
+
+					rpbi.renderArea.offset.x = range.m_rect.m_x;
+					rpbi.renderArea.offset.y = range.m_rect.m_y;
+					rpbi.renderArea.extent.width  = range.m_rect.m_width;
+					rpbi.renderArea.extent.height = range.m_rect.m_height;
+					vkCmdBeginRenderPass(m_commandBuffer, &rpbi, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+					beginRenderPass = true;
+				}
+
+				vkCmdExecuteCommands(m_commandBuffer, 1, &range.m_commandBuffer);
+			}
+
+			if (beginRenderPass)
+			{
+				vkCmdEndRenderPass(m_commandBuffer);
+
+				if (BX_ENABLED(BGFX_CONFIG_DEBUG_ANNOTATION) )
+				{
+					vkCmdEndDebugUtilsLabelEXT(m_commandBuffer);
+				}
+			}
+
 			submitBlit(bs, BGFX_CONFIG_MAX_VIEWS);
 
 //			m_batch.end(m_commandList);
@@ -4781,9 +6227,10 @@ BX_UNUSED(presentMin, presentMax);
 
 				pos++;
 				tvm.printf(10, pos++, 0x8b, " State cache:                        ");
-				tvm.printf(10, pos++, 0x8b, " PSO    | Sampler | Bind   | Queued  ");
-				tvm.printf(10, pos++, 0x8b, " %6d " //|  %6d | %6d | %6d  "
+				tvm.printf(10, pos++, 0x8b, " PSO    | DS     | Sampler | Bind   | Queued  ");
+				tvm.printf(10, pos++, 0x8b, " %6d | %6d " //|  %6d | %6d | %6d  "
 					, m_pipelineStateCache.getCount()
+					, m_descriptorSetCache.getCount()
 //					, m_samplerStateCache.getCount()
 //					, bindLru.getCount()
 //					, m_cmd.m_control.available()
@@ -4818,17 +6265,6 @@ BX_UNUSED(presentMin, presentMax);
 //			PIX_ENDEVENT();
 		}
 
-		if (beginRenderPass)
-		{
-			vkCmdEndRenderPass(m_commandBuffer);
-			beginRenderPass = false;
-
-			if (BX_ENABLED(BGFX_CONFIG_DEBUG_ANNOTATION) )
-			{
-				vkCmdEndDebugUtilsLabelEXT(m_commandBuffer);
-			}
-		}
-
 		setImageMemoryBarrier(m_commandBuffer
 			, m_backBufferColorImage[m_backBufferColorIdx]
 			, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL
@@ -4837,10 +6273,12 @@ BX_UNUSED(presentMin, presentMax);
 
 		VK_CHECK(vkEndCommandBuffer(m_commandBuffer) );
 
-		kick(renderWait); //, m_presentDone[m_backBufferColorIdx]);
-		finishAll();
+		m_cmd.kick(m_imageAcquired[frame], m_renderDone[frame]);
+		m_presentFrame = frame;
 
-		VK_CHECK(vkResetCommandPool(m_device, m_commandPool, 0) );
+		captureElapsed = -bx::getHPCounter();
+		capture(_render->m_frameNum);
+		captureElapsed += bx::getHPCounter();
 	}
 
 } /* namespace vk */ } // namespace bgfx
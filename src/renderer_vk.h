@@ -136,6 +136,7 @@
 			VK_IMPORT_DEVICE_FUNC(false, vkQueueWaitIdle);                 \
 			VK_IMPORT_DEVICE_FUNC(false, vkDeviceWaitIdle);                \
 			VK_IMPORT_DEVICE_FUNC(false, vkWaitForFences);                 \
+			VK_IMPORT_DEVICE_FUNC(false, vkGetFenceStatus);                \
 			VK_IMPORT_DEVICE_FUNC(false, vkBeginCommandBuffer);            \
 			VK_IMPORT_DEVICE_FUNC(false, vkEndCommandBuffer);              \
 			VK_IMPORT_DEVICE_FUNC(false, vkCmdPipelineBarrier);            \
@@ -161,6 +162,8 @@
 			VK_IMPORT_DEVICE_FUNC(false, vkCmdClearAttachments);           \
 			VK_IMPORT_DEVICE_FUNC(false, vkCmdResolveImage);               \
 			VK_IMPORT_DEVICE_FUNC(false, vkCmdCopyBuffer);                 \
+			VK_IMPORT_DEVICE_FUNC(false, vkCmdExecuteCommands);            \
+			VK_IMPORT_DEVICE_FUNC(false, vkCmdCopyImageToBuffer);          \
 			VK_IMPORT_DEVICE_FUNC(false, vkMapMemory);                     \
 			VK_IMPORT_DEVICE_FUNC(false, vkUnmapMemory);                   \
 			VK_IMPORT_DEVICE_FUNC(false, vkFlushMappedMemoryRanges);       \
@@ -235,6 +238,17 @@ namespace bgfx { namespace vk
 VK_DESTROY
 #undef VK_DESTROY_FUNC
 
+	void vkDestroy(VkDescriptorSet& _obj);
+
+	/// Deferred destruction, object is destroyed once GPU is done with all
+	/// frames submitted so far.
+#define VK_DESTROY_FUNC(_name) void vkRelease(Vk##_name& _obj)
+VK_DESTROY
+#undef VK_DESTROY_FUNC
+
+	void vkRelease(VkDescriptorSet& _obj);
+	void vkReleaseMemory(VkDeviceMemory& _obj);
+
 	struct DslBinding
 	{
 		enum Enum
@@ -274,7 +288,7 @@ VK_DESTROY
 			typename HashMap::iterator it = m_hashMap.find(_key);
 			if (it != m_hashMap.end() )
 			{
-				vkDestroy(it->second);
+				vkRelease(it->second);
 				m_hashMap.erase(it);
 			}
 		}
@@ -283,7 +297,7 @@ VK_DESTROY
 		{
 			for (typename HashMap::iterator it = m_hashMap.begin(), itEnd = m_hashMap.end(); it != itEnd; ++it)
 			{
-				vkDestroy(it->second);
+				vkRelease(it->second);
 			}
 
 			m_hashMap.clear();
@@ -299,6 +313,60 @@ VK_DESTROY
 		HashMap m_hashMap;
 	};
 
+	class CommandQueueVK
+	{
+	public:
+		typedef void (*ReleaseFn)(uint64_t _handle);
+
+		CommandQueueVK()
+			: m_numFramesInFlight(0)
+			, m_currentFrame(0)
+		{
+		}
+
+		void init(uint32_t _numFramesInFlight);
+		void shutdown();
+
+		/// Waits until GPU is done with previous use of current frame, destroys
+		/// objects released before it, and returns reset command buffer.
+		VkCommandBuffer alloc();
+
+		/// Submits current frame command buffer, and moves to next frame.
+		void kick(VkSemaphore _wait, VkSemaphore _signal);
+
+		/// Waits for all submitted frames.
+		void finish();
+
+		void release(uint64_t _handle, ReleaseFn _fn);
+
+		uint32_t m_numFramesInFlight;
+		uint32_t m_currentFrame;
+
+	private:
+		struct Resource
+		{
+			uint64_t  m_handle;
+			ReleaseFn m_fn;
+		};
+
+		typedef stl::vector<Resource> ResourceArray;
+
+		struct Frame
+		{
+			ResourceArray m_release;
+			VkCommandPool m_commandPool;
+			VkCommandBuffer m_commandBuffer;
+			VkFence m_fence;
+			bool m_submitted;
+		};
+
+		void consume(Frame& _frame);
+		static void consume(ResourceArray& _release);
+
+		Frame m_frame[BGFX_CONFIG_MAX_FRAME_LATENCY];
+		ResourceArray m_release;
+	};
+
 	class ScratchBufferVK
 	{
 	public:
@@ -310,19 +378,89 @@ VK_DESTROY
 		{
 		}
 
-		void create(uint32_t _size, uint32_t _maxDescriptors);
+		void create(uint32_t _size);
 		void destroy();
 		void reset(VkDescriptorBufferInfo& _gpuAddress);
-		void* allocUbv(uint32_t _vsize, uint32_t _fsize);
 
-		VkDescriptorSet* m_descriptorSet;
+		/// Allocates vertex and fragment uniform data. Returns descriptor set
+		/// to bind, and dynamic offsets of both uniform buffers in _offset.
+		VkDescriptorSet allocUbv(uint32_t _vsize, uint32_t _fsize, uint32_t _offset[2], void** _data);
+
+		VkBuffer m_buffer;
+		VkDeviceMemory m_deviceMem;
+		uint8_t* m_data;
+		uint32_t m_size;
+		uint32_t m_pos;
+	};
+
+	class StagingBufferVK
+	{
+	public:
+		StagingBufferVK()
+			: m_commandPool(VK_NULL_HANDLE)
+			, m_data(NULL)
+			, m_size(0)
+			, m_pos(0)
+			, m_current(0)
+		{
+		}
+
+		~StagingBufferVK()
+		{
+		}
+
+		void create(uint32_t _size);
+		void destroy();
+
+		/// Copies _data into current partition, and records copy into _dst
+		/// buffer. Copy is executed on GPU after next `flush`.
+		void copy(VkBuffer _dst, uint32_t _dstOffset, const void* _data, uint32_t _size);
+
+		/// Submits all pending copies in single transfer command buffer, and
+		/// moves to next partition.
+		void flush();
+
+		struct Batch
+		{
+			VkBuffer m_dst;
+			uint32_t m_first;
+			uint32_t m_num;
+			bool m_barrier;
+		};
+
+		struct Partition
+		{
+			VkCommandBuffer m_commandBuffer;
+			VkFence m_fence;
+			bool m_submitted;
+		};
+
+		/// Destination range written since last barrier.
+		struct Written
+		{
+			VkBuffer m_dst;
+			uint32_t m_begin;
+			uint32_t m_end;
+		};
+
+		typedef stl::vector<Batch> BatchArray;
+		typedef stl::vector<VkBufferCopy> RegionArray;
+		typedef stl::vector<Written> WrittenArray;
+
+		/// Returns index of first written range of _dst that ends after _begin.
+		uint32_t findWritten(VkBuffer _dst, uint32_t _begin) const;
+
+		Partition m_partition[BGFX_CONFIG_MAX_FRAME_LATENCY];
+		BatchArray  m_batch;
+		RegionArray m_region;
+		WrittenArray m_written; //!< Sorted by destination and offset, adjacent ranges merged.
 		VkBuffer m_buffer;
 		VkDeviceMemory m_deviceMem;
+		VkCommandPool m_commandPool;
 		uint8_t* m_data;
 		uint32_t m_size;
 		uint32_t m_pos;
-		uint32_t m_currentDs;
-		uint32_t m_maxDescriptors;
+		uint32_t m_current;
 	};
 
 	struct ImageVK
@@ -354,7 +492,7 @@ VK_DESTROY
 		}
 
 		void create(uint32_t _size, void* _data, uint16_t _flags, bool _vertex, uint32_t _stride = 0);
-		void update(VkCommandBuffer _commandBuffer, uint32_t _offset, uint32_t _size, void* _data, bool _discard = false);
+		void update(uint32_t _offset, uint32_t _size, void* _data, bool _discard = false);
 		void destroy();
 
 		VkBuffer m_buffer;
@@ -441,6 +579,171 @@ VK_DESTROY
 		uint8_t m_numPredefined;
 	};
 
+	/// Everything needed to recreate graphics pipeline. Keys of compiled
+	/// pipelines are persisted, and used to warm up pipeline cache when
+	/// program using them is created. Render pass is identified by its
+	/// attachment formats, since handles are not stable between runs.
+	struct PipelineKeyVK
+	{
+		uint64_t m_state;
+		uint64_t m_stencil;
+		uint32_t m_vshHash;
+		uint32_t m_fshHash;
+		VertexDecl m_decl;
+		uint32_t m_colorFormat;
+		uint32_t m_depthFormat;
+		uint8_t m_numInstanceData;
+	};
+
+	class PipelineCompilerVK
+	{
+	public:
+		struct Job
+		{
+			PipelineKeyVK m_key;
+			const ShaderVK* m_vsh;
+			const ShaderVK* m_fsh;
+			uint32_t m_hash;
+		};
+
+		PipelineCompilerVK()
+			: m_numThreads(0)
+			, m_exit(false)
+		{
+		}
+
+		void init(uint32_t _numThreads);
+		void shutdown();
+
+		/// Queues pipeline for compilation on worker thread.
+		void compile(const Job& _job);
+
+		/// Returns true if pipeline is queued or being compiled.
+		bool isPending(uint32_t _hash);
+
+		/// Moves compiled pipelines into renderer pipeline state cache. When
+		/// _wait is true it blocks until all pending pipelines are compiled.
+		void update(bool _wait = false);
+
+		uint32_t getNumThreads() const
+		{
+			return m_numThreads;
+		}
+
+	private:
+		static int32_t workerProc(bx::Thread* _self, void* _userData);
+		int32_t worker();
+
+		struct Result
+		{
+			uint32_t m_hash;
+			VkPipeline m_pipeline;
+		};
+
+		typedef stl::vector<Job> JobArray;
+		typedef stl::vector<Result> ResultArray;
+		typedef stl::unordered_set<uint32_t> PendingSet;
+
+		JobArray m_jobs;
+		ResultArray m_results;
+		PendingSet m_pending;
+
+		bx::Mutex m_mutex;
+		bx::Semaphore m_jobSem;
+		bx::Semaphore m_resultSem;
+		bx::Thread m_thread[0 < BGFX_CONFIG_MAX_PIPELINE_COMPILE_THREADS ? BGFX_CONFIG_MAX_PIPELINE_COMPILE_THREADS : 1];
+		uint32_t m_numThreads;
+		bool m_exit;
+	};
+
+	/// Draw call with all state resolved on render thread. Draw commands are
+	/// recorded into secondary command buffers by CommandRecorderVK.
+	struct DrawCommandVK
+	{
+		VkPipeline m_pipeline;
+		VkDescriptorSet m_descriptorSet;
+		VkBuffer m_vertexBuffer;
+		VkBuffer m_indexBuffer;
+		VkIndexType m_indexType;
+		VkRect2D m_scissor;
+		uint32_t m_uniformOffset[2];
+		uint32_t m_rgba;
+		uint32_t m_stencilRef;
+		uint32_t m_numVertices;
+		uint32_t m_numIndices;
+		uint32_t m_numInstances;
+		uint32_t m_startVertex;
+		uint32_t m_startIndex;
+	};
+
+	/// Contiguous range of draw commands within single view, recorded into
+	/// single secondary command buffer.
+	struct RecordRangeVK
+	{
+		VkClearAttachment m_clearAttachment[BGFX_CONFIG_MAX_FRAME_BUFFER_ATTACHMENTS + 1];
+		VkClearRect m_clearRect;
+		VkCommandBuffer m_commandBuffer;
+		Rect m_rect;
+		Rect m_scissor;
+		uint32_t m_first;
+		uint32_t m_num;
+		uint16_t m_view;
+		uint8_t m_numClearAttachments;
+	};
+
+	/// Records draw command ranges into secondary command buffers on worker
+	/// threads. Draw commands are fully translated before record is called,
+	/// workers only issue vkCmd* calls.
+	class CommandRecorderVK
+	{
+	public:
+		CommandRecorderVK()
+			: m_ranges(NULL)
+			, m_numRanges(0)
+			, m_next(0)
+			, m_numStarted(0)
+			, m_numThreads(0)
+			, m_frame(0)
+			, m_exit(false)
+		{
+		}
+
+		void init(uint32_t _numThreads);
+		void shutdown();
+
+		/// Resets command pools used by _frame. GPU must be done with command
+		/// buffers previously recorded for that frame.
+		void reset(uint32_t _frame);
+
+		/// Records ranges into secondary command buffers on worker threads
+		/// and calling thread. Returns when all ranges are recorded.
+		void record(RecordRangeVK* _ranges, uint32_t _num);
+
+	private:
+		struct Worker
+		{
+			VkCommandPool m_commandPool[BGFX_CONFIG_MAX_FRAME_LATENCY];
+			stl::vector<VkCommandBuffer> m_commandBuffers[BGFX_CONFIG_MAX_FRAME_LATENCY];
+			uint32_t m_num;
+		};
+
+		static int32_t workerProc(bx::Thread* _self, void* _userData);
+		int32_t worker();
+		void run(Worker& _worker);
+
+		Worker m_worker[BGFX_CONFIG_MAX_RECORD_THREADS + 1];
+		bx::Thread m_thread[0 < BGFX_CONFIG_MAX_RECORD_THREADS ? BGFX_CONFIG_MAX_RECORD_THREADS : 1];
+		bx::Semaphore m_workSem;
+		bx::Semaphore m_doneSem;
+		RecordRangeVK* m_ranges;
+		uint32_t m_numRanges;
+		volatile uint32_t m_next;
+		volatile uint32_t m_numStarted;
+		uint32_t m_numThreads;
+		uint32_t m_frame;
+		bool m_exit;
+	};
+
 	struct TextureVK
 	{
 		void destroy();
@@ -461,6 +764,55 @@ VK_DESTROY
 		Attachment m_attachment[BGFX_CONFIG_MAX_FRAME_BUFFER_ATTACHMENTS];
 	};
 
+	struct ReadBackVK
+	{
+		struct Kind
+		{
+			enum Enum
+			{
+				Capture,
+				ScreenShot,
+
+				Count
+			};
+		};
+
+		ReadBackVK()
+			: m_control(BX_COUNTOF(m_pixels) )
+			, m_commandPool(VK_NULL_HANDLE)
+			, m_data(NULL)
+			, m_dataSize(0)
+		{
+		}
+
+		void create();
+		void destroy();
+		void read(VkImage _image, Kind::Enum _kind, uint32_t _width, uint32_t _height, VkFormat _format, uint32_t _frame, const char* _filePath = NULL);
+		void resolve(bool _wait = false);
+
+		struct Pixels
+		{
+			VkBuffer m_buffer;
+			VkDeviceMemory m_deviceMem;
+			VkFence m_fence;
+			VkCommandBuffer m_commandBuffer;
+			void* m_mapped;
+			uint32_t m_size;
+			uint32_t m_width;
+			uint32_t m_height;
+			uint32_t m_frame;
+			VkFormat m_format;
+			Kind::Enum m_kind;
+			char* m_filePath;
+		};
+
+		Pixels m_pixels[BGFX_CONFIG_MAX_READBACKS];
+		bx::RingBufferControl m_control;
+		VkCommandPool m_commandPool;
+		void* m_data;
+		uint32_t m_dataSize;
+	};
+
 } /* namespace bgfx */ } // namespace vk
 
 #endif // BGFX_RENDERER_VK_H_HEADER_GUARD
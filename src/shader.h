@@ -8,6 +8,18 @@
 
 #include <bx/readerwriter.h>
 
+// Shader variant pack:
+//   uint32_t magic
+//   uint16_t numKeywords, { uint16_t len, char name[len] } * numKeywords
+//   uint32_t numVariants (1 << numKeywords)
+//   uint32_t numBlobs
+//   uint16_t blobIndex[numVariants]
+//   { uint32_t size, uint8_t shader[size] } * numBlobs
+#define BGFX_CHUNK_MAGIC_VPK BX_MAKEFOURCC('V', 'P', 'K', 1)
+
+/// Maximum number of keywords in shader variant pack, shared by shaderc and loader.
+#define BGFX_SHADER_VARIANTS_MAX_KEYWORDS 12
+
 namespace bgfx
 {
 	///
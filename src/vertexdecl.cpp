@@ -3,13 +3,20 @@
  * License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause
  */
 
+#include <bx/allocator.h>
+#include <bx/cpu.h>
 #include <bx/debug.h>
 #include <bx/hash.h>
+#include <bx/math.h>
 #include <bx/readerwriter.h>
+#include <bx/semaphore.h>
+#include <bx/simd_t.h>
 #include <bx/sort.h>
 #include <bx/string.h>
+#include <bx/thread.h>
 #include <bx/uint32_t.h>
 
+#include "config.h"
 #include "vertexdecl.h"
 
 namespace bgfx
@@ -619,6 +626,134 @@ namespace bgfx
 		}
 	}
 
+	typedef void (*ConvertFn)(uint8_t* _dest, uint32_t _destStride, uint32_t _destNum, const uint8_t* _src, uint32_t _srcStride, uint32_t _srcNum, uint32_t _num, float _scale, float _bias);
+
+	/// Float to Uint8/Int16, 4 vertices at the time. Same rounding as vertexPack, value is
+	/// scaled, biased and truncated.
+	template<typename Ty>
+	static void convertFloatToInt(uint8_t* _dest, uint32_t _destStride, uint32_t _destNum, const uint8_t* _src, uint32_t _srcStride, uint32_t _srcNum, uint32_t _num, float _scale, float _bias)
+	{
+		using namespace bx;
+
+		const simd128_t scale = simd_splat<simd128_t>(_scale);
+		const simd128_t bias  = simd_splat<simd128_t>(_bias);
+		const simd128_t zero  = simd_zero<simd128_t>();
+
+		uint32_t ii = 0;
+
+		for (; ii + 4 <= _num; ii += 4)
+		{
+			const float* src0 = (const float*)(_src + (ii+0)*_srcStride);
+			const float* src1 = (const float*)(_src + (ii+1)*_srcStride);
+			const float* src2 = (const float*)(_src + (ii+2)*_srcStride);
+			const float* src3 = (const float*)(_src + (ii+3)*_srcStride);
+
+			Ty* dest0 = (Ty*)(_dest + (ii+0)*_destStride);
+			Ty* dest1 = (Ty*)(_dest + (ii+1)*_destStride);
+			Ty* dest2 = (Ty*)(_dest + (ii+2)*_destStride);
+			Ty* dest3 = (Ty*)(_dest + (ii+3)*_destStride);
+
+			for (uint32_t cc = 0; cc < _destNum; ++cc)
+			{
+				const simd128_t value = cc < _srcNum
+					? simd_ld<simd128_t>(src0[cc], src1[cc], src2[cc], src3[cc])
+					: zero
+					;
+
+				BX_ALIGN_DECL(16, int32_t) packed[4];
+				simd_st(packed, simd_ftoi(simd_madd(value, scale, bias) ) );
+
+				dest0[cc] = Ty(packed[0]);
+				dest1[cc] = Ty(packed[1]);
+				dest2[cc] = Ty(packed[2]);
+				dest3[cc] = Ty(packed[3]);
+			}
+		}
+
+		for (; ii < _num; ++ii)
+		{
+			const float* src  = (const float*)(_src  + ii*_srcStride);
+			Ty*          dest = (Ty*         )(_dest + ii*_destStride);
+
+			for (uint32_t cc = 0; cc < _destNum; ++cc)
+			{
+				const float value = cc < _srcNum ? src[cc] : 0.0f;
+				dest[cc] = Ty(int32_t(value * _scale + _bias) );
+			}
+		}
+	}
+
+	static void convertFloatToHalf(uint8_t* _dest, uint32_t _destStride, uint32_t _destNum, const uint8_t* _src, uint32_t _srcStride, uint32_t _srcNum, uint32_t _num, float /*_scale*/, float /*_bias*/)
+	{
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			const float* src  = (const float*)(_src  + ii*_srcStride);
+			uint16_t*    dest = (uint16_t*   )(_dest + ii*_destStride);
+
+			for (uint32_t cc = 0; cc < _destNum; ++cc)
+			{
+				dest[cc] = bx::halfFromFloat(cc < _srcNum ? src[cc] : 0.0f);
+			}
+		}
+	}
+
+	static void convertFloatToFloat(uint8_t* _dest, uint32_t _destStride, uint32_t _destNum, const uint8_t* _src, uint32_t _srcStride, uint32_t _srcNum, uint32_t _num, float /*_scale*/, float /*_bias*/)
+	{
+		const uint32_t copySize = bx::min(_destNum, _srcNum)*sizeof(float);
+		const uint32_t zeroSize = _destNum*sizeof(float) - copySize;
+
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			uint8_t* dest = _dest + ii*_destStride;
+			bx::memCopy(dest, _src + ii*_srcStride, copySize);
+			bx::memSet(dest + copySize, 0, zeroSize);
+		}
+	}
+
+	/// Selects specialized kernel for attribute conversion, or returns NULL when conversion
+	/// must go through vertexUnpack/vertexPack. Kernels match vertexPack, which packs
+	/// by AttribType and asInt only.
+	static ConvertFn selectConvertFn(
+		  float& _scale
+		, float& _bias
+		, AttribType::Enum _destType
+		, bool _destAsInt
+		, AttribType::Enum _srcType
+		)
+	{
+		_scale = 1.0f;
+		_bias  = 0.0f;
+
+		if (AttribType::Float != _srcType)
+		{
+			return NULL;
+		}
+
+		switch (_destType)
+		{
+		case AttribType::Uint8:
+			_scale = _destAsInt ? 127.0f : 255.0f;
+			_bias  = _destAsInt ? 128.0f :   0.0f;
+			return convertFloatToInt<uint8_t>;
+
+		case AttribType::Int16:
+			_scale = _destAsInt ? 32767.0f : 65535.0f;
+			_bias  = _destAsInt ?     0.0f : -32768.0f;
+			return convertFloatToInt<int16_t>;
+
+		case AttribType::Half:
+			return convertFloatToHalf;
+
+		case AttribType::Float:
+			return convertFloatToFloat;
+
+		default:
+			break;
+		}
+
+		return NULL;
+	}
+
 	void vertexConvert(const VertexDecl& _destDecl, void* _destData, const VertexDecl& _srcDecl, const void* _srcData, uint32_t _num)
 	{
 		if (_destDecl.m_hash == _srcDecl.m_hash)
@@ -641,6 +776,11 @@ namespace bgfx
 			uint32_t src;
 			uint32_t dest;
 			uint32_t size;
+			ConvertFn fn;
+			uint32_t srcNum;
+			uint32_t destNum;
+			float scale;
+			float bias;
 		};
 
 		ConvertOp convertOp[Attrib::Count];
@@ -655,6 +795,7 @@ namespace bgfx
 				ConvertOp& cop = convertOp[numOps];
 				cop.attr = attr;
 				cop.dest = _destDecl.getOffset(attr);
+				cop.fn   = NULL;
 
 				uint8_t num;
 				AttribType::Enum type;
@@ -667,6 +808,19 @@ namespace bgfx
 				{
 					cop.src = _srcDecl.getOffset(attr);
 					cop.op = _destDecl.m_attributes[attr] == _srcDecl.m_attributes[attr] ? ConvertOp::Copy : ConvertOp::Convert;
+
+					if (ConvertOp::Convert == cop.op)
+					{
+						uint8_t srcNum;
+						AttribType::Enum srcType;
+						bool srcNormalized;
+						bool srcAsInt;
+						_srcDecl.decode(attr, srcNum, srcType, srcNormalized, srcAsInt);
+
+						cop.fn      = selectConvertFn(cop.scale, cop.bias, type, asInt, srcType);
+						cop.srcNum  = srcNum;
+						cop.destNum = num;
+					}
 				}
 				else
 				{
@@ -687,8 +841,14 @@ namespace bgfx
 
 			float unpacked[4];
 
-			for (uint32_t ii = 0; ii < _num; ++ii)
+			// Vertices are converted attribute by attribute in blocks small enough to stay in
+			// cache, kernel is selected once per attribute instead of per vertex.
+			const uint32_t kBlockSize = 256;
+
+			for (uint32_t base = 0; base < _num; base += kBlockSize)
 			{
+				const uint32_t num = bx::min(_num - base, kBlockSize);
+
 				for (uint32_t jj = 0; jj < numOps; ++jj)
 				{
 					const ConvertOp& cop = convertOp[jj];
@@ -696,22 +856,38 @@ namespace bgfx
 					switch (cop.op)
 					{
 					case ConvertOp::Set:
-						bx::memSet(dest + cop.dest, 0, cop.size);
+						for (uint32_t ii = 0; ii < num; ++ii)
+						{
+							bx::memSet(dest + ii*destStride + cop.dest, 0, cop.size);
+						}
 						break;
 
 					case ConvertOp::Copy:
-						bx::memCopy(dest + cop.dest, src + cop.src, cop.size);
+						for (uint32_t ii = 0; ii < num; ++ii)
+						{
+							bx::memCopy(dest + ii*destStride + cop.dest, src + ii*srcStride + cop.src, cop.size);
+						}
 						break;
 
 					case ConvertOp::Convert:
-						vertexUnpack(unpacked, cop.attr, _srcDecl, src);
-						vertexPack(unpacked, true, cop.attr, _destDecl, dest);
+						if (NULL != cop.fn)
+						{
+							cop.fn(dest + cop.dest, destStride, cop.destNum, src + cop.src, srcStride, cop.srcNum, num, cop.scale, cop.bias);
+						}
+						else
+						{
+							for (uint32_t ii = 0; ii < num; ++ii)
+							{
+								vertexUnpack(unpacked, cop.attr, _srcDecl, src, ii);
+								vertexPack(unpacked, true, cop.attr, _destDecl, dest, ii);
+							}
+						}
 						break;
 					}
 				}
 
-				src += srcStride;
-				dest += destStride;
+				src  += num*srcStride;
+				dest += num*destStride;
 			}
 		}
 	}
@@ -765,49 +941,362 @@ namespace bgfx
 		return (uint16_t)numVertices;
 	}
 
-	uint16_t weldVertices(uint16_t* _output, const VertexDecl& _decl, const void* _data, uint16_t _num, float _epsilon)
+	static const uint32_t kWeldChunkSize = 16<<10;
+	static const uint32_t kWeldMaxSlabs  = 64;
+
+	struct WeldContext;
+	typedef void (*WeldJobFn)(WeldContext& _ctx, uint32_t _job);
+
+	/// Welding scratch state. Vertices are bucketed into uniform grid with cells two epsilons
+	/// wide, so any vertex within epsilon is either in the same cell or in one of 7 neighbor
+	/// cells on the near side of the cell. Grid is additionally split into slabs along X axis,
+	/// slabs with the same parity never share neighbor cells and are welded in parallel.
+	struct WeldContext
 	{
-		const uint32_t hashSize = bx::uint32_nextpow2(_num);
-		const uint32_t hashMask = hashSize-1;
-		const float epsilonSq = _epsilon*_epsilon;
+		const VertexDecl* m_decl;
+		const void* m_data;
+		float* m_pos;
+		uint32_t* m_hash;
+		uint32_t* m_bucketStart;
+		uint32_t* m_bucketVertex;
+		uint32_t* m_slabStart;
+		uint32_t* m_slabVertex;
+		int32_t* m_chunkMinMax;
+		void* m_output;
+		float m_invCellSize;
+		float m_epsilonSq;
+		uint32_t m_hashMask;
+		uint32_t m_num;
+		uint32_t m_parity;
+
+		WeldJobFn m_fn;
+		uint32_t m_numJobs;
+		uint32_t m_next;
+		uint32_t m_numThreads;
+		bool m_quit;
+
+		bx::Thread m_thread[0 < BGFX_CONFIG_MAX_WELD_THREADS ? BGFX_CONFIG_MAX_WELD_THREADS : 1];
+		bx::Semaphore m_workSem;
+		bx::Semaphore m_doneSem;
+	};
 
-		uint32_t numVertices = 0;
+	inline float weldCellf(float _pos, float _invCellSize)
+	{
+		// Clamp keeps far away or huge coordinates in int32_t range, distance test is exact
+		// so clamped vertices are still welded correctly.
+		return bx::clamp(bx::floor(_pos*_invCellSize), -float(1<<30), float(1<<30) );
+	}
+
+	inline uint32_t weldHash(int32_t _x, int32_t _y, int32_t _z)
+	{
+		return uint32_t(_x)*73856093u
+			^ uint32_t(_y)*19349663u
+			^ uint32_t(_z)*83492791u
+			;
+	}
 
-		const uint32_t size = sizeof(uint16_t)*(hashSize + _num);
-		uint16_t* hashTable = (uint16_t*)alloca(size);
-		bx::memSet(hashTable, 0xff, size);
+	static void weldRun(WeldContext& _ctx)
+	{
+		for (uint32_t job = bx::atomicFetchAndAdd<uint32_t>(&_ctx.m_next, 1)
+			; job < _ctx.m_numJobs
+			; job = bx::atomicFetchAndAdd<uint32_t>(&_ctx.m_next, 1)
+			)
+		{
+			_ctx.m_fn(_ctx, job);
+		}
+	}
 
-		uint16_t* next = hashTable + hashSize;
+	static int32_t weldThreadProc(bx::Thread* /*_self*/, void* _userData)
+	{
+		WeldContext& ctx = *(WeldContext*)_userData;
 
-		for (uint32_t ii = 0; ii < _num; ++ii)
+		for (;;)
+		{
+			ctx.m_workSem.wait();
+
+			if (ctx.m_quit)
+			{
+				break;
+			}
+
+			weldRun(ctx);
+			ctx.m_doneSem.post();
+		}
+
+		return 0;
+	}
+
+	/// Workers are started once per weldVertices call and reused by every dispatch.
+	static void weldStartThreads(WeldContext& _ctx)
+	{
+		_ctx.m_quit = false;
+
+		for (uint32_t ii = 0; ii < _ctx.m_numThreads; ++ii)
+		{
+			_ctx.m_thread[ii].init(weldThreadProc, &_ctx, 0, "bgfx - weld vertices");
+		}
+	}
+
+	static void weldStopThreads(WeldContext& _ctx)
+	{
+		_ctx.m_quit = true;
+		_ctx.m_workSem.post(_ctx.m_numThreads);
+
+		for (uint32_t ii = 0; ii < _ctx.m_numThreads; ++ii)
+		{
+			_ctx.m_thread[ii].shutdown();
+		}
+	}
+
+	static void weldDispatch(WeldContext& _ctx, WeldJobFn _fn, uint32_t _numJobs)
+	{
+		_ctx.m_fn      = _fn;
+		_ctx.m_numJobs = _numJobs;
+		_ctx.m_next    = 0;
+
+		// Calling thread welds too, workers are woken only when there is more than one job.
+		const uint32_t numThreads = 0 < _numJobs
+			? bx::uint32_min(_ctx.m_numThreads, _numJobs-1)
+			: 0
+			;
+
+		_ctx.m_workSem.post(numThreads);
+
+		weldRun(_ctx);
+
+		for (uint32_t ii = 0; ii < numThreads; ++ii)
+		{
+			_ctx.m_doneSem.wait();
+		}
+	}
+
+	static void weldSetupChunk(WeldContext& _ctx, uint32_t _job)
+	{
+		const uint32_t begin = _job*kWeldChunkSize;
+		const uint32_t end   = bx::uint32_min(begin + kWeldChunkSize, _ctx.m_num);
+
+		int32_t minX = INT32_MAX;
+		int32_t maxX = INT32_MIN;
+
+		for (uint32_t ii = begin; ii < end; ++ii)
 		{
 			float pos[4];
-			vertexUnpack(pos, Attrib::Position, _decl, _data, ii);
-			uint32_t hashValue = bx::hash<bx::HashMurmur2A>(pos, 3*sizeof(float) ) & hashMask;
+			vertexUnpack(pos, Attrib::Position, *_ctx.m_decl, _ctx.m_data, ii);
+
+			float* dst = &_ctx.m_pos[ii*3];
+			dst[0] = pos[0];
+			dst[1] = pos[1];
+			dst[2] = pos[2];
+
+			const int32_t xx = int32_t(weldCellf(pos[0], _ctx.m_invCellSize) );
+			const int32_t yy = int32_t(weldCellf(pos[1], _ctx.m_invCellSize) );
+			const int32_t zz = int32_t(weldCellf(pos[2], _ctx.m_invCellSize) );
+
+			_ctx.m_hash[ii] = weldHash(xx, yy, zz) & _ctx.m_hashMask;
 
-			uint16_t offset = hashTable[hashValue];
-			for (; UINT16_MAX != offset; offset = next[offset])
+			minX = bx::min(minX, xx);
+			maxX = bx::max(maxX, xx);
+		}
+
+		_ctx.m_chunkMinMax[_job*2+0] = minX;
+		_ctx.m_chunkMinMax[_job*2+1] = maxX;
+	}
+
+	template<typename Ty>
+	static void weldSlab(WeldContext& _ctx, uint32_t _job)
+	{
+		const uint32_t slab     = _job*2 + _ctx.m_parity;
+		const uint32_t sentinel = UINT32_MAX;
+		Ty* output = (Ty*)_ctx.m_output;
+
+		for (uint32_t kk = _ctx.m_slabStart[slab], kkEnd = _ctx.m_slabStart[slab+1]; kk < kkEnd; ++kk)
+		{
+			const uint32_t ii = _ctx.m_slabVertex[kk];
+			const float* pos = &_ctx.m_pos[ii*3];
+
+			int32_t cell[3];
+			int32_t side[3];
+			for (uint32_t axis = 0; axis < 3; ++axis)
 			{
-				float test[4];
-				vertexUnpack(test, Attrib::Position, _decl, _data, _output[offset]);
+				const float cellf = weldCellf(pos[axis], _ctx.m_invCellSize);
+				cell[axis] = int32_t(cellf);
+				side[axis] = pos[axis]*_ctx.m_invCellSize - cellf < 0.5f ? -1 : 1;
+			}
 
-				if (sqLength(test, pos) < epsilonSq)
+			// Lowest index vertex already chosen as unique within epsilon wins. Buckets are
+			// sorted by vertex index so scan stops as soon as it can't improve the match.
+			uint32_t match = sentinel;
+
+			for (uint32_t nn = 0; nn < 8; ++nn)
+			{
+				const int32_t xx = cell[0] + (nn&1 ? side[0] : 0);
+				const int32_t yy = cell[1] + (nn&2 ? side[1] : 0);
+				const int32_t zz = cell[2] + (nn&4 ? side[2] : 0);
+				const uint32_t hash = weldHash(xx, yy, zz) & _ctx.m_hashMask;
+
+				for (uint32_t bb = _ctx.m_bucketStart[hash], bbEnd = _ctx.m_bucketStart[hash+1]; bb < bbEnd; ++bb)
 				{
-					_output[ii] = _output[offset];
-					break;
+					const uint32_t jj = _ctx.m_bucketVertex[bb];
+					if (jj >= match)
+					{
+						break;
+					}
+
+					// Position is tested before output, vertices outside of epsilon might
+					// belong to slab that is being welded by another thread.
+					if (sqLength(&_ctx.m_pos[jj*3], pos) < _ctx.m_epsilonSq
+					&&  jj == output[jj])
+					{
+						match = jj;
+						break;
+					}
 				}
 			}
 
-			if (UINT16_MAX == offset)
+			output[ii] = Ty(sentinel == match ? ii : match);
+		}
+	}
+
+	static uint32_t weldSlabOf(const WeldContext& _ctx, uint32_t _idx, int32_t _minX, uint32_t _slabCells)
+	{
+		const int32_t xx = int32_t(weldCellf(_ctx.m_pos[_idx*3], _ctx.m_invCellSize) );
+		return (uint32_t(xx) - uint32_t(_minX) ) / _slabCells;
+	}
+
+	template<typename Ty>
+	static uint32_t weldVerticesImpl(Ty* _output, const VertexDecl& _decl, const void* _data, uint32_t _num, float _epsilon, bx::AllocatorI* _allocator)
+	{
+		if (0.0f >= _epsilon)
+		{
+			// Nothing is closer than zero.
+			for (uint32_t ii = 0; ii < _num; ++ii)
 			{
-				_output[ii] = (uint16_t)ii;
-				next[ii] = hashTable[hashValue];
-				hashTable[hashValue] = (uint16_t)ii;
-				numVertices++;
+				_output[ii] = Ty(ii);
 			}
+
+			return _num;
 		}
 
-		return (uint16_t)numVertices;
+		if (0 == _num)
+		{
+			return 0;
+		}
+
+		const uint32_t hashSize  = bx::uint32_nextpow2(bx::uint32_min(_num, 1<<30) );
+		const uint32_t numChunks = (_num + kWeldChunkSize - 1) / kWeldChunkSize;
+
+		const size_t size = 0
+			+ size_t(_num)*3*sizeof(float)       // m_pos
+			+ size_t(_num)*sizeof(uint32_t)      // m_hash
+			+ (hashSize+1)*sizeof(uint32_t)      // m_bucketStart
+			+ size_t(_num)*sizeof(uint32_t)      // m_bucketVertex
+			+ (kWeldMaxSlabs+1)*sizeof(uint32_t) // m_slabStart
+			+ size_t(_num)*sizeof(uint32_t)      // m_slabVertex
+			+ numChunks*2*sizeof(int32_t)        // m_chunkMinMax
+			;
+
+		uint8_t* scratch = (uint8_t*)BX_ALLOC(_allocator, size);
+
+		WeldContext ctx;
+		ctx.m_decl         = &_decl;
+		ctx.m_data         = _data;
+		ctx.m_pos          = (float*)scratch;
+		ctx.m_hash         = (uint32_t*)&ctx.m_pos[_num*3];
+		ctx.m_bucketStart  = &ctx.m_hash[_num];
+		ctx.m_bucketVertex = &ctx.m_bucketStart[hashSize+1];
+		ctx.m_slabStart    = &ctx.m_bucketVertex[_num];
+		ctx.m_slabVertex   = &ctx.m_slabStart[kWeldMaxSlabs+1];
+		ctx.m_chunkMinMax  = (int32_t*)&ctx.m_slabVertex[_num];
+		ctx.m_output       = _output;
+		ctx.m_invCellSize  = 1.0f/(2.0f*_epsilon);
+		ctx.m_epsilonSq    = _epsilon*_epsilon;
+		ctx.m_hashMask     = hashSize-1;
+		ctx.m_num          = _num;
+		ctx.m_parity       = 0;
+		ctx.m_numThreads   = bx::uint32_min(BGFX_CONFIG_MAX_WELD_THREADS, _num/BGFX_CONFIG_WELD_MIN_VERTICES_PER_THREAD);
+
+		weldStartThreads(ctx);
+
+		weldDispatch(ctx, weldSetupChunk, numChunks);
+
+		int32_t minX = INT32_MAX;
+		int32_t maxX = INT32_MIN;
+		for (uint32_t ii = 0; ii < numChunks; ++ii)
+		{
+			minX = bx::min(minX, ctx.m_chunkMinMax[ii*2+0]);
+			maxX = bx::max(maxX, ctx.m_chunkMinMax[ii*2+1]);
+		}
+
+		const uint32_t span      = uint32_t(maxX) - uint32_t(minX) + 1;
+		const uint32_t slabCells = bx::uint32_max(1, (span + kWeldMaxSlabs - 1) / kWeldMaxSlabs);
+		const uint32_t numSlabs  = (span + slabCells - 1) / slabCells;
+
+		// Counting sort vertices into grid buckets and slabs. Scatter goes backward so
+		// vertices stay sorted by index inside bucket and slab, and start ends at bucket
+		// begin.
+		bx::memSet(ctx.m_bucketStart, 0, (hashSize+1)*sizeof(uint32_t) );
+		bx::memSet(ctx.m_slabStart,   0, (kWeldMaxSlabs+1)*sizeof(uint32_t) );
+
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			++ctx.m_bucketStart[ctx.m_hash[ii] ];
+			++ctx.m_slabStart[weldSlabOf(ctx, ii, minX, slabCells)];
+		}
+
+		for (uint32_t ii = 0, sum = 0; ii <= hashSize; ++ii)
+		{
+			sum += ctx.m_bucketStart[ii];
+			ctx.m_bucketStart[ii] = sum;
+		}
+
+		for (uint32_t ii = 0, sum = 0; ii <= kWeldMaxSlabs; ++ii)
+		{
+			sum += ctx.m_slabStart[ii];
+			ctx.m_slabStart[ii] = sum;
+		}
+
+		for (uint32_t ii = _num; 0 < ii--;)
+		{
+			ctx.m_bucketVertex[--ctx.m_bucketStart[ctx.m_hash[ii] ] ] = ii;
+			ctx.m_slabVertex[--ctx.m_slabStart[weldSlabOf(ctx, ii, minX, slabCells)] ] = ii;
+		}
+
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			_output[ii] = Ty(UINT32_MAX);
+		}
+
+		// Even slabs first, then odd slabs which see final state of their even neighbors.
+		// Result doesn't depend on number of threads.
+		ctx.m_parity = 0;
+		weldDispatch(ctx, weldSlab<Ty>, (numSlabs+1)/2);
+
+		ctx.m_parity = 1;
+		weldDispatch(ctx, weldSlab<Ty>, numSlabs/2);
+
+		weldStopThreads(ctx);
+
+		BX_FREE(_allocator, scratch);
+
+		uint32_t numVertices = 0;
+		for (uint32_t ii = 0; ii < _num; ++ii)
+		{
+			numVertices += ii == _output[ii];
+		}
+
+		return numVertices;
+	}
+
+	uint16_t weldVertices(uint16_t* _output, const VertexDecl& _decl, const void* _data, uint16_t _num, float _epsilon)
+	{
+		bx::DefaultAllocator allocator;
+		return uint16_t(weldVerticesImpl(_output, _decl, _data, _num, _epsilon, &allocator) );
+	}
+
+	uint32_t weldVertices(uint32_t* _output, const VertexDecl& _decl, const void* _data, uint32_t _num, float _epsilon, bx::AllocatorI* _allocator)
+	{
+		bx::DefaultAllocator allocator;
+		return weldVerticesImpl(_output, _decl, _data, _num, _epsilon, NULL == _allocator ? &allocator : _allocator);
 	}
 
 } // namespace bgfx
@@ -53,6 +53,9 @@ namespace stl = tinystl;
 #include <bx/uint32_t.h>
 #include <bx/math.h>
 #include <bx/file.h>
+#include <bx/filepath.h>
+#include <bx/cpu.h>
+#include <bx/thread.h>
 
 #include "bounds.h"
 
@@ -67,11 +70,36 @@ struct Index3
 	int32_t m_vbc; // Barycentric ID. Holds eigher 0, 1 or 2.
 };
 
-typedef stl::unordered_map<uint64_t, Index3> Index3Map;
+/// Unique vertex key, full position/texcoord/normal index triple and
+/// barycentric ID.
+struct Index3Key
+{
+	int32_t m_position;
+	int32_t m_texcoord;
+	int32_t m_normal;
+	int32_t m_vbc;
+};
+
+inline bool operator==(const Index3Key& _lhs, const Index3Key& _rhs)
+{
+	return 0 == bx::memCmp(&_lhs, &_rhs, sizeof(Index3Key) );
+}
+
+namespace tinystl
+{
+	template<>
+	inline size_t hash(const Index3Key& _key)
+	{
+		return size_t(bx::hash<bx::HashMurmur2A>(&_key, sizeof(Index3Key) ) );
+	}
+
+} // namespace tinystl
+
+typedef stl::unordered_map<Index3Key, Index3> Index3Map;
 
 struct TriIndices
 {
-	uint64_t m_index[3];
+	Index3Key m_index[3];
 };
 
 typedef stl::vector<TriIndices> TriangleArray;
@@ -97,6 +125,38 @@ struct Primitive
 
 typedef stl::vector<Primitive> PrimitiveArray;
 
+struct Meshlet
+{
+	uint32_t m_startIndex;
+	uint32_t m_numIndices;
+	Sphere   m_sphere;
+	bx::Vec3 m_coneApex;
+	bx::Vec3 m_coneAxis;
+	float    m_coneCutoff;
+};
+
+typedef stl::vector<Meshlet> MeshletArray;
+
+struct Lod
+{
+	uint32_t m_startIndex;
+	uint32_t m_numIndices;
+	float    m_error;
+};
+
+typedef stl::vector<Lod> LodArray;
+
+struct Quantize
+{
+	bgfx::VertexDecl m_decl;
+	bx::Vec3 m_offset;
+	bx::Vec3 m_scale;
+	bool     m_position;
+};
+
+static const uint32_t kMeshletMaxVertices  = 64;
+static const uint32_t kMeshletMaxTriangles = 126;
+
 static uint32_t s_obbSteps = 17;
 
 #define BGFX_CHUNK_MAGIC_VB  BX_MAKEFOURCC('V', 'B', ' ', 0x1)
@@ -104,16 +164,26 @@ static uint32_t s_obbSteps = 17;
 #define BGFX_CHUNK_MAGIC_IB  BX_MAKEFOURCC('I', 'B', ' ', 0x0)
 #define BGFX_CHUNK_MAGIC_IBC BX_MAKEFOURCC('I', 'B', 'C', 0x1)
 #define BGFX_CHUNK_MAGIC_PRI BX_MAKEFOURCC('P', 'R', 'I', 0x0)
-
-void optimizeVertexCache(uint16_t* _indices, uint32_t _numIndices, uint32_t _numVertices)
+#define BGFX_CHUNK_MAGIC_MLT BX_MAKEFOURCC('M', 'L', 'T', 0x0)
+#define BGFX_CHUNK_MAGIC_LOD BX_MAKEFOURCC('L', 'O', 'D', 0x0)
+#define BGFX_CHUNK_MAGIC_QNT BX_MAKEFOURCC('Q', 'N', 'T', 0x0)
+
+// 32-bit vertex count and 32-bit index variants, written only when group doesn't fit into
+// 16-bit indices.
+#define BGFX_CHUNK_MAGIC_VB32  BX_MAKEFOURCC('V', 'B', ' ', 0x2)
+#define BGFX_CHUNK_MAGIC_VBC32 BX_MAKEFOURCC('V', 'B', 'C', 0x1)
+#define BGFX_CHUNK_MAGIC_IB32  BX_MAKEFOURCC('I', 'B', ' ', 0x1)
+#define BGFX_CHUNK_MAGIC_IBC32 BX_MAKEFOURCC('I', 'B', 'C', 0x2)
+
+void optimizeVertexCache(uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices)
 {
-	uint16_t* newIndexList = new uint16_t[_numIndices];
+	uint32_t* newIndexList = new uint32_t[_numIndices];
 	meshopt_optimizeVertexCache(newIndexList, _indices, _numIndices, _numVertices);
-	bx::memCopy(_indices, newIndexList, _numIndices * 2);
+	bx::memCopy(_indices, newIndexList, _numIndices * sizeof(uint32_t) );
 	delete[] newIndexList;
 }
 
-uint32_t optimizeVertexFetch(uint16_t* _indices, uint32_t _numIndices, uint8_t* _vertexData, uint32_t _numVertices, uint16_t _stride)
+uint32_t optimizeVertexFetch(uint32_t* _indices, uint32_t _numIndices, uint8_t* _vertexData, uint32_t _numVertices, uint16_t _stride)
 {
 	unsigned char* newVertices = (unsigned char*)malloc(_numVertices * _stride );
 	size_t vertexCount = meshopt_optimizeVertexFetch(newVertices, _indices, _numIndices, _vertexData, _numVertices, _stride);
@@ -123,15 +193,201 @@ uint32_t optimizeVertexFetch(uint16_t* _indices, uint32_t _numIndices, uint8_t*
 	return uint32_t(vertexCount);
 }
 
-void writeCompressedIndices(bx::WriterI* _writer, const uint16_t* _indices, uint32_t _numIndices, uint32_t _numVertices)
+void buildMeshlets(MeshletArray& _meshlets, const uint32_t* _indices, const PrimitiveArray& _primitives, const uint8_t* _vertices, uint32_t _numVertices, uint32_t _stride, uint32_t _positionOffset)
+{
+	const float* positions = (const float*)&_vertices[_positionOffset];
+
+	for (PrimitiveArray::const_iterator primIt = _primitives.begin(); primIt != _primitives.end(); ++primIt)
+	{
+		const Primitive& prim = *primIt;
+
+		size_t maxMeshlets = meshopt_buildMeshletsBound(prim.m_numIndices, kMeshletMaxVertices, kMeshletMaxTriangles);
+		meshopt_Meshlet* meshlets = new meshopt_Meshlet[maxMeshlets];
+		size_t numMeshlets = meshopt_buildMeshlets(meshlets
+			, &_indices[prim.m_startIndex]
+			, prim.m_numIndices
+			, _numVertices
+			, kMeshletMaxVertices
+			, kMeshletMaxTriangles
+			);
+
+		// Meshlets are built from consecutive triangles, each one covers contiguous range of
+		// primitive's index buffer.
+		uint32_t startIndex = prim.m_startIndex;
+		for (size_t ii = 0; ii < numMeshlets; ++ii)
+		{
+			const meshopt_Meshlet& src = meshlets[ii];
+			const meshopt_Bounds bounds = meshopt_computeMeshletBounds(&src, positions, _numVertices, _stride);
+
+			Meshlet meshlet;
+			meshlet.m_startIndex    = startIndex;
+			meshlet.m_numIndices    = src.triangle_count*3;
+			meshlet.m_sphere.center = bx::load<bx::Vec3>(bounds.center);
+			meshlet.m_sphere.radius = bounds.radius;
+			meshlet.m_coneApex      = bx::load<bx::Vec3>(bounds.cone_apex);
+			meshlet.m_coneAxis      = bx::load<bx::Vec3>(bounds.cone_axis);
+			meshlet.m_coneCutoff    = bounds.cone_cutoff;
+			_meshlets.push_back(meshlet);
+
+			startIndex += meshlet.m_numIndices;
+		}
+
+		BX_CHECK(startIndex == prim.m_startIndex + prim.m_numIndices, "Meshlets don't cover primitive.");
+		delete [] meshlets;
+	}
+}
+
+inline float signNotZero(float _a)
+{
+	return 0.0f > _a ? -1.0f : 1.0f;
+}
+
+void octEncode(float* _result, const float* _normal)
+{
+	const float len    = bx::abs(_normal[0]) + bx::abs(_normal[1]) + bx::abs(_normal[2]);
+	const float invLen = 0.0f < len ? 1.0f/len : 0.0f;
+	const float xx     = _normal[0]*invLen;
+	const float yy     = _normal[1]*invLen;
+
+	if (0.0f > _normal[2])
+	{
+		_result[0] = (1.0f - bx::abs(yy) ) * signNotZero(xx);
+		_result[1] = (1.0f - bx::abs(xx) ) * signNotZero(yy);
+	}
+	else
+	{
+		_result[0] = xx;
+		_result[1] = yy;
+	}
+}
+
+uint8_t* quantizeVertices(const uint8_t* _vertices, uint32_t _numVertices, const bgfx::VertexDecl& _decl, const Quantize& _quantize)
+{
+	const bgfx::VertexDecl& decl = _quantize.m_decl;
+	uint8_t* vertices = new uint8_t[_numVertices*decl.getStride()];
+
+	// Colors and texture coordinates only change type, position, normal and tangent are
+	// encoded below.
+	bgfx::vertexConvert(decl, vertices, _decl, _vertices, _numVertices);
+
+	const bx::Vec3 invScale =
+	{
+		1.0f/_quantize.m_scale.x,
+		1.0f/_quantize.m_scale.y,
+		1.0f/_quantize.m_scale.z,
+	};
+
+	// Dequantization scale is folded into model matrix at submit, which also scales normals
+	// and tangents. Directions are pre-divided by it, so that transformed ones stay correct.
+	const bx::Vec3 one      = { 1.0f, 1.0f, 1.0f };
+	const bx::Vec3 dirScale = _quantize.m_position ? invScale : one;
+
+	for (uint32_t ii = 0; ii < _numVertices; ++ii)
+	{
+		float data[4];
+
+		if (_quantize.m_position)
+		{
+			bgfx::vertexUnpack(data, bgfx::Attrib::Position, _decl, _vertices, ii);
+			const bx::Vec3 pos = bx::mul(bx::sub(bx::load<bx::Vec3>(data), _quantize.m_offset), invScale);
+			data[0] = bx::clamp(pos.x, -1.0f, 1.0f);
+			data[1] = bx::clamp(pos.y, -1.0f, 1.0f);
+			data[2] = bx::clamp(pos.z, -1.0f, 1.0f);
+			data[3] = 0.0f;
+			bgfx::vertexPack(data, true, bgfx::Attrib::Position, decl, vertices, ii);
+		}
+
+		if (decl.has(bgfx::Attrib::Normal) )
+		{
+			bgfx::vertexUnpack(data, bgfx::Attrib::Normal, _decl, _vertices, ii);
+			bx::store(data, bx::mul(bx::load<bx::Vec3>(data), dirScale) );
+			octEncode(data, data);
+			bgfx::vertexPack(data, true, bgfx::Attrib::Normal, decl, vertices, ii);
+		}
+
+		if (decl.has(bgfx::Attrib::Tangent) )
+		{
+			bgfx::vertexUnpack(data, bgfx::Attrib::Tangent, _decl, _vertices, ii);
+			bx::store(data, bx::mul(bx::load<bx::Vec3>(data), dirScale) );
+			octEncode(data, data);
+			data[2] = 0.0f;
+			bgfx::vertexPack(data, true, bgfx::Attrib::Tangent, decl, vertices, ii);
+		}
+	}
+
+	return vertices;
+}
+
+uint32_t buildLods(LodArray& _lods, uint32_t* _indices, uint32_t _numIndices, uint32_t _maxIndices, const uint8_t* _vertices, uint32_t _numVertices, uint32_t _stride, uint32_t _positionOffset, uint32_t _numLods, float _error)
+{
+	const float* positions = (const float*)&_vertices[_positionOffset];
+
+	// Simplifier error is relative to largest extent of mesh, store it in mesh units so that
+	// it can be projected to screen at runtime.
+	Aabb aabb;
+	toAabb(aabb, positions, _numVertices, _stride);
+	const bx::Vec3 size = bx::sub(aabb.max, aabb.min);
+	const float extent = bx::max(size.x, bx::max(size.y, size.z) );
+
+	Lod lod;
+	lod.m_startIndex = 0;
+	lod.m_numIndices = _numIndices;
+	lod.m_error      = 0.0f;
+	_lods.push_back(lod);
+
+	uint32_t numIndices = _numIndices;
+
+	for (uint32_t ii = 1; ii <= _numLods; ++ii)
+	{
+		// Simplifier needs room for whole source index buffer, even though result is smaller.
+		if (numIndices + _numIndices > _maxIndices)
+		{
+			break;
+		}
+
+		const uint32_t targetIndexCount = (_numIndices >> ii) / 3 * 3;
+		const float error = _error * float(1<<(ii-1) );
+
+		uint32_t* indices = &_indices[numIndices];
+		const uint32_t num = uint32_t(meshopt_simplify(indices
+			, _indices
+			, _numIndices
+			, positions
+			, _numVertices
+			, _stride
+			, targetIndexCount
+			, error
+			) );
+
+		if (0 == num
+		||  num >= _lods.back().m_numIndices)
+		{
+			break;
+		}
+
+		optimizeVertexCache(indices, num, _numVertices);
+
+		lod.m_startIndex = numIndices;
+		lod.m_numIndices = num;
+		lod.m_error      = error * extent;
+		_lods.push_back(lod);
+
+		numIndices += num;
+	}
+
+	return numIndices;
+}
+
+void writeCompressedIndices(bx::WriterI* _writer, const uint32_t* _indices, uint32_t _numIndices, uint32_t _numVertices, uint32_t _indexSize)
 {
+	// Encoded stream doesn't depend on index size, loader decodes it to either 16 or 32-bit.
 	size_t maxSize = meshopt_encodeIndexBufferBound(_numIndices, _numVertices);
 	unsigned char* compressedIndices = (unsigned char*)malloc(maxSize);
 	size_t compressedSize = meshopt_encodeIndexBuffer(compressedIndices, maxSize, _indices, _numIndices);
 	bx::printf( "indices uncompressed: %10d, compressed: %10d, ratio: %0.2f%%\n"
-		, _numIndices*2
+		, _numIndices*_indexSize
 		, (uint32_t)compressedSize
-		, 100.0f - float(compressedSize ) / float(_numIndices*2)*100.0f
+		, 100.0f - float(compressedSize ) / float(_numIndices*_indexSize)*100.0f
 		);
 
 	bx::write(_writer, (uint32_t)compressedSize);
@@ -155,7 +411,7 @@ void writeCompressedVertices(bx::WriterI* _writer,  const uint8_t* _vertices, ui
 	free(compressedVertices);
 }
 
-void calcTangents(void* _vertices, uint16_t _numVertices, bgfx::VertexDecl _decl, const uint16_t* _indices, uint32_t _numIndices)
+void calcTangents(void* _vertices, uint32_t _numVertices, bgfx::VertexDecl _decl, const uint32_t* _indices, uint32_t _numIndices)
 {
 	struct PosTexcoord
 	{
@@ -178,7 +434,7 @@ void calcTangents(void* _vertices, uint16_t _numVertices, bgfx::VertexDecl _decl
 
 	for (uint32_t ii = 0, num = _numIndices/3; ii < num; ++ii)
 	{
-		const uint16_t* indices = &_indices[ii*3];
+		const uint32_t* indices = &_indices[ii*3];
 		uint32_t i0 = indices[0];
 		uint32_t i1 = indices[1];
 		uint32_t i2 = indices[2];
@@ -282,11 +538,14 @@ void write(bx::WriterI* _writer
 		, const uint8_t* _vertices
 		, uint32_t _numVertices
 		, const bgfx::VertexDecl& _decl
-		, const uint16_t* _indices
+		, const uint32_t* _indices
 		, uint32_t _numIndices
 		, bool _compress
 		, const stl::string& _material
 		, const PrimitiveArray& _primitives
+		, const MeshletArray& _meshlets
+		, const LodArray& _lods
+		, const Quantize* _quantize
 		)
 {
 	using namespace bx;
@@ -294,38 +553,112 @@ void write(bx::WriterI* _writer
 
 	uint32_t stride = _decl.getStride();
 
+	// Bounds are always calculated from full precision vertices, only vertex buffer data is
+	// quantized.
+	const VertexDecl& decl   = NULL != _quantize ? _quantize->m_decl : _decl;
+	const uint8_t* vertices  = NULL != _quantize ? quantizeVertices(_vertices, _numVertices, _decl, *_quantize) : _vertices;
+	const uint32_t outStride = decl.getStride();
+
+	// Groups that fit into 16-bit indices are written with original chunks, so that files
+	// stay readable by older loaders.
+	const bool index32 = UINT16_MAX < _numVertices;
+
 	if (_compress)
 	{
-		write(_writer, BGFX_CHUNK_MAGIC_VBC);
+		write(_writer, index32 ? BGFX_CHUNK_MAGIC_VBC32 : BGFX_CHUNK_MAGIC_VBC);
 		write(_writer, _vertices, _numVertices, stride);
 
-		write(_writer, _decl);
+		write(_writer, decl);
+
+		if (index32)
+		{
+			write(_writer, _numVertices);
+		}
+		else
+		{
+			write(_writer, uint16_t(_numVertices) );
+		}
 
-		write(_writer, uint16_t(_numVertices) );
-		writeCompressedVertices(_writer, _vertices, _numVertices, uint16_t(stride));
+		writeCompressedVertices(_writer, vertices, _numVertices, uint16_t(outStride) );
 	}
 	else
 	{
-		write(_writer, BGFX_CHUNK_MAGIC_VB);
+		write(_writer, index32 ? BGFX_CHUNK_MAGIC_VB32 : BGFX_CHUNK_MAGIC_VB);
 		write(_writer, _vertices, _numVertices, stride);
 
-		write(_writer, _decl);
+		write(_writer, decl);
+
+		if (index32)
+		{
+			write(_writer, _numVertices);
+		}
+		else
+		{
+			write(_writer, uint16_t(_numVertices) );
+		}
+
+		write(_writer, vertices, _numVertices*outStride);
+	}
 
-		write(_writer, uint16_t(_numVertices) );
-		write(_writer, _vertices, _numVertices*stride);
+	if (vertices != _vertices)
+	{
+		delete [] vertices;
 	}
 
 	if (_compress)
 	{
-		write(_writer, BGFX_CHUNK_MAGIC_IBC);
+		write(_writer, index32 ? BGFX_CHUNK_MAGIC_IBC32 : BGFX_CHUNK_MAGIC_IBC);
+		write(_writer, _numIndices);
+		writeCompressedIndices(_writer, _indices, _numIndices, _numVertices, index32 ? 4 : 2);
+	}
+	else if (index32)
+	{
+		write(_writer, BGFX_CHUNK_MAGIC_IB32);
 		write(_writer, _numIndices);
-		writeCompressedIndices(_writer, _indices, _numIndices, _numVertices);
+		write(_writer, _indices, _numIndices*sizeof(uint32_t) );
 	}
 	else
 	{
+		uint16_t* indices16 = new uint16_t[_numIndices];
+		for (uint32_t ii = 0; ii < _numIndices; ++ii)
+		{
+			indices16[ii] = uint16_t(_indices[ii]);
+		}
+
 		write(_writer, BGFX_CHUNK_MAGIC_IB);
 		write(_writer, _numIndices);
-		write(_writer, _indices, _numIndices*2);
+		write(_writer, indices16, _numIndices*sizeof(uint16_t) );
+
+		delete [] indices16;
+	}
+
+	if (!_lods.empty() )
+	{
+		write(_writer, BGFX_CHUNK_MAGIC_LOD);
+		write(_writer, uint16_t(_lods.size() ) );
+		for (LodArray::const_iterator it = _lods.begin(); it != _lods.end(); ++it)
+		{
+			const Lod& lod = *it;
+			write(_writer, lod.m_startIndex);
+			write(_writer, lod.m_numIndices);
+			write(_writer, lod.m_error);
+		}
+	}
+
+	if (!_meshlets.empty() )
+	{
+		write(_writer, BGFX_CHUNK_MAGIC_MLT);
+		write(_writer, uint32_t(_meshlets.size() ) );
+		for (MeshletArray::const_iterator it = _meshlets.begin(); it != _meshlets.end(); ++it)
+		{
+			const Meshlet& meshlet = *it;
+			write(_writer, meshlet.m_startIndex);
+			write(_writer, meshlet.m_numIndices);
+			write(_writer, meshlet.m_sphere);
+			write(_writer, meshlet.m_coneApex);
+			write(_writer, meshlet.m_coneAxis);
+			write(_writer, meshlet.m_coneCutoff);
+		}
 	}
 
 	write(_writer, BGFX_CHUNK_MAGIC_PRI);
@@ -364,156 +697,169 @@ struct GroupSortByMaterial
 	}
 };
 
-void help(const char* _error = NULL)
-{
-	if (NULL != _error)
-	{
-		bx::printf("Error:\n%s\n\n", _error);
-	}
+static const uint32_t kMaxThreads       = 32;
+static const uint32_t kObjMinChunkSize  = 1<<20;
+static const uint32_t kObjChunksPerThread = 4;
 
-	bx::printf(
-		  "geometryc, bgfx geometry compiler tool, version %d.%d.%d.\n"
-		  "Copyright 2011-2019 Branimir Karadzic. All rights reserved.\n"
-		  "License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause\n\n"
-		, BGFX_GEOMETRYC_VERSION_MAJOR
-		, BGFX_GEOMETRYC_VERSION_MINOR
-		, BGFX_API_VERSION
-		);
+typedef void (*ParallelFn)(uint32_t _index, void* _userData);
 
-	bx::printf(
-		  "Usage: geometryc -f <in> -o <out>\n"
+struct ParallelJob
+{
+	ParallelFn m_fn;
+	void*      m_userData;
+	uint32_t   m_num;
+	uint32_t   m_next;
+};
 
-		  "\n"
-		  "Supported input file types:\n"
-		  "    *.obj                  Wavefront\n"
+int32_t parallelThreadFunc(bx::Thread* /*_self*/, void* _userData)
+{
+	ParallelJob& job = *(ParallelJob*)_userData;
 
-		  "\n"
-		  "Options:\n"
-		  "  -h, --help               Help.\n"
-		  "  -v, --version            Version information only.\n"
-		  "  -f <file path>           Input file path.\n"
-		  "  -o <file path>           Output file path.\n"
-		  "  -s, --scale <num>        Scale factor.\n"
-		  "      --ccw                Counter-clockwise winding order.\n"
-		  "      --flipv              Flip texture coordinate V.\n"
-		  "      --obb <num>          Number of steps for calculating oriented bounding box.\n"
-		  "           Default value is 17. Less steps less precise OBB is.\n"
-		  "           More steps slower calculation.\n"
-		  "      --packnormal <num>   Normal packing.\n"
-		  "           0 - unpacked 12 bytes (default).\n"
-		  "           1 - packed 4 bytes.\n"
-		  "      --packuv <num>       Texture coordinate packing.\n"
-		  "           0 - unpacked 8 bytes (default).\n"
-		  "           1 - packed 4 bytes.\n"
-		  "      --tangent            Calculate tangent vectors (packing mode is the same as normal).\n"
-		  "      --barycentric        Adds barycentric vertex attribute (packed in bgfx::Attrib::Color1).\n"
-		  "  -c, --compress           Compress indices.\n"
+	for (uint32_t ii = bx::atomicFetchAndAdd<uint32_t>(&job.m_next, 1); ii < job.m_num; ii = bx::atomicFetchAndAdd<uint32_t>(&job.m_next, 1) )
+	{
+		job.m_fn(ii, job.m_userData);
+	}
 
-		  "\n"
-		  "For additional information, see https://github.com/bkaradzic/bgfx\n"
-		);
+	return 0;
 }
 
-int main(int _argc, const char* _argv[])
+/// Calls _fn for every index in [0, _num) on up to _numThreads threads, calling thread included.
+void parallelFor(uint32_t _num, ParallelFn _fn, void* _userData, uint32_t _numThreads)
 {
-	bx::CommandLine cmdLine(_argc, _argv);
+	ParallelJob job;
+	job.m_fn       = _fn;
+	job.m_userData = _userData;
+	job.m_num      = _num;
+	job.m_next     = 0;
 
-	if (cmdLine.hasArg('v', "version") )
-	{
-		bx::printf(
-			  "geometryc, bgfx geometry compiler tool, version %d.%d.%d.\n"
-			, BGFX_GEOMETRYC_VERSION_MAJOR
-			, BGFX_GEOMETRYC_VERSION_MINOR
-			, BGFX_API_VERSION
-			);
-		return bx::kExitSuccess;
-	}
+	const uint32_t numThreads = bx::uint32_min(bx::uint32_min(_numThreads, _num), kMaxThreads);
 
-	if (cmdLine.hasArg('h', "help") )
+	bx::Thread thread[kMaxThreads];
+	for (uint32_t ii = 1; ii < numThreads; ++ii)
 	{
-		help();
-		return bx::kExitFailure;
+		thread[ii].init(parallelThreadFunc, &job, 0, "geometryc - worker");
 	}
 
-	const char* filePath = cmdLine.findOption('f');
-	if (NULL == filePath)
-	{
-		help("Input file name must be specified.");
-		return bx::kExitFailure;
-	}
+	parallelThreadFunc(NULL, &job);
 
-	const char* outFilePath = cmdLine.findOption('o');
-	if (NULL == outFilePath)
+	for (uint32_t ii = 1; ii < numThreads; ++ii)
 	{
-		help("Output file name must be specified.");
-		return bx::kExitFailure;
+		thread[ii].shutdown();
 	}
+}
 
-	float scale = 1.0f;
-	const char* scaleArg = cmdLine.findOption('s', "scale");
-	if (NULL != scaleArg)
-	{
-		if (!bx::fromString(&scale, scaleArg))
-		{
-			scale = 1.0f;
-		}
-	}
+// Face vertex indices as they appear in .obj file. Positive indices are 1-based absolute,
+// negative are relative to number of elements parsed so far, and 0 is unspecified.
+struct ObjIndex
+{
+	int32_t m_position;
+	int32_t m_texcoord;
+	int32_t m_normal;
+};
 
-	bool compress = cmdLine.hasArg('c', "compress");
+typedef stl::vector<ObjIndex> ObjIndexArray;
 
-	cmdLine.hasArg(s_obbSteps, '\0', "obb");
-	s_obbSteps = bx::uint32_min(bx::uint32_max(s_obbSteps, 1), 90);
+struct ObjFace
+{
+	uint32_t m_numVertices;
+	uint32_t m_numPositions;
+	uint32_t m_numTexcoords;
+	uint32_t m_numNormals;
+};
 
-	uint32_t packNormal = 0;
-	cmdLine.hasArg(packNormal, '\0', "packnormal");
+typedef stl::vector<ObjFace> ObjFaceArray;
+
+// Group changing statements, replayed in file order once all chunks are parsed.
+struct ObjEvent
+{
+	enum Enum
+	{
+		Name,
+		Material,
+		Vertex,
+	};
 
-	uint32_t packUv = 0;
-	cmdLine.hasArg(packUv, '\0', "packuv");
+	Enum        m_type;
+	uint32_t    m_triangle;
+	stl::string m_value;
+};
 
-	bool ccw = cmdLine.hasArg("ccw");
-	bool flipV = cmdLine.hasArg("flipv");
-	bool hasTangent = cmdLine.hasArg("tangent");
-	bool hasBc = cmdLine.hasArg("barycentric");
+typedef stl::vector<ObjEvent> ObjEventArray;
 
-	bx::FileReader fr;
-	if (!bx::open(&fr, filePath) )
+struct ObjChunk
+{
+	ObjChunk()
+		: m_numLines(0)
+		, m_numTriangles(0)
+		, m_paramVertices(false)
 	{
-		bx::printf("Unable to open input file '%s'.", filePath);
-		exit(bx::kExitFailure);
 	}
 
-	int64_t parseElapsed = -bx::getHPCounter();
-	int64_t triReorderElapsed = 0;
+	bx::StringView m_data;
+
+	Vec3Array     m_positions;
+	Vec3Array     m_normals;
+	Vec3Array     m_texcoords;
+	ObjFaceArray  m_faces;
+	ObjIndexArray m_indices;
+	ObjEventArray m_events;
+	uint32_t      m_numLines;
+	uint32_t      m_numTriangles;
+	bool          m_paramVertices;
+
+	uint32_t      m_basePosition;
+	uint32_t      m_baseTexcoord;
+	uint32_t      m_baseNormal;
+	Index3Map     m_indexMap;
+	TriangleArray m_triangles;
+};
 
-	uint32_t size = (uint32_t)bx::getSize(&fr);
-	char* data = new char[size+1];
-	size = bx::read(&fr, data, size);
-	data[size] = '\0';
-	bx::close(&fr);
+struct ObjContext
+{
+	ObjChunk* m_chunks;
+	float     m_scale;
+	bool      m_ccw;
+	bool      m_hasBc;
+};
 
-	// Reference(s):
-	// - Wavefront .obj file
-	//   https://en.wikipedia.org/wiki/Wavefront_.obj_file
+inline int32_t resolveObjIndex(int32_t _index, uint32_t _base, uint32_t _num)
+{
+	return 0 > _index ? int32_t(_base + _num) + _index
+		:  0 < _index ? _index - 1
+		:  -1
+		;
+}
 
-	Vec3Array positions;
-	Vec3Array normals;
-	Vec3Array texcoords;
-	Index3Map indexMap;
-	TriangleArray triangles;
-	GroupArray groups;
+bool insertIndex(Index3Map& _indexMap, const Index3Key& _key, const Index3& _index)
+{
+	stl::pair<Index3Map::iterator, bool> result = _indexMap.insert(stl::make_pair(_key, _index) );
+	return result.second;
+}
 
-	uint32_t num = 0;
+void closeGroup(GroupArray& _groups, Group& _group, uint32_t _numTriangles)
+{
+	_group.m_numTriangles = _numTriangles - _group.m_startTriangle;
+	if (0 < _group.m_numTriangles)
+	{
+		_groups.push_back(_group);
+		_group.m_startTriangle = _numTriangles;
+		_group.m_numTriangles = 0;
+	}
+}
 
-	Group group;
-	group.m_startTriangle = 0;
-	group.m_numTriangles = 0;
+void parseObjChunk(uint32_t _index, void* _userData)
+{
+	const ObjContext& ctx = *(const ObjContext*)_userData;
+	ObjChunk& chunk = ctx.m_chunks[_index];
+
+	uint32_t lastVertexEvent = UINT32_MAX;
 
 	char commandLine[2048];
 	uint32_t len = sizeof(commandLine);
 	int argc;
 	char* argv[64];
 
-	for (bx::StringView next(data, size); !next.isEmpty(); )
+	for (bx::StringView next(chunk.m_data); !next.isEmpty(); )
 	{
 		next = bx::tokenizeCommandLine(next, commandLine, len, argc, argv, BX_COUNTOF(argv), '\n');
 
@@ -528,123 +874,68 @@ int main(int _argc, const char* _argv[])
 			}
 			else if (0 == bx::strCmp(argv[0], "f") )
 			{
-				TriIndices triangle;
-				bx::memSet(&triangle, 0, sizeof(TriIndices) );
+				ObjFace face;
+				face.m_numVertices  = argc-1;
+				face.m_numPositions = uint32_t(chunk.m_positions.size() );
+				face.m_numTexcoords = uint32_t(chunk.m_texcoords.size() );
+				face.m_numNormals   = uint32_t(chunk.m_normals.size() );
+				chunk.m_faces.push_back(face);
 
-				const int numNormals   = (int)normals.size();
-				const int numTexcoords = (int)texcoords.size();
-				const int numPositions = (int)positions.size();
 				for (uint32_t edge = 0, numEdges = argc-1; edge < numEdges; ++edge)
 				{
-					Index3 index;
-					index.m_texcoord = -1;
-					index.m_normal = -1;
-					index.m_vertexIndex = -1;
-					if (hasBc)
+					ObjIndex index;
+					index.m_texcoord = 0;
+					index.m_normal   = 0;
+
+					bx::StringView triplet(argv[edge + 1]);
+					bx::StringView vertex(triplet);
+					bx::StringView texcoord = bx::strFind(triplet, '/');
+					if (!texcoord.isEmpty())
 					{
-						index.m_vbc = edge < 3 ? edge : (1+(edge+1) )&1;
-					}
-					else
-					{
-						index.m_vbc = 0;
-					}
+						vertex.set(vertex.getPtr(), texcoord.getPtr());
 
-					{
-						bx::StringView triplet(argv[edge + 1]);
-						bx::StringView vertex(triplet);
-						bx::StringView texcoord = bx::strFind(triplet, '/');
-						if (!texcoord.isEmpty())
+						const bx::StringView normal = bx::strFind(bx::StringView(texcoord.getPtr() + 1, triplet.getTerm()), '/');
+						if (!normal.isEmpty())
 						{
-							vertex.set(vertex.getPtr(), texcoord.getPtr());
-
-							const bx::StringView normal = bx::strFind(bx::StringView(texcoord.getPtr() + 1, triplet.getTerm()), '/');
-							if (!normal.isEmpty())
-							{
-								int32_t nn;
-								bx::fromString(&nn, bx::StringView(normal.getPtr() + 1, triplet.getTerm()));
-								index.m_normal = (nn < 0) ? nn + numNormals : nn - 1;
-							}
-
-							texcoord.set(texcoord.getPtr() + 1, normal.getPtr());
-
-							// Reference(s):
-							// - Wavefront .obj file / Vertex normal indices without texture coordinate indices
-							//   https://en.wikipedia.org/wiki/Wavefront_.obj_file#Vertex_Normal_Indices_Without_Texture_Coordinate_Indices
-							if (!texcoord.isEmpty())
-							{
-								int32_t tex;
-								bx::fromString(&tex, texcoord);
-								index.m_texcoord = (tex < 0) ? tex + numTexcoords : tex - 1;
-							}
+							bx::fromString(&index.m_normal, bx::StringView(normal.getPtr() + 1, triplet.getTerm()));
 						}
 
-						int32_t pos;
-						bx::fromString(&pos, vertex);
-						index.m_position = (pos < 0) ? pos + numPositions : pos - 1;
-					}
-
-					const uint64_t hash0 = uint64_t(index.m_position)<< 0;
-					const uint64_t hash1 = uint64_t(index.m_texcoord)<<20;
-					const uint64_t hash2 = uint64_t(index.m_normal  )<<40;
-					const uint64_t hash3 = uint64_t(index.m_vbc     )<<60;
-					const uint64_t hash  = hash0^hash1^hash2^hash3;
-
-					stl::pair<Index3Map::iterator, bool> result = indexMap.insert(stl::make_pair(hash, index) );
-					if (!result.second)
-					{
-						Index3& oldIndex = result.first->second;
-						BX_UNUSED(oldIndex);
-						BX_CHECK(true
-							&& oldIndex.m_position == index.m_position
-							&& oldIndex.m_texcoord == index.m_texcoord
-							&& oldIndex.m_normal   == index.m_normal
-							, "Hash collision!"
-							);
-					}
+						texcoord.set(texcoord.getPtr() + 1, normal.getPtr());
 
-					switch (edge)
-					{
-					case 0:	case 1:	case 2:
-						triangle.m_index[edge] = hash;
-						if (2 == edge)
+						// Reference(s):
+						// - Wavefront .obj file / Vertex normal indices without texture coordinate indices
+						//   https://en.wikipedia.org/wiki/Wavefront_.obj_file#Vertex_Normal_Indices_Without_Texture_Coordinate_Indices
+						if (!texcoord.isEmpty())
 						{
-							if (ccw)
-							{
-								bx::swap(triangle.m_index[1], triangle.m_index[2]);
-							}
-							triangles.push_back(triangle);
+							bx::fromString(&index.m_texcoord, texcoord);
 						}
-						break;
+					}
 
-					default:
-						if (ccw)
-						{
-							triangle.m_index[2] = triangle.m_index[1];
-							triangle.m_index[1] = hash;
-						}
-						else
-						{
-							triangle.m_index[1] = triangle.m_index[2];
-							triangle.m_index[2] = hash;
-						}
+					bx::fromString(&index.m_position, vertex);
 
-						triangles.push_back(triangle);
-						break;
-					}
+					chunk.m_indices.push_back(index);
 				}
+
+				chunk.m_numTriangles += 2 < face.m_numVertices ? face.m_numVertices - 2 : 0;
 			}
 			else if (0 == bx::strCmp(argv[0], "g") )
 			{
-				group.m_name = argv[1];
+				ObjEvent event;
+				event.m_type     = ObjEvent::Name;
+				event.m_triangle = chunk.m_numTriangles;
+				event.m_value    = argv[1];
+				chunk.m_events.push_back(event);
 			}
 			else if (*argv[0] == 'v')
 			{
-				group.m_numTriangles = (uint32_t)(triangles.size() ) - group.m_startTriangle;
-				if (0 < group.m_numTriangles)
+				// Only first vertex statement after faces can close group.
+				if (lastVertexEvent != chunk.m_numTriangles)
 				{
-					groups.push_back(group);
-					group.m_startTriangle = (uint32_t)(triangles.size() );
-					group.m_numTriangles = 0;
+					ObjEvent event;
+					event.m_type     = ObjEvent::Vertex;
+					event.m_triangle = chunk.m_numTriangles;
+					chunk.m_events.push_back(event);
+					lastVertexEvent = chunk.m_numTriangles;
 				}
 
 				if (0 == bx::strCmp(argv[0], "vn") )
@@ -654,16 +945,11 @@ int main(int _argc, const char* _argv[])
 					bx::fromString(&normal.y, argv[2]);
 					bx::fromString(&normal.z, argv[3]);
 
-					normals.push_back(normal);
+					chunk.m_normals.push_back(normal);
 				}
 				else if (0 == bx::strCmp(argv[0], "vp") )
 				{
-					static bool once = true;
-					if (once)
-					{
-						once = false;
-						bx::printf("warning: 'parameter space vertices' are unsupported.\n");
-					}
+					chunk.m_paramVertices = true;
 				}
 				else if (0 == bx::strCmp(argv[0], "vt") )
 				{
@@ -687,7 +973,7 @@ int main(int _argc, const char* _argv[])
 						break;
 					}
 
-					texcoords.push_back(texcoord);
+					chunk.m_texcoords.push_back(texcoord);
 				}
 				else
 				{
@@ -705,7 +991,7 @@ int main(int _argc, const char* _argv[])
 						pw = 1.0f;
 					}
 
-					float invW = scale/pw;
+					float invW = ctx.m_scale/pw;
 					px *= invW;
 					py *= invW;
 					pz *= invW;
@@ -715,25 +1001,16 @@ int main(int _argc, const char* _argv[])
 					pos.y = py;
 					pos.z = pz;
 
-					positions.push_back(pos);
+					chunk.m_positions.push_back(pos);
 				}
 			}
 			else if (0 == bx::strCmp(argv[0], "usemtl") )
 			{
-				stl::string material(argv[1]);
-
-				if (0 != bx::strCmp(material.c_str(), group.m_material.c_str() ) )
-				{
-					group.m_numTriangles = (uint32_t)(triangles.size() ) - group.m_startTriangle;
-					if (0 < group.m_numTriangles)
-					{
-						groups.push_back(group);
-						group.m_startTriangle = (uint32_t)(triangles.size() );
-						group.m_numTriangles = 0;
-					}
-				}
-
-				group.m_material = material;
+				ObjEvent event;
+				event.m_type     = ObjEvent::Material;
+				event.m_triangle = chunk.m_numTriangles;
+				event.m_value    = argv[1];
+				chunk.m_events.push_back(event);
 			}
 // unsupported tags
 // 				else if (0 == bx::strCmp(argv[0], "mtllib") )
@@ -747,17 +1024,419 @@ int main(int _argc, const char* _argv[])
 // 				}
 		}
 
-		++num;
+		++chunk.m_numLines;
+	}
+}
+
+void resolveObjChunk(uint32_t _index, void* _userData)
+{
+	const ObjContext& ctx = *(const ObjContext*)_userData;
+	ObjChunk& chunk = ctx.m_chunks[_index];
+
+	chunk.m_triangles.reserve(chunk.m_numTriangles);
+
+	uint32_t offset = 0;
+	for (ObjFaceArray::const_iterator it = chunk.m_faces.begin(), itEnd = chunk.m_faces.end(); it != itEnd; ++it)
+	{
+		const ObjFace& face = *it;
+
+		TriIndices triangle;
+		bx::memSet(&triangle, 0, sizeof(TriIndices) );
+
+		for (uint32_t edge = 0; edge < face.m_numVertices; ++edge)
+		{
+			const ObjIndex& objIndex = chunk.m_indices[offset + edge];
+
+			Index3 index;
+			index.m_position    = resolveObjIndex(objIndex.m_position, chunk.m_basePosition, face.m_numPositions);
+			index.m_texcoord    = resolveObjIndex(objIndex.m_texcoord, chunk.m_baseTexcoord, face.m_numTexcoords);
+			index.m_normal      = resolveObjIndex(objIndex.m_normal,   chunk.m_baseNormal,   face.m_numNormals);
+			index.m_vertexIndex = -1;
+			if (ctx.m_hasBc)
+			{
+				index.m_vbc = edge < 3 ? edge : (1+(edge+1) )&1;
+			}
+			else
+			{
+				index.m_vbc = 0;
+			}
+
+			Index3Key key;
+			key.m_position = index.m_position;
+			key.m_texcoord = index.m_texcoord;
+			key.m_normal   = index.m_normal;
+			key.m_vbc      = index.m_vbc;
+
+			insertIndex(chunk.m_indexMap, key, index);
+
+			switch (edge)
+			{
+			case 0:	case 1:	case 2:
+				triangle.m_index[edge] = key;
+				if (2 == edge)
+				{
+					if (ctx.m_ccw)
+					{
+						bx::swap(triangle.m_index[1], triangle.m_index[2]);
+					}
+					chunk.m_triangles.push_back(triangle);
+				}
+				break;
+
+			default:
+				if (ctx.m_ccw)
+				{
+					triangle.m_index[2] = triangle.m_index[1];
+					triangle.m_index[1] = key;
+				}
+				else
+				{
+					triangle.m_index[1] = triangle.m_index[2];
+					triangle.m_index[2] = key;
+				}
+
+				chunk.m_triangles.push_back(triangle);
+				break;
+			}
+		}
+
+		offset += face.m_numVertices;
+	}
+}
+
+/// Parses .obj data in chunks split at line boundaries. Chunks are tokenized in parallel,
+/// then face indices are resolved against element counts of preceding chunks and
+/// deduplicated per chunk in parallel, and finally chunk vertex tables, triangles and
+/// groups are merged in file order.
+uint32_t parseObj(
+	  Vec3Array& _positions
+	, Vec3Array& _normals
+	, Vec3Array& _texcoords
+	, Index3Map& _indexMap
+	, TriangleArray& _triangles
+	, GroupArray& _groups
+	, const char* _data
+	, uint32_t _size
+	, float _scale
+	, bool _ccw
+	, bool _hasBc
+	, uint32_t _numThreads
+	)
+{
+	const uint32_t numChunks = bx::uint32_max(1, bx::uint32_min(_numThreads*kObjChunksPerThread, _size/kObjMinChunkSize) );
+	ObjChunk* chunks = new ObjChunk[numChunks];
+
+	const char* term = _data + _size;
+	const char* ptr  = _data;
+	for (uint32_t ii = 0; ii < numChunks; ++ii)
+	{
+		const char* end = term;
+		if (ii != numChunks-1)
+		{
+			const char* split = bx::max(ptr, _data + uint64_t(_size)*(ii+1)/numChunks);
+			const bx::StringView eol = bx::strFind(bx::StringView(split, term), '\n');
+			end = eol.isEmpty() ? term : eol.getPtr()+1;
+		}
+
+		chunks[ii].m_data.set(ptr, end);
+		ptr = end;
+	}
+
+	ObjContext ctx;
+	ctx.m_chunks = chunks;
+	ctx.m_scale  = _scale;
+	ctx.m_ccw    = _ccw;
+	ctx.m_hasBc  = _hasBc;
+
+	parallelFor(numChunks, parseObjChunk, &ctx, _numThreads);
+
+	uint32_t numLines = 0;
+	bool paramVertices = false;
+
+	for (uint32_t ii = 0; ii < numChunks; ++ii)
+	{
+		ObjChunk& chunk = chunks[ii];
+		chunk.m_basePosition = uint32_t(_positions.size() );
+		chunk.m_baseTexcoord = uint32_t(_texcoords.size() );
+		chunk.m_baseNormal   = uint32_t(_normals.size() );
+
+		_positions.insert(_positions.end(), chunk.m_positions.begin(), chunk.m_positions.end() );
+		_texcoords.insert(_texcoords.end(), chunk.m_texcoords.begin(), chunk.m_texcoords.end() );
+		_normals.insert(_normals.end(), chunk.m_normals.begin(), chunk.m_normals.end() );
+
+		numLines      += chunk.m_numLines;
+		paramVertices |= chunk.m_paramVertices;
+	}
+
+	if (paramVertices)
+	{
+		bx::printf("warning: 'parameter space vertices' are unsupported.\n");
+	}
+
+	parallelFor(numChunks, resolveObjChunk, &ctx, _numThreads);
+
+	Group group;
+	group.m_startTriangle = 0;
+	group.m_numTriangles = 0;
+
+	for (uint32_t ii = 0; ii < numChunks; ++ii)
+	{
+		const ObjChunk& chunk = chunks[ii];
+
+		for (Index3Map::const_iterator it = chunk.m_indexMap.begin(), itEnd = chunk.m_indexMap.end(); it != itEnd; ++it)
+		{
+			insertIndex(_indexMap, it->first, it->second);
+		}
+
+		const uint32_t triangleOffset = uint32_t(_triangles.size() );
+
+		for (ObjEventArray::const_iterator it = chunk.m_events.begin(), itEnd = chunk.m_events.end(); it != itEnd; ++it)
+		{
+			const ObjEvent& event = *it;
+			const uint32_t numTriangles = triangleOffset + event.m_triangle;
+
+			switch (event.m_type)
+			{
+			case ObjEvent::Name:
+				group.m_name = event.m_value;
+				break;
+
+			case ObjEvent::Vertex:
+				closeGroup(_groups, group, numTriangles);
+				break;
+
+			case ObjEvent::Material:
+				if (0 != bx::strCmp(event.m_value.c_str(), group.m_material.c_str() ) )
+				{
+					closeGroup(_groups, group, numTriangles);
+				}
+
+				group.m_material = event.m_value;
+				break;
+			}
+		}
+
+		_triangles.insert(_triangles.end(), chunk.m_triangles.begin(), chunk.m_triangles.end() );
 	}
 
-	group.m_numTriangles = (uint32_t)(triangles.size() ) - group.m_startTriangle;
-	if (0 < group.m_numTriangles)
+	closeGroup(_groups, group, uint32_t(_triangles.size() ) );
+
+	delete [] chunks;
+
+	return numLines;
+}
+
+struct Batch
+{
+	uint8_t*       m_vertexData;
+	uint32_t*      m_indexData;
+	uint32_t       m_numVertices;
+	uint32_t       m_numIndices;
+	uint32_t       m_maxIndices;
+	stl::string    m_material;
+	PrimitiveArray m_primitives;
+	MeshletArray   m_meshlets;
+	LodArray       m_lods;
+};
+
+typedef stl::vector<Batch*> BatchArray;
+
+struct BatchContext
+{
+	Batch**                 m_batches;
+	const bgfx::VertexDecl* m_decl;
+	uint32_t                m_positionOffset;
+	uint32_t                m_numLods;
+	float                   m_lodError;
+	bool                    m_tangent;
+	bool                    m_meshlets;
+};
+
+void processBatch(uint32_t _index, void* _userData)
+{
+	const BatchContext& ctx = *(const BatchContext*)_userData;
+	Batch& batch = *ctx.m_batches[_index];
+
+	const bgfx::VertexDecl& decl = *ctx.m_decl;
+	const uint32_t stride = decl.getStride();
+
+	if (ctx.m_tangent)
 	{
-		groups.push_back(group);
-		group.m_startTriangle = (uint32_t)(triangles.size() );
-		group.m_numTriangles = 0;
+		calcTangents(batch.m_vertexData, batch.m_numVertices, decl, batch.m_indexData, batch.m_numIndices);
 	}
 
+	for (PrimitiveArray::const_iterator primIt = batch.m_primitives.begin(); primIt != batch.m_primitives.end(); ++primIt)
+	{
+		const Primitive& prim = *primIt;
+		optimizeVertexCache(batch.m_indexData + prim.m_startIndex, prim.m_numIndices, batch.m_numVertices);
+	}
+	batch.m_numVertices = optimizeVertexFetch(batch.m_indexData, batch.m_numIndices, batch.m_vertexData, batch.m_numVertices, uint16_t(stride) );
+
+	if (ctx.m_meshlets)
+	{
+		buildMeshlets(batch.m_meshlets, batch.m_indexData, batch.m_primitives, batch.m_vertexData, batch.m_numVertices, stride, ctx.m_positionOffset);
+	}
+
+	if (0 < ctx.m_numLods)
+	{
+		batch.m_numIndices = buildLods(batch.m_lods
+			, batch.m_indexData
+			, batch.m_numIndices
+			, batch.m_maxIndices
+			, batch.m_vertexData
+			, batch.m_numVertices
+			, stride
+			, ctx.m_positionOffset
+			, ctx.m_numLods
+			, ctx.m_lodError
+			);
+	}
+}
+
+struct Options
+{
+	float    m_scale;
+	float    m_lodError;
+	float    m_quantError;
+	uint32_t m_numLods;
+	uint32_t m_packNormal;
+	uint32_t m_packUv;
+	uint32_t m_numThreads;
+	bool     m_compress;
+	bool     m_index32;
+	bool     m_meshlets;
+	bool     m_quantize;
+	bool     m_ccw;
+	bool     m_flipV;
+	bool     m_tangent;
+	bool     m_barycentric;
+};
+
+void help(const char* _error = NULL)
+{
+	if (NULL != _error)
+	{
+		bx::printf("Error:\n%s\n\n", _error);
+	}
+
+	bx::printf(
+		  "geometryc, bgfx geometry compiler tool, version %d.%d.%d.\n"
+		  "Copyright 2011-2019 Branimir Karadzic. All rights reserved.\n"
+		  "License: https://github.com/bkaradzic/bgfx#license-bsd-2-clause\n\n"
+		, BGFX_GEOMETRYC_VERSION_MAJOR
+		, BGFX_GEOMETRYC_VERSION_MINOR
+		, BGFX_API_VERSION
+		);
+
+	bx::printf(
+		  "Usage: geometryc -f <in> -o <out>\n"
+		  "       geometryc --batch -f <in directory> -o <out directory>\n"
+
+		  "\n"
+		  "Supported input file types:\n"
+		  "    *.obj                  Wavefront\n"
+
+		  "\n"
+		  "Options:\n"
+		  "  -h, --help               Help.\n"
+		  "  -v, --version            Version information only.\n"
+		  "  -f <file path>           Input file path.\n"
+		  "  -o <file path>           Output file path.\n"
+		  "  -s, --scale <num>        Scale factor.\n"
+		  "      --ccw                Counter-clockwise winding order.\n"
+		  "      --flipv              Flip texture coordinate V.\n"
+		  "      --obb <num>          Number of steps for calculating oriented bounding box.\n"
+		  "           Default value is 17. Less steps less precise OBB is.\n"
+		  "           More steps slower calculation.\n"
+		  "      --packnormal <num>   Normal packing.\n"
+		  "           0 - unpacked 12 bytes (default).\n"
+		  "           1 - packed 4 bytes.\n"
+		  "      --packuv <num>       Texture coordinate packing.\n"
+		  "           0 - unpacked 8 bytes (default).\n"
+		  "           1 - packed 4 bytes.\n"
+		  "      --tangent            Calculate tangent vectors (packing mode is the same as normal).\n"
+		  "      --barycentric        Adds barycentric vertex attribute (packed in bgfx::Attrib::Color1).\n"
+		  "  -c, --compress           Compress indices.\n"
+		  "      --index32            Use 32-bit indices for groups with more than 65533 vertices,\n"
+		  "           instead of splitting them into multiple 16-bit index groups.\n"
+		  "      --meshlets           Split primitives into meshlets (clusters of up to 64 vertices and\n"
+		  "           126 triangles) with bounding sphere and normal cone, for cluster culling.\n"
+		  "      --lods <num>         Number of generated LOD levels (default 0). Each level targets half\n"
+		  "           of triangles of previous level, and is appended to group index buffer.\n"
+		  "      --loderror <num>     Simplification error of first LOD level, relative to mesh extent\n"
+		  "           (default 0.01). Error limit doubles with each next level.\n"
+		  "      --quantize           Quantize vertices: positions as normalized int16 with dequantization\n"
+		  "           offset and scale stored in mesh, octahedral encoded normals and tangents,\n"
+		  "           and half float texture coordinates.\n"
+		  "      --quanterror <num>   Max position error in mesh units (default 0.0001). Positions are kept\n"
+		  "           as float when int16 quantization of mesh bounds can't meet it.\n"
+		  "      --threads <num>      Number of threads used for parsing and processing (default 4).\n"
+		  "      --batch              Convert all *.obj files from input directory into output directory.\n"
+
+		  "\n"
+		  "For additional information, see https://github.com/bkaradzic/bgfx\n"
+		);
+}
+
+int32_t convert(const char* _filePath, const char* _outFilePath, const Options& _options)
+{
+	const float    scale      = _options.m_scale;
+	const float    lodError   = _options.m_lodError;
+	const float    quantError = _options.m_quantError;
+	const uint32_t numLods    = _options.m_numLods;
+	const uint32_t packNormal = _options.m_packNormal;
+	const uint32_t packUv     = _options.m_packUv;
+	const uint32_t numThreads = _options.m_numThreads;
+	const bool     compress   = _options.m_compress;
+	const bool     index32    = _options.m_index32;
+	const bool     meshlets   = _options.m_meshlets;
+	const bool     quantize   = _options.m_quantize;
+	const bool     ccw        = _options.m_ccw;
+	const bool     flipV      = _options.m_flipV;
+	const bool     hasBc      = _options.m_barycentric;
+	bool           hasTangent = _options.m_tangent;
+
+	bx::FileReader fr;
+	if (!bx::open(&fr, _filePath) )
+	{
+		bx::printf("Unable to open input file '%s'.\n", _filePath);
+		return bx::kExitFailure;
+	}
+
+	int64_t parseElapsed = -bx::getHPCounter();
+	int64_t triReorderElapsed = 0;
+
+	uint32_t size = (uint32_t)bx::getSize(&fr);
+	char* data = new char[size+1];
+	size = bx::read(&fr, data, size);
+	data[size] = '\0';
+	bx::close(&fr);
+
+	// Reference(s):
+	// - Wavefront .obj file
+	//   https://en.wikipedia.org/wiki/Wavefront_.obj_file
+
+	Vec3Array positions;
+	Vec3Array normals;
+	Vec3Array texcoords;
+	Index3Map indexMap;
+	TriangleArray triangles;
+	GroupArray groups;
+
+	uint32_t num = parseObj(positions
+		, normals
+		, texcoords
+		, indexMap
+		, triangles
+		, groups
+		, data
+		, size
+		, scale
+		, ccw
+		, hasBc
+		, numThreads
+		);
+
 	delete [] data;
 
 	int64_t now = bx::getHPCounter();
@@ -863,9 +1542,73 @@ int main(int _argc, const char* _argv[])
 
 	decl.end();
 
+	Quantize quant;
+	if (quantize)
+	{
+		Aabb aabb;
+		toAabb(aabb, &positions[0], uint32_t(positions.size() ), sizeof(bx::Vec3) );
+
+		quant.m_offset = getCenter(aabb);
+		quant.m_scale  = getExtents(aabb);
+		quant.m_scale.x = bx::max(quant.m_scale.x, bx::kFloatMin);
+		quant.m_scale.y = bx::max(quant.m_scale.y, bx::kFloatMin);
+		quant.m_scale.z = bx::max(quant.m_scale.z, bx::kFloatMin);
+
+		// vertexPack truncates to normalized int16, error is up to one step of half extent/32767.
+		// Error target is in mesh units, so large meshes keep float positions.
+		const float maxError = bx::max(quant.m_scale.x, bx::max(quant.m_scale.y, quant.m_scale.z) ) / 32767.0f;
+		quant.m_position = maxError <= quantError;
+
+		if (!quant.m_position)
+		{
+			bx::printf("Position quantization error %f exceeds %f, positions are not quantized.\n"
+				, maxError
+				, quantError
+				);
+		}
+
+		bgfx::VertexDecl& qdecl = quant.m_decl;
+		qdecl.begin();
+
+		if (quant.m_position)
+		{
+			qdecl.add(bgfx::Attrib::Position, 4, bgfx::AttribType::Int16, true, true);
+		}
+		else
+		{
+			qdecl.add(bgfx::Attrib::Position, 3, bgfx::AttribType::Float);
+		}
+
+		if (hasColor)
+		{
+			qdecl.add(bgfx::Attrib::Color0, 4, bgfx::AttribType::Uint8, true);
+		}
+
+		if (hasBc)
+		{
+			qdecl.add(bgfx::Attrib::Color1, 4, bgfx::AttribType::Uint8, true);
+		}
+
+		if (hasTexcoord)
+		{
+			qdecl.add(bgfx::Attrib::TexCoord0, 2, bgfx::AttribType::Half);
+		}
+
+		if (hasNormal)
+		{
+			qdecl.add(bgfx::Attrib::Normal, 2, bgfx::AttribType::Int16, true, true);
+			if (hasTangent)
+			{
+				qdecl.add(bgfx::Attrib::Tangent, 4, bgfx::AttribType::Uint8, true, true);
+			}
+		}
+
+		qdecl.end();
+	}
+
 	uint32_t stride = decl.getStride();
 	uint8_t* vertexData = new uint8_t[triangles.size() * 3 * stride];
-	uint16_t* indexData = new uint16_t[triangles.size() * 3];
+	uint32_t* indexData = new uint32_t[triangles.size() * 3];
 	int32_t numVertices = 0;
 	int32_t numIndices = 0;
 
@@ -874,18 +1617,12 @@ int main(int _argc, const char* _argv[])
 	int32_t writtenIndices = 0;
 
 	uint8_t* vertices = vertexData;
-	uint16_t* indices = indexData;
+	uint32_t* indices = indexData;
 
 	stl::string material = groups.begin()->m_material;
 
 	PrimitiveArray primitives;
-
-	bx::FileWriter writer;
-	if (!bx::open(&writer, outFilePath) )
-	{
-		bx::printf("Unable to open output file '%s'.", outFilePath);
-		exit(bx::kExitFailure);
-	}
+	BatchArray batches;
 
 	Primitive prim;
 	prim.m_startVertex = 0;
@@ -907,7 +1644,7 @@ int main(int _argc, const char* _argv[])
 		{
 			if (0 != bx::strCmp(material.c_str(), groupIt->m_material.c_str() )
 			|| sentinel
-			||  65533 <= numVertices)
+			|| (!index32 && 65533 <= numVertices) )
 			{
 				prim.m_numVertices = numVertices - prim.m_startVertex;
 				prim.m_numIndices  = numIndices  - prim.m_startIndex;
@@ -916,31 +1653,19 @@ int main(int _argc, const char* _argv[])
 					primitives.push_back(prim);
 				}
 
-				if (hasTangent)
-				{
-					calcTangents(vertexData, uint16_t(numVertices), decl, indexData, numIndices);
-				}
-
-				triReorderElapsed -= bx::getHPCounter();
-				for (PrimitiveArray::const_iterator primIt = primitives.begin(); primIt != primitives.end(); ++primIt)
-				{
-					const Primitive& prim1 = *primIt;
-					optimizeVertexCache(indexData + prim1.m_startIndex, prim1.m_numIndices, numVertices);
-				}
-				numVertices = optimizeVertexFetch(indexData, numIndices, vertexData, numVertices, uint16_t(stride));
-
-				triReorderElapsed += bx::getHPCounter();
-
-				write(&writer
-					, vertexData
-					, numVertices
-					, decl
-					, indexData
-					, numIndices
-					, compress
-					, material
-					, primitives
-					);
+				// LOD levels are appended after batch indices, and simplifier needs scratch space
+				// for whole source index buffer.
+				Batch* batch = new Batch;
+				batch->m_numVertices = numVertices;
+				batch->m_numIndices  = numIndices;
+				batch->m_maxIndices  = numIndices * (0 < numLods ? 3 : 1);
+				batch->m_vertexData  = new uint8_t[numVertices*stride];
+				batch->m_indexData   = new uint32_t[batch->m_maxIndices];
+				bx::memCopy(batch->m_vertexData, vertexData, numVertices*stride);
+				bx::memCopy(batch->m_indexData, indexData, numIndices*sizeof(uint32_t) );
+				batch->m_material   = material;
+				batch->m_primitives = primitives;
+				batches.push_back(batch);
 				primitives.clear();
 
 				for (Index3Map::iterator indexIt = indexMap.begin(); indexIt != indexMap.end(); ++indexIt)
@@ -948,10 +1673,6 @@ int main(int _argc, const char* _argv[])
 					indexIt->second.m_vertexIndex = -1;
 				}
 
-				++writtenPrimitives;
-				writtenVertices += numVertices;
-				writtenIndices += numIndices;
-
 				vertices = vertexData;
 				indices  = indexData;
 				numVertices = 0;
@@ -968,8 +1689,7 @@ int main(int _argc, const char* _argv[])
 			TriIndices& triangle = triangles[tri];
 			for (uint32_t edge = 0; edge < 3; ++edge)
 			{
-				uint64_t hash = triangle.m_index[edge];
-				Index3& index = indexMap[hash];
+				Index3& index = indexMap[triangle.m_index[edge] ];
 				if (index.m_vertexIndex == -1)
 				{
 		 			index.m_vertexIndex = numVertices++;
@@ -1017,7 +1737,7 @@ int main(int _argc, const char* _argv[])
 					vertices += stride;
 				}
 
-				*indices++ = (uint16_t)index.m_vertexIndex;
+				*indices++ = (uint32_t)index.m_vertexIndex;
 				++numIndices;
 			}
 		}
@@ -1042,12 +1762,77 @@ int main(int _argc, const char* _argv[])
 
 	BX_CHECK(0 == primitives.size(), "Not all primitives are written");
 
-	bx::printf("size: %d\n", uint32_t(bx::seek(&writer) ) );
-	bx::close(&writer);
-
 	delete [] indexData;
 	delete [] vertexData;
 
+	// Batches don't share any data, tangents, optimization, meshlets and LODs are processed
+	// in parallel, and written in order afterwards.
+	BatchContext batchCtx;
+	batchCtx.m_batches        = batches.empty() ? NULL : &batches[0];
+	batchCtx.m_decl           = &decl;
+	batchCtx.m_positionOffset = positionOffset;
+	batchCtx.m_numLods        = numLods;
+	batchCtx.m_lodError       = lodError;
+	batchCtx.m_tangent        = hasTangent;
+	batchCtx.m_meshlets       = meshlets;
+
+	triReorderElapsed -= bx::getHPCounter();
+	parallelFor(uint32_t(batches.size() ), processBatch, &batchCtx, numThreads);
+	triReorderElapsed += bx::getHPCounter();
+
+	int32_t result = bx::kExitSuccess;
+
+	bx::FileWriter writer;
+	if (!bx::open(&writer, _outFilePath) )
+	{
+		bx::printf("Unable to open output file '%s'.\n", _outFilePath);
+		result = bx::kExitFailure;
+	}
+	else
+	{
+		if (quantize
+		&&  quant.m_position)
+		{
+			bx::write(&writer, BGFX_CHUNK_MAGIC_QNT);
+			bx::write(&writer, quant.m_offset);
+			bx::write(&writer, quant.m_scale);
+		}
+
+		for (BatchArray::const_iterator it = batches.begin(); it != batches.end(); ++it)
+		{
+			const Batch& batch = **it;
+
+			write(&writer
+				, batch.m_vertexData
+				, batch.m_numVertices
+				, decl
+				, batch.m_indexData
+				, batch.m_numIndices
+				, compress
+				, batch.m_material
+				, batch.m_primitives
+				, batch.m_meshlets
+				, batch.m_lods
+				, quantize ? &quant : NULL
+				);
+
+			++writtenPrimitives;
+			writtenVertices += batch.m_numVertices;
+			writtenIndices  += batch.m_numIndices;
+		}
+
+		bx::printf("size: %d\n", uint32_t(bx::seek(&writer) ) );
+		bx::close(&writer);
+	}
+
+	for (BatchArray::const_iterator it = batches.begin(); it != batches.end(); ++it)
+	{
+		Batch* batch = *it;
+		delete [] batch->m_indexData;
+		delete [] batch->m_vertexData;
+		delete batch;
+	}
+
 	now = bx::getHPCounter();
 	convertElapsed += now;
 
@@ -1062,5 +1847,153 @@ int main(int _argc, const char* _argv[])
 		, writtenIndices
 		);
 
-	return bx::kExitSuccess;
+	return result;
+}
+
+
+int32_t convertDirectory(const char* _inDirPath, const char* _outDirPath, const Options& _options)
+{
+	bx::DirectoryReader dr;
+	if (!bx::open(&dr, _inDirPath) )
+	{
+		bx::printf("Unable to open input directory '%s'.\n", _inDirPath);
+		return bx::kExitFailure;
+	}
+
+	int32_t result = bx::kExitSuccess;
+
+	bx::Error err;
+	while (err.isOk() )
+	{
+		bx::FileInfo fi;
+		bx::read(&dr, fi, &err);
+
+		if (err.isOk()
+		&&  bx::FileType::File == fi.type
+		&&  0 == bx::strCmpI(fi.filePath.getExt(), ".obj") )
+		{
+			bx::FilePath inFilePath(_inDirPath);
+			inFilePath.join(fi.filePath.getFileName() );
+
+			bx::FilePath outFilePath(_outDirPath);
+			outFilePath.join(fi.filePath.getBaseName() );
+
+			char outFileName[bx::kMaxFilePath];
+			bx::snprintf(outFileName, BX_COUNTOF(outFileName), "%s.bin", outFilePath.getCPtr() );
+
+			bx::printf("%s -> %s\n", inFilePath.getCPtr(), outFileName);
+
+			if (bx::kExitSuccess != convert(inFilePath.getCPtr(), outFileName, _options) )
+			{
+				result = bx::kExitFailure;
+			}
+		}
+	}
+
+	bx::close(&dr);
+
+	return result;
+}
+
+int main(int _argc, const char* _argv[])
+{
+	bx::CommandLine cmdLine(_argc, _argv);
+
+	if (cmdLine.hasArg('v', "version") )
+	{
+		bx::printf(
+			  "geometryc, bgfx geometry compiler tool, version %d.%d.%d.\n"
+			, BGFX_GEOMETRYC_VERSION_MAJOR
+			, BGFX_GEOMETRYC_VERSION_MINOR
+			, BGFX_API_VERSION
+			);
+		return bx::kExitSuccess;
+	}
+
+	if (cmdLine.hasArg('h', "help") )
+	{
+		help();
+		return bx::kExitFailure;
+	}
+
+	const char* filePath = cmdLine.findOption('f');
+	if (NULL == filePath)
+	{
+		help("Input file name must be specified.");
+		return bx::kExitFailure;
+	}
+
+	const char* outFilePath = cmdLine.findOption('o');
+	if (NULL == outFilePath)
+	{
+		help("Output file name must be specified.");
+		return bx::kExitFailure;
+	}
+
+	Options options;
+
+	options.m_scale = 1.0f;
+	const char* scaleArg = cmdLine.findOption('s', "scale");
+	if (NULL != scaleArg)
+	{
+		if (!bx::fromString(&options.m_scale, scaleArg))
+		{
+			options.m_scale = 1.0f;
+		}
+	}
+
+	options.m_compress = cmdLine.hasArg('c', "compress");
+	options.m_index32  = cmdLine.hasArg("index32");
+	options.m_meshlets = cmdLine.hasArg("meshlets");
+
+	options.m_numLods = 0;
+	cmdLine.hasArg(options.m_numLods, '\0', "lods");
+	options.m_numLods = bx::uint32_min(options.m_numLods, 8);
+
+	options.m_quantize = cmdLine.hasArg("quantize");
+
+	options.m_quantError = 0.0001f;
+	const char* quantErrorArg = cmdLine.findOption("quanterror");
+	if (NULL != quantErrorArg)
+	{
+		if (!bx::fromString(&options.m_quantError, quantErrorArg) )
+		{
+			options.m_quantError = 0.0001f;
+		}
+	}
+
+	options.m_lodError = 0.01f;
+	const char* lodErrorArg = cmdLine.findOption("loderror");
+	if (NULL != lodErrorArg)
+	{
+		if (!bx::fromString(&options.m_lodError, lodErrorArg) )
+		{
+			options.m_lodError = 0.01f;
+		}
+	}
+
+	cmdLine.hasArg(s_obbSteps, '\0', "obb");
+	s_obbSteps = bx::uint32_min(bx::uint32_max(s_obbSteps, 1), 90);
+
+	options.m_packNormal = 0;
+	cmdLine.hasArg(options.m_packNormal, '\0', "packnormal");
+
+	options.m_packUv = 0;
+	cmdLine.hasArg(options.m_packUv, '\0', "packuv");
+
+	options.m_numThreads = 4;
+	cmdLine.hasArg(options.m_numThreads, '\0', "threads");
+	options.m_numThreads = bx::uint32_min(bx::uint32_max(options.m_numThreads, 1), kMaxThreads);
+
+	options.m_ccw         = cmdLine.hasArg("ccw");
+	options.m_flipV       = cmdLine.hasArg("flipv");
+	options.m_tangent     = cmdLine.hasArg("tangent");
+	options.m_barycentric = cmdLine.hasArg("barycentric");
+
+	if (cmdLine.hasArg("batch") )
+	{
+		return convertDirectory(filePath, outFilePath, options);
+	}
+
+	return convert(filePath, outFilePath, options);
 }
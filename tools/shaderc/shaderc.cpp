@@ -5,7 +5,12 @@
 
 #include "shaderc.h"
 #include <bx/commandline.h>
+#include <bx/cpu.h>
 #include <bx/filepath.h>
+#include <bx/thread.h>
+#include <bx/timer.h>
+#include <stdio.h>
+#include "../../src/shader.h"
 
 #define MAX_TAGS 256
 extern "C"
@@ -19,7 +24,9 @@ extern "C"
 #define BGFX_CHUNK_MAGIC_VSH BX_MAKEFOURCC('V', 'S', 'H', BGFX_SHADER_BIN_VERSION)
 
 #define BGFX_SHADERC_VERSION_MAJOR 1
-#define BGFX_SHADERC_VERSION_MINOR 16
+#define BGFX_SHADERC_VERSION_MINOR 17
+
+#define SHADERC_CACHE_MAGIC BX_MAKEFOURCC('S', 'C', 'C', 1)
 
 namespace bgfx
 {
@@ -672,6 +679,7 @@ namespace bgfx
 		{
 			m_depends += " \\\n ";
 			m_depends += _fileName;
+			m_dependencies.push_back(_fileName);
 		}
 
 		bool run(const char* _input)
@@ -755,6 +763,7 @@ namespace bgfx
 		fppTag* m_tagptr;
 
 		std::string m_depends;
+		std::vector<std::string> m_dependencies;
 		std::string m_default;
 		std::string m_input;
 		std::string m_preprocessed;
@@ -902,10 +911,22 @@ namespace bgfx
 				"           spirv\n"
 			  "      --preprocess              Preprocess only.\n"
 			  "      --define <defines>        Add defines to preprocessor (semicolon separated).\n"
+			  "      --keywords <keywords>     Compile all permutations of keywords (semicolon separated) into\n"
+			  "                                single variant pack. Each keyword is defined only in variants\n"
+			  "                                where it's enabled.\n"
 			  "      --raw                     Do not process shader. No preprocessor, and no glsl-optimizer (GLSL only).\n"
 			  "      --type <type>             Shader type (vertex, fragment)\n"
 			  "      --varyingdef <file path>  Path to varying.def.sc file.\n"
 			  "      --verbose                 Verbose.\n"
+			  "      --cache <dir>             Skip compilation when output for the same input, options and\n"
+			  "                                included files is found in cache directory.\n"
+
+			  "\n"
+			  "Batch mode:\n"
+			  "      --manifest <file path>    Compile all shaders listed in manifest file. Each line contains\n"
+			  "                                shaderc command line for single shader, lines starting with #\n"
+			  "                                are ignored. --cache and --verbose are passed to each shader.\n"
+			  "  -j, --jobs <num>              Number of threads used to compile shaders in batch mode.\n"
 
 			  "\n"
 			  "Options (DX9 and DX11 only):\n"
@@ -928,7 +949,7 @@ namespace bgfx
 		return word;
 	}
 
-	bool compileShader(const char* _varying, const char* _comment, char* _shader, uint32_t _shaderLen, Options& _options, bx::FileWriter* _writer)
+	bool compileShader(const char* _varying, const char* _comment, char* _shader, uint32_t _shaderLen, Options& _options, bx::WriterI* _writer)
 	{
 		uint32_t glsl  = 0;
 		uint32_t essl  = 0;
@@ -2308,9 +2329,455 @@ namespace bgfx
 
 		delete [] data;
 
+		// Report all files shader depends on, including files pulled by
+		// #include, so they can be validated by shader cache.
+		_options.dependencies = preprocessor.m_dependencies;
+
 		return compiled;
 	}
 
+	static bool hashFile(const char* _filePath, uint32_t& _outHash)
+	{
+		bx::FileReader reader;
+		if (!bx::open(&reader, _filePath) )
+		{
+			return false;
+		}
+
+		const uint32_t size = (uint32_t)bx::getSize(&reader);
+		uint8_t* data = new uint8_t[size];
+		const int32_t read = bx::read(&reader, data, int32_t(size) );
+		bx::close(&reader);
+
+		_outHash = bx::hash<bx::HashMurmur2A>(data, read);
+		delete [] data;
+
+		return true;
+	}
+
+	static std::string cacheFilePath(const char* _cacheDir, const std::string& _commandLine, const char* _shader, uint32_t _shaderLen, const char* _varying)
+	{
+		// Key is based on everything that affects output except content of
+		// included files. Those are listed in cache entry and validated on
+		// lookup. Compiler and shader binary versions are part of the key, so
+		// entries written by older shaderc are never reused.
+		const uint32_t version[] =
+		{
+			BGFX_SHADERC_VERSION_MAJOR,
+			BGFX_SHADERC_VERSION_MINOR,
+			BGFX_SHADER_BIN_VERSION,
+		};
+
+		uint32_t hash[2];
+		for (uint32_t ii = 0; ii < BX_COUNTOF(hash); ++ii)
+		{
+			bx::HashMurmur2A murmur;
+			murmur.begin(ii);
+			murmur.add(version, int32_t(sizeof(version) ) );
+			murmur.add(_commandLine.c_str(), int32_t(_commandLine.size() ) );
+			murmur.add(_shader, int32_t(_shaderLen) );
+			if (NULL != _varying)
+			{
+				murmur.add(_varying, int32_t(bx::strLen(_varying) ) );
+			}
+			hash[ii] = murmur.end();
+		}
+
+		char name[64];
+		bx::snprintf(name, BX_COUNTOF(name), "/%08x%08x.shaderc", hash[0], hash[1]);
+
+		std::string filePath = _cacheDir;
+		filePath += name;
+		return filePath;
+	}
+
+	static void writeDepends(const Options& _options)
+	{
+		std::string depends;
+		for (size_t ii = 0; ii < _options.dependencies.size(); ++ii)
+		{
+			depends += " \\\n ";
+			depends += _options.dependencies[ii];
+		}
+
+		std::string ofp = _options.outputFilePath + ".d";
+		bx::FileWriter writer;
+		if (bx::open(&writer, ofp.c_str() ) )
+		{
+			writef(&writer, "%s : %s\n", _options.outputFilePath.c_str(), depends.c_str() );
+			bx::close(&writer);
+		}
+	}
+
+	static bool readCache(const char* _cacheFilePath, Options& _options)
+	{
+		bx::FileReader reader;
+		if (!bx::open(&reader, _cacheFilePath) )
+		{
+			return false;
+		}
+
+		// Cache file can be truncated or corrupted, every read is checked and
+		// sizes are bounded by file size before anything is allocated.
+		const uint32_t fileSize = (uint32_t)bx::getSize(&reader);
+
+		bool hit = false;
+
+		uint32_t magic;
+		uint32_t numDependencies;
+		if (4 == bx::read(&reader, magic)
+		&&  SHADERC_CACHE_MAGIC == magic
+		&&  4 == bx::read(&reader, numDependencies)
+		&&  numDependencies <= fileSize/6)
+		{
+			std::vector<std::string> dependencies;
+			dependencies.reserve(numDependencies);
+
+			hit = true;
+			for (uint32_t ii = 0; ii < numDependencies && hit; ++ii)
+			{
+				uint16_t len;
+				hit = 2 == bx::read(&reader, len)
+					&& 0 != len
+					&& len <= fileSize
+					;
+
+				if (!hit)
+				{
+					break;
+				}
+
+				std::string dependency(len, '\0');
+				uint32_t expected;
+				uint32_t hash;
+				hit = len == bx::read(&reader, &dependency[0], len)
+					&& 4 == bx::read(&reader, expected)
+					&& hashFile(dependency.c_str(), hash)
+					&& expected == hash
+					;
+
+				dependencies.push_back(dependency);
+			}
+
+			uint32_t size;
+			if (hit)
+			{
+				hit = 4 == bx::read(&reader, size)
+					&& size <= fileSize
+					;
+			}
+
+			if (hit)
+			{
+				uint8_t* data = new uint8_t[size];
+				hit = int32_t(size) == bx::read(&reader, data, int32_t(size) );
+
+				if (hit)
+				{
+					BX_TRACE("Cache hit %s -> %s.", _cacheFilePath, _options.outputFilePath.c_str() );
+					writeFile(_options.outputFilePath.c_str(), data, int32_t(size) );
+
+					_options.dependencies = dependencies;
+					if (_options.depends)
+					{
+						writeDepends(_options);
+					}
+				}
+
+				delete [] data;
+			}
+		}
+
+		bx::close(&reader);
+
+		return hit;
+	}
+
+	static void writeCache(const char* _cacheFilePath, const Options& _options)
+	{
+		File output;
+		output.load(_options.outputFilePath.c_str() );
+
+		if (NULL == output.getData() )
+		{
+			return;
+		}
+
+		// Cache file is written under unique temporary name and renamed when complete,
+		// so concurrent shaderc processes never read partially written cache file.
+		static uint32_t s_tmpCounter = 0;
+		char tmpFilePath[1024];
+		bx::snprintf(tmpFilePath, BX_COUNTOF(tmpFilePath), "%s.%llx-%x.tmp"
+			, _cacheFilePath
+			, (unsigned long long)bx::getHPCounter()
+			, bx::atomicFetchAndAdd<uint32_t>(&s_tmpCounter, 1)
+			);
+
+		bx::FileWriter writer;
+		if (!bx::open(&writer, tmpFilePath) )
+		{
+			fprintf(stderr, "Unable to write shader cache file '%s'.\n", _cacheFilePath);
+			return;
+		}
+
+		bx::write(&writer, SHADERC_CACHE_MAGIC);
+		bx::write(&writer, uint32_t(_options.dependencies.size() ) );
+
+		for (size_t ii = 0; ii < _options.dependencies.size(); ++ii)
+		{
+			const std::string& dependency = _options.dependencies[ii];
+
+			uint32_t hash = 0;
+			hashFile(dependency.c_str(), hash);
+
+			bx::write(&writer, uint16_t(dependency.size() ) );
+			bx::write(&writer, dependency.c_str(), int32_t(dependency.size() ) );
+			bx::write(&writer, hash);
+		}
+
+		bx::write(&writer, output.getSize() );
+		bx::write(&writer, output.getData(), int32_t(output.getSize() ) );
+		bx::close(&writer);
+
+#if BX_PLATFORM_WINDOWS
+		// rename doesn't replace existing file on Windows, racing process
+		// can only observe missing file, which is cache miss.
+		bx::remove(_cacheFilePath);
+#endif // BX_PLATFORM_WINDOWS
+
+		if (0 != ::rename(tmpFilePath, _cacheFilePath) )
+		{
+			bx::remove(tmpFilePath);
+		}
+	}
+
+	class VectorWriter : public bx::WriterI
+	{
+	public:
+		virtual ~VectorWriter()
+		{
+		}
+
+		virtual int32_t write(const void* _data, int32_t _size, bx::Error* /*_err*/) override
+		{
+			const uint8_t* data = (const uint8_t*)_data;
+			m_data.insert(m_data.end(), data, data+_size);
+			return _size;
+		}
+
+		std::vector<uint8_t> m_data;
+	};
+
+	static bool compileVariants(const char* _varying, const char* _comment, const char* _shader, uint32_t _shaderLen, Options& _options, const std::vector<std::string>& _keywords, bx::WriterI* _writer)
+	{
+		const uint32_t numKeywords = uint32_t(_keywords.size() );
+		const uint32_t numVariants = 1<<numKeywords;
+		const size_t   padding     = 16384;
+
+		std::vector<uint16_t> blobIndex(numVariants);
+		std::vector<std::vector<uint8_t> > blobs;
+		std::vector<uint32_t> blobHash;
+		std::vector<std::string> dependencies;
+
+		for (uint32_t mask = 0; mask < numVariants; ++mask)
+		{
+			Options options = _options;
+			options.depends = false;
+
+			for (uint32_t ii = 0; ii < numKeywords; ++ii)
+			{
+				if (0 != (mask & (1<<ii) ) )
+				{
+					options.defines.push_back(_keywords[ii]);
+				}
+			}
+
+			// Inner compileShader takes ownership of source buffer.
+			char* data = new char[_shaderLen+padding+1];
+			bx::memCopy(data, _shader, _shaderLen+1);
+			bx::memSet(&data[_shaderLen+1], 0, padding);
+
+			VectorWriter writer;
+			if (!compileShader(_varying, _comment, data, _shaderLen, options, &writer) )
+			{
+				fprintf(stderr, "Failed to build variant 0x%x.\n", mask);
+				return false;
+			}
+
+			for (size_t ii = 0; ii < options.dependencies.size(); ++ii)
+			{
+				const std::string& dependency = options.dependencies[ii];
+				if (dependencies.end() == std::find(dependencies.begin(), dependencies.end(), dependency) )
+				{
+					dependencies.push_back(dependency);
+				}
+			}
+
+			// Keywords that don't affect generated code produce identical
+			// output, store each unique shader only once.
+			const uint32_t hash = bx::hash<bx::HashMurmur2A>(writer.m_data.data(), uint32_t(writer.m_data.size() ) );
+
+			uint32_t blob = 0;
+			for (uint32_t num = uint32_t(blobs.size() ); blob < num; ++blob)
+			{
+				if (hash == blobHash[blob]
+				&&  writer.m_data == blobs[blob])
+				{
+					break;
+				}
+			}
+
+			if (blob == blobs.size() )
+			{
+				blobs.push_back(writer.m_data);
+				blobHash.push_back(hash);
+			}
+
+			blobIndex[mask] = uint16_t(blob);
+		}
+
+		BX_TRACE("Variant pack: %d keywords, %d variants, %d unique shaders.", numKeywords, numVariants, int32_t(blobs.size() ) );
+
+		bx::write(_writer, BGFX_CHUNK_MAGIC_VPK);
+
+		bx::write(_writer, uint16_t(numKeywords) );
+		for (uint32_t ii = 0; ii < numKeywords; ++ii)
+		{
+			const std::string& keyword = _keywords[ii];
+			bx::write(_writer, uint16_t(keyword.size() ) );
+			bx::write(_writer, keyword.c_str(), int32_t(keyword.size() ) );
+		}
+
+		bx::write(_writer, numVariants);
+		bx::write(_writer, uint32_t(blobs.size() ) );
+		bx::write(_writer, blobIndex.data(), int32_t(numVariants*sizeof(uint16_t) ) );
+
+		for (size_t ii = 0; ii < blobs.size(); ++ii)
+		{
+			const std::vector<uint8_t>& blob = blobs[ii];
+			bx::write(_writer, uint32_t(blob.size() ) );
+			bx::write(_writer, blob.data(), int32_t(blob.size() ) );
+		}
+
+		_options.dependencies = dependencies;
+
+		if (_options.depends)
+		{
+			writeDepends(_options);
+		}
+
+		return true;
+	}
+
+	static int compileShaderFile(const bx::CommandLine& _cmdLine);
+
+	struct Batch
+	{
+		std::vector<std::string> commands;
+		int32_t next;
+		int32_t numFailed;
+	};
+
+	static int32_t batchThread(bx::Thread* /*_self*/, void* _userData)
+	{
+		Batch* batch = (Batch*)_userData;
+		const int32_t num = int32_t(batch->commands.size() );
+
+		for (int32_t ii = bx::atomicFetchAndAdd(&batch->next, 1); ii < num; ii = bx::atomicFetchAndAdd(&batch->next, 1) )
+		{
+			const std::string& command = batch->commands[ii];
+
+			char commandLine[4096];
+			uint32_t len = sizeof(commandLine);
+			int32_t argc = 0;
+			char* argv[128];
+			argv[0] = const_cast<char*>("shaderc");
+
+			bx::tokenizeCommandLine(command.c_str(), commandLine, len, argc, &argv[1], BX_COUNTOF(argv)-1, '\0');
+
+			// Global options like --verbose are set once by manifest driver, worker
+			// threads only compile.
+			const bx::CommandLine cmdLine(argc+1, (const char**)argv);
+			if (bx::kExitSuccess != compileShaderFile(cmdLine) )
+			{
+				fprintf(stderr, "Failed: %s\n", command.c_str() );
+				bx::atomicFetchAndAdd(&batch->numFailed, 1);
+			}
+		}
+
+		return bx::kExitSuccess;
+	}
+
+	int compileManifest(const char* _filePath, const bx::CommandLine& _cmdLine)
+	{
+		File manifest;
+		manifest.load(_filePath);
+
+		if (NULL == manifest.getData() )
+		{
+			fprintf(stderr, "Unable to open manifest file '%s'.\n", _filePath);
+			return bx::kExitFailure;
+		}
+
+		// Options specified next to --manifest are appended to every command.
+		std::string common;
+		const char* cacheDir = _cmdLine.findOption("cache");
+		if (NULL != cacheDir)
+		{
+			common += " --cache \"";
+			common += cacheDir;
+			common += "\"";
+		}
+
+		Batch batch;
+		batch.next      = 0;
+		batch.numFailed = 0;
+
+		const bx::StringView data(manifest.getData(), int32_t(manifest.getSize() ) );
+		for (bx::StringView next = bx::strLTrimSpace(data); !next.isEmpty(); )
+		{
+			const bx::StringView eol  = bx::strFindEol(next);
+			const bx::StringView line = bx::strRTrim(bx::StringView(next.getPtr(), eol.getPtr() ), " \t\r");
+
+			if (!line.isEmpty()
+			&&  '#' != line.getPtr()[0])
+			{
+				std::string command(line.getPtr(), line.getTerm() );
+				command += common;
+				batch.commands.push_back(command);
+			}
+
+			next = bx::strLTrimSpace(bx::strFindNl(bx::StringView(eol.getPtr(), data.getTerm() ) ) );
+		}
+
+		uint32_t numThreads = 1;
+		_cmdLine.hasArg(numThreads, 'j', "jobs");
+		numThreads = bx::uint32_clamp(numThreads, 1, uint32_t(batch.commands.size() ) );
+
+		BX_TRACE("Compiling %d shaders from '%s' using %d threads.", int32_t(batch.commands.size() ), _filePath, numThreads);
+
+		bx::Thread* threads = new bx::Thread[numThreads];
+		for (uint32_t ii = 0; ii < numThreads; ++ii)
+		{
+			threads[ii].init(batchThread, &batch, 0, "shaderc - batch");
+		}
+
+		for (uint32_t ii = 0; ii < numThreads; ++ii)
+		{
+			threads[ii].shutdown();
+		}
+
+		delete [] threads;
+
+		if (0 != batch.numFailed)
+		{
+			fprintf(stderr, "Failed to build %d of %d shaders.\n", batch.numFailed, int32_t(batch.commands.size() ) );
+			return bx::kExitFailure;
+		}
+
+		return bx::kExitSuccess;
+	}
+
 	int compileShader(int _argc, const char* _argv[])
 	{
 		bx::CommandLine cmdLine(_argc, _argv);
@@ -2334,21 +2801,32 @@ namespace bgfx
 
 		g_verbose = cmdLine.hasArg("verbose");
 
-		const char* filePath = cmdLine.findOption('f');
+		const char* manifest = cmdLine.findOption("manifest");
+		if (NULL != manifest)
+		{
+			return compileManifest(manifest, cmdLine);
+		}
+
+		return compileShaderFile(cmdLine);
+	}
+
+	static int compileShaderFile(const bx::CommandLine& _cmdLine)
+	{
+		const char* filePath = _cmdLine.findOption('f');
 		if (NULL == filePath)
 		{
 			help("Shader file name must be specified.");
 			return bx::kExitFailure;
 		}
 
-		const char* outFilePath = cmdLine.findOption('o');
+		const char* outFilePath = _cmdLine.findOption('o');
 		if (NULL == outFilePath)
 		{
 			help("Output file name must be specified.");
 			return bx::kExitFailure;
 		}
 
-		const char* type = cmdLine.findOption('\0', "type");
+		const char* type = _cmdLine.findOption('\0', "type");
 		if (NULL == type)
 		{
 			help("Must specify shader type.");
@@ -2360,9 +2838,9 @@ namespace bgfx
 		options.outputFilePath = outFilePath;
 		options.shaderType = bx::toLower(type[0]);
 
-		options.disasm = cmdLine.hasArg('\0', "disasm");
+		options.disasm = _cmdLine.hasArg('\0', "disasm");
 
-		const char* platform = cmdLine.findOption('\0', "platform");
+		const char* platform = _cmdLine.findOption('\0', "platform");
 		if (NULL == platform)
 		{
 			platform = "";
@@ -2370,9 +2848,9 @@ namespace bgfx
 
 		options.platform = platform;
 
-		options.raw = cmdLine.hasArg('\0', "raw");
+		options.raw = _cmdLine.hasArg('\0', "raw");
 
-		const char* profile = cmdLine.findOption('p', "profile");
+		const char* profile = _cmdLine.findOption('p', "profile");
 
 		if ( NULL != profile)
 		{
@@ -2380,17 +2858,17 @@ namespace bgfx
 		}
 
 		{
-			options.debugInformation       = cmdLine.hasArg('\0', "debug");
-			options.avoidFlowControl       = cmdLine.hasArg('\0', "avoid-flow-control");
-			options.noPreshader            = cmdLine.hasArg('\0', "no-preshader");
-			options.partialPrecision       = cmdLine.hasArg('\0', "partial-precision");
-			options.preferFlowControl      = cmdLine.hasArg('\0', "prefer-flow-control");
-			options.backwardsCompatibility = cmdLine.hasArg('\0', "backwards-compatibility");
-			options.warningsAreErrors      = cmdLine.hasArg('\0', "Werror");
-			options.keepIntermediate       = cmdLine.hasArg('\0', "keep-intermediate");
+			options.debugInformation       = _cmdLine.hasArg('\0', "debug");
+			options.avoidFlowControl       = _cmdLine.hasArg('\0', "avoid-flow-control");
+			options.noPreshader            = _cmdLine.hasArg('\0', "no-preshader");
+			options.partialPrecision       = _cmdLine.hasArg('\0', "partial-precision");
+			options.preferFlowControl      = _cmdLine.hasArg('\0', "prefer-flow-control");
+			options.backwardsCompatibility = _cmdLine.hasArg('\0', "backwards-compatibility");
+			options.warningsAreErrors      = _cmdLine.hasArg('\0', "Werror");
+			options.keepIntermediate       = _cmdLine.hasArg('\0', "keep-intermediate");
 
 			uint32_t optimization = 3;
-			if (cmdLine.hasArg(optimization, 'O') )
+			if (_cmdLine.hasArg(optimization, 'O') )
 			{
 				options.optimize = true;
 				options.optimizationLevel = optimization;
@@ -2398,9 +2876,9 @@ namespace bgfx
 		}
 
 		bx::StringView bin2c;
-		if (cmdLine.hasArg("bin2c") )
+		if (_cmdLine.hasArg("bin2c") )
 		{
-			const char* bin2cArg = cmdLine.findOption("bin2c");
+			const char* bin2cArg = _cmdLine.findOption("bin2c");
 			if (NULL != bin2cArg)
 			{
 				bin2c.set(bin2cArg);
@@ -2431,9 +2909,9 @@ namespace bgfx
 			}
 		}
 
-		options.depends = cmdLine.hasArg("depends");
-		options.preprocessOnly = cmdLine.hasArg("preprocess");
-		const char* includeDir = cmdLine.findOption('i');
+		options.depends = _cmdLine.hasArg("depends");
+		options.preprocessOnly = _cmdLine.hasArg("preprocess");
+		const char* includeDir = _cmdLine.findOption('i');
 
 		BX_TRACE("depends: %d", options.depends);
 		BX_TRACE("preprocessOnly: %d", options.preprocessOnly);
@@ -2442,7 +2920,7 @@ namespace bgfx
 		for (int ii = 1; NULL != includeDir; ++ii)
 		{
 			options.includeDirs.push_back(includeDir);
-			includeDir = cmdLine.findOption(ii, 'i');
+			includeDir = _cmdLine.findOption(ii, 'i');
 		}
 
 		std::string dir;
@@ -2454,7 +2932,7 @@ namespace bgfx
 			options.includeDirs.push_back(dir);
 		}
 
-		const char* defines = cmdLine.findOption("define");
+		const char* defines = _cmdLine.findOption("define");
 		while (NULL != defines
 		&&    '\0'  != *defines)
 		{
@@ -2465,11 +2943,38 @@ namespace bgfx
 			defines = ';' == *eol.getPtr() ? eol.getPtr()+1 : eol.getPtr();
 		}
 
+		std::vector<std::string> keywords;
+		const char* keyword = _cmdLine.findOption("keywords");
+		while (NULL != keyword
+		&&    '\0'  != *keyword)
+		{
+			keyword = bx::strLTrimSpace(keyword).getPtr();
+			bx::StringView eol = bx::strFind(keyword, ';');
+			if (eol.getPtr() != keyword)
+			{
+				keywords.push_back(std::string(keyword, eol.getPtr() ) );
+			}
+			keyword = ';' == *eol.getPtr() ? eol.getPtr()+1 : eol.getPtr();
+		}
+
+		if (BGFX_SHADER_VARIANTS_MAX_KEYWORDS < keywords.size() )
+		{
+			fprintf(stderr, "Too many keywords %d, maximum is %d.\n", int32_t(keywords.size() ), BGFX_SHADER_VARIANTS_MAX_KEYWORDS);
+			return bx::kExitFailure;
+		}
+
+		if (!keywords.empty()
+		&& (options.preprocessOnly || !bin2c.isEmpty() ) )
+		{
+			fprintf(stderr, "--keywords can't be used with --preprocess or --bin2c.\n");
+			return bx::kExitFailure;
+		}
+
 		std::string commandLineComment = "// shaderc command line:\n//";
-		for (int32_t ii = 0, num = cmdLine.getNum(); ii < num; ++ii)
+		for (int32_t ii = 0, num = _cmdLine.getNum(); ii < num; ++ii)
 		{
 			commandLineComment += " ";
-			commandLineComment += cmdLine.get(ii);
+			commandLineComment += _cmdLine.get(ii);
 		}
 		commandLineComment += "\n\n";
 
@@ -2488,7 +2993,7 @@ namespace bgfx
 			if ('c' != options.shaderType)
 			{
 				std::string defaultVarying = dir + "varying.def.sc";
-				const char* varyingdef = cmdLine.findOption("varyingdef", defaultVarying.c_str() );
+				const char* varyingdef = _cmdLine.findOption("varyingdef", defaultVarying.c_str() );
 				attribdef.load(varyingdef);
 				varying = attribdef.getData();
 				if (NULL     != varying
@@ -2521,6 +3026,20 @@ namespace bgfx
 			bx::memSet(&data[size+1], 0, padding);
 			bx::close(&reader);
 
+			std::string cacheFile;
+			const char* cacheDir = _cmdLine.findOption("cache");
+			if (NULL != cacheDir
+			&& !options.preprocessOnly)
+			{
+				cacheFile = cacheFilePath(cacheDir, commandLineComment, data, size, varying);
+
+				if (readCache(cacheFile.c_str(), options) )
+				{
+					delete [] data;
+					return bx::kExitSuccess;
+				}
+			}
+
 			bx::FileWriter* writer = NULL;
 
 			if (!bin2c.isEmpty() )
@@ -2538,10 +3057,24 @@ namespace bgfx
 				return bx::kExitFailure;
 			}
 
-			compiled = compileShader(varying, commandLineComment.c_str(), data, size, options, writer);
+			if (keywords.empty() )
+			{
+				compiled = compileShader(varying, commandLineComment.c_str(), data, size, options, writer);
+			}
+			else
+			{
+				compiled = compileVariants(varying, commandLineComment.c_str(), data, size, options, keywords, writer);
+				delete [] data;
+			}
 
 			bx::close(writer);
 			delete writer;
+
+			if (compiled
+			&& !cacheFile.empty() )
+			{
+				writeCache(cacheFile.c_str(), options);
+			}
 		}
 
 		if (compiled)
@@ -60,6 +60,7 @@ namespace bgfx
 #include <bx/string.h>
 #include <bx/hash.h>
 #include <bx/file.h>
+#include <bx/mutex.h>
 #include "../../src/vertexdecl.h"
 
 namespace bgfx
@@ -105,6 +105,7 @@ namespace bgfx { namespace glsl
 		if (target != kGlslTargetMetal)
 		{
 			bx::StringView parse(optimizedShader);
+			uint16_t regIndex = 0;
 
 			while (!parse.isEmpty() )
 			{
@@ -188,6 +189,17 @@ namespace bgfx { namespace glsl
 						un.num = num;
 						un.regIndex = 0;
 						un.regCount = num;
+
+						if (UniformType::Sampler != un.type)
+						{
+							// std140 layout in vec4 registers, in declaration
+							// order. Renderer uses it for uniform blocks.
+							const uint16_t regs = UniformType::Mat4 == un.type ? 4 : UniformType::Mat3 == un.type ? 3 : 1;
+							un.regIndex = regIndex;
+							un.regCount = uint16_t(num*regs);
+							regIndex += un.regCount;
+						}
+
 						uniforms.push_back(un);
 					}
 
@@ -360,6 +372,11 @@ namespace bgfx { namespace glsl
 
 	bool compileGLSLShader(const Options& _options, uint32_t _version, const std::string& _code, bx::WriterI* _writer)
 	{
+		// glsl-optimizer keeps global state shared between contexts, when
+		// compiling in batch mode only one shader can be optimized at time.
+		static bx::Mutex s_mutex;
+		bx::MutexScope scope(s_mutex);
+
 		return glsl::compile(_options, _version, _code, _writer);
 	}
 
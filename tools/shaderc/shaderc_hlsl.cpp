@@ -815,6 +815,12 @@ namespace bgfx { namespace hlsl
 
 	bool compileHLSLShader(const Options& _options, uint32_t _version, const std::string& _code, bx::WriterI* _writer)
 	{
+		// D3DCompiler is loaded and unloaded for each shader through global
+		// function pointers, when compiling in batch mode only one shader can
+		// be compiled at time.
+		static bx::Mutex s_mutex;
+		bx::MutexScope scope(s_mutex);
+
 		return hlsl::compile(_options, _version, _code, _writer, true);
 	}
 
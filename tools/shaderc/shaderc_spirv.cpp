@@ -4,6 +4,7 @@
  */
 
 #include "shaderc.h"
+#include <bx/mutex.h>
 
 BX_PRAGMA_DIAGNOSTIC_PUSH()
 BX_PRAGMA_DIAGNOSTIC_IGNORED_MSVC(4100) // error C4100: 'inclusionDepth' : unreferenced formal parameter
@@ -617,11 +618,37 @@ namespace bgfx { namespace spirv
 		return size;
 	}
 
+	static bx::Mutex s_glslangMutex;
+	static uint32_t  s_glslangRefCount = 0;
+
+	/// glslang process state is global. With --manifest shaders are compiled on multiple
+	/// threads, so it's initialized by first compile and finalized by last one to finish.
+	struct GlslangProcessScope
+	{
+		GlslangProcessScope()
+		{
+			bx::MutexScope lock(s_glslangMutex);
+			if (0 == s_glslangRefCount++)
+			{
+				glslang::InitializeProcess();
+			}
+		}
+
+		~GlslangProcessScope()
+		{
+			bx::MutexScope lock(s_glslangMutex);
+			if (0 == --s_glslangRefCount)
+			{
+				glslang::FinalizeProcess();
+			}
+		}
+	};
+
 	static bool compile(const Options& _options, uint32_t _version, const std::string& _code, bx::WriterI* _writer, bool _firstPass)
 	{
 		BX_UNUSED(_version);
 
-		glslang::InitializeProcess();
+		GlslangProcessScope glslangScope;
 
 		glslang::TProgram* program = new glslang::TProgram;
 
@@ -945,8 +972,6 @@ namespace bgfx { namespace spirv
 		delete program;
 		delete shader;
 
-		glslang::FinalizeProcess();
-
 		return compiled && linked && validated;
 	}
 